@@ -28,7 +28,11 @@ public:
     // Perform an automatic save, unconditionally. This will run the save algorithms
     // for the currently loaded map, regardless whether it is due for a save or not.
     // Call the "runAutosaveCheck" method to see if an autosave is overdue.
+    // The map is captured right away, the files are written in the background.
     virtual void performAutosave() = 0;
+
+    // Blocks until the files of the last performAutosave() call have been written.
+    virtual void finishPendingSave() = 0;
 };
 
 constexpr const char* const RKEY_AUTOSAVE_SNAPSHOTS_ENABLED = "user/ui/map/autoSaveSnapshots";
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "inode.h"
-#include <string>
+#include "math/Hash.h"
 
 namespace scene
 {
 
+// Fingerprint value of a comparable node, a default-constructed instance is empty
+using Fingerprint = math::Hash128;
+
 /**
  * Prototype of a comparable scene node, providing hash information
  * for comparison to another node. Nodes of the same type can be compared against each other.
@@ -19,7 +22,8 @@ public:
     // Returns the fingerprint (checksum) of this node, to allow for quick 
     // matching against other nodes of the same type. Fingerprints of different
     // types are not comparable, be sure to check the node type first.
-    virtual std::string getFingerprint() = 0;
+    // The value is cached by the nodes and recalculated after they changed.
+    virtual Fingerprint getFingerprint() = 0;
 };
 
 // The number of digits that are considered when hashing floating point values in fingerprinting
@@ -525,6 +525,16 @@ public:
     // Access to the settings manager
     virtual IEntitySettings& getSettings() = 0;
 
+    /**
+     * While model loading is suspended, entities don't load the model named in their
+     * "model" spawnarg right away, it is loaded by the next IEntityNode::refreshModel()
+     * call instead. This allows for collecting the models of many entities first,
+     * such that they can be loaded concurrently (see IModelCache::preloadModels).
+     * Calls can be nested, every suspendModelLoading() needs a matching resumeModelLoading().
+     */
+    virtual void suspendModelLoading() = 0;
+    virtual void resumeModelLoading() = 0;
+
     /**
      * Create an instance of the given entity at the given position, and return
      * the Node containing the new entity.
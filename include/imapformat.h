@@ -121,6 +121,20 @@ public:
 	// Patch export methods
 	virtual void beginWritePatch(const IPatchNodePtr& patch, std::ostream& stream) = 0;
 	virtual void endWritePatch(const IPatchNodePtr& patch, std::ostream& stream) = 0;
+
+	/**
+	 * Returns a new writer which is able to write a part of the map independently
+	 * of this instance, continuing as if the given number of entities had been begun
+	 * and the given number of primitives had been written to the current entity.
+	 * This allows for several parts of the map to be written concurrently, each into
+	 * its own buffer, to be concatenated in order afterwards.
+	 *
+	 * Writers which need to see all nodes in sequence return an empty pointer.
+	 */
+	virtual std::shared_ptr<IMapWriter> createPartialWriter(std::size_t entityNum, std::size_t primitiveNum)
+	{
+		return std::shared_ptr<IMapWriter>();
+	}
 };
 typedef std::shared_ptr<IMapWriter> IMapWriterPtr;
 
@@ -57,6 +57,17 @@ public:
 	// Each frame has a series of float values, applied to one or more animated components (x, y, z, yaw, pitch, roll)
 	typedef std::vector<float> FrameKeys;
 
+	// The joint keys of a single animation frame
+	struct FramePose
+	{
+		// The base frame keys with the frame values applied, relative to the parent joints
+		std::vector<Key> localKeys;
+
+		// The keys with the joint hierarchy applied
+		std::vector<Key> keys;
+	};
+	typedef std::shared_ptr<const FramePose> FramePosePtr;
+
 	/**
 	 * Get the number of joints in this animation.
 	 */
@@ -98,6 +109,12 @@ public:
 	 * the file does not exist or the anim was found to be invalid.
 	 */
 	virtual IMD5AnimPtr getAnim(const std::string& vfsPath) = 0;
+
+	/**
+	 * Returns the pose of the given animation frame. Every pose is calculated
+	 * once and shared by all models playing the same animation.
+	 */
+	virtual IMD5Anim::FramePosePtr getFramePose(const IMD5AnimPtr& anim, std::size_t frame) = 0;
 };
 
 const char* const MODULE_ANIMATIONCACHE("MD5AnimationCache");
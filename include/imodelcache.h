@@ -3,6 +3,7 @@
 #include "imodule.h"
 #include "imodel.h"
 #include "inode.h"
+#include <set>
 #include <sigc++/signal.h>
 
 namespace model 
@@ -37,6 +38,16 @@ public:
 	 */
 	virtual IModelPtr getModel(const std::string& modelPath) = 0;
 
+	/**
+	 * Starts loading the models at the given VFS paths on a set of worker threads
+	 * and returns immediately. Paths that are already cached or currently being
+	 * loaded are skipped, as well as paths without a suitable model importer.
+	 *
+	 * A getModel() or getModelNode() call requesting one of these paths will wait
+	 * for its load to finish and then store the result in the cache as usual.
+	 */
+	virtual void preloadModels(const std::set<std::string>& modelPaths) = 0;
+
     // Loads a model from the static resources in DarkRadiant's runtime data/resources folder
     virtual scene::INodePtr getModelNodeForStaticResource(const std::string& resourcePath) = 0;
 
@@ -283,6 +283,10 @@ public:
 	virtual scene::INodePtr createPatch(PatchDefType type) = 0;
 
 	virtual IPatchSettings& getSettings() = 0;
+
+	// Number of transformed patches waiting for their tesselation update,
+	// which is done in one batch before the next patch is rendered
+	virtual std::size_t getNumQueuedTesselations() = 0;
 };
 
 }
@@ -186,10 +186,39 @@ public:
 
     /**
      * Enumerate all entity object (partially) intersecting with the given bounds.
-     * The bounds are specified in world coordinates.
+     * The bounds are specified in world coordinates. This might call into the
+     * objects to update their bounds, so it must only be used from the render thread.
+     * Worker threads need to use foreachPreparedRenderableTouchingBounds().
      */
     virtual void foreachRenderableTouchingBounds(const AABB& bounds, const ObjectVisitFunction& functor) = 0;
 
+    /**
+     * Brings the world bounds cached for all objects up to date. This is calling
+     * into the objects which changed since the last call, giving them the chance
+     * to build their pending geometry. Needs to be called from the render thread.
+     */
+    virtual void prepareRenderableBounds() = 0;
+
+    using PreparedObjectVisitFunction = std::function<void(const render::IRenderableObject::Ptr&, Shader*, const AABB&)>;
+
+    /**
+     * Enumerate all entity objects (partially) intersecting with the given bounds,
+     * passing the world bounds of each object to the functor. The query is working
+     * on the state of the last prepareRenderableBounds() call, without calling into
+     * the objects. It can be run from several threads at once, as long as the
+     * entity and its objects are not changed in the meantime.
+     */
+    virtual void foreachPreparedRenderableTouchingBounds(const AABB& bounds,
+        const PreparedObjectVisitFunction& functor) const = 0;
+
+    /**
+     * Returns a number that is increased whenever an object is added to or removed
+     * from this entity, or when one of the objects changes its bounds. Renderers can
+     * use this to find out whether a previous foreachRenderableTouchingBounds() result
+     * is still valid.
+     */
+    virtual std::size_t getRenderableChangeCount() const = 0;
+
     // Returns true if this entity produces shadows when lit (i.e.returns false when the entity has "noshadows" set to 1)
     virtual bool isShadowCasting() const = 0;
 };
@@ -4,6 +4,7 @@
 #include "ideclmanager.h"
 #include "igameresource.h"
 
+#include <memory>
 #include <vector>
 #include <functional>
 
@@ -76,6 +77,35 @@ public:
 	virtual const std::string& getDisplayFolder() = 0;
 };
 
+/**
+ * A source of decoded PCM sample data, which is read in chunks
+ * instead of decoding the whole file into memory at once.
+ * The format of the samples is constant for the lifetime of the stream.
+ */
+class ISoundStream
+{
+public:
+    using Ptr = std::unique_ptr<ISoundStream>;
+
+    virtual ~ISoundStream() {}
+
+    // Number of interleaved channels (1 = mono, 2 = stereo)
+    virtual unsigned int getNumChannels() const = 0;
+
+    // Bits per sample, either 8 or 16
+    virtual unsigned int getBitsPerSample() const = 0;
+
+    // Samples per second
+    virtual unsigned int getSampleRate() const = 0;
+
+    // Decodes up to <size> bytes of sample data into the given buffer.
+    // Returns the number of bytes written, which is 0 when the end of the stream is reached.
+    virtual std::size_t read(char* buffer, std::size_t size) = 0;
+
+    // Restarts the stream at the first sample, returns false if this failed
+    virtual bool rewind() = 0;
+};
+
 constexpr const char* const MODULE_SOUNDMANAGER("SoundManager");
 
 /// Sound manager interface.
@@ -94,8 +124,8 @@ public:
     /** 
 	 * greebo: Plays the given sound file (defined by its VFS path).
      *
-     * @returns: TRUE, if the sound file was found at the given VFS path,
-     *           FALSE otherwise
+     * @returns: TRUE, if the sound file was found at the given VFS path
+     *           and could be opened for playback, FALSE otherwise
      */
     virtual bool playSound(const std::string& fileName) = 0;
 
@@ -103,8 +133,8 @@ public:
 	 * greebo: Plays the given sound file (defined by its VFS path).
 	 * Will loop the sound if the given flag is set to TRUE.
 	 *
-	 * @returns: TRUE, if the sound file was found at the given VFS path,
-	 *           FALSE otherwise
+	 * @returns: TRUE, if the sound file was found at the given VFS path
+	 *           and could be opened for playback, FALSE otherwise
 	 */
 	virtual bool playSound(const std::string& fileName, bool loopSound) = 0;
 
@@ -116,6 +146,12 @@ public:
     // Will throw a std::out_of_range exception if the path cannot be resolved
     virtual float getSoundFileDuration(const std::string& vfsPath) = 0;
 
+    // Opens a stream decoding the samples of the given sound file, this doesn't need a sound device.
+    // WAV streams can only be rewound if <rewindable> is set, since this keeps the data in memory.
+    // Will throw a std::out_of_range exception if the path cannot be resolved,
+    // or a std::runtime_error if the file cannot be decoded.
+    virtual ISoundStream::Ptr openSoundStream(const std::string& vfsPath, bool rewindable) = 0;
+
     // Reloads all sound shader definitions from the VFS
     virtual void reloadSounds() = 0;
 };
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace parallel
+{
+
+// Returns the number of worker threads to use for the given number of items
+inline std::size_t getNumWorkers(std::size_t numItems)
+{
+    return std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u), numItems);
+}
+
+/**
+ * Calls a function for every index in [0..count), distributed over a set of
+ * worker threads (one per hardware thread, at most one per index). Each worker
+ * picks the next unprocessed index until all of them are done, the indices are
+ * processed in no particular order.
+ *
+ * If the function throws, the workers stop picking up new indices. The first
+ * exception is re-thrown by get(), after all workers have stopped.
+ *
+ * The function is copied and only called from the worker threads, the workers
+ * can be left running after the creating scope has been left (the destructor
+ * is blocking until they are done, like the futures of std::async).
+ */
+class IndexWorkers
+{
+public:
+    using Function = std::function<void(std::size_t)>;
+
+private:
+    struct State
+    {
+        std::size_t count;
+        Function func;
+        std::atomic<std::size_t> nextIndex;
+        std::atomic<std::size_t> numProcessed;
+        std::atomic<bool> cancelled;
+
+        State(std::size_t count_, Function func_) :
+            count(count_),
+            func(std::move(func_)),
+            nextIndex(0),
+            numProcessed(0),
+            cancelled(false)
+        {}
+    };
+
+    std::shared_ptr<State> _state;
+    std::vector<std::future<void>> _workers;
+
+public:
+    IndexWorkers(std::size_t count, Function func) :
+        _state(std::make_shared<State>(count, std::move(func)))
+    {
+        auto numWorkers = getNumWorkers(count);
+        _workers.reserve(numWorkers);
+
+        for (std::size_t i = 0; i < numWorkers; ++i)
+        {
+            _workers.emplace_back(std::async(std::launch::async, [state = _state]()
+            {
+                for (auto index = state->nextIndex++; index < state->count && !state->cancelled;
+                     index = state->nextIndex++)
+                {
+                    try
+                    {
+                        state->func(index);
+                    }
+                    catch (...)
+                    {
+                        // Let the other workers stop early, the exception is stored in the future
+                        state->cancelled = true;
+                        throw;
+                    }
+
+                    ++state->numProcessed;
+                }
+            }));
+        }
+    }
+
+    IndexWorkers(IndexWorkers&& other) = default;
+    IndexWorkers& operator=(IndexWorkers&& other) = default;
+
+    // Number of indices the function has been completed for
+    std::size_t getNumProcessed() const
+    {
+        return _state->numProcessed;
+    }
+
+    // Lets the workers stop after the index they're currently processing
+    void cancel()
+    {
+        _state->cancelled = true;
+    }
+
+    // True if all workers have stopped
+    bool isFinished() const
+    {
+        return std::all_of(_workers.begin(), _workers.end(), [](const std::future<void>& worker)
+        {
+            return !worker.valid() || worker.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+    }
+
+    // Waits until all workers have stopped or the timeout has passed,
+    // returns true if all of them have stopped
+    bool waitFor(std::chrono::milliseconds timeout) const
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        return std::all_of(_workers.begin(), _workers.end(), [&](const std::future<void>& worker)
+        {
+            return !worker.valid() || worker.wait_until(deadline) == std::future_status::ready;
+        });
+    }
+
+    // Waits until all workers have stopped, exceptions are not propagated
+    void wait() const
+    {
+        for (const auto& worker : _workers)
+        {
+            if (worker.valid()) worker.wait();
+        }
+    }
+
+    // Waits until all workers have stopped and re-throws the first exception of the function
+    void get()
+    {
+        wait();
+
+        for (auto& worker : _workers)
+        {
+            if (worker.valid()) worker.get();
+        }
+    }
+};
+
+/**
+ * Calls the function for every index in [0..count) on a set of worker threads
+ * and blocks until all of them are done. Exceptions thrown by the function are
+ * propagated to the caller, after all workers have stopped. If only one worker
+ * would be used, the indices are processed on the calling thread.
+ */
+inline void forEachIndex(std::size_t count, const IndexWorkers::Function& func)
+{
+    if (getNumWorkers(count) < 2)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+
+        return;
+    }
+
+    IndexWorkers workers(count, func);
+    workers.get();
+}
+
+/**
+ * Like forEachIndex(), but calls the progress function on the calling thread in
+ * the given interval while the workers are busy, passing the number of processed
+ * indices. The progress function is allowed to throw to cancel the operation,
+ * the exception is propagated after all workers have stopped.
+ */
+inline void forEachIndex(std::size_t count, const IndexWorkers::Function& func,
+    const std::function<void(std::size_t)>& progress, std::chrono::milliseconds interval)
+{
+    IndexWorkers workers(count, func);
+
+    try
+    {
+        while (!workers.waitFor(interval))
+        {
+            progress(workers.getNumProcessed());
+        }
+    }
+    catch (...)
+    {
+        // The workers must not outlive the objects the function is referring to
+        workers.cancel();
+        workers.wait();
+        throw;
+    }
+
+    workers.get();
+}
+
+}
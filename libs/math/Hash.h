@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <string>
 #include "Vector3.h"
 #include "SHA256.h"
 
@@ -104,4 +107,214 @@ public:
     }
 };
 
+// A 128 bit hash value as produced by the FastHash class below. A fixed-size
+// value type, which is cheap to copy, compare and store as map key.
+// A default-constructed value is considered empty.
+struct Hash128
+{
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    bool empty() const
+    {
+        return low == 0 && high == 0;
+    }
+
+    bool operator==(const Hash128& other) const
+    {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator!=(const Hash128& other) const
+    {
+        return !operator==(other);
+    }
+
+    bool operator<(const Hash128& other) const
+    {
+        return high < other.high || (high == other.high && low < other.low);
+    }
+
+    // Returns the hexadecimal representation (32 characters)
+    std::string toString() const
+    {
+        constexpr char hexChars[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+
+        std::string hexString(32, '\0');
+
+        for (auto i = 0; i < 16; ++i)
+        {
+            auto value = high >> (60 - i * 4);
+            hexString[i] = hexChars[value & 0x0F];
+            hexString[i + 16] = hexChars[(low >> (60 - i * 4)) & 0x0F];
+        }
+
+        return hexString;
+    }
+};
+
+// Non-cryptographic 128 bit hash with the same interface as the Hash class above,
+// considerably faster than SHA256. The 64 bit words are fed into the block mixing
+// and finalisation steps of MurmurHash3 (x64_128 variant).
+class FastHash
+{
+private:
+    std::uint64_t _h1;
+    std::uint64_t _h2;
+
+    // Words are mixed in pairs, this is holding the first one of an incomplete pair
+    std::uint64_t _pendingWord;
+    bool _hasPendingWord;
+
+    std::uint64_t _length;
+
+    static constexpr std::uint64_t C1 = 0x87c37b91114253d5ULL;
+    static constexpr std::uint64_t C2 = 0x4cf5ad432745937fULL;
+
+public:
+    FastHash(std::uint64_t seed = 0) :
+        _h1(seed),
+        _h2(seed),
+        _pendingWord(0),
+        _hasPendingWord(false),
+        _length(0)
+    {}
+
+    void addSizet(std::size_t value)
+    {
+        addWord(static_cast<std::uint64_t>(value));
+    }
+
+    void addDouble(double value, std::size_t significantDigits)
+    {
+        addWord(roundDouble(value, significantDigits));
+    }
+
+    template<typename ElementType>
+    void addVector3(const BasicVector3<ElementType>& v, std::size_t significantDigits)
+    {
+        addWord(roundDouble(v.x(), significantDigits));
+        addWord(roundDouble(v.y(), significantDigits));
+        addWord(roundDouble(v.z(), significantDigits));
+    }
+
+    void addString(const std::string& str)
+    {
+        auto remaining = str.length();
+        auto data = str.data();
+
+        for (; remaining >= sizeof(std::uint64_t); remaining -= sizeof(std::uint64_t), data += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            addWord(word);
+        }
+
+        if (remaining > 0)
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, data, remaining);
+            addWord(word);
+        }
+
+        // Include the length, such that subsequent strings can't be shifted against each other
+        addWord(static_cast<std::uint64_t>(str.length()));
+    }
+
+    void addHash(const Hash128& hash)
+    {
+        addWord(hash.low);
+        addWord(hash.high);
+    }
+
+    Hash128 getValue() const
+    {
+        auto h1 = _h1;
+        auto h2 = _h2;
+
+        if (_hasPendingWord)
+        {
+            h1 ^= mixK1(_pendingWord);
+        }
+
+        h1 ^= _length;
+        h2 ^= _length;
+
+        h1 += h2;
+        h2 += h1;
+
+        h1 = finalMix(h1);
+        h2 = finalMix(h2);
+
+        h1 += h2;
+        h2 += h1;
+
+        return Hash128{ h1, h2 };
+    }
+
+    operator Hash128() const
+    {
+        return getValue();
+    }
+
+private:
+    static std::uint64_t roundDouble(double value, std::size_t significantDigits)
+    {
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(value * detail::RoundingFactor(significantDigits)));
+    }
+
+    static std::uint64_t rotateLeft(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static std::uint64_t mixK1(std::uint64_t k1)
+    {
+        k1 *= C1;
+        k1 = rotateLeft(k1, 31);
+        return k1 * C2;
+    }
+
+    static std::uint64_t mixK2(std::uint64_t k2)
+    {
+        k2 *= C2;
+        k2 = rotateLeft(k2, 33);
+        return k2 * C1;
+    }
+
+    static std::uint64_t finalMix(std::uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    void addWord(std::uint64_t word)
+    {
+        _length += sizeof(word);
+
+        if (!_hasPendingWord)
+        {
+            _pendingWord = word;
+            _hasPendingWord = true;
+            return;
+        }
+
+        _hasPendingWord = false;
+
+        _h1 ^= mixK1(_pendingWord);
+        _h1 = rotateLeft(_h1, 27);
+        _h1 += _h2;
+        _h1 = _h1 * 5 + 0x52dce729;
+
+        _h2 ^= mixK2(word);
+        _h2 = rotateLeft(_h2, 31);
+        _h2 += _h1;
+        _h2 = _h2 * 5 + 0x38495ab5;
+    }
+};
+
 }
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <unordered_map>
+#include "math/Hash.h"
+#include "render/MeshVertex.h"
+
+namespace render
+{
+
+namespace detail
+{
+    // Hashes the position and texture coordinates of a vertex, the other
+    // attributes are only considered when comparing the colliding vertices
+    struct ExactVertexHash
+    {
+        std::size_t operator()(const MeshVertex& v) const
+        {
+            // Adding 0 turns -0 into +0, which are considered equal by operator==
+            std::size_t hash = std::hash<double>()(v.vertex.x() + 0.0);
+            math::combineHash(hash, std::hash<double>()(v.vertex.y() + 0.0));
+            math::combineHash(hash, std::hash<double>()(v.vertex.z() + 0.0));
+            math::combineHash(hash, std::hash<double>()(v.texcoord.x() + 0.0));
+            math::combineHash(hash, std::hash<double>()(v.texcoord.y() + 0.0));
+
+            return hash;
+        }
+    };
+
+    struct ExactVertexEqual
+    {
+        bool operator()(const MeshVertex& a, const MeshVertex& b) const
+        {
+            return a.vertex == b.vertex && a.normal == b.normal && a.texcoord == b.texcoord &&
+                a.colour == b.colour && a.tangent == b.tangent && a.bitangent == b.bitangent;
+        }
+    };
+
+    // Parameters of the vertex scoring function, taken from Forsyth's article
+    constexpr std::size_t CacheSize = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    constexpr std::size_t NoTriangle = std::numeric_limits<std::size_t>::max();
+
+    struct VertexInfo
+    {
+        int cachePosition = -1;
+        float score = 0;
+
+        // Range of this vertex' triangles in the adjacency list,
+        // the ones not emitted yet are kept in front
+        std::size_t firstTriangle = 0;
+        std::size_t numActiveTriangles = 0;
+    };
+
+    inline float getVertexScore(const VertexInfo& vertex)
+    {
+        if (vertex.numActiveTriangles == 0)
+        {
+            return -1.0f; // no triangle left needing this vertex
+        }
+
+        float score = 0;
+
+        if (vertex.cachePosition >= 0)
+        {
+            if (vertex.cachePosition < 3)
+            {
+                // The vertices of the last triangle get a fixed score, to not favour
+                // any of them, the next triangle is going to share an edge anyway
+                score = LastTriangleScore;
+            }
+            else
+            {
+                // Points for being high in the cache
+                const float scaler = 1.0f / (CacheSize - 3);
+                score = std::pow(1.0f - (vertex.cachePosition - 3) * scaler, CacheDecayPower);
+            }
+        }
+
+        // Bonus points for having only a few triangles left, to get rid of lone vertices quickly
+        score += ValenceBoostScale * std::pow(static_cast<float>(vertex.numActiveTriangles), -ValenceBoostPower);
+
+        return score;
+    }
+}
+
+/**
+ * Load-time optimisations applied to the geometry of static model surfaces.
+ *
+ * None of these operations is changing the appearance of the mesh: only
+ * vertices with exactly the same attributes are merged, and the triangles
+ * are kept as they are, only the order they are drawn in is changed.
+ */
+class MeshOptimiser
+{
+public:
+    // Merges vertices that are exactly equal in all of their attributes and
+    // remaps the indices accordingly. The remaining vertices keep their order.
+    static void weldVertices(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        std::unordered_map<MeshVertex, unsigned int, detail::ExactVertexHash, detail::ExactVertexEqual> uniqueVertices;
+        uniqueVertices.reserve(vertices.size());
+
+        std::vector<unsigned int> remap(vertices.size());
+        std::size_t numUniqueVertices = 0;
+
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            auto result = uniqueVertices.try_emplace(vertices[i], static_cast<unsigned int>(numUniqueVertices));
+
+            if (result.second)
+            {
+                // First occurrence, move it down to the end of the unique vertex block
+                vertices[numUniqueVertices++] = vertices[i];
+            }
+
+            remap[i] = result.first->second;
+        }
+
+        if (numUniqueVertices == vertices.size())
+        {
+            return; // nothing to weld
+        }
+
+        vertices.resize(numUniqueVertices);
+
+        for (auto& index : indices)
+        {
+            if (index < remap.size())
+            {
+                index = remap[index];
+            }
+        }
+    }
+
+    // Re-orders the triangles such that subsequent triangles are re-using the
+    // vertices in the GPU's post-transform cache as often as possible.
+    // This is an implementation of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".
+    static void optimiseTriangleOrder(std::vector<unsigned int>& indices, std::size_t numVertices)
+    {
+        auto numTriangles = indices.size() / 3;
+
+        if (numTriangles < 2 || indices.size() % 3 != 0)
+        {
+            return;
+        }
+
+        for (auto index : indices)
+        {
+            if (index >= numVertices) return; // don't touch invalid meshes
+        }
+
+        std::vector<detail::VertexInfo> vertexInfo(numVertices);
+
+        // Build the list of triangles using each vertex
+        for (auto index : indices)
+        {
+            vertexInfo[index].numActiveTriangles++;
+        }
+
+        std::size_t offset = 0;
+
+        for (auto& vertex : vertexInfo)
+        {
+            vertex.firstTriangle = offset;
+            offset += vertex.numActiveTriangles;
+            vertex.numActiveTriangles = 0;
+        }
+
+        std::vector<std::size_t> vertexTriangles(indices.size());
+
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            auto& vertex = vertexInfo[indices[i]];
+            vertexTriangles[vertex.firstTriangle + vertex.numActiveTriangles++] = i / 3;
+        }
+
+        for (auto& vertex : vertexInfo)
+        {
+            vertex.score = detail::getVertexScore(vertex);
+        }
+
+        std::vector<float> triangleScores(numTriangles);
+        std::vector<bool> triangleEmitted(numTriangles, false);
+
+        for (std::size_t t = 0; t < numTriangles; ++t)
+        {
+            triangleScores[t] = vertexInfo[indices[t * 3]].score +
+                vertexInfo[indices[t * 3 + 1]].score + vertexInfo[indices[t * 3 + 2]].score;
+        }
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+
+        // The simulated cache holds the most recently used vertices at the front,
+        // it can temporarily grow by the three vertices of a new triangle
+        std::vector<unsigned int> cache;
+        std::vector<unsigned int> newCache;
+        cache.reserve(detail::CacheSize + 3);
+        newCache.reserve(detail::CacheSize + 3);
+
+        std::size_t bestTriangle = detail::NoTriangle;
+        std::size_t nextUnemittedTriangle = 0;
+
+        for (std::size_t emitted = 0; emitted < numTriangles; ++emitted)
+        {
+            if (bestTriangle == detail::NoTriangle)
+            {
+                // Nothing in the cache is connected to any remaining triangle, continue
+                // with the next one in the original order
+                while (triangleEmitted[nextUnemittedTriangle])
+                {
+                    ++nextUnemittedTriangle;
+                }
+
+                bestTriangle = nextUnemittedTriangle;
+            }
+
+            triangleEmitted[bestTriangle] = true;
+
+            newCache.clear();
+
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                auto index = indices[bestTriangle * 3 + corner];
+                result.push_back(index);
+                newCache.push_back(index);
+
+                // Remove the triangle from the active list of this vertex
+                auto& vertex = vertexInfo[index];
+                auto begin = vertexTriangles.begin() + vertex.firstTriangle;
+                auto end = begin + vertex.numActiveTriangles;
+
+                for (auto t = begin; t != end; ++t)
+                {
+                    if (*t == bestTriangle)
+                    {
+                        std::swap(*t, *(end - 1));
+                        break;
+                    }
+                }
+
+                vertex.numActiveTriangles--;
+            }
+
+            // The vertices already in the cache are moving down
+            for (auto index : cache)
+            {
+                if (index != newCache[0] && index != newCache[1] && index != newCache[2])
+                {
+                    newCache.push_back(index);
+                }
+            }
+
+            std::swap(cache, newCache);
+
+            // Update the scores of the vertices that are in (or just fell out of) the cache
+            for (std::size_t i = 0; i < cache.size(); ++i)
+            {
+                auto& vertex = vertexInfo[cache[i]];
+                vertex.cachePosition = i < detail::CacheSize ? static_cast<int>(i) : -1;
+
+                auto newScore = detail::getVertexScore(vertex);
+                auto scoreDelta = newScore - vertex.score;
+                vertex.score = newScore;
+
+                for (std::size_t t = 0; t < vertex.numActiveTriangles; ++t)
+                {
+                    triangleScores[vertexTriangles[vertex.firstTriangle + t]] += scoreDelta;
+                }
+            }
+
+            if (cache.size() > detail::CacheSize)
+            {
+                cache.resize(detail::CacheSize);
+            }
+
+            // The next triangle is the best one using any of the cached vertices
+            bestTriangle = detail::NoTriangle;
+            float bestScore = -1;
+
+            for (auto index : cache)
+            {
+                const auto& vertex = vertexInfo[index];
+
+                for (std::size_t t = 0; t < vertex.numActiveTriangles; ++t)
+                {
+                    auto triangle = vertexTriangles[vertex.firstTriangle + t];
+
+                    if (triangleScores[triangle] > bestScore)
+                    {
+                        bestScore = triangleScores[triangle];
+                        bestTriangle = triangle;
+                    }
+                }
+            }
+        }
+
+        indices.swap(result);
+    }
+};
+
+}
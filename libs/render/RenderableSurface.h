@@ -30,13 +30,20 @@ private:
     // The render entity the adapter is attached to
     IRenderEntity* _renderEntity;
 
+    // The shader used to attach to the render entity
+    ShaderPtr _entityShader;
+
     // When attached to an entity, this is the backend storage handle
     IGeometryStore::Slot _storageLocation;
 
+    // The storage location might change after a geometry update
+    bool _storageLocationNeedsUpdate;
+
 protected:
     RenderableSurface() :
         _renderEntity(nullptr),
-        _storageLocation(std::numeric_limits<IGeometryStore::Slot>::max())
+        _storageLocation(std::numeric_limits<IGeometryStore::Slot>::max()),
+        _storageLocationNeedsUpdate(false)
     {}
 
 public:
@@ -71,6 +78,9 @@ public:
             shader->updateSurface(slot);
         }
 
+        // Surfaces sharing their storage might get a new one, re-acquire it next time
+        _storageLocationNeedsUpdate = _renderEntity != nullptr;
+
         boundsChanged();
     }
 
@@ -107,7 +117,9 @@ public:
 
         _renderEntity = entity;
         _renderEntity->addRenderable(shared_from_this(), shader.get());
+        _entityShader = shader;
         _storageLocation = shader->getSurfaceStorageLocation(_shaders[shader]);
+        _storageLocationNeedsUpdate = false;
     }
 
     // Renders the surface stored in our single slot
@@ -124,8 +136,16 @@ public:
         return _sigBoundsChanged;
     }
 
+    // Returns the storage location of the geometry, this may only be called
+    // after the shaders have been prepared for rendering
     IGeometryStore::Slot getStorageLocation() override
     {
+        if (_storageLocationNeedsUpdate)
+        {
+            _storageLocationNeedsUpdate = false;
+            _storageLocation = _entityShader->getSurfaceStorageLocation(_shaders[_entityShader]);
+        }
+
         assert(_storageLocation != std::numeric_limits<IGeometryStore::Slot>::max());
         return _storageLocation;
     }
@@ -139,7 +159,9 @@ private:
             _renderEntity = nullptr;
         }
 
+        _entityShader.reset();
         _storageLocation = std::numeric_limits<IGeometryStore::Slot>::max();
+        _storageLocationNeedsUpdate = false;
     }
 
     void detachFromShader(const ShaderMapping::iterator& iter)
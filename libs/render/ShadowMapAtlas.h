@@ -0,0 +1,224 @@
+#pragma once
+
+#include <set>
+#include <vector>
+#include <utility>
+#include <cassert>
+#include <functional>
+#include "Rectangle.h"
+
+namespace render
+{
+
+/**
+ * Manages the regions of the shadow map texture, which are assigned to the
+ * shadow casting lights. Every light needs six square tiles of the same size
+ * (one for each cube map face), which are placed next to each other in a
+ * horizontal strip of 6*size x size pixels.
+ *
+ * The atlas is divided into square root blocks of the maximum tile size, the
+ * strips are handed out by a buddy allocator splitting these blocks into
+ * four quarters each level down. Freed strips are merged with their siblings,
+ * to make room for larger tiles again.
+ */
+class ShadowMapAtlas
+{
+public:
+    // The number of tile sizes below (and including) the maximum size
+    constexpr static std::size_t NumTileSizes = 5;
+
+    // Invoked when the atlas is full, should free a region and return true,
+    // or return false if there's nothing that can be freed
+    using EvictFunction = std::function<bool()>;
+
+private:
+    std::size_t _maxTileSize;
+
+    // Block positions in units of (6 pixels, 1 pixel), such that a strip
+    // of six tiles is covering a square block
+    using Block = std::pair<int, int>;
+
+    // The unused blocks of every level, level 0 is the maximum tile size
+    std::vector<std::set<Block>> _freeBlocks;
+
+public:
+    // Constructs the atlas for a square shadow map texture of the given size
+    ShadowMapAtlas(std::size_t textureSize) :
+        _maxTileSize(textureSize / 6),
+        _freeBlocks(NumTileSizes)
+    {
+        clear();
+    }
+
+    std::size_t getMaxTileSize() const
+    {
+        return _maxTileSize;
+    }
+
+    std::size_t getMinTileSize() const
+    {
+        return _maxTileSize >> (NumTileSizes - 1);
+    }
+
+    // Frees all allocated regions
+    void clear()
+    {
+        for (auto& blocks : _freeBlocks)
+        {
+            blocks.clear();
+        }
+
+        // The strips are six times as wide as high, so a texture of 6N x 6N pixels
+        // is holding six root blocks of size N on top of each other
+        for (int i = 0; i < 6; ++i)
+        {
+            _freeBlocks[0].emplace(0, i * getBlockSize(0));
+        }
+    }
+
+    // Allocates six tiles of the given size (which must be one of the supported
+    // power-of-two sizes), returns false if the atlas has no space left.
+    // The rectangle is receiving the first tile, the others are following to the right.
+    bool allocate(std::size_t tileSize, Rectangle& rectangle)
+    {
+        Block block;
+
+        if (!allocateBlock(getLevel(tileSize), block))
+        {
+            return false;
+        }
+
+        rectangle.x = block.first * 6;
+        rectangle.y = block.second;
+        rectangle.width = static_cast<int>(tileSize);
+        rectangle.height = static_cast<int>(tileSize);
+
+        return true;
+    }
+
+    // Allocates six tiles of the given size, falling back to smaller sizes if the
+    // atlas is full. Before trying the next smaller size, the evict function is
+    // invoked until it reports that nothing more can be freed.
+    // The size of the allocated tiles is stored in the rectangle.
+    bool allocateUpTo(std::size_t tileSize, Rectangle& rectangle, const EvictFunction& evict)
+    {
+        for (auto size = tileSize; size >= getMinTileSize(); size /= 2)
+        {
+            do
+            {
+                if (allocate(size, rectangle))
+                {
+                    return true;
+                }
+            }
+            while (evict());
+        }
+
+        return false;
+    }
+
+    // Releases the given region, which must have been allocated before
+    void free(const Rectangle& rectangle)
+    {
+        freeBlock(getLevel(static_cast<std::size_t>(rectangle.width)), Block(rectangle.x / 6, rectangle.y));
+    }
+
+private:
+    int getBlockSize(std::size_t level) const
+    {
+        return static_cast<int>(_maxTileSize >> level);
+    }
+
+    std::size_t getLevel(std::size_t tileSize) const
+    {
+        for (std::size_t level = 0; level < NumTileSizes; ++level)
+        {
+            if (_maxTileSize >> level == tileSize)
+            {
+                return level;
+            }
+        }
+
+        assert(false); // not a supported tile size
+        return NumTileSizes - 1;
+    }
+
+    bool allocateBlock(std::size_t level, Block& block)
+    {
+        auto& freeBlocks = _freeBlocks[level];
+
+        if (!freeBlocks.empty())
+        {
+            block = *freeBlocks.begin();
+            freeBlocks.erase(freeBlocks.begin());
+            return true;
+        }
+
+        // Nothing left on this level, split a larger block
+        Block parent;
+
+        if (level == 0 || !allocateBlock(level - 1, parent))
+        {
+            return false;
+        }
+
+        auto size = getBlockSize(level);
+
+        // Hand out the first quarter, the other three are free
+        freeBlocks.emplace(parent.first + size, parent.second);
+        freeBlocks.emplace(parent.first, parent.second + size);
+        freeBlocks.emplace(parent.first + size, parent.second + size);
+
+        block = parent;
+        return true;
+    }
+
+    void freeBlock(std::size_t level, const Block& block)
+    {
+        auto& freeBlocks = _freeBlocks[level];
+
+        if (level > 0)
+        {
+            auto size = getBlockSize(level);
+            auto parentSize = size * 2;
+
+            Block parent(block.first - block.first % parentSize, block.second - block.second % parentSize);
+
+            Block siblings[4] =
+            {
+                parent,
+                Block(parent.first + size, parent.second),
+                Block(parent.first, parent.second + size),
+                Block(parent.first + size, parent.second + size)
+            };
+
+            bool allSiblingsFree = true;
+
+            for (const auto& sibling : siblings)
+            {
+                if (sibling != block && freeBlocks.count(sibling) == 0)
+                {
+                    allSiblingsFree = false;
+                    break;
+                }
+            }
+
+            if (allSiblingsFree)
+            {
+                // Merge the quarters back into their parent block
+                for (const auto& sibling : siblings)
+                {
+                    freeBlocks.erase(sibling);
+                }
+
+                freeBlock(level - 1, parent);
+                return;
+            }
+        }
+
+        assert(freeBlocks.count(block) == 0);
+        freeBlocks.insert(block);
+    }
+};
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <algorithm>
+#include "ifilesystem.h"
+#include "math/Vector2.h"
+#include "math/Hash.h"
+#include "os/fs.h"
+#include "os/path.h"
+#include "string/convert.h"
+
+namespace render
+{
+
+/**
+ * Naming scheme of the thumbnail files stored in the cache folder.
+ *
+ * A thumbnail key consists of two hashes separated by a dash, the first one
+ * identifying the asset (a material, model or particle), the second one its
+ * source files: <assethash>-<sourcehash>
+ *
+ * The file name is appending the size of the image the thumbnail has been
+ * created from: <key>_<width>x<height>.png
+ */
+
+namespace detail
+{
+
+inline bool isPositiveNumber(const std::string& str)
+{
+    return !str.empty() && std::all_of(str.begin(), str.end(),
+        [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }) &&
+        string::convert<int>(str) > 0;
+}
+
+}
+
+// Number of hex characters of each hash used in the keys
+constexpr std::size_t ThumbnailHashLength = 16;
+
+// Adds the path and the modification time of the given file to the hash.
+// Files located in PK4s are using the modification time of the archive.
+inline void addThumbnailSourceFile(math::Hash& hash, const vfs::FileInfo& info)
+{
+    if (info.isEmpty()) return;
+
+    hash.addString(info.fullPath());
+
+    auto archivePath = info.getArchivePath();
+
+    if (archivePath.empty()) return;
+
+    auto physicalPath = info.getIsPhysicalFile() ?
+        os::standardPathWithSlash(archivePath) + info.fullPath() : archivePath;
+
+    hash.addString(physicalPath);
+
+    std::error_code ec;
+    auto modificationTime = fs::last_write_time(physicalPath, ec);
+
+    if (!ec)
+    {
+        hash.addSizet(static_cast<std::size_t>(modificationTime.time_since_epoch().count()));
+    }
+}
+
+// Combines the hashes identifying the asset and its source files into a key
+inline std::string makeThumbnailKey(const math::Hash& assetHash, const math::Hash& sourceHash)
+{
+    return static_cast<std::string>(assetHash).substr(0, ThumbnailHashLength) + "-" +
+        static_cast<std::string>(sourceHash).substr(0, ThumbnailHashLength);
+}
+
+// Returns the file name of the thumbnail with the given key and source image size
+inline std::string getThumbnailFilename(const std::string& key, const Vector2i& sourceSize)
+{
+    return key + "_" + std::to_string(sourceSize.x()) + "x" + std::to_string(sourceSize.y()) + ".png";
+}
+
+// Splits a file name (without extension) like <key>_<width>x<height> into its components
+inline bool parseThumbnailFilename(const std::string& stem, std::string& key, Vector2i& sourceSize)
+{
+    auto underscore = stem.rfind('_');
+    auto separator = stem.rfind('x');
+
+    if (underscore == std::string::npos || separator == std::string::npos || separator < underscore)
+    {
+        return false;
+    }
+
+    auto width = stem.substr(underscore + 1, separator - underscore - 1);
+    auto height = stem.substr(separator + 1);
+
+    if (underscore == 0 || !detail::isPositiveNumber(width) || !detail::isPositiveNumber(height))
+    {
+        return false;
+    }
+
+    key = stem.substr(0, underscore);
+    sourceSize.x() = string::convert<int>(width);
+    sourceSize.y() = string::convert<int>(height);
+
+    return true;
+}
+
+// Returns the part of the key identifying the asset, including the dash.
+// Returns an empty string if the key is not separated into two parts.
+inline std::string getThumbnailAssetPrefix(const std::string& key)
+{
+    auto dash = key.find('-');
+
+    if (dash == std::string::npos || dash == 0)
+    {
+        return {};
+    }
+
+    return key.substr(0, dash + 1);
+}
+
+// Removes all entries of the same asset as the given key from the map, except the
+// one of the key itself. Returns the removed entries, such that their files can be deleted.
+template<typename Thumbnail>
+std::vector<Thumbnail> removeOutdatedThumbnails(std::map<std::string, Thumbnail>& thumbnails, const std::string& key)
+{
+    std::vector<Thumbnail> removed;
+
+    auto assetPrefix = getThumbnailAssetPrefix(key);
+
+    if (assetPrefix.empty()) return removed;
+
+    for (auto i = thumbnails.lower_bound(assetPrefix); i != thumbnails.end(); )
+    {
+        if (i->first.compare(0, assetPrefix.length(), assetPrefix) != 0) break;
+
+        if (i->first == key)
+        {
+            ++i;
+            continue;
+        }
+
+        removed.push_back(i->second);
+        i = thumbnails.erase(i);
+    }
+
+    return removed;
+}
+
+}
@@ -225,10 +225,13 @@ private:
         }
 
         // Called by EntityWindings after the vertex location has moved
-        // in which case this group needs to rebuild its index remap
+        // in which case this group needs to rebuild its index remap.
+        // The entity is notified, such that the rebuild happens before
+        // its next bounds query and not in the middle of one.
         void onVertexGeometryLocationChanged()
         {
             _surfaceNeedsRebuild = true;
+            boundsChanged();
         }
 
     private:
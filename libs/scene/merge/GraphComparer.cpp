@@ -1,6 +1,7 @@
 #include "GraphComparer.h"
 
 #include <algorithm>
+#include <chrono>
 #include "ientity.h"
 #include "i18n.h"
 #include "itextstream.h"
@@ -9,6 +10,7 @@
 #include "math/Hash.h"
 #include "scenelib.h"
 #include "string/string.h"
+#include "ParallelForEach.h"
 #include "command/ExecutionNotPossible.h"
 #include "NodeUtils.h"
 
@@ -18,12 +20,91 @@ namespace scene
 namespace merge
 {
 
-ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base)
+namespace
+{
+    // Below this number of items the work is done on the calling thread
+    constexpr std::size_t MIN_ITEMS_FOR_PARALLEL_COMPARISON = 16;
+
+    // Interval of the progress callbacks while the workers are busy
+    constexpr std::chrono::milliseconds PROGRESS_INTERVAL(100);
+
+    // Invokes the function for every index in [0..count), distributed over a number of worker threads.
+    // The progress (mapped to the range [progressStart..progressEnd]) is reported on the calling thread,
+    // the callback is allowed to throw to cancel the operation. Exceptions thrown by the function
+    // are propagated to the caller after all workers have stopped.
+    void forEachIndex(std::size_t count, const std::function<void(std::size_t)>& func,
+        const ProgressCallback& progress, float progressStart, float progressEnd)
+    {
+        auto reportProgress = [&](std::size_t numProcessed)
+        {
+            if (progress && count > 0)
+            {
+                progress(progressStart + (progressEnd - progressStart) * numProcessed / count);
+            }
+        };
+
+        if (count < MIN_ITEMS_FOR_PARALLEL_COMPARISON)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                func(i);
+                reportProgress(i + 1);
+            }
+
+            return;
+        }
+
+        parallel::forEachIndex(count, func, reportProgress, PROGRESS_INTERVAL);
+
+        reportProgress(count);
+    }
+
+    std::vector<INodePtr> collectEntities(const INodePtr& root)
+    {
+        std::vector<INodePtr> entities;
+
+        root->foreachNode([&](const INodePtr& node)
+        {
+            if (node->getNodeType() == INode::Type::Entity)
+            {
+                entities.push_back(node);
+            }
+
+            return true;
+        });
+
+        return entities;
+    }
+}
+
+ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base,
+    const ProgressCallback& progress)
 {
     auto result = std::make_shared<ComparisonResult>(source, base);
 
-    auto sourceEntities = NodeUtils::CollectEntityFingerprints(source);
-    auto baseEntities = NodeUtils::CollectEntityFingerprints(base);
+    auto sourceNodes = collectEntities(source);
+    auto baseNodes = collectEntities(base);
+
+    // Fingerprinting is the expensive part, each entity is calculating the hashes of its children too.
+    // Every primitive is belonging to a single entity, so no node is hashed by two threads at once.
+    std::vector<Fingerprint> fingerprints(sourceNodes.size() + baseNodes.size());
+
+    forEachIndex(fingerprints.size(), [&](std::size_t i)
+    {
+        const auto& node = i < sourceNodes.size() ? sourceNodes[i] : baseNodes[i - sourceNodes.size()];
+        auto comparable = std::dynamic_pointer_cast<IComparableNode>(node);
+        assert(comparable);
+
+        if (comparable)
+        {
+            fingerprints[i] = comparable->getFingerprint();
+        }
+    }, progress, 0.0f, 0.5f);
+
+    auto sourceEntities = CollectEntityFingerprints(sourceNodes,
+        std::vector<Fingerprint>(fingerprints.begin(), fingerprints.begin() + sourceNodes.size()), source);
+    auto baseEntities = CollectEntityFingerprints(baseNodes,
+        std::vector<Fingerprint>(fingerprints.begin() + sourceNodes.size(), fingerprints.end()), base);
 
     // Filter out all the matching nodes and store them in the result
     if (sourceEntities.empty())
@@ -65,12 +146,32 @@ ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, cons
     }
 
     // Enter the second stage and try to match entities and detailing diffs
-    processDifferingEntities(*result, sourceMismatches, baseMismatches);
+    processDifferingEntities(*result, sourceMismatches, baseMismatches, progress);
+
+    return result;
+}
+
+GraphComparer::Fingerprints GraphComparer::CollectEntityFingerprints(const std::vector<INodePtr>& entities,
+    const std::vector<Fingerprint>& fingerprints, const INodePtr& root)
+{
+    Fingerprints result;
+
+    for (std::size_t i = 0; i < entities.size(); ++i)
+    {
+        // Store the fingerprint and check for collisions
+        auto insertResult = result.try_emplace(fingerprints[i], entities[i]);
+
+        if (!insertResult.second)
+        {
+            rWarning() << "More than one node with the same fingerprint found in the parent node with name " << root->name() << std::endl;
+        }
+    }
 
     return result;
 }
 
-void GraphComparer::processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches, const EntityMismatchByName& baseMismatches)
+void GraphComparer::processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches,
+    const EntityMismatchByName& baseMismatches, const ProgressCallback& progress)
 {
     // Find all entities that are missing in either source or base (by name)
     std::list<EntityMismatchByName::value_type> missingInSource;
@@ -93,10 +194,14 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
     std::set_difference(baseMismatches.begin(), baseMismatches.end(), sourceMismatches.begin(), sourceMismatches.end(),
         std::back_inserter(missingInSource), compareEntityNames);
 
+    // The differences are added in order, the details of each pair are filled in by the workers
+    std::vector<ComparisonResult::EntityDifference*> entitiesPresentInBoth;
+    entitiesPresentInBoth.reserve(matchingByName.size());
+
     for (const auto& match : matchingByName)
     {
-        auto sourceMismatch = sourceMismatches.find(match.second.entityName)->second;
-        auto baseMismatch = baseMismatches.find(match.second.entityName)->second;
+        const auto& sourceMismatch = sourceMismatches.find(match.second.entityName)->second;
+        const auto& baseMismatch = baseMismatches.find(match.second.entityName)->second;
 
         auto& entityDiff = result.differingEntities.emplace_back(ComparisonResult::EntityDifference
         {
@@ -108,12 +213,19 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
             ComparisonResult::EntityDifference::Type::EntityPresentButDifferent
         });
 
+        entitiesPresentInBoth.push_back(&entityDiff);
+    }
+
+    forEachIndex(entitiesPresentInBoth.size(), [&](std::size_t i)
+    {
+        auto& entityDiff = *entitiesPresentInBoth[i];
+
         // Analyse the key values
-        entityDiff.differingKeyValues = compareKeyValues(sourceMismatch.node, baseMismatch.node);
+        entityDiff.differingKeyValues = compareKeyValues(entityDiff.sourceNode, entityDiff.baseNode);
 
         // Analyse the child nodes
-        entityDiff.differingChildren = compareChildNodes(sourceMismatch.node, baseMismatch.node);
-    }
+        entityDiff.differingChildren = compareChildNodes(entityDiff.sourceNode, entityDiff.baseNode);
+    }, progress, 0.5f, 1.0f);
 
     for (const auto& mismatch : missingInSource)
     {
@@ -122,7 +234,7 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
             INodePtr(), // source node is empty
             mismatch.second.node,
             mismatch.second.entityName,
-            std::string(),// source fingerprint is empty
+            Fingerprint(),// source fingerprint is empty
             mismatch.second.fingerPrint, // base fingerprint
             ComparisonResult::EntityDifference::Type::EntityMissingInSource
         });
@@ -136,7 +248,7 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
             INodePtr(), // base node is empty
             mismatch.second.entityName,
             mismatch.second.fingerPrint, // source fingerprint
-            std::string(),// base fingerprint is empty
+            Fingerprint(),// base fingerprint is empty
             ComparisonResult::EntityDifference::Type::EntityMissingInBase
         });
     }
@@ -4,6 +4,8 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <functional>
+#include <vector>
 
 #include "inode.h"
 #include "imap.h"
@@ -17,20 +19,26 @@ namespace scene
 namespace merge
 {
 
+// Receives the progress of a comparison as fraction in the range [0..1]
+using ProgressCallback = std::function<void(float fraction)>;
+
 /**
  * Static utility class to compare two scenes given by their root nodes.
  * The Source is considered to be the "newer" graph with the changes,
  * the Base resembles the "older" or unchanged graph the Source graph is based on.
+ *
+ * The entities of larger maps are fingerprinted and compared on a number of worker
+ * threads, the order of the entities in the ComparisonResult is not affected by this.
  */
 class GraphComparer
 {
 private:
-    using Fingerprints = std::map<std::string, INodePtr>;
+    using Fingerprints = std::map<Fingerprint, INodePtr>;
 
 public:
     struct EntityMismatch
     {
-        std::string fingerPrint;
+        Fingerprint fingerPrint;
         INodePtr node;
         std::string entityName;
     };
@@ -38,12 +46,17 @@ public:
     using EntityMismatchByName = std::map<std::string, EntityMismatch>;
 
 public:
-    // Compares the two graphs and returns the result
-    static ComparisonResult::Ptr Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base);
+    // Compares the two graphs and returns the result. The optional progress callback
+    // is invoked on the calling thread, it may throw to abort the comparison.
+    static ComparisonResult::Ptr Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base,
+        const ProgressCallback& progress = ProgressCallback());
 
 private:
+    static Fingerprints CollectEntityFingerprints(const std::vector<INodePtr>& entities,
+        const std::vector<Fingerprint>& fingerprints, const INodePtr& root);
+
     static void processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches, 
-        const EntityMismatchByName& baseMismatches);
+        const EntityMismatchByName& baseMismatches, const ProgressCallback& progress);
 
     static std::list<ComparisonResult::KeyValueDifference> compareKeyValues(
         const INodePtr& sourceNode, const INodePtr& baseNode);
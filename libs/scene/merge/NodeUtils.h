@@ -12,7 +12,7 @@ namespace scene
 namespace merge
 {
 
-using Fingerprints = std::map<std::string, INodePtr>;
+using Fingerprints = std::map<Fingerprint, INodePtr>;
 
 class NodeUtils
 {
@@ -35,14 +35,6 @@ public:
         return GetEntityNameOrFingerprint(member);
     }
 
-    static Fingerprints CollectEntityFingerprints(const INodePtr& root)
-    {
-        return CollectNodeFingerprints(root, [](const INodePtr& node)
-        {
-            return node->getNodeType() == INode::Type::Entity;
-        });
-    }
-
     static Fingerprints CollectPrimitiveFingerprints(const INodePtr& parent)
     {
         return CollectNodeFingerprints(parent, [](const INodePtr& node)
@@ -93,7 +85,7 @@ private:
 
         if (comparable)
         {
-            return comparable->getFingerprint();
+            return comparable->getFingerprint().toString();
         }
 
         return std::string();
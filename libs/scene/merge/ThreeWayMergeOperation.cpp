@@ -13,6 +13,20 @@ namespace scene
 namespace merge
 {
 
+namespace
+{
+    // Maps the progress of a sub-operation to the range [start..end] of the given callback
+    ProgressCallback getPartialProgress(const ProgressCallback& progress, float start, float end)
+    {
+        if (!progress) return ProgressCallback();
+
+        return [=](float fraction)
+        {
+            progress(start + (end - start) * fraction);
+        };
+    }
+}
+
 // Contains lookup tables needed during analysis of the two scenes
 struct ThreeWayMergeOperation::ComparisonData
 {
@@ -23,10 +37,12 @@ struct ThreeWayMergeOperation::ComparisonData
     ComparisonResult::Ptr baseToSource;
     ComparisonResult::Ptr baseToTarget;
 
-    ComparisonData(const IMapRootNodePtr& baseRoot, const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot)
+    ComparisonData(const IMapRootNodePtr& baseRoot, const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot,
+        const ProgressCallback& progress)
     {
-        baseToSource = GraphComparer::Compare(sourceRoot, baseRoot);
-        baseToTarget = GraphComparer::Compare(targetRoot, baseRoot);
+        // The two comparisons are sharing the base graph, run them one after the other
+        baseToSource = GraphComparer::Compare(sourceRoot, baseRoot, getPartialProgress(progress, 0.0f, 0.5f));
+        baseToTarget = GraphComparer::Compare(targetRoot, baseRoot, getPartialProgress(progress, 0.5f, 1.0f));
 
         // Create source and target entity diff dictionaries (by entity name)
         for (auto it = baseToSource->differingEntities.begin(); it != baseToSource->differingEntities.end(); ++it)
@@ -233,9 +249,9 @@ void ThreeWayMergeOperation::processEntityModification(const ComparisonResult::E
     }
 }
 
-void ThreeWayMergeOperation::compareAndCreateActions()
+void ThreeWayMergeOperation::compareAndCreateActions(const ProgressCallback& progress)
 {
-    ComparisonData data(_baseRoot, _sourceRoot, _targetRoot);
+    ComparisonData data(_baseRoot, _sourceRoot, _targetRoot, progress);
 
     // Check each entity difference from the base to the source map
     // fully accept only those entities that are not altered in the target map, and detect conflicts
@@ -353,7 +369,7 @@ void ThreeWayMergeOperation::compareAndCreateActions()
 }
 
 ThreeWayMergeOperation::Ptr ThreeWayMergeOperation::Create(const IMapRootNodePtr& baseRoot, 
-    const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot)
+    const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot, const ProgressCallback& progress)
 {
     if (baseRoot == sourceRoot || baseRoot == targetRoot || sourceRoot == targetRoot)
     {
@@ -364,17 +380,17 @@ ThreeWayMergeOperation::Ptr ThreeWayMergeOperation::Create(const IMapRootNodePtr
 
     // Phase 1 is to detect any entity additions from the source to the target that might cause name conflicts
     // After this pass some key values might have been changed
-    operation->adjustSourceEntitiesWithNameConflicts();
+    operation->adjustSourceEntitiesWithNameConflicts(getPartialProgress(progress, 0.0f, 0.5f));
 
     // Phase 2 will run another comparison of the graphs (since key values might have been modified)
-    operation->compareAndCreateActions();
+    operation->compareAndCreateActions(getPartialProgress(progress, 0.5f, 1.0f));
 
     return operation;
 }
 
-void ThreeWayMergeOperation::adjustSourceEntitiesWithNameConflicts()
+void ThreeWayMergeOperation::adjustSourceEntitiesWithNameConflicts(const ProgressCallback& progress)
 {
-    ComparisonData data(_baseRoot, _sourceRoot, _targetRoot);
+    ComparisonData data(_baseRoot, _sourceRoot, _targetRoot, progress);
 
     std::set<INodePtr> sourceEntitiesToBeRenamed;
 
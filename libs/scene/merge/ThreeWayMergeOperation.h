@@ -4,6 +4,7 @@
 #include <list>
 #include "imapmerge.h"
 #include "ComparisonResult.h"
+#include "GraphComparer.h"
 #include "MergeAction.h"
 #include "MergeOperationBase.h"
 
@@ -42,7 +43,9 @@ public:
 
     // Creates the merge operation from the given root nodes. The base root is the common ancestor of source and target,
     // and none of the three must be equal to any of them.
-    static Ptr Create(const IMapRootNodePtr& baseRoot, const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot);
+    // The optional progress callback is invoked on the calling thread during the graph comparisons.
+    static Ptr Create(const IMapRootNodePtr& baseRoot, const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot,
+        const ProgressCallback& progress = ProgressCallback());
 
     void setMergeSelectionGroups(bool enabled) override;
     void setMergeLayers(bool enabled) override;
@@ -63,9 +66,9 @@ public:
     void applyActions() override;
 
 private:
-    void adjustSourceEntitiesWithNameConflicts();
+    void adjustSourceEntitiesWithNameConflicts(const ProgressCallback& progress);
     
-    void compareAndCreateActions();
+    void compareAndCreateActions(const ProgressCallback& progress);
     void processEntityModification(const ComparisonResult::EntityDifference& sourceDiff,
         const ComparisonResult::EntityDifference& targetDiff);
 
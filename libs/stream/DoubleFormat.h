@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ostream>
+#include <iterator>
+#include <fmt/format.h>
+
+namespace stream
+{
+
+// Writes the double using the stream's precision, producing the same characters as os << d.
+// For the default float notation this is bypassing the locale-aware std::num_put facet,
+// which is considerably slower than fmt's formatting routines.
+inline void writeDouble(const double d, std::ostream& os)
+{
+	constexpr auto nonDefaultFlags = std::ios::floatfield | std::ios::showpoint | std::ios::showpos | std::ios::uppercase;
+
+	if ((os.flags() & nonDefaultFlags) != 0 || os.precision() < 0)
+	{
+		os << d;
+		return;
+	}
+
+	// The default notation of iostreams is equivalent to printf's %g
+	fmt::memory_buffer buffer;
+	fmt::format_to(std::back_inserter(buffer), "{:.{}g}", d, static_cast<int>(os.precision()));
+
+	os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+}
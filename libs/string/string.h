@@ -4,6 +4,8 @@
 /// C-style null-terminated-character-array string library.
 
 #include <cstring>
+#include <cctype>
+#include <string>
 
 namespace string
 {
@@ -34,6 +36,32 @@ struct ILess
     }
 };
 
+/// Case-insensitive equality functor, for use with unordered containers
+struct IEqual
+{
+    bool operator() (const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs.size() == rhs.size() && icmp(lhs.c_str(), rhs.c_str()) == 0;
+    }
+};
+
+/// Case-insensitive hash functor (FNV-1a on the lowercase characters), matching IEqual
+struct IHash
+{
+    std::size_t operator() (const std::string& str) const
+    {
+        std::size_t hash = static_cast<std::size_t>(14695981039346656037ULL);
+
+        for (auto c : str)
+        {
+            hash ^= static_cast<std::size_t>(std::tolower(static_cast<unsigned char>(c)));
+            hash *= static_cast<std::size_t>(1099511628211ULL);
+        }
+
+        return hash;
+    }
+};
+
 }
 
 /// \brief Returns true if [\p string, \p string + \p n) is lexicographically equal to [\p other, \p other + \p n).
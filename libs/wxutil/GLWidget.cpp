@@ -60,6 +60,27 @@ GLWidget::~GLWidget()
 	}
 }
 
+bool GLWidget::MakeCurrent()
+{
+	// Same restriction as in OnPaint, SetCurrent() needs a shown window
+	if (!IsShownOnScreen()) return false;
+
+	if (_privateContext != nullptr)
+	{
+		// Use the private context for this widget
+		return SetCurrent(*_privateContext);
+	}
+
+	// Use the globally shared context, we rely on this being of type GLContext
+	const auto& context = GlobalOpenGLContext().getSharedContext();
+	if (!context) return false;
+
+	assert(std::dynamic_pointer_cast<GLContext>(context));
+
+	auto wxContext = std::static_pointer_cast<GLContext>(context);
+	return SetCurrent(wxContext->get());
+}
+
 void GLWidget::OnPaint(wxPaintEvent& WXUNUSED(event))
 {
 	// Got this check from the wxWidgets sources, they assert the widget to be shown
@@ -80,20 +101,7 @@ void GLWidget::OnPaint(wxPaintEvent& WXUNUSED(event))
     wxPaintDC dc(this);
 
 	// Grab the context for this widget
-	if (_privateContext != nullptr)
-	{
-		// Use the private context for this widget
-		SetCurrent(*_privateContext);
-	}
-	else
-	{
-		// Use the globally shared context, we rely on this being of type GLContext
-		const auto& context = GlobalOpenGLContext().getSharedContext();
-		assert(std::dynamic_pointer_cast<GLContext>(context));
-
-		auto wxContext = std::static_pointer_cast<GLContext>(context);
-		SetCurrent(wxContext->get());
-	}
+	MakeCurrent();
 
 	if (_renderCallback())
 	{
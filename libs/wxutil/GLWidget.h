@@ -32,6 +32,11 @@ public:
 	// Call this to enable/disable the private GL context of this widget
 	void SetHasPrivateContext(bool hasPrivateContext);
 
+	// Makes the context used by this widget current, to release GL objects
+	// outside of the render callback. Returns false if the widget is not shown,
+	// in which case the context cannot be made current.
+	bool MakeCurrent();
+
 	virtual ~GLWidget();
 
 private:
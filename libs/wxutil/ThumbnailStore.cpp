@@ -0,0 +1,162 @@
+#include "ThumbnailStore.h"
+
+#include <thread>
+#include <cstdio>
+#include <algorithm>
+#include "imodule.h"
+#include "itextstream.h"
+
+#include "os/fs.h"
+#include "render/ThumbnailFilename.h"
+
+#include <wx/image.h>
+
+namespace wxutil
+{
+
+ThumbnailStore::ThumbnailStore(const std::string& subFolder, int maxSize) :
+    _folder(GetCachePath() + (subFolder.empty() ? std::string() : subFolder + "/")),
+    _maxSize(maxSize),
+    _folderScanned(false)
+{}
+
+std::string ThumbnailStore::GetCachePath()
+{
+    return module::GlobalModuleRegistry().getApplicationContext().getCacheDataPath() + "thumbnails/";
+}
+
+std::optional<ThumbnailStore::Thumbnail> ThumbnailStore::findThumbnail(const std::string& key)
+{
+    if (key.empty()) return std::nullopt;
+
+    ensureFolderScanned();
+
+    std::lock_guard<std::mutex> lock(_thumbnailLock);
+
+    auto found = _thumbnails.find(key);
+
+    if (found == _thumbnails.end()) return std::nullopt;
+
+    return found->second;
+}
+
+void ThumbnailStore::storeThumbnail(const std::string& key, const Vector2i& sourceSize,
+    const std::shared_ptr<Pixels>& pixels)
+{
+    if (key.empty() || pixels->width <= 0 || pixels->height <= 0) return;
+
+    _writeQueue.enqueue([this, key, sourceSize, pixels]()
+    {
+        writeThumbnail(key, sourceSize, *pixels);
+    });
+}
+
+void ThumbnailStore::ensureFolderScanned()
+{
+    std::lock_guard<std::mutex> lock(_thumbnailLock);
+
+    if (_folderScanned) return;
+
+    _folderScanned = true;
+
+    std::error_code ec;
+
+    for (fs::directory_iterator i(_folder, ec), end; !ec && i != end; i.increment(ec))
+    {
+        const auto& path = i->path();
+
+        if (path.extension() != ".png") continue;
+
+        std::string key;
+        Vector2i sourceSize;
+
+        if (render::parseThumbnailFilename(path.stem().string(), key, sourceSize))
+        {
+            _thumbnails[key] = Thumbnail{ sourceSize, path.string() };
+        }
+    }
+}
+
+void ThumbnailStore::writeThumbnail(const std::string& key, const Vector2i& sourceSize, const Pixels& pixels)
+{
+    wxImage image(pixels.width, pixels.height, false);
+
+    if (pixels.channels == 4)
+    {
+        image.SetAlpha();
+    }
+
+    auto rgb = image.GetData();
+    auto alpha = image.GetAlpha();
+
+    for (int y = 0; y < pixels.height; ++y)
+    {
+        auto sourceRow = static_cast<std::size_t>(pixels.bottomUp ? pixels.height - 1 - y : y);
+        auto source = pixels.data.data() + sourceRow * pixels.width * pixels.channels;
+
+        for (int x = 0; x < pixels.width; ++x, source += pixels.channels)
+        {
+            auto i = static_cast<std::size_t>(y) * pixels.width + x;
+
+            rgb[i * 3 + 0] = source[0];
+            rgb[i * 3 + 1] = source[1];
+            rgb[i * 3 + 2] = source[2];
+
+            if (alpha)
+            {
+                alpha[i] = source[3];
+            }
+        }
+    }
+
+    if (std::max(pixels.width, pixels.height) > _maxSize)
+    {
+        auto scale = static_cast<double>(_maxSize) / std::max(pixels.width, pixels.height);
+
+        image.Rescale(std::max(static_cast<int>(pixels.width * scale), 1),
+            std::max(static_cast<int>(pixels.height * scale), 1), wxIMAGE_QUALITY_HIGH);
+    }
+
+    fs::path path = _folder + render::getThumbnailFilename(key, sourceSize);
+
+    // Write to a temporary file first, readers must never see a half-written file
+    auto tempPath = path;
+    tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    try
+    {
+        fs::create_directories(path.parent_path());
+
+        if (!image.SaveFile(tempPath.string(), wxBITMAP_TYPE_PNG))
+        {
+            rWarning() << "Could not write thumbnail " << tempPath.string() << std::endl;
+            std::remove(tempPath.string().c_str());
+            return;
+        }
+
+        fs::rename(tempPath, path);
+    }
+    catch (const fs::filesystem_error& ex)
+    {
+        rWarning() << "Could not store thumbnail " << path.string() << ": " << ex.what() << std::endl;
+
+        std::remove(tempPath.string().c_str());
+        return;
+    }
+
+    // The outdated files need to be known before they can be removed
+    ensureFolderScanned();
+
+    std::lock_guard<std::mutex> lock(_thumbnailLock);
+
+    _thumbnails[key] = Thumbnail{ sourceSize, path.string() };
+
+    // Remove the files of the same asset made from older sources
+    for (const auto& outdated : render::removeOutdatedThumbnails(_thumbnails, key))
+    {
+        std::error_code ec;
+        fs::remove(outdated.filePath, ec);
+    }
+}
+
+}
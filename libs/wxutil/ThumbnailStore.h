@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include "math/Vector2.h"
+#include "SequentialTaskQueue.h"
+
+namespace wxutil
+{
+
+/**
+ * A folder of small PNG thumbnails in the user's cache folder, indexed by the
+ * keys described in render/ThumbnailFilename.h. Used by the texture browser
+ * for materials and by the render previews for models and particles.
+ *
+ * The folder is scanned once on first access. Compressing and writing new
+ * thumbnails happens on a worker thread, outdated files of the same asset
+ * are removed once a new thumbnail has been written.
+ */
+class ThumbnailStore
+{
+public:
+    struct Thumbnail
+    {
+        // Dimensions of the image this thumbnail has been created from
+        Vector2i sourceSize;
+
+        // Absolute path to the PNG file
+        std::string filePath;
+    };
+
+    // Uncompressed pixels handed over to the writer thread
+    struct Pixels
+    {
+        int width = 0;
+        int height = 0;
+
+        // 3 for RGB, 4 for RGBA
+        int channels = 4;
+
+        // True if the first row is the bottom one, like the data of glReadPixels
+        bool bottomUp = false;
+
+        std::vector<unsigned char> data;
+    };
+
+private:
+    std::string _folder;
+    int _maxSize;
+
+    std::mutex _thumbnailLock;
+    std::map<std::string, Thumbnail> _thumbnails;
+    bool _folderScanned;
+
+    util::SequentialTaskQueue _writeQueue;
+
+public:
+    // Thumbnails are stored in the given sub folder of the thumbnail cache
+    // path, their largest edge is scaled down to maxSize pixels
+    ThumbnailStore(const std::string& subFolder, int maxSize);
+
+    // Returns the stored thumbnail for the given key, if there is one
+    std::optional<Thumbnail> findThumbnail(const std::string& key);
+
+    // Queues the given pixels to be scaled down and written to disk
+    void storeThumbnail(const std::string& key, const Vector2i& sourceSize,
+        const std::shared_ptr<Pixels>& pixels);
+
+    // The folder all thumbnail stores are located in, including the trailing slash
+    static std::string GetCachePath();
+
+private:
+    void ensureFolderScanned();
+
+    // Compresses and stores the given pixels, called on the worker thread
+    void writeThumbnail(const std::string& key, const Vector2i& sourceSize, const Pixels& pixels);
+};
+
+}
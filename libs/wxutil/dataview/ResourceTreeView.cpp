@@ -36,6 +36,60 @@ wxEvent* ResourceTreeView::PopulationFinishedEvent::Clone() const
 wxDEFINE_EVENT(EV_TREEVIEW_POPULATION_FINISHED, ResourceTreeView::PopulationFinishedEvent);
 wxDEFINE_EVENT(EV_TREEVIEW_FILTERTEXT_CLEARED, wxCommandEvent);
 
+// Attached to the tree store before the TreeModelFilter is, such that
+// the index is up to date when the filter evaluates the changed rows
+class ResourceTreeView::SearchIndexNotifier :
+    public wxDataViewModelNotifier
+{
+private:
+    ResourceTreeView& _owner;
+
+public:
+    SearchIndexNotifier(ResourceTreeView& owner) :
+        _owner(owner)
+    {}
+
+    bool ItemAdded(const wxDataViewItem& parent, const wxDataViewItem& item) override
+    {
+        // Drop anything the index might still associate with this item ID
+        _owner._searchIndex.Remove(item);
+        _owner._visibilityNeedsUpdate = true;
+        return true;
+    }
+
+    bool ItemDeleted(const wxDataViewItem& parent, const wxDataViewItem& item) override
+    {
+        _owner._searchIndex.Remove(item);
+        _owner._visibilityNeedsUpdate = true;
+        return true;
+    }
+
+    bool ItemChanged(const wxDataViewItem& item) override
+    {
+        // The cached text must go even if the visibility update is skipped,
+        // a pending re-evaluation would otherwise match the old values
+        _owner._searchIndex.InvalidateSearchText(item);
+        _owner.UpdateVisibilityOfItem(item);
+        return true;
+    }
+
+    bool ValueChanged(const wxDataViewItem& item, unsigned int col) override
+    {
+        _owner._searchIndex.InvalidateSearchText(item);
+        _owner.UpdateVisibilityOfItem(item);
+        return true;
+    }
+
+    bool Cleared() override
+    {
+        _owner._searchIndexNeedsRebuild = true;
+        return true;
+    }
+
+    void Resort() override
+    {}
+};
+
 ResourceTreeView::ResourceTreeView(wxWindow* parent, const ResourceTreeView::Columns& columns, long style) :
     ResourceTreeView(parent, TreeModel::Ptr(), columns, style)
 {}
@@ -49,6 +103,9 @@ ResourceTreeView::ResourceTreeView(wxWindow* parent, const TreeModel::Ptr& model
     _expandTopLevelItemsAfterPopulation(false),
     _columnToSelectAfterPopulation(nullptr),
     _setFavouritesRecursively(true),
+    _searchIndexNeedsRebuild(true),
+    _visibilityNeedsUpdate(true),
+    _searchIndexNotifier(nullptr),
     _declPathColumn(_columns.fullName),
     _favouriteKeyColumn(_columns.fullName)
 {
@@ -60,6 +117,7 @@ ResourceTreeView::ResourceTreeView(wxWindow* parent, const TreeModel::Ptr& model
         _treeStore.reset(new TreeModel(_columns));
     }
 
+    AttachSearchIndexNotifier();
     AssociateModel(_treeStore.get());
 
     Bind(wxEVT_DATAVIEW_ITEM_CONTEXT_MENU, &ResourceTreeView::_onContextMenu, this);
@@ -78,6 +136,8 @@ ResourceTreeView::~ResourceTreeView()
         _populator->EnsureStopped();
         _populator.reset();
     }
+
+    DetachSearchIndexNotifier();
 }
 
 const TreeModel::Ptr& ResourceTreeView::GetTreeModel()
@@ -87,9 +147,14 @@ const TreeModel::Ptr& ResourceTreeView::GetTreeModel()
 
 void ResourceTreeView::SetTreeModel(const TreeModel::Ptr& model)
 {
+    DetachSearchIndexNotifier();
+
     _treeStore = model;
     _emptyFavouritesLabel = wxDataViewItem();
 
+    _searchIndex.Clear();
+    _searchIndexNeedsRebuild = true;
+
     if (!_treeStore)
     {
         _treeModelFilter = TreeModelFilter::Ptr();
@@ -97,11 +162,32 @@ void ResourceTreeView::SetTreeModel(const TreeModel::Ptr& model)
         return;
     }
 
+    AttachSearchIndexNotifier();
     SetupTreeModelFilter();
 }
 
+void ResourceTreeView::AttachSearchIndexNotifier()
+{
+    if (_searchIndexNotifier != nullptr || !_treeStore) return;
+
+    // The model takes ownership of the notifier
+    _searchIndexNotifier = new SearchIndexNotifier(*this);
+    _treeStore->AddNotifier(_searchIndexNotifier);
+}
+
+void ResourceTreeView::DetachSearchIndexNotifier()
+{
+    if (_searchIndexNotifier == nullptr) return;
+
+    // This is deleting the notifier
+    _treeStore->RemoveNotifier(_searchIndexNotifier);
+    _searchIndexNotifier = nullptr;
+}
+
 void ResourceTreeView::SetupTreeModelFilter()
 {
+    _visibilityNeedsUpdate = true;
+
     // Set up the filter
     _treeModelFilter.reset(new TreeModelFilter(_treeStore));
 
@@ -238,6 +324,8 @@ bool ResourceTreeView::SetFilterText(const wxString& filterText)
 
 void ResourceTreeView::UpdateTreeVisibility()
 {
+    _visibilityNeedsUpdate = true;
+
     if (_treeModelFilter)
     {
 #if defined(__WXGTK__) && !wxCHECK_VERSION(3, 0, 5)
@@ -525,6 +613,9 @@ void ResourceTreeView::SetFavourite(TreeModel::Row& row, bool isFavourite)
         GlobalFavouritesManager().removeFavourite(_favouriteTypeName, row[_favouriteKeyColumn]);
     }
 
+    // The row might be sending its events to the filter model, not the tree store
+    UpdateVisibilityOfItem(row.getItem());
+
     row.SendItemChanged();
 }
 
@@ -622,8 +713,49 @@ bool ResourceTreeView::IsFavouriteSelected()
     return row[_columns.isFavourite].getBool();
 }
 
+void ResourceTreeView::EnsureVisibilityEvaluated()
+{
+    if (_searchIndexNeedsRebuild)
+    {
+        _searchIndexNeedsRebuild = false;
+        _visibilityNeedsUpdate = true;
+
+        _searchIndex.Reset(*_treeStore, _colsToSearch);
+    }
+
+    if (_visibilityNeedsUpdate)
+    {
+        _visibilityNeedsUpdate = false;
+
+        _searchIndex.Evaluate([this](const wxDataViewItem& item)
+        {
+            TreeModel::Row row(item, *_treeStore);
+            return IsTreeModelRowVisible(row);
+        });
+    }
+}
+
+void ResourceTreeView::UpdateVisibilityOfItem(const wxDataViewItem& item)
+{
+    // Nothing to do if the index is going to be re-evaluated anyway
+    if (_searchIndexNeedsRebuild || _visibilityNeedsUpdate) return;
+
+    _searchIndex.Update(item, [this](const wxDataViewItem& item)
+    {
+        TreeModel::Row row(item, *_treeStore);
+        return IsTreeModelRowVisible(row);
+    });
+}
+
 bool ResourceTreeView::IsTreeModelRowOrAnyChildVisible(TreeModel::Row& row)
 {
+    EnsureVisibilityEvaluated();
+
+    if (_searchIndex.IsEvaluated(row.getItem()))
+    {
+        return _searchIndex.IsVisible(row.getItem());
+    }
+
     // Test the node itself
     if (IsTreeModelRowVisible(row))
     {
@@ -665,7 +797,15 @@ bool ResourceTreeView::IsTreeModelRowVisible(wxutil::TreeModel::Row& row)
 
 bool ResourceTreeView::IsTreeModelRowFiltered(wxutil::TreeModel::Row& row)
 {
-    return !_filterText.empty() && !TreeModel::RowContainsString(row, _filterText, _colsToSearch, true);
+    if (_filterText.empty()) return false;
+
+    // Prefer the lower case strings held by the search index
+    if (auto searchText = _searchIndex.GetSearchText(row.getItem()); searchText != nullptr)
+    {
+        return !searchText->Contains(_filterText);
+    }
+
+    return !TreeModel::RowContainsString(row, _filterText, _colsToSearch, true);
 }
 
 bool ResourceTreeView::IsTreeModelRowVisibleByViewMode(wxutil::TreeModel::Row& row)
@@ -4,6 +4,7 @@
 #include "TreeView.h"
 #include "TreeModel.h"
 #include "TreeModelFilter.h"
+#include "TreeModelSearchIndex.h"
 #include "IResourceTreePopulator.h"
 #include "../menu/PopupMenu.h"
 #include "wxutil/Icon.h"
@@ -94,6 +95,16 @@ private:
 
     wxString _filterText;
 
+    // Holds the search strings and the visibility of all rows in the tree store,
+    // to avoid recursing into the children of every filtered row
+    TreeModelSearchIndex _searchIndex;
+    bool _searchIndexNeedsRebuild;
+    bool _visibilityNeedsUpdate;
+
+    // Keeps the search index in sync with the tree store
+    class SearchIndexNotifier;
+    SearchIndexNotifier* _searchIndexNotifier;
+
     // The column that is hosting the declaration path (used by e.g. "copy to clipboard")
     TreeModel::Column _declPathColumn;
     TreeModel::Column _favouriteKeyColumn;
@@ -187,6 +198,15 @@ private:
     // Recursive visibility test used by the TreeModelFilterFunction
     bool IsTreeModelRowOrAnyChildVisible(TreeModel::Row& row);
 
+    // Rebuilds the search index and evaluates the visibility of all rows if necessary
+    void EnsureVisibilityEvaluated();
+
+    // Re-evaluates the visibility of a single changed row
+    void UpdateVisibilityOfItem(const wxDataViewItem& item);
+
+    void AttachSearchIndexNotifier();
+    void DetachSearchIndexNotifier();
+
     // Returns true if the given row is visible according 
     // to the current view mode (show favourites vs. show all)
     bool IsTreeModelRowVisibleByViewMode(TreeModel::Row& row);
@@ -0,0 +1,164 @@
+#include "TreeModelSearchIndex.h"
+
+namespace wxutil
+{
+
+TreeModelSearchIndex::TreeModelSearchIndex() :
+    _model(nullptr)
+{}
+
+void TreeModelSearchIndex::Reset(TreeModel& model, const std::vector<TreeModel::Column>& columns)
+{
+    Clear();
+
+    _model = &model;
+    _columns = columns;
+}
+
+void TreeModelSearchIndex::Clear()
+{
+    _model = nullptr;
+    _columns.clear();
+    _entries.clear();
+    _entryByItem.clear();
+    _searchTexts.clear();
+}
+
+bool TreeModelSearchIndex::IsEvaluated(const wxDataViewItem& item) const
+{
+    return _entryByItem.count(item.GetID()) > 0;
+}
+
+void TreeModelSearchIndex::Evaluate(const MatchFunction& matches)
+{
+    _entries.clear();
+    _entryByItem.clear();
+
+    if (_model == nullptr) return;
+
+    // Walk the live tree, rows might have been added or removed since the last run
+    EvaluateChildren(_model->GetRoot(), NoParent, matches);
+
+    // Children are stored after their parents, walking backwards
+    // visits each row after all of its descendants have been counted
+    for (auto i = _entries.rbegin(); i != _entries.rend(); ++i)
+    {
+        if (i->parent != NoParent && i->isVisible())
+        {
+            _entries[i->parent].numVisibleChildren++;
+        }
+    }
+}
+
+void TreeModelSearchIndex::Update(const wxDataViewItem& item, const MatchFunction& matches)
+{
+    auto found = _entryByItem.find(item.GetID());
+
+    if (found == _entryByItem.end()) return;
+
+    // The values might have changed, the search text is re-read on demand
+    InvalidateSearchText(item);
+
+    auto& entry = _entries[found->second];
+
+    bool wasVisible = entry.isVisible();
+    entry.matches = matches(item);
+    bool isVisible = entry.isVisible();
+
+    // Walk upwards as long as the visibility of the parent rows is affected
+    for (auto parent = entry.parent; parent != NoParent && wasVisible != isVisible; parent = _entries[parent].parent)
+    {
+        auto& parentEntry = _entries[parent];
+
+        wasVisible = parentEntry.isVisible();
+
+        if (isVisible)
+        {
+            parentEntry.numVisibleChildren++;
+        }
+        else
+        {
+            parentEntry.numVisibleChildren--;
+        }
+
+        isVisible = parentEntry.isVisible();
+    }
+}
+
+void TreeModelSearchIndex::InvalidateSearchText(const wxDataViewItem& item)
+{
+    _searchTexts.erase(item.GetID());
+}
+
+void TreeModelSearchIndex::Remove(const wxDataViewItem& item)
+{
+    _searchTexts.erase(item.GetID());
+
+    auto found = _entryByItem.find(item.GetID());
+
+    if (found == _entryByItem.end()) return;
+
+    auto index = found->second;
+    _entryByItem.erase(found);
+
+    // The descendants are following the row, their parents are never preceding it.
+    // Their IDs might be re-used by the model after removal, forget about them too.
+    for (auto i = index + 1; i < _entries.size() && _entries[i].parent != NoParent &&
+        _entries[i].parent >= index; ++i)
+    {
+        _searchTexts.erase(_entries[i].item);
+        _entryByItem.erase(_entries[i].item);
+    }
+}
+
+bool TreeModelSearchIndex::IsVisible(const wxDataViewItem& item) const
+{
+    auto found = _entryByItem.find(item.GetID());
+
+    return found != _entryByItem.end() && _entries[found->second].isVisible();
+}
+
+const wxString* TreeModelSearchIndex::GetSearchText(const wxDataViewItem& item)
+{
+    if (_model == nullptr) return nullptr;
+
+    auto existing = _searchTexts.find(item.GetID());
+
+    if (existing != _searchTexts.end())
+    {
+        return &existing->second;
+    }
+
+    wxString searchText;
+    TreeModel::Row row(item, *_model);
+
+    for (const auto& column : _columns)
+    {
+        if (!searchText.empty())
+        {
+            searchText += '\n';
+        }
+
+        searchText += row[column].getString().Lower();
+    }
+
+    return &_searchTexts.emplace(item.GetID(), searchText).first->second;
+}
+
+void TreeModelSearchIndex::EvaluateChildren(const wxDataViewItem& parentItem, std::size_t parentIndex, const MatchFunction& matches)
+{
+    wxDataViewItemArray children;
+    _model->GetChildren(parentItem, children);
+
+    for (const auto& child : children)
+    {
+        auto index = _entries.size();
+
+        _entries.push_back(Entry{ child.GetID(), parentIndex, matches(child), 0 });
+        _entryByItem.emplace(child.GetID(), index);
+
+        EvaluateChildren(child, index, matches);
+    }
+}
+
+}
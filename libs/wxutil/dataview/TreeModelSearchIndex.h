@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include "TreeModel.h"
+
+namespace wxutil
+{
+
+/**
+ * Index over the rows of a TreeModel, used to evaluate the visibility
+ * of a filtered tree without recursing into the children of every row
+ * the filter is asked about.
+ *
+ * The searchable column values of each row are converted to lower case
+ * once and kept until the row is removed or the index is reset.
+ * The visibility of all rows (a row is visible if it or any of its
+ * descendants is matching) is evaluated in a single pass over the tree,
+ * and can be updated incrementally when individual rows are changing.
+ */
+class TreeModelSearchIndex
+{
+public:
+    // Returns true if the given row is matching the current filter criteria
+    using MatchFunction = std::function<bool(const wxDataViewItem&)>;
+
+private:
+    static constexpr std::size_t NoParent = static_cast<std::size_t>(-1);
+
+    struct Entry
+    {
+        wxDataViewItem::Type item;
+        std::size_t parent;
+        bool matches;
+        std::size_t numVisibleChildren;
+
+        bool isVisible() const
+        {
+            return matches || numVisibleChildren > 0;
+        }
+    };
+
+    TreeModel* _model;
+    std::vector<TreeModel::Column> _columns;
+
+    // Entries in depth-first order, parents are preceding their children
+    std::vector<Entry> _entries;
+    std::unordered_map<wxDataViewItem::Type, std::size_t> _entryByItem;
+
+    // Lower case column values, separated by line breaks
+    std::unordered_map<wxDataViewItem::Type, wxString> _searchTexts;
+
+public:
+    TreeModelSearchIndex();
+
+    // Attaches the index to the given model, the search text is taken
+    // from the given columns (String or IconText). Any previously
+    // indexed data is discarded.
+    void Reset(TreeModel& model, const std::vector<TreeModel::Column>& columns);
+
+    void Clear();
+
+    // True if the index holds the visibility of the given row
+    bool IsEvaluated(const wxDataViewItem& item) const;
+
+    // Walks the whole tree and evaluates the match function for every row,
+    // updating the visibility flags of the whole tree
+    void Evaluate(const MatchFunction& matches);
+
+    // Re-reads the values of the given row and re-evaluates it.
+    // The change is propagated to the visibility of its parent rows.
+    void Update(const wxDataViewItem& item, const MatchFunction& matches);
+
+    // Drops the cached search text of the given row after its values have
+    // changed, the text is re-read on the next request. The visibility of the
+    // row is left alone until the next Update() or Evaluate() call.
+    void InvalidateSearchText(const wxDataViewItem& item);
+
+    // Drops the data of a row that is about to be removed from the model,
+    // including the data of all its descendants (as of the last evaluation)
+    void Remove(const wxDataViewItem& item);
+
+    // Returns true if the given row or any of its descendants is matching
+    bool IsVisible(const wxDataViewItem& item) const;
+
+    // Returns the lower case search text of the given row, or nullptr if the index is not attached
+    const wxString* GetSearchText(const wxDataViewItem& item);
+
+private:
+    void EvaluateChildren(const wxDataViewItem& parentItem, std::size_t parentIndex, const MatchFunction& matches);
+};
+
+}
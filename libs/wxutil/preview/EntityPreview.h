@@ -34,10 +34,10 @@ protected:
     float _defaultCamDistanceFactor;
 
 private:
-    bool onPreRender() override;
     RenderStateFlags getRenderFlagsFill() override;
 
 protected:
+    bool onPreRender() override;
     void setupSceneGraph() override;
     AABB getSceneBounds() override;
 
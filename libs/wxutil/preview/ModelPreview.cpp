@@ -5,6 +5,7 @@
 #include "imodelcache.h"
 #include "i18n.h"
 #include "ieclass.h"
+#include "ifilesystem.h"
 #include "math/AABB.h"
 #include "modelskin.h"
 #include "entitylib.h"
@@ -13,6 +14,8 @@
 #include "scene/BasicRootNode.h"
 #include "wxutil/dialog/MessageBox.h"
 #include "string/convert.h"
+#include "math/Hash.h"
+#include "render/ThumbnailFilename.h"
 #include "fmt/format.h"
 
 namespace wxutil
@@ -24,8 +27,11 @@ namespace
 }
 
 ModelPreview::ModelPreview(wxWindow* parent) :
-    EntityPreview(parent)
-{}
+    EntityPreview(parent),
+    _thumbnailShown(false)
+{
+    enableThumbnails("models");
+}
 
 ModelPreview::~ModelPreview()
 {
@@ -46,6 +52,13 @@ void ModelPreview::setModel(const std::string& model)
 {
     // Remember the name and mark the scene as "not ready"
     _model = model;
+    _thumbnailKey = calculateThumbnailKey();
+
+    if (_model != _lastModel)
+    {
+        _thumbnailShown = false;
+    }
+
     queueSceneUpdate();
 
     if (!_model.empty())
@@ -70,6 +83,7 @@ void ModelPreview::setSkin(const std::string& skin) {
 
     _skin = skin;
     _skinDeclChangedConn.disconnect();
+    _thumbnailKey = calculateThumbnailKey();
     queueSceneUpdate();
 
     // Redraw
@@ -159,6 +173,55 @@ void ModelPreview::prepareScene()
     }
 }
 
+bool ModelPreview::onPreRender()
+{
+    // Show the stored snapshot of a model that has not been loaded yet. Loading
+    // is deferred to the next frame, such that the snapshot is visible meanwhile.
+    if (_model != _lastModel && !_thumbnailShown && drawThumbnail(_thumbnailKey))
+    {
+        _thumbnailShown = true;
+        CallAfter([this]() { queueDraw(); });
+
+        return false;
+    }
+
+    return EntityPreview::onPreRender();
+}
+
+std::string ModelPreview::getThumbnailKey()
+{
+    // Only the first frame of a model is using the initial view position
+    return _modelNode && _model == _lastModel ? _thumbnailKey : std::string();
+}
+
+std::string ModelPreview::calculateThumbnailKey()
+{
+    if (_model.empty()) return {};
+
+    math::Hash modelHash;
+    modelHash.addString(_model);
+    modelHash.addString(_skin);
+
+    math::Hash sourceHash;
+
+    auto modelDef = GlobalEntityClassManager().findModel(_model);
+
+    if (modelDef)
+    {
+        render::addThumbnailSourceFile(sourceHash, modelDef->getBlockSyntax().fileInfo);
+    }
+
+    render::addThumbnailSourceFile(sourceHash,
+        GlobalFileSystem().getFileInfo(modelDef ? modelDef->getMesh() : _model));
+
+    if (auto skin = _skin.empty() ? nullptr : GlobalModelSkinCache().findSkin(_skin); skin)
+    {
+        render::addThumbnailSourceFile(sourceHash, skin->getBlockSyntax().fileInfo);
+    }
+
+    return render::makeThumbnailKey(modelHash, sourceHash);
+}
+
 void ModelPreview::setupInitialViewPosition()
 {
     if (_lastModel != _model)
@@ -35,6 +35,12 @@ private:
     // Current model to display
     scene::INodePtr _modelNode;
 
+    // Key of the stored snapshot of the current model and skin
+    std::string _thumbnailKey;
+
+    // True once the stored snapshot has been shown in place of the current model
+    bool _thumbnailShown;
+
     sigc::signal<void, const model::ModelNodePtr&> _modelLoadedSignal;
     sigc::connection _skinDeclChangedConn;
 
@@ -71,12 +77,17 @@ public:
 
 protected:
     void prepareScene() override;
+    bool onPreRender() override;
+    std::string getThumbnailKey() override;
 
     void setupSceneGraph() override;
     AABB getSceneBounds() override;
     void applySkin();
     void onSkinDeclarationChanged();
     void setupInitialViewPosition() override;
+
+private:
+    std::string calculateThumbnailKey();
 };
 
 } // namespace
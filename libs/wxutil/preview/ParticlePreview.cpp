@@ -12,6 +12,8 @@
 #include "entitylib.h"
 
 #include "string/string.h"
+#include "math/Hash.h"
+#include "render/ThumbnailFilename.h"
 #include "wxutil/GLWidget.h"
 #include "wxutil/dialog/MessageBox.h"
 
@@ -27,6 +29,10 @@ namespace
 {
     const char* const FUNC_EMITTER_CLASS = "func_emitter";
 
+    // Playback time at which the snapshot of a particle is taken, when most
+    // particle systems are showing more than their first particles
+    constexpr std::size_t THUMBNAIL_CAPTURE_TIME_MSEC = 1000;
+
 	enum ToolItems
 	{
 		TOOL_SHOW_AXES = 100,
@@ -41,6 +47,8 @@ namespace
 ParticlePreview::ParticlePreview(wxWindow* parent) :
 	RenderPreview(parent, true)
 {
+    enableThumbnails("particles");
+
     // Add one additional toolbar for particle-related stuff
 	wxToolBar* toolbar = new wxToolBar(_mainPanel, wxID_ANY);
 	toolbar->SetToolBitmapSize(wxSize(24, 24));
@@ -107,6 +115,7 @@ void ParticlePreview::SetPreviewDeclName(const std::string& declName)
 
         _particleNode.reset();
         _lastParticle = "";
+        _thumbnailKey.clear();
         stopPlayback();
         return;
     }
@@ -160,6 +169,14 @@ void ParticlePreview::SetPreviewDeclName(const std::string& declName)
 
         _lastParticle = nameClean;
 
+        math::Hash particleHash;
+        particleHash.addString(nameClean);
+
+        math::Hash sourceHash;
+        render::addThumbnailSourceFile(sourceHash, getParticle()->getBlockSyntax().fileInfo);
+
+        _thumbnailKey = render::makeThumbnailKey(particleHash, sourceHash);
+
         // Start playback when switching particles
         startPlayback();
     }
@@ -282,6 +299,16 @@ void ParticlePreview::onModelRotationChanged()
     }
 }
 
+std::string ParticlePreview::getThumbnailKey()
+{
+    if (!_particleNode || _renderSystem->getTime() < THUMBNAIL_CAPTURE_TIME_MSEC)
+    {
+        return {};
+    }
+
+    return _thumbnailKey;
+}
+
 void ParticlePreview::drawAxes()
 {
     glDisable(GL_TEXTURE_2D);
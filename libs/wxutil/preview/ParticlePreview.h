@@ -35,6 +35,9 @@ private:
 
     std::string _lastParticle;
 
+    // Key of the stored snapshot of the current particle
+    std::string _thumbnailKey;
+
 public:
 
     /// Construct a ParticlePreview widget.
@@ -77,6 +80,8 @@ protected:
 
     void onModelRotationChanged() override;
 
+    std::string getThumbnailKey() override;
+
 private:
     void drawAxes();
 
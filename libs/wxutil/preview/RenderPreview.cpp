@@ -19,6 +19,7 @@
 #include <wx/menu.h>
 #include <wx/dcclient.h>
 #include <wx/textctrl.h>
+#include <wx/image.h>
 #include "../Bitmap.h"
 
 #include <fmt/format.h>
@@ -41,6 +42,9 @@ namespace
 	const std::string RKEY_RENDERPREVIEW_SHOWGRID("user/ui/renderPreview/showGrid");
 	const std::string RKEY_RENDERPREVIEW_FONTSIZE("user/ui/renderPreview/fontSize");
 	const std::string RKEY_RENDERPREVIEW_FONTSTYLE("user/ui/renderPreview/fontStyle");
+
+    // Largest edge length of the stored preview snapshots
+    constexpr int MAX_THUMBNAIL_SIZE = 256;
 }
 
 RenderPreview::RenderPreview(wxWindow* parent, bool enableAnimation) :
@@ -532,6 +536,9 @@ bool RenderPreview::drawPreview()
         _renderSystem->renderFullBrightScene(RenderViewType::Camera, flags, _view);
     }
 
+    // Snapshot the scene before any overlays are drawn
+    captureThumbnail();
+
     // Grid will be drawn afterwards, with enabled depth test
     if (_renderGrid && canDrawGrid())
     {
@@ -893,6 +900,115 @@ std::string RenderPreview::getInfoText()
     return fmt::format("{0:.3f} sec.", (_renderSystem->getTime() * 0.001f));
 }
 
+void RenderPreview::enableThumbnails(const std::string& subFolder)
+{
+    _thumbnails = std::make_unique<ThumbnailStore>(subFolder, MAX_THUMBNAIL_SIZE);
+}
+
+void RenderPreview::captureThumbnail()
+{
+    if (!_thumbnails || _previewWidth <= 0 || _previewHeight <= 0) return;
+
+    auto key = getThumbnailKey();
+
+    if (key.empty() || !_capturedThumbnailKeys.insert(key).second || _thumbnails->findThumbnail(key))
+    {
+        return;
+    }
+
+    // This is stalling until the frame is rendered, but it happens only once per asset
+    // and source file change. Scaling and compression happens on the store's worker thread.
+    auto pixels = std::make_shared<ThumbnailStore::Pixels>();
+    pixels->width = _previewWidth;
+    pixels->height = _previewHeight;
+    pixels->channels = 3;
+    pixels->bottomUp = true;
+    pixels->data.resize(static_cast<std::size_t>(_previewWidth) * _previewHeight * 3);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, _previewWidth, _previewHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels->data.data());
+
+    _thumbnails->storeThumbnail(key, Vector2i(_previewWidth, _previewHeight), pixels);
+}
+
+bool RenderPreview::drawThumbnail(const std::string& key)
+{
+    auto thumbnail = _thumbnails ? _thumbnails->findThumbnail(key) : std::nullopt;
+
+    if (!thumbnail) return false;
+
+    wxImage image;
+
+    if (!image.LoadFile(thumbnail->filePath, wxBITMAP_TYPE_PNG) || !image.IsOk())
+    {
+        return false;
+    }
+
+    if (GLEW_VERSION_1_3)
+    {
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    if (GLEW_VERSION_2_0)
+    {
+        glUseProgram(0);
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // wxImage data is RGB without padding, the first row is the top one
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.GetWidth(), image.GetHeight(), 0,
+        GL_RGB, GL_UNSIGNED_BYTE, image.GetData());
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, _previewWidth, 0, _previewHeight, -100, 100);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    glColor3f(1, 1, 1);
+
+    // Fit the image into the view, keeping its aspect ratio
+    auto scale = std::min(static_cast<double>(_previewWidth) / image.GetWidth(),
+        static_cast<double>(_previewHeight) / image.GetHeight());
+
+    auto width = image.GetWidth() * scale;
+    auto height = image.GetHeight() * scale;
+    auto left = (_previewWidth - width) * 0.5;
+    auto bottom = (_previewHeight - height) * 0.5;
+
+    glBegin(GL_QUADS);
+    glTexCoord2d(0, 1);
+    glVertex2d(left, bottom);
+    glTexCoord2d(1, 1);
+    glVertex2d(left + width, bottom);
+    glTexCoord2d(1, 0);
+    glVertex2d(left + width, bottom + height);
+    glTexCoord2d(0, 0);
+    glVertex2d(left, bottom + height);
+    glEnd();
+
+    glDisable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDeleteTextures(1, &texture);
+
+    return true;
+}
+
 void RenderPreview::onGLKeyPress(wxKeyEvent& ev)
 {
     if (!_freezePointer.isCapturing(_glWidget))
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <set>
+#include <memory>
 #include <wx/panel.h>
 #include <wx/timer.h>
 #include <sigc++/trackable.h>
@@ -12,6 +14,7 @@
 #include "irender.h"
 
 #include "../FreezePointer.h"
+#include "../ThumbnailStore.h"
 #include "render/NopRenderView.h"
 #include "render/CamRenderer.h"
 
@@ -74,6 +77,9 @@ private:
 
     void setupToolbars(bool enableAnimation);
 
+    // Stores the rendered frame if there is no thumbnail for the current key yet
+    void captureThumbnail();
+
 protected:
 	wxPanel* _mainPanel;
 
@@ -94,6 +100,12 @@ private:
 
     bool _enableLightingModeAtStart;
 
+    // Stored snapshots of the previewed assets, only set up if enabled by the subclass
+    std::unique_ptr<ThumbnailStore> _thumbnails;
+
+    // Keys the snapshot has been taken of in this session
+    std::set<std::string> _capturedThumbnailKeys;
+
 protected:
     const unsigned int MSEC_PER_FRAME = 16;
 
@@ -180,6 +192,20 @@ protected:
     // Can be overridden by subclasses to update their scene/models
     virtual void onRenderModeChanged() {}
 
+    // Lets the preview store a snapshot of each asset in the given sub folder
+    // of the thumbnail cache, see getThumbnailKey()
+    void enableThumbnails(const std::string& subFolder);
+
+    // Returns the key of the thumbnail showing the current scene as rendered in
+    // this frame (see render/ThumbnailFilename.h). The frame is stored once per
+    // key, right after the scene has been rendered. Return an empty key if the
+    // frame should not be stored, which is the default.
+    virtual std::string getThumbnailKey() { return {}; }
+
+    // Draws the stored thumbnail with the given key, scaled to fit the view.
+    // Returns false if there is no such thumbnail.
+    bool drawThumbnail(const std::string& key);
+
     // Returns the info text that is rendered in the lower left corner of the preview. 
     // Shows the render time by default, but can be overridden by subclasses.
     virtual std::string getInfoText();
@@ -110,7 +110,7 @@ void AIVocalSetPreview::onPlay(wxCommandEvent& ev)
 		// Pass the call to the sound manager
 		if (!GlobalSoundManager().playSound(file))
 		{
-			_statusLabel->SetLabelMarkup(_("<b>Error:</b> File not found."));
+			_statusLabel->SetLabelMarkup(_("<b>Error:</b> File not found or not playable."));
 		}
 	}
 }
@@ -48,17 +48,22 @@ bool AutomationEngine::hasLostConnection() const
 }
 
 bool AutomationEngine::connect()
+{
+    // TODO: make port configurable, as it is in TDM?
+    return connect(DEFAULT_HOST, DEFAULT_PORT);
+}
+
+bool AutomationEngine::connect(const std::string& host, int port)
 {
     if (isAlive())
         return true;    //already connected
 
     // Make connection using clsocket
-    // TODO: make port configurable, as it is in TDM?
     std::unique_ptr<CActiveSocket> connection(new CActiveSocket());
     if (
         !connection->Initialize() ||
         !connection->SetNonblocking() ||
-        !connection->Open(DEFAULT_HOST, DEFAULT_PORT))
+        !connection->Open(host.c_str(), static_cast<uint16>(port)))
     {
         return false;
     }
@@ -47,6 +47,8 @@ public:
     // Connect to TDM instance if not connected yet.
     // Returns false if failed to connect, true on success.
     bool connect();
+    // Same as above, but connects to the given host and port instead of the default one.
+    bool connect(const std::string& host, int port);
     // Disconnect from TDM instance if connected.
     // If force = false, then it waits until all pending requests are finished.
     // If force = true, then all pending requests are dropped, no blocking for sure.
@@ -0,0 +1,202 @@
+#include "DiffBinaryMapWriter.h"
+#include "DiffStatus.h"
+
+#include <vector>
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+#include "ientity.h"
+
+namespace gameconn
+{
+
+namespace
+{
+    const char* const MAGIC = "TDMD";
+
+    void writeVarint(std::size_t value, std::ostream& stream) {
+        while (value >= 0x80) {
+            stream.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        stream.put(static_cast<char>(value));
+    }
+
+    void writeString(const std::string& str, std::ostream& stream) {
+        writeVarint(str.size(), stream);
+        stream.write(str.data(), str.size());
+    }
+
+    DiffBinaryMapWriter::Kind getKind(const DiffStatus& status) {
+        assert(status.isModified());
+        if (status.isRemoved())
+            return DiffBinaryMapWriter::Remove;
+        if (status.isAdded())
+            return DiffBinaryMapWriter::Add;
+        if (status.needsRespawn())
+            return DiffBinaryMapWriter::ModifyRespawn;
+        return DiffBinaryMapWriter::Modify;
+    }
+
+    const char* getStatusWord(unsigned char kind) {
+        switch (kind) {
+        case DiffBinaryMapWriter::Modify: return "modify";
+        case DiffBinaryMapWriter::ModifyRespawn: return "modify_respawn";
+        case DiffBinaryMapWriter::Add: return "add";
+        case DiffBinaryMapWriter::Remove: return "remove";
+        default: throw std::runtime_error("Invalid entity record in binary diff");
+        }
+    }
+
+    class DiffReader {
+        const std::string& _data;
+        std::size_t _pos = 0;
+
+    public:
+        DiffReader(const std::string& data) : _data(data) {}
+
+        unsigned char readByte() {
+            if (_pos >= _data.size())
+                throw std::runtime_error("Binary diff is truncated");
+            return static_cast<unsigned char>(_data[_pos++]);
+        }
+
+        std::size_t readVarint() {
+            std::size_t value = 0;
+            for (int shift = 0; ; shift += 7) {
+                if (shift >= 64)
+                    throw std::runtime_error("Invalid number in binary diff");
+                unsigned char byte = readByte();
+                value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return value;
+            }
+        }
+
+        std::string readString() {
+            std::size_t length = readVarint();
+            if (length > _data.size() - _pos)
+                throw std::runtime_error("Binary diff is truncated");
+            std::string result = _data.substr(_pos, length);
+            _pos += length;
+            return result;
+        }
+
+        bool isAtEnd() const {
+            return _pos == _data.size();
+        }
+    };
+}
+
+DiffBinaryMapWriter::DiffBinaryMapWriter(const std::map<std::string, DiffStatus>& statuses) :
+    _entityStatuses(statuses)
+{}
+
+void DiffBinaryMapWriter::beginWriteDiff(std::ostream& stream)
+{
+    stream.write(MAGIC, 4);
+    stream.put(static_cast<char>(Version));
+}
+
+void DiffBinaryMapWriter::endWriteDiff(std::ostream& stream)
+{
+    stream.put(static_cast<char>(End));
+}
+
+void DiffBinaryMapWriter::beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream)
+{}
+
+void DiffBinaryMapWriter::endWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream)
+{}
+
+void DiffBinaryMapWriter::writeKey(const std::string& key, std::ostream& stream) {
+    auto found = _keyIndices.find(key);
+    if (found != _keyIndices.end()) {
+        writeVarint(found->second, stream);
+        return;
+    }
+    std::size_t index = _keyIndices.size();
+    _keyIndices[key] = index;
+    writeVarint(index, stream);
+    writeString(key, stream);
+}
+
+void DiffBinaryMapWriter::writeRemoveEntityStub(const std::string& name, std::ostream& stream) {
+    stream.put(static_cast<char>(getKind(_entityStatuses.at(name))));
+    writeVarint(1, stream);
+    writeKey("name", stream);
+    writeString(name, stream);
+}
+
+void DiffBinaryMapWriter::beginWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) {
+    stream.put(static_cast<char>(getKind(_entityStatuses.at(entity->name()))));
+
+    std::vector<std::pair<std::string, std::string>> spawnargs;
+    entity->getEntity().forEachKeyValue([&](const std::string& key, const std::string& value)
+    {
+        spawnargs.emplace_back(key, value);
+    });
+
+    writeVarint(spawnargs.size(), stream);
+    for (const auto& pair : spawnargs) {
+        writeKey(pair.first, stream);
+        writeString(pair.second, stream);
+    }
+}
+
+void DiffBinaryMapWriter::endWriteEntity(const IEntityNodePtr& entity, std::ostream& stream)
+{}
+
+void DiffBinaryMapWriter::beginWriteBrush(const IBrushNodePtr&, std::ostream&)
+{}
+
+void DiffBinaryMapWriter::endWriteBrush(const IBrushNodePtr&, std::ostream&)
+{}
+
+void DiffBinaryMapWriter::beginWritePatch(const IPatchNodePtr&, std::ostream&)
+{}
+
+void DiffBinaryMapWriter::endWritePatch(const IPatchNodePtr&, std::ostream&)
+{}
+
+std::string DiffBinaryMapWriter::ConvertToText(const std::string& diff)
+{
+    DiffReader reader(diff);
+
+    char magic[4];
+    for (char& ch : magic)
+        ch = static_cast<char>(reader.readByte());
+    if (std::string(magic, 4) != MAGIC)
+        throw std::runtime_error("Data is not a binary diff");
+    if (reader.readByte() != Version)
+        throw std::runtime_error("Unsupported binary diff version");
+
+    std::ostringstream stream;
+    std::vector<std::string> keys;
+
+    for (unsigned char kind = reader.readByte(); kind != End; kind = reader.readByte()) {
+        stream << getStatusWord(kind) << " entity" << std::endl;
+        stream << "{" << std::endl;
+
+        std::size_t numSpawnargs = reader.readVarint();
+        for (std::size_t i = 0; i < numSpawnargs; i++) {
+            std::size_t index = reader.readVarint();
+            if (index == keys.size())
+                keys.push_back(reader.readString());
+            else if (index > keys.size())
+                throw std::runtime_error("Invalid key index in binary diff");
+
+            std::string value = reader.readString();
+            stream << "\"" << keys[index] << "\" \"" << value << "\"" << std::endl;
+        }
+
+        stream << "}" << std::endl;
+    }
+
+    if (!reader.isAtEnd())
+        throw std::runtime_error("Unexpected data after the end of the binary diff");
+
+    return stream.str();
+}
+
+}
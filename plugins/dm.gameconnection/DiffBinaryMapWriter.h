@@ -0,0 +1,78 @@
+#pragma once
+
+#include "imapformat.h"
+
+#include <map>
+#include <string>
+
+namespace gameconn
+{
+
+class DiffStatus;
+
+/**
+ * Compact binary variant of DiffDoom3MapWriter for TheDarkMod hot reload.
+ *
+ * The diff carries the same entities and spawnargs as the text format, as a
+ * sequence of records (all integers are unsigned LEB128 varints):
+ *
+ *   header:  "TDMD" <version>
+ *   entity:  <kind> <spawnarg count> { <key> <value> }...
+ *   end:     <kind 0>
+ *
+ * Values are length-prefixed strings. Keys are sent as index into the table of
+ * keys used so far in this diff, the index equal to the table size is followed
+ * by a new key string which is appended to the table.
+ */
+class DiffBinaryMapWriter : public map::IMapWriter
+{
+public:
+    static constexpr unsigned char Version = 1;
+
+    // Record kinds, named after the status words of the text format
+    enum Kind : unsigned char
+    {
+        End = 0,
+        Modify = 1,
+        ModifyRespawn = 2,
+        Add = 3,
+        Remove = 4,
+    };
+
+private:
+    const std::map<std::string, DiffStatus>& _entityStatuses;
+
+    // Indices of the keys written so far
+    std::map<std::string, std::size_t> _keyIndices;
+
+    void writeKey(const std::string& key, std::ostream& stream);
+
+public:
+    DiffBinaryMapWriter(const std::map<std::string, DiffStatus>& statuses);
+
+    // Header and end marker, to be written around all the entities of the diff
+    void beginWriteDiff(std::ostream& stream);
+    void endWriteDiff(std::ostream& stream);
+
+    void beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override;
+    void endWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override;
+
+    // Entity export methods
+    void beginWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override;
+    void endWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override;
+    void writeRemoveEntityStub(const std::string& name, std::ostream& stream);
+
+    // Brush export methods
+    void beginWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override;
+    void endWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override;
+
+    // Patch export methods
+    void beginWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override;
+    void endWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override;
+
+    // Converts a binary diff to the entity blocks written by DiffDoom3MapWriter.
+    // Throws std::runtime_error if the data is malformed.
+    static std::string ConvertToText(const std::string& diff);
+};
+
+}
@@ -10,6 +10,14 @@ DiffDoom3MapWriter::DiffDoom3MapWriter(const std::map<std::string, DiffStatus>&
     _entityStatuses(statuses)
 {}
 
+void DiffDoom3MapWriter::beginWriteDiff(std::ostream& stream)
+{
+    stream << "// diff " << _entityStatuses.size() << std::endl;
+}
+
+void DiffDoom3MapWriter::endWriteDiff(std::ostream& stream)
+{}
+
 void DiffDoom3MapWriter::beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream)
 {}
 
@@ -22,6 +22,10 @@ class DiffDoom3MapWriter : public map::IMapWriter
 public:
     DiffDoom3MapWriter(const std::map<std::string, DiffStatus>& statuses);
 
+    // Header and end of the diff, to be written around all the entities of the diff
+    void beginWriteDiff(std::ostream& stream);
+    void endWriteDiff(std::ostream& stream);
+
     void beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override;
     void endWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override;
 
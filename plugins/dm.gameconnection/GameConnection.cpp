@@ -1,9 +1,12 @@
 #include "GameConnection.h"
 #include "DiffStatus.h"
 #include "DiffDoom3MapWriter.h"
+#include "DiffBinaryMapWriter.h"
+#include "MapDiffExport.h"
 #include "AutomationEngine.h"
 
 #include "i18n.h"
+#include "itextstream.h"
 #include "igame.h"
 #include "icameraview.h"
 #include "inode.h"
@@ -18,7 +21,9 @@
 #include "wxutil/Bitmap.h"
 #include "util/ScopedBoolLock.h"
 #include "registry/registry.h"
+#include "string/case_conv.h"
 
+#include <chrono>
 #include <sigc++/signal.h>
 #include <sigc++/connection.h>
 #include <wx/toolbar.h>
@@ -37,6 +42,15 @@ namespace
     //this is how often this class "thinks" when idle
     constexpr int THINK_INTERVAL = 123;
 
+    //in "always update map" mode, consecutive edits are batched into one diff:
+    //it is sent when nothing has changed for this long...
+    constexpr std::chrono::milliseconds UPDATE_MAP_SETTLE_TIME(100);
+    //...but not later than this after the first change of the batch
+    constexpr std::chrono::milliseconds UPDATE_MAP_MAX_DELAY(500);
+
+    //opt-in: send map diffs in the binary encoding, which needs a game version supporting it
+    constexpr const char* const RKEY_USE_BINARY_MAP_DIFFS = "user/ui/gameConnection/useBinaryMapDiffs";
+
     //all ordinary requests, executed synchronously
     constexpr int TAG_GENERIC = 5;
     //camera DR->TDM sync is continuous, executed asynchronously
@@ -55,6 +69,11 @@ namespace
     inline std::string queryPreamble(std::string type) {
         return messagePreamble("query") + fmt::format("query \"{}\"\n", type);
     }
+
+    //true if the game rejected a request because it doesn't know its action
+    inline bool isUnknownActionResponse(const std::string& response) {
+        return string::to_lower_copy(response).find("unknown action") != std::string::npos;
+    }
 }
 
 GameConnection::GameConnection()
@@ -70,7 +89,7 @@ std::string GameConnection::executeGenericRequest(const std::string& request)
 
 bool GameConnection::sendAnyPendingAsync()
 {
-    if (_mapObserver.getChanges().size() && _updateMapAlways) {
+    if (_updateMapAlways && _mapObserver.hasSettledChanges(UPDATE_MAP_SETTLE_TIME, UPDATE_MAP_MAX_DELAY)) {
         //note: this is blocking
         doUpdateMap();
         return true;
@@ -139,6 +158,9 @@ bool GameConnection::connect()
     if (!_engine->connect())
         return false;       //failed to connect
 
+    //older game versions only understand text diffs, binary diffs need to be enabled by the user
+    _useBinaryDiffs = registry::getValue<bool>(RKEY_USE_BINARY_MAP_DIFFS);
+
     setThinkLoop(true);
 
     _mapEventListener = GlobalMapModule().signal_mapEvent().connect(
@@ -719,75 +741,28 @@ bool GameConnection::isAlwaysUpdateMapEnabled() const
     return _updateMapAlways;
 }
 
-/**
- * stgatilov: Saves only entities with specified names to in-memory map patch.
- * This diff is intended to be consumed by TheDarkMod automation for HotReload purposes.
- * TODO: What about patches and brushes?
- */
-std::string saveMapDiff(const DiffEntityStatuses& entityStatuses)
-{
-    auto root = GlobalSceneGraph().root();
-
-    std::set<scene::INode*> subsetNodes;
-    root->foreachNode([&](const scene::INodePtr& node) {
-        if (entityStatuses.count(node->name()))
-            subsetNodes.insert(node.get());
-        return true;
-    });
-
-    std::ostringstream outStream;
-    outStream << "// diff " << entityStatuses.size() << std::endl;
-
-    DiffDoom3MapWriter writer(entityStatuses);
-
-    //write removal stubs (no actual spawnargs)
-    for (const auto& pNS : entityStatuses) {
-        const auto& name = pNS.first;
-        const auto& status = pNS.second;
-        assert(status.isModified());    //(don't put untouched entities into map)
-        if (status.isRemoved())
-            writer.writeRemoveEntityStub(name, outStream);
-    }
-
-    //write added/modified entities as usual
-    {
-        registry::ScopedKeyChanger progressDisabler(RKEY_MAP_SUPPRESS_LOAD_STATUS_DIALOG, true);
-
-        // Hack: disable recalculateBrushWindings for this export
-        registry::ScopedKeyChanger<std::string> guard("MapExporter_IgnoreBrushes", "yes");
-
-        // Get a scoped exporter class
-        auto exporter = GlobalMapModule().createMapExporter(writer, root, outStream);
-
-        try
-        {
-            // Pass the traversal function and the root of the subgraph to export
-            exporter->exportMap(root, scene::traverseSubset(subsetNodes));
-            // end the life of the exporter instance here to finish the scene
-            exporter.reset();
-        }
-        catch (map::FileOperation::OperationCancelled&)
-        {
-            radiant::NotificationMessage::SendInformation(_("Map export cancelled"));
-        }
-    }
-
-    return outStream.str();
-}
-
 void GameConnection::doUpdateMap()
 {
     try {
         if (!_engine->isAlive())
             return; //no connection, don't even try
 
-        // Get map diff
-        std::string diff = saveMapDiff(_mapObserver.getChanges());
-        if (diff.empty()) {
-            return; //TODO: fail
+        std::string response;
+
+        if (_useBinaryDiffs) {
+            response = sendMapDiff("reloadmap-diff-binary", saveMapDiff<DiffBinaryMapWriter>(_mapObserver.getChanges()));
+
+            //other failures are not related to the encoding, the diff is sent again with the next update
+            if (isUnknownActionResponse(response)) {
+                rMessage() << "HotReload: game doesn't know binary diffs, falling back to text diffs" << std::endl;
+                _useBinaryDiffs = false;
+                response = sendMapDiff("reloadmap-diff", saveMapDiff<DiffDoom3MapWriter>(_mapObserver.getChanges()));
+            }
+        }
+        else {
+            response = sendMapDiff("reloadmap-diff", saveMapDiff<DiffDoom3MapWriter>(_mapObserver.getChanges()));
         }
 
-        std::string response = executeGenericRequest(actionPreamble("reloadmap-diff") + "content:\n" + diff);
         if (response.find("HotReload: SUCCESS") != std::string::npos) {
             //success: clear current diff, so that we don't reapply it next time
             _mapObserver.clear();
@@ -799,6 +774,16 @@ void GameConnection::doUpdateMap()
     }
 }
 
+std::string GameConnection::sendMapDiff(const std::string& action, const std::string& diff)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    std::string response = executeGenericRequest(actionPreamble(action) + "content:\n" + diff);
+    auto roundTrip = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    rDebug() << "HotReload: " << action << " of " << _mapObserver.getChanges().size() << " entities ("
+        << diff.size() << " bytes) answered in " << roundTrip.count() << " ms" << std::endl;
+    return response;
+}
+
 //-------------------------------------------------------------
 
 const std::string& GameConnection::getName() const
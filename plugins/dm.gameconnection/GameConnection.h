@@ -73,7 +73,8 @@ public:
     // The game applies the diff on top of its current map state and hot reloads entities.
     void doUpdateMap();
     // Enable/disable mode: doUpdateMap after every entity change.
-    // Note: the update is postponed to next think, so that mass changes go as one diff.
+    // Note: the update is postponed until the changes settle down (with an upper bound on the delay),
+    // so that mass changes and rapid consecutive edits go as one diff.
     void setAlwaysUpdateMapEnabled(bool on);
     // Returns true iff the mode for update map after every change is enabled.
     bool isAlwaysUpdateMapEnabled() const;
@@ -122,6 +123,9 @@ private:
     bool _autoReloadMap = false;
     // True when "setAlwaysUpdateMapEnabled" is enabled.
     bool _updateMapAlways = false;
+    // True if map diffs are sent in the binary encoding. Enabled by the user
+    // in the registry, reset when the game doesn't know the binary diff action.
+    bool _useBinaryDiffs = false;
 
     // True when restartGame procedure is executed.
     bool _restartInProgress = false;
@@ -152,6 +156,8 @@ private:
 
     // Waits for previous TAG_GENERIC requests to finish, then executes request as TAG_GENERIC (blocking).
     std::string executeGenericRequest(const std::string& request);
+    // Sends the given map diff as request for the given action, returns the response (blocking).
+    std::string sendMapDiff(const std::string& action, const std::string& diff);
     // Set noclip or god or notarget to specific state (blocking).
     // toggleCommand is the command which toggles state.
     // offKeyword is the part of phrase printed to game console when the state becomes disabled.
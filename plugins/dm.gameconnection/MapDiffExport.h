@@ -0,0 +1,80 @@
+#pragma once
+
+#include <set>
+#include <sstream>
+#include <cassert>
+
+#include "i18n.h"
+#include "imap.h"
+#include "iscenegraph.h"
+#include "scene/Traverse.h"
+#include "registry/registry.h"
+#include "messages/MapFileOperation.h"
+#include "messages/NotificationMessage.h"
+
+#include "DiffStatus.h"
+
+namespace gameconn
+{
+
+/**
+ * stgatilov: Saves only entities with specified names to in-memory map patch.
+ * This diff is intended to be consumed by TheDarkMod automation for HotReload purposes.
+ * The writer is either DiffDoom3MapWriter (text) or DiffBinaryMapWriter (compact binary).
+ * TODO: What about patches and brushes?
+ */
+template<typename DiffWriter>
+std::string saveMapDiff(const DiffEntityStatuses& entityStatuses)
+{
+    auto root = GlobalSceneGraph().root();
+
+    std::set<scene::INode*> subsetNodes;
+    root->foreachNode([&](const scene::INodePtr& node) {
+        if (entityStatuses.count(node->name()))
+            subsetNodes.insert(node.get());
+        return true;
+    });
+
+    std::ostringstream outStream;
+
+    DiffWriter writer(entityStatuses);
+    writer.beginWriteDiff(outStream);
+
+    //write removal stubs (no actual spawnargs)
+    for (const auto& pNS : entityStatuses) {
+        const auto& name = pNS.first;
+        const auto& status = pNS.second;
+        assert(status.isModified());    //(don't put untouched entities into map)
+        if (status.isRemoved())
+            writer.writeRemoveEntityStub(name, outStream);
+    }
+
+    //write added/modified entities as usual
+    {
+        registry::ScopedKeyChanger progressDisabler(RKEY_MAP_SUPPRESS_LOAD_STATUS_DIALOG, true);
+
+        // Hack: disable recalculateBrushWindings for this export
+        registry::ScopedKeyChanger<std::string> guard("MapExporter_IgnoreBrushes", "yes");
+
+        // Get a scoped exporter class
+        auto exporter = GlobalMapModule().createMapExporter(writer, root, outStream);
+
+        try
+        {
+            // Pass the traversal function and the root of the subgraph to export
+            exporter->exportMap(root, scene::traverseSubset(subsetNodes));
+            // end the life of the exporter instance here to finish the scene
+            exporter.reset();
+        }
+        catch (map::FileOperation::OperationCancelled&)
+        {
+            radiant::NotificationMessage::SendInformation(_("Map export cancelled"));
+        }
+    }
+
+    writer.endWriteDiff(outStream);
+
+    return outStream.str();
+}
+
+}
@@ -156,6 +156,10 @@ MapObserver::~MapObserver() {
 }
 
 void MapObserver::entityUpdated(const std::string& name, const DiffStatus& diff) {
+    _lastChangeTime = std::chrono::steady_clock::now();
+    if (_entityChanges.empty())
+        _firstChangeTime = _lastChangeTime;
+
     DiffStatus& status = _entityChanges[name];
     status = status.combine(diff);
 }
@@ -164,4 +168,15 @@ const DiffEntityStatuses& MapObserver::getChanges() const {
     return _entityChanges;
 }
 
+bool MapObserver::hasSettledChanges(std::chrono::milliseconds settleTime, std::chrono::milliseconds maxDelay) const {
+    return hasSettledChanges(settleTime, maxDelay, std::chrono::steady_clock::now());
+}
+
+bool MapObserver::hasSettledChanges(std::chrono::milliseconds settleTime, std::chrono::milliseconds maxDelay,
+    std::chrono::steady_clock::time_point now) const {
+    if (_entityChanges.empty())
+        return false;
+    return now - _lastChangeTime >= settleTime || now - _firstChangeTime >= maxDelay;
+}
+
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include "icommandsystem.h"
 #include "iscenegraph.h"
 #include "ientity.h"
@@ -31,6 +32,13 @@ public:
     //returns pending entity change since last clear (or since enabled)
     const DiffEntityStatuses& getChanges() const;
 
+    //returns true if there are pending changes and they have settled down:
+    //nothing changed during the last settleTime, or the first pending change is older than maxDelay
+    bool hasSettledChanges(std::chrono::milliseconds settleTime, std::chrono::milliseconds maxDelay) const;
+    //same as above, evaluated at the given point of time
+    bool hasSettledChanges(std::chrono::milliseconds settleTime, std::chrono::milliseconds maxDelay,
+        std::chrono::steady_clock::time_point now) const;
+
 private:
     //receives events about entity changes
     void entityUpdated(const std::string& name, const DiffStatus& diff);
@@ -44,6 +52,9 @@ private:
     std::map<IEntityNode*, Entity::Observer*> _entityObservers;		//note: values owned
     //set of entities with changes since last clear
     DiffEntityStatuses _entityChanges;
+    //when the first pending change and the most recent one happened
+    std::chrono::steady_clock::time_point _firstChangeTime;
+    std::chrono::steady_clock::time_point _lastChangeTime;
 
     //internal classes can call private methods
     friend class MapObserver_EntityObserver;
@@ -1,6 +1,8 @@
 #include "BrushInterface.h"
 
+#include "iundo.h"
 #include "../SceneNodeBuffer.h"
+#include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
 PYBIND11_MAKE_OPAQUE(IWinding);
@@ -174,6 +176,127 @@ void ScriptBrushNode::undoSave()
 	brushNode->getIBrush().undoSave();
 }
 
+py::array_t<double> ScriptBrushNode::getFacePlanes()
+{
+	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(_node.lock());
+	std::size_t numFaces = brushNode ? brushNode->getIBrush().getNumFaces() : 0;
+
+	py::array_t<double> planes(std::vector<std::size_t>{ numFaces, 4 });
+	auto view = planes.mutable_unchecked<2>();
+
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		const auto& plane = brushNode->getIBrush().getFace(i).getPlane3();
+
+		view(i, 0) = plane.normal().x();
+		view(i, 1) = plane.normal().y();
+		view(i, 2) = plane.normal().z();
+		view(i, 3) = plane.dist();
+	}
+
+	return planes;
+}
+
+std::vector<std::string> ScriptBrushNode::getFaceShaders()
+{
+	std::vector<std::string> shaders;
+
+	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(_node.lock());
+	if (brushNode == NULL) return shaders;
+
+	IBrush& brush = brushNode->getIBrush();
+	shaders.reserve(brush.getNumFaces());
+
+	for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+	{
+		shaders.push_back(brush.getFace(i).getShader());
+	}
+
+	return shaders;
+}
+
+void ScriptBrushNode::setFaceShaders(const std::vector<std::string>& shaders)
+{
+	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(_node.lock());
+	if (brushNode == NULL) return;
+
+	IBrush& brush = brushNode->getIBrush();
+
+	if (shaders.size() != brush.getNumFaces())
+	{
+		throw py::value_error("setFaceShaders: expected " + std::to_string(brush.getNumFaces()) +
+			" shaders, got " + std::to_string(shaders.size()));
+	}
+
+	UndoableCommand cmd("setFaceShaders");
+
+	for (std::size_t i = 0; i < shaders.size(); ++i)
+	{
+		IFace& face = brush.getFace(i);
+
+		// Skip unchanged faces, setShader() is re-calculating the texture scale
+		if (face.getShader() != shaders[i])
+		{
+			face.setShader(shaders[i]);
+		}
+	}
+}
+
+py::array_t<double> ScriptBrushNode::getFaceTextureMatrices()
+{
+	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(_node.lock());
+	std::size_t numFaces = brushNode ? brushNode->getIBrush().getNumFaces() : 0;
+
+	py::array_t<double> matrices(std::vector<std::size_t>{ numFaces, 2, 3 });
+	auto view = matrices.mutable_unchecked<3>();
+
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		auto projection = brushNode->getIBrush().getFace(i).getProjectionMatrix();
+
+		// The bottom row of the projection matrix is always (0, 0, 1)
+		for (py::ssize_t row = 0; row < 2; ++row)
+		{
+			for (py::ssize_t col = 0; col < 3; ++col)
+			{
+				view(i, row, col) = projection.eigen().matrix()(row, col);
+			}
+		}
+	}
+
+	return matrices;
+}
+
+void ScriptBrushNode::setFaceTextureMatrices(const py::array_t<double>& matrices)
+{
+	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(_node.lock());
+	if (brushNode == NULL) return;
+
+	IBrush& brush = brushNode->getIBrush();
+
+	if (matrices.ndim() != 3 || static_cast<std::size_t>(matrices.shape(0)) != brush.getNumFaces() ||
+		matrices.shape(1) != 2 || matrices.shape(2) != 3)
+	{
+		throw py::value_error("setFaceTextureMatrices: expected an array of shape (" +
+			std::to_string(brush.getNumFaces()) + ", 2, 3)");
+	}
+
+	UndoableCommand cmd("setFaceTextureMatrices");
+
+	auto view = matrices.unchecked<3>();
+
+	for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+	{
+		IFace& face = brush.getFace(i);
+
+		face.undoSave();
+		face.setProjectionMatrix(Matrix3::byRows(
+			view(i, 0, 0), view(i, 0, 1), view(i, 0, 2),
+			view(i, 1, 0), view(i, 1, 1), view(i, 1, 2),
+			0, 0, 1));
+	}
+}
+
 // Checks if the given SceneNode structure is a BrushNode
 bool ScriptBrushNode::isBrush(const ScriptSceneNode& node) 
 {
@@ -247,6 +370,11 @@ void BrushInterface::registerInterface(py::module& scope, py::dict& globals)
 	brush.def("getFace", &ScriptBrushNode::getFace);
 	brush.def("getDetailFlag", &ScriptBrushNode::getDetailFlag);
 	brush.def("setDetailFlag", &ScriptBrushNode::setDetailFlag);
+	brush.def("getFacePlanes", &ScriptBrushNode::getFacePlanes);
+	brush.def("getFaceShaders", &ScriptBrushNode::getFaceShaders);
+	brush.def("setFaceShaders", &ScriptBrushNode::setFaceShaders);
+	brush.def("getFaceTextureMatrices", &ScriptBrushNode::getFaceTextureMatrices);
+	brush.def("setFaceTextureMatrices", &ScriptBrushNode::setFaceTextureMatrices);
 
 	// Define the BrushCreator interface
 	py::class_<BrushInterface> brushCreator(scope, "BrushCreator");
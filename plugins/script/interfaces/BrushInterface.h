@@ -4,6 +4,7 @@
 #include "iscriptinterface.h"
 #include "ibrush.h"
 
+#include <pybind11/numpy.h>
 #include "SceneGraphInterface.h"
 
 namespace script 
@@ -87,6 +88,23 @@ public:
 	// Call this before manipulating the brush to make your action undo-able.
 	void undoSave();
 
+	// Returns the planes of all faces as Nx4 array, each row holding (normal.x, normal.y, normal.z, dist)
+	py::array_t<double> getFacePlanes();
+
+	// Returns the shader names of all faces, in face order
+	std::vector<std::string> getFaceShaders();
+
+	// Assigns the given shaders to the faces, in face order, as a single undoable operation.
+	// Raises a ValueError if the number of shaders doesn't match the number of faces.
+	void setFaceShaders(const std::vector<std::string>& shaders);
+
+	// Returns the texture projection matrices of all faces as Nx2x3 array
+	py::array_t<double> getFaceTextureMatrices();
+
+	// Assigns the Nx2x3 texture projection matrices to the faces as a single undoable operation.
+	// Raises a ValueError if the array shape doesn't match the number of faces.
+	void setFaceTextureMatrices(const py::array_t<double>& matrices);
+
 	// Checks if the given SceneNode structure is a BrushNode
 	static bool isBrush(const ScriptSceneNode& node);
 
@@ -4,6 +4,7 @@
 #include <pybind11/stl_bind.h>
 
 #include "ipatch.h"
+#include "iundo.h"
 #include "itextstream.h"
 
 #include "../SceneNodeBuffer.h"
@@ -135,6 +136,72 @@ void ScriptPatchNode::controlPointsChanged()
 	patchNode->getPatch().controlPointsChanged();
 }
 
+py::array_t<double> ScriptPatchNode::getControlPoints() const
+{
+	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(_node.lock());
+	std::size_t width = patchNode ? patchNode->getPatch().getWidth() : 0;
+	std::size_t height = patchNode ? patchNode->getPatch().getHeight() : 0;
+
+	py::array_t<double> controlPoints(std::vector<std::size_t>{ height, width, 5 });
+	auto view = controlPoints.mutable_unchecked<3>();
+
+	if (!patchNode) return controlPoints;
+
+	// Read through the const interface, the non-const ctrlAt() marks the control points as exposed
+	const IPatch& patch = patchNode->getPatch();
+
+	for (std::size_t row = 0; row < height; ++row)
+	{
+		for (std::size_t col = 0; col < width; ++col)
+		{
+			const auto& ctrl = patch.ctrlAt(row, col);
+
+			view(row, col, 0) = ctrl.vertex.x();
+			view(row, col, 1) = ctrl.vertex.y();
+			view(row, col, 2) = ctrl.vertex.z();
+			view(row, col, 3) = ctrl.texcoord.x();
+			view(row, col, 4) = ctrl.texcoord.y();
+		}
+	}
+
+	return controlPoints;
+}
+
+void ScriptPatchNode::setControlPoints(const py::array_t<double>& controlPoints)
+{
+	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(_node.lock());
+	if (patchNode == NULL) return;
+
+	IPatch& patch = patchNode->getPatch();
+
+	if (controlPoints.ndim() != 3 || static_cast<std::size_t>(controlPoints.shape(0)) != patch.getHeight() ||
+		static_cast<std::size_t>(controlPoints.shape(1)) != patch.getWidth() || controlPoints.shape(2) != 5)
+	{
+		throw py::value_error("setControlPoints: expected an array of shape (" + std::to_string(patch.getHeight()) +
+			", " + std::to_string(patch.getWidth()) + ", 5)");
+	}
+
+	UndoableCommand cmd("setPatchControlPoints");
+
+	patch.undoSave();
+
+	auto view = controlPoints.unchecked<3>();
+
+	for (std::size_t row = 0; row < patch.getHeight(); ++row)
+	{
+		for (std::size_t col = 0; col < patch.getWidth(); ++col)
+		{
+			auto& ctrl = patch.ctrlAt(row, col);
+
+			ctrl.vertex = Vector3(view(row, col, 0), view(row, col, 1), view(row, col, 2));
+			ctrl.texcoord = Vector2(view(row, col, 3), view(row, col, 4));
+		}
+	}
+
+	// Update the tesselation once after all points have been assigned
+	patch.controlPointsChanged();
+}
+
 const std::string& ScriptPatchNode::getShader() const
 {
 	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(_node.lock());
@@ -265,6 +332,8 @@ void PatchInterface::registerInterface(py::module& scope, py::dict& globals)
 	patchNode.def("getSubdivisions", &ScriptPatchNode::getSubdivisions);
 	patchNode.def("setFixedSubdivisions", &ScriptPatchNode::setFixedSubdivisions);
 	patchNode.def("controlPointsChanged", &ScriptPatchNode::controlPointsChanged);
+	patchNode.def("getControlPoints", &ScriptPatchNode::getControlPoints);
+	patchNode.def("setControlPoints", &ScriptPatchNode::setControlPoints);
 	patchNode.def("getTesselatedPatchMesh", &ScriptPatchNode::getTesselatedPatchMesh);
 
 	// Define the GlobalPatchCreator interface
@@ -4,6 +4,7 @@
 #include "iscriptinterface.h"
 #include "ipatch.h"
 
+#include <pybind11/numpy.h>
 #include "SceneGraphInterface.h"
 
 namespace script
@@ -51,6 +52,13 @@ public:
 
 	void controlPointsChanged();
 
+	// Returns all control points as HxWx5 array, each entry holding (x, y, z, s, t)
+	py::array_t<double> getControlPoints() const;
+
+	// Assigns all control points from the given HxWx5 array as a single undoable operation.
+	// The array dimensions must match the patch dimensions, raises a ValueError otherwise.
+	void setControlPoints(const py::array_t<double>& controlPoints);
+
 	// Shader handling
 	const std::string& getShader() const;
 	void setShader(const std::string& name);
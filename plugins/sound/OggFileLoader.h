@@ -1,25 +1,23 @@
 #pragma once
 
 #include <vector>
-
-#ifdef __APPLE__
-#include <OpenAL/al.h>
-#else
-#include <AL/al.h>
-#endif
+#include <cstdint>
+#include <stdexcept>
 
 #include <vorbis/vorbisfile.h>
 #include <fmt/format.h>
 
 #include "iarchive.h"
 #include "stream/ScopedArchiveBuffer.h"
+#include "itextstream.h"
 #include "OggFileStream.h"
+#include "isound.h"
 
 namespace sound
 {
 
 /**
- * greebo: Loader class creating an AL buffer from an OGG file.
+ * greebo: Loader class providing streamed access to the samples of an OGG file.
  */
 class OggFileLoader
 {
@@ -63,77 +61,196 @@ private:
             ov_clear(&_oggFile);
         }
     };
+
+    // Decodes the OGG file chunk by chunk, only the encoded data is held in memory
+    class Stream :
+        public ISoundStream
+    {
+    private:
+        FileWrapper _file;
+        vorbis_info* _info;
+
+    public:
+        Stream(ArchiveFile& file) :
+            _file(file),
+            _info(ov_info(_file.getHandle(), -1))
+        {}
+
+        unsigned int getNumChannels() const override
+        {
+            return _info->channels == 1 ? 1 : 2;
+        }
+
+        unsigned int getBitsPerSample() const override
+        {
+            return 16;
+        }
+
+        unsigned int getSampleRate() const override
+        {
+            return static_cast<unsigned int>(_info->rate);
+        }
+
+        std::size_t read(char* buffer, std::size_t size) override
+        {
+            std::size_t bytesRead = 0;
+
+            while (bytesRead < size)
+            {
+                int bitStream;
+                auto bytes = ov_read(_file.getHandle(), buffer + bytesRead, static_cast<int>(size - bytesRead), 0, 2, 1, &bitStream);
+
+                if (bytes == OV_HOLE)
+                {
+                    // Interruption in the data, keep decoding
+                    rError() << "Error decoding OGG: OV_HOLE.\n";
+                    continue;
+                }
+
+                if (bytes < 0)
+                {
+                    rError() << "Error decoding OGG: " << bytes << ".\n";
+                    break;
+                }
+
+                if (bytes == 0) break; // end of stream
+
+                bytesRead += static_cast<std::size_t>(bytes);
+            }
+
+            return bytesRead;
+        }
+
+        bool rewind() override
+        {
+            return ov_pcm_seek(_file.getHandle(), 0) == 0;
+        }
+    };
+
+    // Ogg page header size without the segment table
+    static constexpr std::size_t PageHeaderSize = 27;
+
 public:
     /**
      * greebo: Determines the OGG file length in seconds.
+     * This is walking over the page headers of the file without decoding any audio data,
+     * the length is derived from the granule position (the sample count) of the last page.
      * @throws: std::runtime_error if an error occurs.
      */
     static float GetDuration(ArchiveFile& vfsFile)
     {
-        FileWrapper file(vfsFile);
+        auto& stream = vfsFile.getInputStream();
 
-        return static_cast<float>(ov_time_total(file.getHandle(), -1));
-    }
-
-    /**
-     * greebo: Loads an OGG file from the given stream into OpenAL,
-     * returns the openAL buffer handle.
-     *
-     * @throws: std::runtime_error if an error occurs.
-     */
-    static ALuint LoadFromFile(ArchiveFile& vfsFile)
-    {
-        FileWrapper file(vfsFile);
+        std::vector<unsigned char> pageBody(255 * 255);
+        unsigned char header[PageHeaderSize];
+        unsigned char segments[255];
 
-        // Get some information about the OGG file
-        vorbis_info* vorbisInfo = ov_info(file.getHandle(), -1);
+        bool firstPage = true;
+        unsigned int serialNumber = 0;
+        unsigned int sampleRate = 0;
+        int64_t lastGranulePosition = -1;
 
-        // Check the number of channels
-        ALenum format = (vorbisInfo->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+        while (ReadBytes(stream, header, PageHeaderSize))
+        {
+            if (header[0] != 'O' || header[1] != 'g' || header[2] != 'g' || header[3] != 'S')
+            {
+                throw std::runtime_error("Invalid OGG page header");
+            }
 
-        // Get the sample Rate
-        ALsizei freq = static_cast<ALsizei>(vorbisInfo->rate);
+            auto numSegments = header[26];
 
-        long bytes;
-        char smallBuffer[4096];
+            if (!ReadBytes(stream, segments, numSegments))
+            {
+                throw std::runtime_error("Unexpected end of OGG file");
+            }
 
-        std::vector<char> largeBuffer;
-        largeBuffer.reserve(vfsFile.size() * 2);
+            std::size_t bodySize = 0;
 
-        do
-        {
-            int bitStream;
-            // Read a chunk of decoded data from the vorbis file
-            bytes = ov_read(file.getHandle(), smallBuffer, sizeof(smallBuffer), 0, 2, 1, &bitStream);
+            for (std::size_t i = 0; i < numSegments; ++i)
+            {
+                bodySize += segments[i];
+            }
 
-            if (bytes == OV_HOLE)
+            if (!ReadBytes(stream, pageBody.data(), bodySize))
             {
-                rError() << "Error decoding OGG: OV_HOLE.\n";
+                break; // truncated file, use what we have so far
             }
-            else if (bytes == OV_EBADLINK)
+
+            auto serial = static_cast<unsigned int>(ReadLittleEndian(header + 14, 4));
+
+            if (firstPage)
             {
-                rError() << "Error decoding OGG: OV_EBADLINK.\n";
+                firstPage = false;
+                serialNumber = serial;
+
+                // The first page holds the vorbis identification header
+                // packet type (1), "vorbis" (6), version (4), channels (1), sample rate (4)
+                if (bodySize < 16 || pageBody[0] != 1 || std::string(pageBody.begin() + 1, pageBody.begin() + 7) != "vorbis")
+                {
+                    throw std::runtime_error("No vorbis identification header found");
+                }
+
+                sampleRate = static_cast<unsigned int>(ReadLittleEndian(pageBody.data() + 12, 4));
+                continue;
             }
-            else
+
+            // A granule position of -1 means that no packet is finished on this page
+            auto granulePosition = static_cast<int64_t>(ReadLittleEndian(header + 6, 8));
+
+            if (serial == serialNumber && granulePosition != -1)
             {
-                // Stuff this into the variable-sized buffer
-                largeBuffer.insert(largeBuffer.end(), smallBuffer, smallBuffer + bytes);
+                lastGranulePosition = granulePosition;
             }
-        } 
-        while (bytes > 0);
+        }
+
+        if (sampleRate == 0 || lastGranulePosition < 0)
+        {
+            throw std::runtime_error("Could not determine OGG file length");
+        }
 
-        ALuint bufferNum = 0;
-        // Allocate a new buffer
-        alGenBuffers(1, &bufferNum);
+        return static_cast<float>(lastGranulePosition) / sampleRate;
+    }
 
-        // Upload sound data to buffer
-        alBufferData(bufferNum,
-            format,
-            largeBuffer.data(),
-            static_cast<ALsizei>(largeBuffer.size()),
-            freq);
+    /**
+     * Opens a stream decoding the given OGG file in chunks.
+     * The encoded file contents are read into memory right away,
+     * the file object is not referenced after this call returns.
+     *
+     * @throws: std::runtime_error if an error occurs.
+     */
+    static ISoundStream::Ptr OpenStream(ArchiveFile& vfsFile)
+    {
+        return std::make_unique<Stream>(vfsFile);
+    }
+
+private:
+    // Reads exactly <length> bytes, returns false if the stream ended before
+    static bool ReadBytes(InputStream& stream, unsigned char* buffer, std::size_t length)
+    {
+        std::size_t totalRead = 0;
+
+        while (totalRead < length)
+        {
+            auto bytesRead = stream.read(buffer + totalRead, length - totalRead);
+
+            if (bytesRead == 0) return false;
+
+            totalRead += bytesRead;
+        }
+
+        return true;
+    }
+
+    static uint64_t ReadLittleEndian(const unsigned char* bytes, std::size_t numBytes)
+    {
+        uint64_t value = 0;
+
+        for (std::size_t i = numBytes; i > 0; --i)
+        {
+            value = (value << 8) | bytes[i - 1];
+        }
 
-        return bufferNum;
+        return value;
     }
 };
 
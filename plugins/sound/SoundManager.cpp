@@ -75,15 +75,24 @@ bool SoundManager::playSound(const std::string& fileName)
 
 bool SoundManager::playSound(const std::string& fileName, bool loopSound)
 {
-    auto file = openSoundFile(fileName);
+    if (!_soundPlayer) return false;
 
-	if (file && _soundPlayer)
-	{
-		_soundPlayer->play(*file, loopSound);
-		return true;
-	}
+    try
+    {
+        // Looped WAV files need to be rewindable
+        _soundPlayer->play(openSoundStream(fileName, loopSound), loopSound);
+    }
+    catch (const std::out_of_range&)
+    {
+        return false;
+    }
+    catch (const std::runtime_error& ex)
+    {
+        rError() << "SoundManager: Error opening " << fileName << ": " << ex.what() << std::endl;
+        return false;
+    }
 
-    return false;
+    return true;
 }
 
 void SoundManager::stopSound()
@@ -176,6 +185,24 @@ float SoundManager::getSoundFileDuration(const std::string& vfsPath)
     return 0.0f;
 }
 
+ISoundStream::Ptr SoundManager::openSoundStream(const std::string& vfsPath, bool rewindable)
+{
+    auto file = openSoundFile(vfsPath);
+
+    if (!file)
+    {
+        throw std::out_of_range("Could not resolve sound file " + vfsPath);
+    }
+
+    if (string::to_lower_copy(os::getExtension(file->getName())) == "ogg")
+    {
+        return OggFileLoader::OpenStream(*file);
+    }
+
+    // Must be a wave file
+    return WavFileLoader::OpenStream(file, rewindable);
+}
+
 void SoundManager::reloadSounds()
 {
     GlobalDeclarationManager().reloadDeclarations();
@@ -32,6 +32,7 @@ public:
 	void stopSound() override;
     void reloadSounds() override;
     float getSoundFileDuration(const std::string& vfsPath) override;
+    ISoundStream::Ptr openSoundStream(const std::string& vfsPath, bool rewindable) override;
 
 	// RegisterableModule implementation
 	const std::string& getName() const override;
@@ -1,8 +1,9 @@
 #include "SoundPlayer.h"
 
-#include <vorbis/vorbisfile.h>
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include "itextstream.h"
 #include "string/case_conv.h"
 
 #include "os/path.h"
@@ -17,19 +18,91 @@
 #include <unistd.h>
 #endif
 
-#include "WavFileLoader.h"
-#include "OggFileLoader.h"
-
 namespace sound
 {
 
+namespace
+{
+	// Interval at which the streaming thread checks for processed buffers
+	constexpr std::chrono::milliseconds STREAMING_INTERVAL(50);
+
+	ALenum getAlFormat(const ISoundStream& stream)
+	{
+		if (stream.getNumChannels() == 1)
+		{
+			return stream.getBitsPerSample() == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+		}
+
+		return stream.getBitsPerSample() == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+	}
+
+	// Streaming source operations on an OpenAL source
+	class OpenALStreamingSource :
+		public IStreamingSource
+	{
+	private:
+		ALuint _source;
+
+	public:
+		OpenALStreamingSource(ALuint source) :
+			_source(source)
+		{}
+
+		void setBufferData(unsigned int buffer, int format, const char* data,
+			std::size_t size, unsigned int sampleRate) override
+		{
+			alBufferData(buffer, format, data, static_cast<ALsizei>(size), static_cast<ALsizei>(sampleRate));
+		}
+
+		void queueBuffer(unsigned int buffer) override
+		{
+			ALuint name = buffer;
+			alSourceQueueBuffers(_source, 1, &name);
+		}
+
+		unsigned int unqueueProcessedBuffer() override
+		{
+			ALuint buffer = 0;
+			alSourceUnqueueBuffers(_source, 1, &buffer);
+			return buffer;
+		}
+
+		std::size_t getNumProcessedBuffers() override
+		{
+			ALint processed = 0;
+			alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+			return processed > 0 ? static_cast<std::size_t>(processed) : 0;
+		}
+
+		std::size_t getNumQueuedBuffers() override
+		{
+			ALint queued = 0;
+			alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+			return queued > 0 ? static_cast<std::size_t>(queued) : 0;
+		}
+
+		bool isPlaying() override
+		{
+			ALint state = 0;
+			alGetSourcei(_source, AL_SOURCE_STATE, &state);
+			return state == AL_PLAYING;
+		}
+
+		void play() override
+		{
+			alSourcePlay(_source);
+		}
+	};
+}
+
 // Constructor
 SoundPlayer::SoundPlayer() :
 	_initialised(false),
 	_context(NULL),
-	_buffer(0),
 	_source(0)
 {
+	_buffers.fill(0);
+
 	// Disable the timer, to make sure
 	_timer.Connect(wxEVT_TIMER, wxTimerEventHandler(SoundPlayer::onTimerIntervalReached), NULL, this);
 	_timer.Stop();
@@ -93,38 +166,35 @@ SoundPlayer::~SoundPlayer() {
 
 void SoundPlayer::onTimerIntervalReached(wxTimerEvent& ev)
 {
-	// Check for active source and buffer
-	if (_source != 0 && _buffer != 0)
+	// Once the streaming thread played all data, the source and buffers can go
+	if (_streamer && _streamer->isFinished())
 	{
-		ALint state;
-		// Query the state of the source
-		alGetSourcei(_source, AL_SOURCE_STATE, &state);
-
-		if (state == AL_STOPPED)
-		{
-			// Erase the buffer
-			clearBuffer();
-
-			// Disable the timer to stop calling this function
-			_timer.Stop();
-		}
+		// This disables the timer too
+		clearBuffer();
 	}
 }
 
 void SoundPlayer::clearBuffer()
 {
-	// Check if there is an active buffer
-	if (_source != 0) {
-		// Stop playing
+	// Stop refilling the buffers first, this also releases the stream
+	_streamer.reset();
+	_streamingSource.reset();
+
+	// Check if there is an active source
+	if (_source != 0)
+	{
+		// Stop playing and detach the queued buffers
 		alSourceStop(_source);
+		alSourcei(_source, AL_BUFFER, 0);
 		alDeleteSources(1, &_source);
 		_source = 0;
+	}
 
-		if (_buffer != 0) {
-			// Free the buffer
-			alDeleteBuffers(1, &_buffer);
-			_buffer = 0;
-		}
+	if (_buffers.front() != 0)
+	{
+		// Free the buffers
+		alDeleteBuffers(static_cast<ALsizei>(_buffers.size()), _buffers.data());
+		_buffers.fill(0);
 	}
 
 	_timer.Stop();
@@ -135,79 +205,45 @@ void SoundPlayer::stop()
 	clearBuffer();
 }
 
-void SoundPlayer::play(ArchiveFile& file, bool loopSound) 
+void SoundPlayer::play(ISoundStream::Ptr stream, bool loopSound)
 {
 	// If we're not initialised yet, do it now
 	if (!_initialised) 
 	{
 		initialise();
-    }
+	}
 
 	// Stop any previous playback operations, that might be still active
 	clearBuffer();
 
-	// Retrieve the extension
-	std::string ext = os::getExtension(file.getName());
-
-	if (string::to_lower_copy(ext) == "ogg")
-	{
-		createBufferDataFromOgg(file);
-	}
-	else 
-	{
-		createBufferDataFromWav(file);
-	}
+	if (_context == NULL) return;
 
-	if (_buffer != 0) 
-	{
-		alGenSources(1, &_source);
+	alGenBuffers(static_cast<ALsizei>(_buffers.size()), _buffers.data());
+	alGenSources(1, &_source);
 
-		// Assign the buffer to the source and play it
-		alSourcei(_source, AL_BUFFER, _buffer);
+	_streamingSource = std::make_unique<OpenALStreamingSource>(_source);
 
-		// Set the looping flag
-		alSourcei(_source, AL_LOOPING, loopSound ? AL_TRUE : AL_FALSE);
+	auto format = getAlFormat(*stream);
+	_streamer = std::make_unique<SoundStreamer>(*_streamingSource, std::move(stream), format, loopSound, _buffers);
 
-		// greebo: Wait 10 msec. to fix a problem with buffers not being played
-		// maybe the AL needs time to push the data?
-		usleep(10000);
+	// Fill the initial buffers right here, the rest is decoded while playing
+	if (!_streamer->queueInitialBuffers())
+	{
+		clearBuffer();
+		return;
+	}
 
-		alSourcePlay(_source);
+	// greebo: Wait 10 msec. to fix a problem with buffers not being played
+	// maybe the AL needs time to push the data?
+	usleep(10000);
 
-		// Enable the periodic buffer check, this destructs the buffer
-		// as soon as the playback has finished
-		_timer.Start(200);
-	}
-}
+	alSourcePlay(_source);
 
-void SoundPlayer::createBufferDataFromWav(ArchiveFile& file)
-{
-	// Must be a wave file
-	try
-	{
-		// Create an AL sound buffer directly from the buffer in memory
-		_buffer = WavFileLoader::LoadFromStream(file.getInputStream());
-	}
-	catch (std::runtime_error& e)
-	{
-		rError() << "SoundPlayer: Error opening WAV file: " << e.what() << std::endl;
-		_buffer = 0;
-	}
-}
+	_streamer->start(STREAMING_INTERVAL);
 
-void SoundPlayer::createBufferDataFromOgg(ArchiveFile& file)
-{
-    // Must be an OGG file
-    try
-    {
-        // Create an AL sound buffer directly from the buffer in memory
-        _buffer = OggFileLoader::LoadFromFile(file);
-    }
-    catch (std::runtime_error & e)
-    {
-        rError() << "SoundPlayer: Error opening OGG file: " << e.what() << std::endl;
-        _buffer = 0;
-    }
+	// Enable the periodic check, this destructs the buffers
+	// as soon as the playback has finished
+	_timer.Start(200);
 }
 
 } // namespace sound
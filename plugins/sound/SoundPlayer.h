@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 
 #ifdef __APPLE__
 #include <OpenAL/al.h>
@@ -12,7 +13,8 @@
 
 #include <wx/timer.h>
 
-class ArchiveFile;
+#include "isound.h"
+#include "SoundStreamer.h"
 
 namespace sound {
 
@@ -25,14 +27,21 @@ protected:
 
 	ALCcontext* _context;
 
-	// The buffer containing the currently played audio data
-	ALuint _buffer;
+	// The ring of buffers queued on the source, these are refilled
+	// with the next chunk of audio data once the source processed them
+	SoundStreamer::Buffers _buffers;
 
-	// The source playing the buffer
+	// The source playing the buffers
 	ALuint _source;
 
+	// Passes the buffer operations of the streamer to the source
+	std::unique_ptr<IStreamingSource> _streamingSource;
+
+	// Decodes the currently played sound data on a worker thread
+	std::unique_ptr<SoundStreamer> _streamer;
+
 	// The timer object to check whether the sound is done playing
-	// to destroy the buffer afterwards
+	// to destroy the buffers afterwards
 	wxTimer _timer;
 
 public:
@@ -44,10 +53,11 @@ public:
 	 */
 	virtual ~SoundPlayer();
 
-	/** greebo: Call this with the ArchiveFile object containing
-	 * 			the file to be played.
+	/** greebo: Call this with the stream of the sound file to be played.
+	 * 			The stream is decoded in chunks while playing, starting
+	 *			playback right away. Looped streams need to be rewindable.
 	 */
-	virtual void play(ArchiveFile& file, bool loopSound);
+	virtual void play(ISoundStream::Ptr stream, bool loopSound);
 
 	/** greebo: Stops the playback immediately.
 	 */
@@ -57,14 +67,11 @@ protected:
 	// Initialises the AL context
 	void initialise();
 
-	// Clears the buffer, stops playing
+	// Clears the buffers, stops playing
 	void clearBuffer();
 
-	// This is called periodically to check whether the buffer can be cleared
+	// This is called periodically to check whether the buffers can be cleared
 	void onTimerIntervalReached(wxTimerEvent& ev);
-
-	void createBufferDataFromOgg(ArchiveFile& file);
-	void createBufferDataFromWav(ArchiveFile& file);
 };
 
 } // namespace sound
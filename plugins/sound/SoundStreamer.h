@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#include "isound.h"
+
+namespace sound
+{
+
+/**
+ * The operations on an audio source needed to stream sound data through
+ * a ring of queued buffers. The SoundPlayer implements this on top of an
+ * OpenAL source, buffer names and formats are the ones of OpenAL.
+ */
+class IStreamingSource
+{
+public:
+	virtual ~IStreamingSource() {}
+
+	// Uploads the given samples to the buffer
+	virtual void setBufferData(unsigned int buffer, int format, const char* data,
+		std::size_t size, unsigned int sampleRate) = 0;
+
+	// Appends the buffer to the queue of the source
+	virtual void queueBuffer(unsigned int buffer) = 0;
+
+	// Removes the oldest processed buffer from the queue and returns it
+	virtual unsigned int unqueueProcessedBuffer() = 0;
+
+	// Number of queued buffers the source has finished playing
+	virtual std::size_t getNumProcessedBuffers() = 0;
+
+	// Number of buffers in the queue, including the processed ones
+	virtual std::size_t getNumQueuedBuffers() = 0;
+
+	virtual bool isPlaying() = 0;
+	virtual void play() = 0;
+};
+
+/**
+ * Streams the samples of an ISoundStream through a ring of buffers queued
+ * on a source. The initial buffers are filled right away, after that a worker
+ * thread refills each buffer the source has processed with the next chunk
+ * and queues it again, until the stream is exhausted. Looping streams are
+ * rewound when reaching their end.
+ */
+class SoundStreamer
+{
+public:
+	static constexpr std::size_t NumBuffers = 4;
+
+	// Size of each of the queued buffers, in bytes
+	static constexpr std::size_t DefaultBufferSize = 32768;
+
+	using Buffers = std::array<unsigned int, NumBuffers>;
+
+private:
+	IStreamingSource& _source;
+	ISoundStream::Ptr _stream;
+	int _format;
+	bool _loop;
+	Buffers _buffers;
+
+	// Scratch memory holding the samples of the buffer being filled
+	std::vector<char> _sampleBuffer;
+
+	std::thread _worker;
+	std::mutex _lock;
+	std::condition_variable _stopSignal;
+	bool _stopRequested;
+
+	// Set once the stream has been played completely
+	std::atomic<bool> _finished;
+
+public:
+	SoundStreamer(IStreamingSource& source, ISoundStream::Ptr stream, int format, bool loop,
+		const Buffers& buffers, std::size_t bufferSize = DefaultBufferSize) :
+		_source(source),
+		_stream(std::move(stream)),
+		_format(format),
+		_loop(loop),
+		_buffers(buffers),
+		_sampleBuffer(bufferSize),
+		_stopRequested(false),
+		_finished(false)
+	{}
+
+	~SoundStreamer()
+	{
+		stop();
+	}
+
+	// Fills and queues as many of the buffers as there is data for,
+	// returns false if the stream doesn't provide any data
+	bool queueInitialBuffers()
+	{
+		std::size_t numBuffers = 0;
+
+		for (; numBuffers < _buffers.size() && fillBuffer(_buffers[numBuffers]); ++numBuffers)
+		{
+			_source.queueBuffer(_buffers[numBuffers]);
+		}
+
+		return numBuffers > 0;
+	}
+
+	// Starts the worker thread, checking for processed buffers in the given interval
+	void start(std::chrono::milliseconds interval)
+	{
+		_stopRequested = false;
+		_finished = false;
+		_worker = std::thread(&SoundStreamer::run, this, interval);
+	}
+
+	// Stops the worker thread, blocks until it has left
+	void stop()
+	{
+		if (!_worker.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_stopRequested = true;
+		}
+
+		_stopSignal.notify_one();
+		_worker.join();
+	}
+
+	// True if all data of the stream has been played
+	bool isFinished() const
+	{
+		return _finished;
+	}
+
+	// Refills and requeues the buffers processed by the source, resuming playback
+	// if the source ran out of data in the meantime. Returns false once there are
+	// no buffers left in the queue, i.e. when the stream has been played completely.
+	bool update()
+	{
+		for (auto processed = _source.getNumProcessedBuffers(); processed > 0; --processed)
+		{
+			auto buffer = _source.unqueueProcessedBuffer();
+
+			// Buffers are only requeued as long as there is data left
+			if (fillBuffer(buffer))
+			{
+				_source.queueBuffer(buffer);
+			}
+		}
+
+		if (_source.getNumQueuedBuffers() == 0)
+		{
+			return false;
+		}
+
+		// The source stops if it runs out of queued data, resume after refilling
+		if (!_source.isPlaying())
+		{
+			_source.play();
+		}
+
+		return true;
+	}
+
+private:
+	void run(std::chrono::milliseconds interval)
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				if (_stopSignal.wait_for(lock, interval, [this] { return _stopRequested; }))
+				{
+					return;
+				}
+			}
+
+			if (!update())
+			{
+				_finished = true;
+				return;
+			}
+		}
+	}
+
+	// Decodes the next chunk of the stream into the given buffer,
+	// returns false if the stream has no more data
+	bool fillBuffer(unsigned int buffer)
+	{
+		std::size_t bytesRead = 0;
+		bool rewound = false;
+
+		while (bytesRead < _sampleBuffer.size())
+		{
+			auto bytes = _stream->read(_sampleBuffer.data() + bytesRead, _sampleBuffer.size() - bytesRead);
+
+			if (bytes == 0)
+			{
+				// Start over when looping, but don't spin on streams without any data
+				if (!_loop || rewound || !_stream->rewind()) break;
+
+				rewound = true;
+				continue;
+			}
+
+			rewound = false;
+			bytesRead += bytes;
+		}
+
+		// Only pass complete sample frames to the buffer
+		auto frameSize = _stream->getNumChannels() * (_stream->getBitsPerSample() / 8);
+		bytesRead -= bytesRead % frameSize;
+
+		if (bytesRead == 0) return false;
+
+		_source.setBufferData(buffer, _format, _sampleBuffer.data(), bytesRead, _stream->getSampleRate());
+
+		return true;
+	}
+};
+
+}
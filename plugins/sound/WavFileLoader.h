@@ -1,20 +1,17 @@
 #pragma once
 
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
 #include "idatastream.h"
+#include "iarchive.h"
 
-#ifdef __APPLE__
-#include <OpenAL/al.h>
-#else
-#include <AL/al.h>
-#endif
-
-class InputStream;
+#include "isound.h"
 
 namespace sound {
 
 /**
- * greebo: Loader class creating an AL buffer from a WAV file.
+ * greebo: Loader class providing streamed access to the samples of a WAV file.
  *
  * Modeled after the one used by the Ogre3D people, found it posted
  * somewhere on the net.
@@ -38,21 +35,129 @@ private:
             fileFormat[4] = '\0';
             audioFormat = 0;
         }
+    };
+
+    typedef StreamBase::byte_type byte;
 
-        ALenum getAlFormat() const
+    // Reads the payload of the data chunk sequentially from the file
+    class Stream :
+        public ISoundStream
+    {
+    private:
+        ArchiveFilePtr _file;
+        FileInfo _info;
+
+        std::size_t _dataSize;
+        std::size_t _position;
+
+        bool _rewindable;
+        bool _replaying;
+        std::vector<byte> _data;
+
+    public:
+        Stream(const ArchiveFilePtr& file, bool rewindable) :
+            _file(file),
+            _dataSize(0),
+            _position(0),
+            _rewindable(rewindable),
+            _replaying(false)
         {
-            if (channels == 1)
+            auto& stream = _file->getInputStream();
+
+            ParseFileInfo(stream, _info);
+            SkipToRemainingData(stream);
+
+            if (_info.bps != 8 && _info.bps != 16)
             {
-                return bps == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+                throw std::runtime_error("Unsupported number of bits per sample.");
             }
-            else
+
+            // The next four bytes are the remaining size of the file
+            unsigned int remainingSize = 0;
+            stream.read(reinterpret_cast<byte*>(&remainingSize), sizeof(remainingSize));
+
+            _dataSize = remainingSize;
+        }
+
+        unsigned int getNumChannels() const override
+        {
+            return _info.channels == 1 ? 1 : 2;
+        }
+
+        unsigned int getBitsPerSample() const override
+        {
+            return _info.bps;
+        }
+
+        unsigned int getSampleRate() const override
+        {
+            return _info.freq;
+        }
+
+        std::size_t read(char* buffer, std::size_t size) override
+        {
+            auto bytesToRead = std::min(size, _dataSize - _position);
+
+            if (_replaying)
             {
-                return  bps == 8 ? AL_FORMAT_STEREO16 : AL_FORMAT_STEREO16;
+                std::copy(_data.begin() + _position, _data.begin() + _position + bytesToRead, buffer);
+                _position += bytesToRead;
+
+                return bytesToRead;
             }
+
+            auto bytesRead = readFromFile(reinterpret_cast<byte*>(buffer), bytesToRead);
+
+            if (_rewindable)
+            {
+                _data.insert(_data.end(), buffer, buffer + bytesRead);
+            }
+
+            return bytesRead;
         }
-    };
 
-    typedef StreamBase::byte_type byte;
+        bool rewind() override
+        {
+            if (!_rewindable) return false;
+
+            if (!_replaying)
+            {
+                // Retain the rest of the data before switching to the in-memory copy
+                std::vector<byte> remainder(_dataSize - _position);
+                remainder.resize(readFromFile(remainder.data(), remainder.size()));
+                _data.insert(_data.end(), remainder.begin(), remainder.end());
+
+                _replaying = true;
+            }
+
+            _position = 0;
+            return true;
+        }
+
+    private:
+        std::size_t readFromFile(byte* buffer, std::size_t size)
+        {
+            std::size_t bytesRead = 0;
+
+            while (bytesRead < size)
+            {
+                auto result = _file->getInputStream().read(buffer + bytesRead, size - bytesRead);
+
+                if (result == 0)
+                {
+                    // The file is shorter than announced in the header
+                    _dataSize = _position + bytesRead;
+                    break;
+                }
+
+                bytesRead += result;
+            }
+
+            _position += bytesRead;
+
+            return bytesRead;
+        }
+    };
 
 public:
     /**
@@ -77,33 +182,17 @@ public:
         return static_cast<float>(numSamplesPerChannel) / info.freq;
     }
 
-	/**
-	 * greebo: Loads a WAV file from a stream into OpenAL,
-     * returns the openAL buffer handle.
-	 *
-	 * @throws: std::runtime_error if an error occurs.
-	 */
-	static ALuint LoadFromStream(InputStream& stream)
+    /**
+     * Opens a stream reading the sample data of the given WAV file in chunks.
+     * If <rewindable> is true, the data read so far is retained in memory
+     * to be able to restart the stream once it reached its end.
+     *
+     * @throws: std::runtime_error if an error occurs.
+     */
+    static ISoundStream::Ptr OpenStream(const ArchiveFilePtr& file, bool rewindable)
     {
-        FileInfo info;
-        ParseFileInfo(stream, info);
-
-        SkipToRemainingData(stream);
-
-		// The next four bytes are the remaining size of the file
-		unsigned int remainingSize = 0;
-		stream.read(reinterpret_cast<byte*>(&remainingSize), sizeof(remainingSize));
-
-		ALuint bufferNum = 0;
-		alGenBuffers(1, &bufferNum);
-
-        std::vector<byte> data(remainingSize);
-        stream.read(data.data(), remainingSize);
-
-		alBufferData(bufferNum, info.getAlFormat(), data.data(), static_cast<ALsizei>(remainingSize), info.freq);
-
-		return bufferNum;
-	}
+        return std::make_unique<Stream>(file, rewindable);
+    }
 
 private:
     // Assuming that the FMT chunk has been parsed, this seeks forward to the 
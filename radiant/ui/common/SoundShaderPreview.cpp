@@ -236,7 +236,7 @@ void SoundShaderPreview::playSelectedFile(bool loop)
 		// Pass the call to the sound manager
 		if (!GlobalSoundManager().playSound(selectedFile, loop))
 		{
-			_statusLabel->SetLabel(_("Error: File not found."));
+			_statusLabel->SetLabel(_("Error: File not found or not playable."));
 		}
 	}
 }
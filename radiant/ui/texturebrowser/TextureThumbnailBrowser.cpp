@@ -32,6 +32,7 @@
 #include "debugging/gl.h"
 #include "ui/mediabrowser/FocusMaterialRequest.h"
 #include "TextureBrowserManager.h"
+#include "TextureThumbnailCache.h"
 
 namespace ui
 {
@@ -49,6 +50,9 @@ namespace
 
     constexpr int VIEWPORT_BORDER = 12;
     constexpr int TILE_BORDER = 2;
+
+    // Interval for checking whether the thumbnail read backs have finished
+    constexpr int READBACK_POLL_INTERVAL_MSEC = 50;
 }
 
 class TextureThumbnailBrowser::TextureTile
@@ -60,19 +64,24 @@ public:
     Vector2i position;
     MaterialPtr material;
 
+    // The cached thumbnail of this material, if there is one
+    std::string thumbnailKey;
+    std::optional<TextureThumbnailCache::Thumbnail> thumbnail;
+    TexturePtr thumbnailTexture;
+
     TextureTile(TextureThumbnailBrowser& owner) :
         _owner(owner)
     {}
 
     void render(bool drawName)
     {
-        TexturePtr texture = material->getEditorImage();
-        if (!texture) return;
-
         // Is this texture visible?
         if ((position.y() - size.y() - FONT_HEIGHT() < _owner.getOriginY()) &&
             (position.y() > _owner.getOriginY() - _owner.getViewportHeight()))
         {
+            auto texture = getTexture();
+            if (!texture) return;
+
             drawBorder();
             drawTextureQuad(texture->getGLTexNum());
             if (drawName)
@@ -81,6 +90,33 @@ public:
     }
 
 private:
+    TexturePtr getTexture()
+    {
+        constexpr auto maxSize = TextureThumbnailCache::MaxThumbnailSize;
+
+        // The thumbnail is good enough as long as it doesn't need to be magnified
+        if (thumbnail && (std::max(size.x(), size.y()) <= maxSize ||
+            std::max(thumbnail->sourceSize.x(), thumbnail->sourceSize.y()) <= maxSize))
+        {
+            if (!thumbnailTexture)
+            {
+                thumbnailTexture = GlobalMaterialManager().loadTextureFromFile(thumbnail->filePath);
+            }
+
+            return thumbnailTexture;
+        }
+
+        auto texture = material->getEditorImage();
+
+        // Store the thumbnail for the next time this material is shown
+        if (texture)
+        {
+            _owner._thumbnailCache->captureThumbnail(thumbnailKey, *texture);
+        }
+
+        return texture;
+    }
+
     void drawBorder()
     {
         // borders rules:
@@ -217,8 +253,12 @@ TextureThumbnailBrowser::TextureThumbnailBrowser(wxWindow* parent, bool showTool
     _useUniformScale(registry::getValue<bool>(RKEY_TEXTURE_USE_UNIFORM_SCALE)),
     _uniformTextureSize(registry::getValue<int>(RKEY_TEXTURE_UNIFORM_SIZE)),
     _maxNameLength(registry::getValue<int>(RKEY_TEXTURE_MAX_NAME_LENGTH)),
-    _updateNeeded(true)
+    _updateNeeded(true),
+    _thumbnailCache(std::make_unique<TextureThumbnailCache>()),
+    _readbackTimer(this)
 {
+    Bind(wxEVT_TIMER, &TextureThumbnailBrowser::onReadbackTimer, this);
+
     observeKey(RKEY_TEXTURE_UNIFORM_SIZE);
     observeKey(RKEY_TEXTURE_USE_UNIFORM_SCALE);
     observeKey(RKEY_TEXTURE_SCALE);
@@ -330,6 +370,18 @@ TextureThumbnailBrowser::TextureThumbnailBrowser(wxWindow* parent, bool showTool
     updateScroll();
 }
 
+TextureThumbnailBrowser::~TextureThumbnailBrowser()
+{
+    _readbackTimer.Stop();
+
+    // The pending read backs hold buffers and fences, which need to be
+    // deleted with our GL context being current
+    if (_wxGLWidget != nullptr && _thumbnailCache->hasPendingReadbacks() && _wxGLWidget->MakeCurrent())
+    {
+        _thumbnailCache->releasePendingReadbacks();
+    }
+}
+
 void TextureThumbnailBrowser::loadScaleFromRegistry()
 {
     int index = registry::getValue<int>(RKEY_TEXTURE_SCALE);
@@ -420,14 +472,14 @@ void TextureThumbnailBrowser::keyChanged()
 }
 
 // Return the display width of a texture in the texture browser
-int TextureThumbnailBrowser::getTextureWidth(const Texture& tex) const
+int TextureThumbnailBrowser::getTextureWidth(const Vector2i& textureSize) const
 {
     if (!_useUniformScale)
     {
         // Don't use uniform scale
-        return static_cast<int>(tex.getWidth() * (static_cast<float>(_textureScale) / 100));
+        return static_cast<int>(textureSize.x() * (static_cast<float>(_textureScale) / 100));
     }
-    else if (tex.getWidth() >= tex.getHeight())
+    else if (textureSize.x() >= textureSize.y())
     {
         // Texture is square, or wider than it is tall
         return _uniformTextureSize;
@@ -436,19 +488,19 @@ int TextureThumbnailBrowser::getTextureWidth(const Texture& tex) const
     {
         // Otherwise, preserve the texture's aspect ratio
         return static_cast<int>(_uniformTextureSize *
-            (static_cast<float>(tex.getWidth()) / tex.getHeight())
+            (static_cast<float>(textureSize.x()) / textureSize.y())
         );
     }
 }
 
-int TextureThumbnailBrowser::getTextureHeight(const Texture& tex) const
+int TextureThumbnailBrowser::getTextureHeight(const Vector2i& textureSize) const
 {
     if (!_useUniformScale)
     {
         // Don't use uniform scale
-        return static_cast<int>(tex.getHeight() * (static_cast<float>(_textureScale) / 100));
+        return static_cast<int>(textureSize.y() * (static_cast<float>(_textureScale) / 100));
     }
-    else if (tex.getHeight() >= tex.getWidth())
+    else if (textureSize.y() >= textureSize.x())
     {
         // Texture is square, or taller than it is wide
         return _uniformTextureSize;
@@ -458,7 +510,7 @@ int TextureThumbnailBrowser::getTextureHeight(const Texture& tex) const
         // Otherwise, preserve the texture's aspect ratio
         return static_cast<int>(
             _uniformTextureSize
-            * (static_cast<float>(tex.getHeight()) / tex.getWidth())
+            * (static_cast<float>(textureSize.y()) / textureSize.x())
         );
     }
 }
@@ -519,12 +571,12 @@ TextureThumbnailBrowser::CurrentPosition::CurrentPosition()
 : origin(VIEWPORT_BORDER, -VIEWPORT_BORDER), rowAdvance(0)
 { }
 
-Vector2i TextureThumbnailBrowser::getNextPositionForTexture(const Texture& tex)
+Vector2i TextureThumbnailBrowser::getNextPositionForTexture(const Vector2i& textureSize)
 {
     auto& currentPos = *_currentPopulationPosition;
 
-    int nWidth = getTextureWidth(tex);
-    int nHeight = getTextureHeight(tex);
+    int nWidth = getTextureWidth(textureSize);
+    int nHeight = getTextureHeight(textureSize);
 
     // Wrap to the next row if there is not enough horizontal space for this
     // texture
@@ -605,12 +657,25 @@ void TextureThumbnailBrowser::createTileForMaterial(const MaterialPtr& material)
     auto& tile = *_tiles.back();
 
     tile.material = material;
+    tile.thumbnailKey = _thumbnailCache->getThumbnailKey(*material);
+    tile.thumbnail = _thumbnailCache->findThumbnail(tile.thumbnailKey);
 
-    Texture& texture = *tile.material->getEditorImage();
+    Vector2i textureSize;
 
-    tile.position = getNextPositionForTexture(texture);
-    tile.size.x() = getTextureWidth(texture);
-    tile.size.y() = getTextureHeight(texture);
+    // With a cached thumbnail the editor image doesn't need to be loaded
+    if (tile.thumbnail)
+    {
+        textureSize = tile.thumbnail->sourceSize;
+    }
+    else
+    {
+        auto texture = tile.material->getEditorImage();
+        textureSize = Vector2i(static_cast<int>(texture->getWidth()), static_cast<int>(texture->getHeight()));
+    }
+
+    tile.position = getNextPositionForTexture(textureSize);
+    tile.size.x() = getTextureWidth(textureSize);
+    tile.size.y() = getTextureHeight(textureSize);
 
     _entireSpaceHeight = std::max(
         _entireSpaceHeight,
@@ -954,9 +1019,23 @@ bool TextureThumbnailBrowser::onRender()
 
     draw();
 
+    // Pick up the thumbnails read back during the previous frames,
+    // come back later for the ones the GPU is still working on
+    _thumbnailCache->processPendingReadbacks();
+
+    if (_thumbnailCache->hasPendingReadbacks() && !_readbackTimer.IsRunning())
+    {
+        _readbackTimer.StartOnce(READBACK_POLL_INTERVAL_MSEC);
+    }
+
     debug::assertNoGlErrors();
 
     return true;
 }
 
+void TextureThumbnailBrowser::onReadbackTimer(wxTimerEvent& ev)
+{
+    queueDraw();
+}
+
 } // namespace
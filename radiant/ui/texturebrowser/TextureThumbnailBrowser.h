@@ -10,6 +10,7 @@
 #include "wxutil/event/SingleIdleCallback.h"
 
 #include <optional>
+#include <wx/timer.h>
 
 namespace wxutil
 {
@@ -24,6 +25,8 @@ class wxToolBar;
 namespace ui
 {
 
+class TextureThumbnailCache;
+
 /**
  * \brief Widget for rendering textures thumbnails as tiles in a scrollable
  * container.
@@ -115,8 +118,14 @@ class TextureThumbnailBrowser :
     };
     std::unique_ptr<CurrentPosition> _currentPopulationPosition;
 
+    std::unique_ptr<TextureThumbnailCache> _thumbnailCache;
+
+    // Triggers another redraw while thumbnail read backs are in progress
+    wxTimer _readbackTimer;
+
 public:
     TextureThumbnailBrowser(wxWindow* parent, bool showToolbar = true);
+    ~TextureThumbnailBrowser() override;
 
     // Schedules an update of the renderable items
     void queueUpdate();
@@ -160,13 +169,13 @@ private:
     // Repopulates the texture tiles
     void refreshTiles();
 
-    // Return the display width/height of a texture in the texture browser
-    int getTextureWidth(const Texture& tex) const;
-    int getTextureHeight(const Texture& tex) const;
+    // Return the display width/height of a texture of the given size in the texture browser
+    int getTextureWidth(const Vector2i& textureSize) const;
+    int getTextureHeight(const Vector2i& textureSize) const;
 
-    // Get a new position for the given texture, and advance the CurrentPosition
+    // Get a new position for a texture of the given size, and advance the CurrentPosition
     // state object.
-    Vector2i getNextPositionForTexture(const Texture& texture);
+    Vector2i getNextPositionForTexture(const Vector2i& textureSize);
 
     bool checkSeekInMediaBrowser(); // sensitivity check
     void onSeekInMediaBrowser();
@@ -223,6 +232,7 @@ private:
 
 	// wx callbacks
 	bool onRender();
+	void onReadbackTimer(wxTimerEvent& ev);
 	void onScrollChanged(wxScrollEvent& ev);
 	void onGLResize(wxSizeEvent& ev);
 	void onGLMouseScroll(wxMouseEvent& ev);
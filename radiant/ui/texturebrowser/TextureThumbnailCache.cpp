@@ -0,0 +1,285 @@
+#include "TextureThumbnailCache.h"
+
+#include <algorithm>
+#include "igl.h"
+#include "igame.h"
+#include "ideclmanager.h"
+#include "ifilesystem.h"
+#include "ishaderlayer.h"
+
+#include "os/path.h"
+#include "math/Hash.h"
+#include "render/ThumbnailFilename.h"
+#include "string/case_conv.h"
+
+namespace ui
+{
+
+namespace
+{
+    // Registry key holding texture types
+    constexpr const char* const GKEY_IMAGE_TYPES = "/filetypes/texture//extension";
+}
+
+TextureThumbnailCache::TextureThumbnailCache() :
+    _store(std::string(), MaxThumbnailSize),
+    _materialsReloaded(false)
+{
+    for (const auto& node : GlobalGameManager().currentGame()->getLocalXPath(GKEY_IMAGE_TYPES))
+    {
+        _imageExtensions.emplace_back(string::to_lower_copy(node.getContent()));
+    }
+
+    // The declaration files might have changed on disk, the keys are evaluated again
+    _materialsReloadedConn = GlobalDeclarationManager().signal_DeclsReloaded(decl::Type::Material).connect(
+        [this]() { _materialsReloaded = true; });
+}
+
+TextureThumbnailCache::~TextureThumbnailCache()
+{
+    _materialsReloadedConn.disconnect();
+    clearMaterialKeys();
+
+    // No GL calls here, there's no guarantee for a current context. The owner
+    // is releasing the pending read backs, the objects of any remaining ones
+    // are deleted along with the context.
+}
+
+std::string TextureThumbnailCache::getThumbnailKey(Material& material)
+{
+    if (_materialsReloaded.exchange(false))
+    {
+        clearMaterialKeys();
+    }
+
+    auto existing = _materialKeys.find(material.getName());
+
+    // Unsaved changes are not reflected by any source file
+    if (material.isModified())
+    {
+        if (existing != _materialKeys.end())
+        {
+            existing->second.materialChanged.disconnect();
+            _materialKeys.erase(existing);
+        }
+
+        return {};
+    }
+
+    if (existing != _materialKeys.end() && !*existing->second.outdated)
+    {
+        return existing->second.key;
+    }
+
+    if (existing == _materialKeys.end())
+    {
+        auto outdated = std::make_shared<std::atomic<bool>>(false);
+
+        existing = _materialKeys.emplace(material.getName(), MaterialKey{ std::string(), outdated,
+            material.sig_materialChanged().connect([outdated]() { *outdated = true; }) }).first;
+    }
+
+    *existing->second.outdated = false;
+    existing->second.key = calculateThumbnailKey(material);
+
+    return existing->second.key;
+}
+
+void TextureThumbnailCache::clearMaterialKeys()
+{
+    for (auto& [_, materialKey] : _materialKeys)
+    {
+        materialKey.materialChanged.disconnect();
+    }
+
+    _materialKeys.clear();
+}
+
+std::string TextureThumbnailCache::calculateThumbnailKey(Material& material)
+{
+    math::Hash materialHash;
+    materialHash.addString(material.getName());
+
+    math::Hash sourceHash;
+    render::addThumbnailSourceFile(sourceHash, material.getShaderFileInfo());
+
+    // Without an editor image expression the material is using the
+    // first layer that is neither a bump nor a specular map
+    auto expression = material.getEditorImageExpression();
+
+    if (!expression)
+    {
+        material.foreachLayer([&](const IShaderLayer::Ptr& layer)
+        {
+            if (layer->getType() == IShaderLayer::BUMP || layer->getType() == IShaderLayer::SPECULAR ||
+                !layer->getMapExpression())
+            {
+                return true;
+            }
+
+            expression = layer->getMapExpression();
+            return false;
+        });
+    }
+
+    if (expression)
+    {
+        auto expressionString = expression->getExpressionString();
+        sourceHash.addString(expressionString);
+
+        auto imageFile = findImageFile(expressionString);
+
+        if (!imageFile.empty())
+        {
+            render::addThumbnailSourceFile(sourceHash, GlobalFileSystem().getFileInfo(imageFile));
+        }
+    }
+
+    return render::makeThumbnailKey(materialHash, sourceHash);
+}
+
+std::optional<TextureThumbnailCache::Thumbnail> TextureThumbnailCache::findThumbnail(const std::string& key)
+{
+    return _store.findThumbnail(key);
+}
+
+void TextureThumbnailCache::captureThumbnail(const std::string& key, const Texture& texture)
+{
+    if (key.empty() || !_capturedKeys.insert(key).second || findThumbnail(key))
+    {
+        return;
+    }
+
+    // Reading back without stalling the GUI thread needs pixel buffer objects and fences
+    if (!(GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object) || !(GLEW_VERSION_3_2 || GLEW_ARB_sync))
+    {
+        return;
+    }
+
+    Vector2i sourceSize(static_cast<int>(texture.getWidth()), static_cast<int>(texture.getHeight()));
+
+    if (sourceSize.x() <= 0 || sourceSize.y() <= 0) return;
+
+    glBindTexture(GL_TEXTURE_2D, texture.getGLTexNum());
+
+    // Pick the largest mipmap level fitting into the thumbnail size, levels
+    // that have not been specified report a width of 0. Precompressed images
+    // are decompressed by the driver when reading them back.
+    GLint level = 0;
+    GLint width = 0;
+    GLint height = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+
+    while (std::max(width, height) > MaxThumbnailSize)
+    {
+        GLint levelWidth = 0;
+        GLint levelHeight = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level + 1, GL_TEXTURE_WIDTH, &levelWidth);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level + 1, GL_TEXTURE_HEIGHT, &levelHeight);
+
+        // No more mipmaps, the worker is scaling down the smallest one
+        if (levelWidth == 0 || levelHeight == 0) break;
+
+        ++level;
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    if (width == 0 || height == 0) return;
+
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+
+    // With a pack buffer bound the call returns immediately, the
+    // pixels are transferred to the buffer offset 0 in the background
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _pendingReadbacks.emplace_back(PendingReadback{ key, sourceSize, width, height, buffer, fence });
+}
+
+void TextureThumbnailCache::processPendingReadbacks()
+{
+    while (!_pendingReadbacks.empty())
+    {
+        auto& readback = _pendingReadbacks.front();
+
+        // Poll without waiting, flushing makes sure the fence is reaching the GPU.
+        // Fences are signalled in the order they have been issued, the later
+        // read backs can't be finished either.
+        auto result = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+        if (result == GL_TIMEOUT_EXPIRED) break;
+
+        if (result != GL_WAIT_FAILED)
+        {
+            auto pixels = std::make_shared<wxutil::ThumbnailStore::Pixels>();
+            pixels->width = readback.width;
+            pixels->height = readback.height;
+            pixels->data.resize(static_cast<std::size_t>(readback.width) * readback.height * 4);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+            glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels->data.size()), pixels->data.data());
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            _store.storeThumbnail(readback.key, readback.sourceSize, pixels);
+        }
+
+        releaseReadback(readback);
+        _pendingReadbacks.erase(_pendingReadbacks.begin());
+    }
+}
+
+bool TextureThumbnailCache::hasPendingReadbacks() const
+{
+    return !_pendingReadbacks.empty();
+}
+
+void TextureThumbnailCache::releasePendingReadbacks()
+{
+    for (auto& readback : _pendingReadbacks)
+    {
+        releaseReadback(readback);
+    }
+
+    _pendingReadbacks.clear();
+}
+
+void TextureThumbnailCache::releaseReadback(PendingReadback& readback)
+{
+    glDeleteSync(readback.fence);
+    glDeleteBuffers(1, &readback.buffer);
+
+    readback.fence = nullptr;
+    readback.buffer = 0;
+}
+
+std::string TextureThumbnailCache::findImageFile(const std::string& expression)
+{
+    // Generated images like addnormals(...) don't have a single source file
+    if (expression.find('(') != std::string::npos) return {};
+
+    // Try the same paths as the image loader
+    auto name = os::standardPath(expression);
+    name = name.substr(0, name.rfind('.'));
+
+    for (const auto& extension : _imageExtensions)
+    {
+        auto candidate = (extension == "dds" ? "dds/" : "") + name + "." + extension;
+
+        if (!GlobalFileSystem().getFileInfo(candidate).isEmpty())
+        {
+            return candidate;
+        }
+    }
+
+    return {};
+}
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include "igl.h"
+#include "ishaders.h"
+#include "math/Vector2.h"
+#include "wxutil/ThumbnailStore.h"
+#include <sigc++/connection.h>
+
+namespace ui
+{
+
+/**
+ * On-disk cache of small material thumbnails used by the texture browser,
+ * stored as PNG files in the user's cache folder. Tiles showing a cached
+ * thumbnail don't need to load the full editor image of their material.
+ *
+ * A thumbnail is identified by the material name, the paths and modification
+ * times of the material's declaration file and editor image, such that
+ * changing any of the sources is invalidating the stored file.
+ *
+ * Missing thumbnails are read back from the editor image after it has been
+ * uploaded to OpenGL. The read back is using a pixel buffer object and a
+ * fence, the pixels are picked up in a later frame once the transfer has
+ * finished, without blocking the GUI thread. The compression and writing of
+ * the image file is happening on the worker thread of the thumbnail store.
+ *
+ * The key of each material is evaluated once per session, until the material
+ * is changed or the material declarations are reloaded.
+ */
+class TextureThumbnailCache
+{
+public:
+    // Largest edge length of a stored thumbnail
+    static constexpr int MaxThumbnailSize = 256;
+
+    // The size of the thumbnail is the one of the material's editor image
+    using Thumbnail = wxutil::ThumbnailStore::Thumbnail;
+
+private:
+    // File extensions (in order of preference) the image loader is trying
+    std::vector<std::string> _imageExtensions;
+
+    // The thumbnail files, located in the root of the thumbnail folder
+    wxutil::ThumbnailStore _store;
+
+    // Keys of thumbnails that have been captured in this session (main thread only)
+    std::set<std::string> _capturedKeys;
+
+    // A texture transfer into a pixel buffer object, not yet known to be finished
+    struct PendingReadback
+    {
+        std::string key;
+        Vector2i sourceSize;
+        int width;
+        int height;
+        GLuint buffer;
+        GLsync fence;
+    };
+
+    // Read backs in the order they have been issued (main thread only)
+    std::vector<PendingReadback> _pendingReadbacks;
+
+    struct MaterialKey
+    {
+        std::string key;
+
+        // Set when the material signals a change, which might happen on any thread
+        std::shared_ptr<std::atomic<bool>> outdated;
+        sigc::connection materialChanged;
+    };
+
+    // Thumbnail keys by material name (main thread only)
+    std::map<std::string, MaterialKey> _materialKeys;
+
+    // Set when the material declarations have been reloaded
+    std::atomic<bool> _materialsReloaded;
+    sigc::connection _materialsReloadedConn;
+
+public:
+    TextureThumbnailCache();
+    ~TextureThumbnailCache();
+
+    // Returns the key identifying the thumbnail of the given material, it is
+    // changing whenever a source file is modified. Source files changed on disk
+    // are noticed after the material declarations have been reloaded.
+    // Returns an empty key for materials with unsaved changes.
+    std::string getThumbnailKey(Material& material);
+
+    // Returns the stored thumbnail for the given key, if there is one
+    std::optional<Thumbnail> findThumbnail(const std::string& key);
+
+    // Starts reading back a downscaled copy of the given texture, which is
+    // written to disk once processPendingReadbacks() has picked it up.
+    // Requires the GL context to be current. Does nothing if the thumbnail
+    // for this key exists or is already being captured.
+    void captureThumbnail(const std::string& key, const Texture& texture);
+
+    // Queues writing the pixels of all finished read backs, without waiting
+    // for the ones still in progress. Requires the GL context to be current.
+    void processPendingReadbacks();
+
+    // True if there are read backs that have not been picked up yet
+    bool hasPendingReadbacks() const;
+
+    // Drops all read backs that have not been picked up yet, deleting their
+    // GL objects. Requires the GL context to be current.
+    void releasePendingReadbacks();
+
+private:
+    std::string calculateThumbnailKey(Material& material);
+    void releaseReadback(PendingReadback& readback);
+    void clearMaterialKeys();
+
+    // Returns the VFS path of the image file the given map expression is loaded from
+    std::string findImageFile(const std::string& expression);
+};
+
+}
@@ -201,6 +201,11 @@ void Brush::onFaceNeedsRenderableUpdate()
     _owner.onFaceNeedsRenderableUpdate();
 }
 
+void Brush::onFaceChanged()
+{
+    _owner.invalidateFingerprint();
+}
+
 Brush::DetailFlag Brush::getDetailFlag() const
 {
 	return _detailFlag;
@@ -313,6 +318,8 @@ void Brush::appendFaces(const Faces& other) {
 
 void Brush::undoSave()
 {
+    _owner.invalidateFingerprint();
+
     if (_undoStateSaver != nullptr)
 	{
         _undoStateSaver->saveState();
@@ -397,6 +404,7 @@ void Brush::reserve(std::size_t count) {
 
 void Brush::push_back(Faces::value_type face) {
     m_faces.push_back(face);
+    _owner.invalidateFingerprint();
 
     if (_undoStateSaver)
     {
@@ -417,6 +425,7 @@ void Brush::pop_back()
     }
 
     m_faces.pop_back();
+    _owner.invalidateFingerprint();
     for (Observers::iterator i = m_observers.begin(); i != m_observers.end(); ++i) {
         (*i)->pop_back();
         (*i)->DEBUG_verify();
@@ -431,6 +440,7 @@ void Brush::erase(std::size_t index)
     }
 
     m_faces.erase(m_faces.begin() + index);
+    _owner.invalidateFingerprint();
     for (Observers::iterator i = m_observers.begin(); i != m_observers.end(); ++i) {
         (*i)->erase(index);
         (*i)->DEBUG_verify();
@@ -440,11 +450,14 @@ void Brush::erase(std::size_t index)
 void Brush::onFacePlaneChanged()
 {
     m_planeChanged = true;
+    _owner.invalidateFingerprint();
     aabbChanged();
 }
 
 void Brush::onFaceShaderChanged()
 {
+    _owner.invalidateFingerprint();
+
     // When the face shader changes, no geometry change is happening
     // therefore no call to onFacePlaneChanged() is necessary
 
@@ -474,6 +487,7 @@ void Brush::clear()
     }
 
     m_faces.clear();
+    _owner.invalidateFingerprint();
 
     for(Observers::iterator i = m_observers.begin(); i != m_observers.end(); ++i) {
         (*i)->clear();
@@ -196,6 +196,8 @@ public:
     void onFaceConnectivityChanged();
     void onFaceEvaluateTransform();
     void onFaceNeedsRenderableUpdate();
+    // Plane, material or texture projection of a face is (about to be) changed
+    void onFaceChanged();
 
 	// Sets the shader of all faces to the given name
 	void setShader(const std::string& newShader) override;
@@ -7,6 +7,12 @@
 #include "math/Hash.h"
 #include <functional>
 
+namespace
+{
+    // Brushes with more faces than this are culling their faces by bounds during selection tests
+    constexpr std::size_t FACE_CULLING_THRESHOLD = 8;
+}
+
 BrushNode::BrushNode() :
 	scene::SelectableNode(),
 	_brush(*this),
@@ -14,7 +20,8 @@ BrushNode::BrushNode() :
     _numSelectedComponents(0),
     _untransformedOriginChanged(true),
     _renderableVertices(_brush, _selectedPoints),
-    _facesNeedRenderableUpdate(true)
+    _facesNeedRenderableUpdate(true),
+    _fingerprintNeedsUpdate(true)
 {
 	_brush.attach(*this); // BrushObserver
 
@@ -40,7 +47,8 @@ BrushNode::BrushNode(const BrushNode& other) :
     _numSelectedComponents(0),
     _untransformedOriginChanged(true),
     _renderableVertices(_brush, _selectedPoints),
-    _facesNeedRenderableUpdate(true)
+    _facesNeedRenderableUpdate(true),
+    _fingerprintNeedsUpdate(true)
 {
 	_brush.attach(*this); // BrushObserver
 }
@@ -59,16 +67,24 @@ const AABB& BrushNode::localAABB() const {
 	return _brush.localAABB();
 }
 
-std::string BrushNode::getFingerprint()
+scene::Fingerprint BrushNode::getFingerprint()
 {
     constexpr std::size_t SignificantDigits = scene::SignificantFingerprintDoubleDigits;
 
+    if (!_fingerprintNeedsUpdate)
+    {
+        return _fingerprint;
+    }
+
+    _fingerprintNeedsUpdate = false;
+
     if (_brush.getNumFaces() == 0)
     {
-        return std::string(); // empty brushes produce an empty fingerprint
+        _fingerprint = scene::Fingerprint(); // empty brushes produce an empty fingerprint
+        return _fingerprint;
     }
 
-    math::Hash hash;
+    math::FastHash hash;
 
     hash.addSizet(static_cast<std::size_t>(_brush.getDetailFlag() + 1));
 
@@ -94,7 +110,8 @@ std::string BrushNode::getFingerprint()
         hash.addDouble(texdef.zy(), SignificantDigits);
     }
 
-    return hash;
+    _fingerprint = hash;
+    return _fingerprint;
 }
 
 // Snappable implementation
@@ -116,7 +133,7 @@ void BrushNode::testSelect(Selector& selector, SelectionTest& test)
 	SelectionIntersection best;
 	for (FaceInstances::iterator i = _faceInstances.begin(); i != _faceInstances.end(); ++i)
 	{
-		if (i->faceIsVisible())
+		if (i->faceIsVisible() && !faceIsOutsideVolume(*i, test.getVolume()))
 		{
 			i->testSelect(test, best);
 		}
@@ -217,7 +234,10 @@ void BrushNode::testSelectComponents(Selector& selector, SelectionTest& test, se
         {
             for (FaceInstances::iterator i = _faceInstances.begin(); i != _faceInstances.end(); ++i)
             {
-                i->testSelect(selector, test);
+                if (!faceIsOutsideVolume(*i, test.getVolume()))
+                {
+                    i->testSelect(selector, test);
+                }
             }
         }
         else
@@ -232,6 +252,15 @@ void BrushNode::testSelectComponents(Selector& selector, SelectionTest& test, se
     }
 }
 
+bool BrushNode::faceIsOutsideVolume(const FaceInstance& faceInstance, const VolumeTest& volume) const
+{
+    if (_faceInstances.size() <= FACE_CULLING_THRESHOLD) return false;
+
+    const auto& faceBounds = faceInstance.getFace().getWindingBounds();
+
+    return faceBounds.isValid() && volume.TestAABB(faceBounds, localToWorld()) == VOLUME_OUTSIDE;
+}
+
 const AABB& BrushNode::getSelectedComponentsBounds() const {
 	_aabb_component = AABB();
 
@@ -380,6 +409,11 @@ void BrushNode::onFaceNeedsRenderableUpdate()
     _facesNeedRenderableUpdate = true;
 }
 
+void BrushNode::invalidateFingerprint()
+{
+    _fingerprintNeedsUpdate = true;
+}
+
 void BrushNode::onPreRender(const VolumeTest& volume)
 {
     _brush.evaluateBRep();
@@ -62,6 +62,10 @@ class BrushNode final :
 
     bool _facesNeedRenderableUpdate;
 
+    // Cached fingerprint, recalculated on demand after the brush changed
+    scene::Fingerprint _fingerprint;
+    bool _fingerprintNeedsUpdate;
+
 public:
 	BrushNode();
 
@@ -82,7 +86,7 @@ public:
 	Type getNodeType() const override;
 
     // IComparable implementation
-    std::string getFingerprint() override;
+    scene::Fingerprint getFingerprint() override;
 
 	// Bounded implementation
 	const AABB& localAABB() const override;
@@ -141,6 +145,9 @@ public:
 	std::size_t getHighlightFlags() override;
     void onFaceNeedsRenderableUpdate();
 
+    // Called by the contained brush when its faces or flags are changing
+    void invalidateFingerprint();
+
 	void evaluateTransform();
 
 	// Traceable implementation
@@ -182,6 +189,10 @@ protected:
 private:
 	void transformComponents(const Matrix4& matrix);
 
+	// Brushes with many faces are checking the cached face bounds against the
+	// test volume, before running the more expensive polygon test
+	bool faceIsOutsideVolume(const FaceInstance& faceInstance, const VolumeTest& volume) const;
+
 	void updateSelectedPointsArray();
 
 };
@@ -192,6 +192,8 @@ void Face::disconnectUndoSystem(IUndoSystem& undoSystem)
 
 void Face::undoSave()
 {
+    _owner.onFaceChanged();
+
     if (_undoStateSaver)
     {
         _undoStateSaver->saveState();
@@ -360,6 +362,8 @@ void Face::updateRenderables()
 
 void Face::updateWinding()
 {
+    _windingBounds = m_winding.aabb();
+
     updateRenderables();
     m_winding.updateNormals(m_plane.getPlane().normal());
 }
@@ -445,6 +449,8 @@ void Face::revertTexdef()
 
 void Face::texdefChanged()
 {
+    _owner.onFaceChanged();
+
     revertTexdef();
     emitTextureCoordinates();
     updateRenderables();
@@ -697,6 +703,11 @@ Winding& Face::getWinding() {
     return m_winding;
 }
 
+const AABB& Face::getWindingBounds() const
+{
+    return _windingBounds;
+}
+
 render::RenderableWinding& Face::getWindingSurfaceSolid()
 {
     return _windingSurfaceSolid;
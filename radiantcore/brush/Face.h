@@ -6,6 +6,7 @@
 #include <sigc++/connection.h>
 
 #include "math/Vector3.h"
+#include "math/AABB.h"
 
 #include "TextureProjection.h"
 #include "SurfaceShader.h"
@@ -53,6 +54,9 @@ private:
 	Winding m_winding;
 	Vector3 m_centroid;
 
+    // Bounds of the winding, refreshed in updateWinding()
+    AABB _windingBounds;
+
 	IUndoStateSaver* _undoStateSaver;
 
 	// Cached visibility flag, queried during front end rendering
@@ -189,6 +193,11 @@ public:
 	const Winding& getWinding() const override;
 	Winding& getWinding() override;
 
+    // Returns the bounds of this face's winding (in brush space), as calculated
+    // the last time the winding was updated. This may be invalid if the winding
+    // hasn't been built yet, and may be larger than the current winding.
+    const AABB& getWindingBounds() const;
+
     render::RenderableWinding& getWindingSurfaceSolid();
     render::RenderableWinding& getWindingSurfaceWireframe();
 
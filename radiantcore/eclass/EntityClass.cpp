@@ -5,6 +5,7 @@
 #include "string/convert.h"
 
 #include "string/predicate.h"
+#include <algorithm>
 #include <functional>
 #include <utility>
 
@@ -202,6 +203,8 @@ const Vector4& EntityClass::getColour()
  */
 void EntityClass::emplaceAttribute(EntityClassAttribute&& attribute)
 {
+    invalidateResolvedAttributes();
+
     // Try to emplace the class attribute
     auto result = _attributes.try_emplace(attribute.getName(), std::move(attribute));
 
@@ -224,50 +227,98 @@ void EntityClass::emplaceAttribute(EntityClassAttribute&& attribute)
     }
 }
 
-void EntityClass::forEachAttributeInternal(InternalAttrVisitor visitor,
-                                           bool editorKeys) const
+void EntityClass::forEachAttribute(AttributeVisitor visitor,
+                                   bool editorKeys)
 {
-    // Visit parent attributes, making sure we set the inherited flag
-    if (_parent)
-        _parent->forEachAttributeInternal(visitor, editorKeys);
+    ensureParsed();
+
+    // The resolved table holds exactly one attribute per name, the most
+    // derived one, together with its inherited flag
+    getResolvedAttributes();
 
-    // Visit our own attributes
-    for (const auto& pair: _attributes)
+    for (const auto* resolved : _sortedResolvedAttributes)
     {
         // Visit if it is a non-editor key or we are visiting all keys
-        if (editorKeys || !string::istarts_with(pair.first, "editor_"))
+        if (editorKeys || !string::istarts_with(resolved->attribute->getName(), "editor_"))
         {
-            visitor(pair.second);
+            visitor(*resolved->attribute, resolved->inherited);
         }
     }
 }
 
-void EntityClass::forEachAttribute(AttributeVisitor visitor,
-                                   bool editorKeys)
+const EntityClass::ResolvedAttributeMap& EntityClass::getResolvedAttributes()
 {
-    ensureParsed();
+    if (_resolvedAttributes)
+    {
+        return *_resolvedAttributes;
+    }
 
-    // First compile a map of all attributes we need to pass to the visitor,
-    // ensuring that there is only one attribute per name (i.e. we don't want to
-    // visit the same-named attribute on both a child and one of its ancestors)
-    using AttrsByName = std::map<std::string, const EntityClassAttribute*>;
-    AttrsByName attrsByName;
-
-    // Internal visit function visits parent first, then child, ensuring that
-    // more derived attributes will replace parents in the map
-    forEachAttributeInternal(
-        [&attrsByName](const EntityClassAttribute& a) {
-            attrsByName[a.getName()] = &a;
-        },
-        editorKeys
-    );
-
-    // Pass attributes to the visitor function, setting the inherited flag on
-    // any which are not present on this EntityClass
-    for (const auto& pair: attrsByName)
+    ResolvedAttributeMap resolved;
+
+    // Start with the (already flattened) table of the parent, everything
+    // in there is inherited from our point of view
+    if (_parent)
+    {
+        _parent->ensureParsed();
+
+        const auto& parentAttributes = _parent->getResolvedAttributes();
+        resolved.reserve(parentAttributes.size() + _attributes.size());
+
+        for (const auto& [name, parentAttr] : parentAttributes)
+        {
+            resolved.emplace(name, ResolvedAttribute{ parentAttr.attribute, true });
+        }
+    }
+
+    // Our own attributes replace any inherited ones of the same name
+    for (auto& [name, attribute] : _attributes)
     {
-        visitor(*pair.second, (_attributes.count(pair.first) == 0));
+        resolved.insert_or_assign(name, ResolvedAttribute{ &attribute, false });
     }
+
+    _resolvedAttributes = std::move(resolved);
+
+    // Keep a name-sorted list of the entries for the attribute visitor
+    _sortedResolvedAttributes.clear();
+    _sortedResolvedAttributes.reserve(_resolvedAttributes->size());
+
+    for (const auto& pair : *_resolvedAttributes)
+    {
+        _sortedResolvedAttributes.push_back(&pair.second);
+    }
+
+    std::sort(_sortedResolvedAttributes.begin(), _sortedResolvedAttributes.end(),
+        [](const ResolvedAttribute* a, const ResolvedAttribute* b)
+    {
+        return a->attribute->getName() < b->attribute->getName();
+    });
+
+    return *_resolvedAttributes;
+}
+
+void EntityClass::invalidateResolvedAttributes()
+{
+    _sortedResolvedAttributes.clear();
+    _resolvedAttributes.reset();
+}
+
+void EntityClass::onParentChanged()
+{
+    // The parent's attributes might have been reloaded, our flattened table
+    // is pointing to stale data now. It must not be looked at anymore: the
+    // parent has already cleared its attributes when this signal arrives.
+    invalidateResolvedAttributes();
+
+    // Re-evaluate the inherited colour, but suppress the signal, since
+    // we're going to notify our own subclasses below anyway
+    auto wasBlocked = _blockChangeSignal;
+    _blockChangeSignal = true;
+    resetColour();
+    _blockChangeSignal = wasBlocked;
+
+    // Propagate the change down the inheritance tree, subclasses
+    // need to discard their flattened tables too
+    emitChangedSignal();
 }
 
 // Resolve inheritance for this class
@@ -294,6 +345,9 @@ void EntityClass::resolveInheritance()
     {
         // Set our parent pointer
         _parent = static_cast<EntityClass*>(parentClass.get());
+
+        // Any previously resolved table didn't know about the parent yet
+        invalidateResolvedAttributes();
     }
     else
     {
@@ -330,7 +384,7 @@ void EntityClass::resolveInheritance()
         // we only have a single connection to the parent's changed signal.
         _parentChangedConnection.disconnect();
         _parentChangedConnection = _parent->changedSignal().connect(
-            sigc::mem_fun(this, &EntityClass::resetColour)
+            sigc::mem_fun(this, &EntityClass::onParentChanged)
         );
     }
 }
@@ -357,19 +411,18 @@ EntityClassAttribute* EntityClass::getAttribute(const std::string& name, bool in
 {
     ensureParsed();
 
-    // First look up the attribute on this class; if found, we can simply return it
-    auto f = _attributes.find(name);
-    if (f != _attributes.end())
-        return &f->second;
+    // Ignoring inheritance means looking up the attribute on this class only
+    if (!includeInherited)
+    {
+        auto f = _attributes.find(name);
+        return f != _attributes.end() ? &f->second : nullptr;
+    }
 
-    // If there is no parent or we have been instructed to ignore inheritance,
-    // this is the end of the line: return nothing
-    if (!_parent || !includeInherited)
-        return nullptr;
+    // The flattened table already contains the most derived attribute of each name
+    const auto& resolved = getResolvedAttributes();
+    auto found = resolved.find(name);
 
-    // Otherwise delegate to the parent (which will recurse until an attribute
-    // is found or a null parent ends the process)
-    return _parent->getAttribute(name);
+    return found != resolved.end() ? found->second.attribute : nullptr;
 }
 
 std::string EntityClass::getAttributeValue(const std::string& name, bool includeInherited)
@@ -433,6 +486,7 @@ void EntityClass::clear()
 
     _fixedSize = false;
 
+    invalidateResolvedAttributes();
     _attributes.clear();
     _inheritanceResolved = false;
 }
@@ -536,6 +590,10 @@ void EntityClass::onParsingFinished()
 {
     resolveInheritance();
 
+    // Build the flattened attribute table now, all lookups from here on
+    // are served from it without walking the parent chain
+    getResolvedAttributes();
+
     // Reset the determined visibility, it might have changed
     _visibility = Lazy<vfs::Visibility>([this] { return determineVisibilityFromValues(); });
 
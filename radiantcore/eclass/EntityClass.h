@@ -14,6 +14,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <optional>
 
@@ -57,6 +58,21 @@ private:
     using EntityAttributeMap = std::map<std::string, EntityClassAttribute, string::ILess>;
     EntityAttributeMap _attributes;
 
+    // Flattened view of all attributes visible on this class, including the
+    // inherited ones. Each name maps to the most derived attribute, so lookups
+    // don't need to walk the parent chain. The table is built after parsing
+    // and discarded whenever this class or one of its ancestors changes.
+    struct ResolvedAttribute
+    {
+        EntityClassAttribute* attribute;
+        bool inherited;
+    };
+    using ResolvedAttributeMap = std::unordered_map<std::string, ResolvedAttribute, string::IHash, string::IEqual>;
+    std::optional<ResolvedAttributeMap> _resolvedAttributes;
+
+    // All entries of the resolved map, sorted by name, for use in forEachAttribute
+    std::vector<const ResolvedAttribute*> _sortedResolvedAttributes;
+
     // Flag to indicate inheritance resolved. An EntityClass resolves its
     // inheritance by copying all values from the parent onto the child,
     // after recursively instructing the parent to resolve its own inheritance.
@@ -77,10 +93,12 @@ private:
     void parseEditorSpawnarg(const std::string& key, const std::string& value);
     void setIsLight(bool val);
 
-    // Visit attributes recursively, parent first then child
-    using InternalAttrVisitor = std::function<void(const EntityClassAttribute&)>;
-    void forEachAttributeInternal(InternalAttrVisitor visitor,
-                                  bool editorKeys) const;
+    // Invoked when the parent class signals a change
+    void onParentChanged();
+
+    // (Re-)build the flattened attribute table if it's not available
+    const ResolvedAttributeMap& getResolvedAttributes();
+    void invalidateResolvedAttributes();
 
     // Return attribute if found, possibly checking parents
     EntityClassAttribute* getAttribute(const std::string&, bool includeInherited = true);
@@ -22,6 +22,7 @@
 #include "target/TargetManager.h"
 #include "module/StaticModule.h"
 #include "EntitySettings.h"
+#include "ModelKey.h"
 #include "selection/algorithm/General.h"
 #include "selection/algorithm/Group.h"
 #include "selection/algorithm/Entity.h"
@@ -257,6 +258,16 @@ IEntitySettings& Doom3EntityModule::getSettings()
 	return *EntitySettings::InstancePtr();
 }
 
+void Doom3EntityModule::suspendModelLoading()
+{
+	ModelKey::SuspendModelLoading();
+}
+
+void Doom3EntityModule::resumeModelLoading()
+{
+	ModelKey::ResumeModelLoading();
+}
+
 // RegisterableModule implementation
 const std::string& Doom3EntityModule::getName() const
 {
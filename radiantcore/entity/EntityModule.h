@@ -19,6 +19,8 @@ public:
 	IEntityNodePtr createEntity(const IEntityClassPtr& eclass) override;
     ITargetManagerPtr createTargetManager() override;
 	IEntitySettings& getSettings() override;
+	void suspendModelLoading() override;
+	void resumeModelLoading() override;
 
 	/**
 	 * Create an instance of the given entity at the given position, and return
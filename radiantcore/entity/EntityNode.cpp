@@ -1,5 +1,6 @@
 #include "EntityNode.h"
 
+#include <algorithm>
 #include "i18n.h"
 #include "itextstream.h"
 #include "icounter.h"
@@ -7,7 +8,6 @@
 #include "imap.h"
 #include "itransformable.h"
 #include "math/Hash.h"
-#include "string/case_conv.h"
 
 #include "EntitySettings.h"
 
@@ -25,6 +25,7 @@ EntityNode::EntityNode(const IEntityClassPtr& eclass) :
     _colourKey(std::bind(&EntityNode::_colourKeyChanged, this, std::placeholders::_1)),
 	_modelKey(*this),
 	_keyObservers(_spawnArgs),
+	_keyValueFingerprint(_spawnArgs),
 	_shaderParms(_keyObservers, _colourKey),
 	_direction(1,0,0),
     _isAttachedToRenderSystem(false),
@@ -49,6 +50,7 @@ EntityNode::EntityNode(const EntityNode& other) :
     _colourKey(std::bind(&EntityNode::_colourKeyChanged, this, std::placeholders::_1)),
 	_modelKey(*this),
 	_keyObservers(_spawnArgs),
+	_keyValueFingerprint(_spawnArgs),
 	_shaderParms(_keyObservers, _colourKey),
 	_direction(1,0,0),
     _isAttachedToRenderSystem(false),
@@ -247,32 +249,36 @@ void EntityNode::foreachRenderableTouchingBounds(const AABB& bounds,
     _renderObjects.foreachRenderableTouchingBounds(bounds, functor);
 }
 
-bool EntityNode::isShadowCasting() const
+void EntityNode::prepareRenderableBounds()
 {
-    return _isShadowCasting;
+    _renderObjects.prepareBoundsQueries();
 }
 
-std::string EntityNode::getFingerprint()
+void EntityNode::foreachPreparedRenderableTouchingBounds(const AABB& bounds,
+    const PreparedObjectVisitFunction& functor) const
 {
-    std::map<std::string, std::string> sortedKeyValues;
+    _renderObjects.foreachPreparedRenderableTouchingBounds(bounds, functor);
+}
 
-    // Entities are just a collection of key/value pairs,
-    // use them in lower case form, ignore inherited keys, sort before hashing
-    _spawnArgs.forEachKeyValue([&](const std::string& key, const std::string& value)
-    {
-        sortedKeyValues.emplace(string::to_lower_copy(key), string::to_lower_copy(value));
-    }, false);
+std::size_t EntityNode::getRenderableChangeCount() const
+{
+    return _renderObjects.getChangeCount();
+}
+
+bool EntityNode::isShadowCasting() const
+{
+    return _isShadowCasting;
+}
 
-    math::Hash hash;
+scene::Fingerprint EntityNode::getFingerprint()
+{
+    math::FastHash hash;
 
-    for (const auto& pair : sortedKeyValues)
-    {
-        hash.addString(pair.first);
-        hash.addString(pair.second);
-    }
+    // The key values are hashed and cached by the helper class
+    hash.addHash(_keyValueFingerprint.get());
 
     // Entities need to include any child hashes, but be insensitive to their order
-    std::set<std::string> childFingerprints;
+    std::vector<scene::Fingerprint> childFingerprints;
 
     foreachNode([&](const scene::INodePtr& child)
     {
@@ -280,15 +286,20 @@ std::string EntityNode::getFingerprint()
 
         if (comparable)
         {
-            childFingerprints.insert(comparable->getFingerprint());
+            childFingerprints.push_back(comparable->getFingerprint());
         }
 
         return true;
     });
 
-    for (auto childFingerprint : childFingerprints)
+    std::sort(childFingerprints.begin(), childFingerprints.end());
+
+    // Children with the same fingerprint are counted once
+    auto uniqueEnd = std::unique(childFingerprints.begin(), childFingerprints.end());
+
+    for (auto childFingerprint = childFingerprints.begin(); childFingerprint != uniqueEnd; ++childFingerprint)
     {
-        hash.addString(childFingerprint);
+        hash.addHash(*childFingerprint);
     }
 
     return hash;
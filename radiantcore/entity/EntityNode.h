@@ -18,6 +18,7 @@
 #include "OriginKey.h"
 
 #include "KeyObserverMap.h"
+#include "KeyValueFingerprint.h"
 #include "RenderableEntityName.h"
 #include "RenderableObjectCollection.h"
 
@@ -77,6 +78,9 @@ protected:
 	// A helper class managing the collection of KeyObservers attached to the SpawnArgs
 	KeyObserverMap _keyObservers;
 
+	// Caches the hash of the spawnargs, used to calculate the fingerprint
+	KeyValueFingerprint _keyValueFingerprint;
+
 	// Helper class observing the "shaderParmNN" spawnargs and caching their values
 	ShaderParms _shaderParms;
 
@@ -141,6 +145,10 @@ public:
     virtual void foreachRenderable(const ObjectVisitFunction& functor) override;
     virtual void foreachRenderableTouchingBounds(const AABB& bounds,
         const ObjectVisitFunction& functor) override;
+    virtual void prepareRenderableBounds() override;
+    virtual void foreachPreparedRenderableTouchingBounds(const AABB& bounds,
+        const PreparedObjectVisitFunction& functor) const override;
+    virtual std::size_t getRenderableChangeCount() const override;
     virtual bool isShadowCasting() const override;
 
     // IMatrixTransform implementation
@@ -151,7 +159,7 @@ public:
     }
 
     // IComparableNode implementation
-    std::string getFingerprint() override;
+    scene::Fingerprint getFingerprint() override;
 
 	// SelectionTestable implementation
 	virtual void testSelect(Selector& selector, SelectionTest& test) override;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <map>
+#include "ientity.h"
+#include "icomparablenode.h"
+#include "math/Hash.h"
+#include "string/case_conv.h"
+
+#include "SpawnArgs.h"
+
+namespace entity
+{
+
+/**
+ * Observes the spawnargs of an entity and caches the hash of its
+ * key/value pairs, which is part of the entity's fingerprint.
+ * The cached value is invalidated whenever a key is inserted, changed or erased.
+ */
+class KeyValueFingerprint :
+    public Entity::Observer
+{
+private:
+    SpawnArgs& _entity;
+
+    scene::Fingerprint _fingerprint;
+    bool _needsUpdate;
+
+public:
+    KeyValueFingerprint(SpawnArgs& entity) :
+        _entity(entity),
+        _needsUpdate(true)
+    {
+        _entity.attachObserver(this);
+    }
+
+    ~KeyValueFingerprint()
+    {
+        _entity.detachObserver(this);
+    }
+
+    const scene::Fingerprint& get()
+    {
+        if (_needsUpdate)
+        {
+            _needsUpdate = false;
+            _fingerprint = calculate();
+        }
+
+        return _fingerprint;
+    }
+
+    void onKeyInsert(const std::string& key, EntityKeyValue& value) override
+    {
+        _needsUpdate = true;
+    }
+
+    void onKeyChange(const std::string& key, const std::string& value) override
+    {
+        _needsUpdate = true;
+    }
+
+    void onKeyErase(const std::string& key, EntityKeyValue& value) override
+    {
+        _needsUpdate = true;
+    }
+
+private:
+    scene::Fingerprint calculate()
+    {
+        std::map<std::string, std::string> sortedKeyValues;
+
+        // Entities are just a collection of key/value pairs,
+        // use them in lower case form, ignore inherited keys, sort before hashing
+        _entity.forEachKeyValue([&](const std::string& key, const std::string& value)
+        {
+            sortedKeyValues.emplace(string::to_lower_copy(key), string::to_lower_copy(value));
+        }, false);
+
+        math::FastHash hash;
+
+        for (const auto& pair : sortedKeyValues)
+        {
+            hash.addString(pair.first);
+            hash.addString(pair.second);
+        }
+
+        return hash;
+    }
+};
+
+}
@@ -8,6 +8,12 @@
 #include "string/replace.h"
 #include "scenelib.h"
 
+namespace
+{
+	// Number of active ModelKey::SuspendModelLoading() calls
+	std::size_t _modelLoadingSuspensions = 0;
+}
+
 ModelKey::ModelKey(scene::INode& parentNode) :
 	_parentNode(parentNode),
 	_active(true),
@@ -30,7 +36,8 @@ void ModelKey::destroy()
 
 void ModelKey::refreshModel()
 {
-	if (!_model.node) return;
+	// Without a node there's nothing to refresh, unless the model load has been deferred
+	if (!_model.node && _model.path.empty()) return;
 
     attachModelNodeKeepingSkin();
 }
@@ -65,6 +72,9 @@ void ModelKey::attachModelNode()
 	// If the "model" spawnarg is empty, there's nothing to attach
     if (_model.path.empty()) return;
 
+    // The model is going to be attached by refreshModel() after loading has been resumed
+    if (_modelLoadingSuspensions > 0) return;
+
     // The actual model path to request the model from the file cache
     std::string actualModelPath(_model.path);
 
@@ -149,6 +159,12 @@ void ModelKey::attachModelNodeKeepingSkin()
     {
         // No existing model, just attach it
         attachModelNode();
+
+        // The skin spawnarg might have been set while model loading was suspended
+        if (auto skinned = std::dynamic_pointer_cast<SkinnedModel>(_model.node); skinned && !_model.explicitSkin.empty())
+        {
+            skinned->skinChanged(_model.explicitSkin);
+        }
     }
 }
 
@@ -174,6 +190,17 @@ void ModelKey::disconnectUndoSystem(IUndoSystem& undoSystem)
 	_undo.disconnectUndoSystem(undoSystem);
 }
 
+void ModelKey::SuspendModelLoading()
+{
+	++_modelLoadingSuspensions;
+}
+
+void ModelKey::ResumeModelLoading()
+{
+	assert(_modelLoadingSuspensions > 0);
+	--_modelLoadingSuspensions;
+}
+
 void ModelKey::importState(const ModelNodeAndPath& data)
 {
 	_model.path = data.path;
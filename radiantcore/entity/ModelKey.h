@@ -62,6 +62,11 @@ public:
 	void connectUndoSystem(IUndoSystem& undoSystem);
 	void disconnectUndoSystem(IUndoSystem& undoSystem);
 
+	// While suspended, model keys only store the path of a new model,
+	// it is loaded and attached by the next refreshModel() call
+	static void SuspendModelLoading();
+	static void ResumeModelLoading();
+
 private:
     void onModelDefChanged();
 
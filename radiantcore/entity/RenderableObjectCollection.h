@@ -1,9 +1,16 @@
 #pragma once
 
 #include <map>
+#include <tuple>
+#include <cassert>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
 #include <sigc++/connection.h>
 #include <sigc++/trackable.h>
 #include <sigc++/functors/mem_fun.h>
+#include <sigc++/adaptors/bind.h>
 #include "irender.h"
 #include "irenderableobject.h"
 #include "itextstream.h"
@@ -11,40 +18,111 @@
 namespace entity
 {
 
+/**
+ * Keeps track of the renderable objects attached to an entity.
+ *
+ * Collections with lots of objects (like the worldspawn owning all the brush faces)
+ * sort their objects into a sparse grid, such that bounds queries like the ones
+ * used for gathering light interactions only need to look at the objects nearby.
+ * Objects are re-sorted lazily after they signalled a bounds change.
+ *
+ * Bounds queries are only working with the world bounds cached for each object.
+ * After calling prepareBoundsQueries(), foreachPreparedRenderableTouchingBounds()
+ * is not modifying any state and can be run from multiple threads at once, as
+ * long as no objects are added, removed or changed in the meantime.
+ */
 class RenderableObjectCollection :
     public sigc::trackable
 {
 private:
-    AABB _collectionBounds;
-    bool _collectionBoundsNeedUpdate;
+    // Collections with fewer objects than this are searched linearly
+    static constexpr std::size_t MinObjectsForGrid = 64;
+
+    // Edge length of a single grid cell
+    static constexpr double GridCellSize = 512.0;
+
+    // Objects spanning more cells than this are not sorted into the grid
+    static constexpr long long MaxCellsPerObject = 64;
+
+    struct CellRange
+    {
+        int min[3];
+        int max[3];
+
+        long long getNumCells() const
+        {
+            return static_cast<long long>(max[0] - min[0] + 1) *
+                (max[1] - min[1] + 1) * (max[2] - min[2] + 1);
+        }
+    };
 
     struct ObjectData
     {
         Shader* shader;
         sigc::connection boundsChangedConnection;
+
+        // The world bounds as of the last update, used by all bounds queries
+        AABB bounds;
+        CellRange cells;
+
+        bool isIndexed = false;     // sorted into the grid or the list of objects outside
+        bool isOutsideGrid = false;
+        bool needsUpdate = false;
     };
 
-    std::map<render::IRenderableObject::Ptr, ObjectData> _objects;
+    using ObjectMap = std::map<render::IRenderableObject::Ptr, ObjectData>;
+    using ObjectEntry = ObjectMap::value_type;
+
+    ObjectMap _objects;
+
+    AABB _collectionBounds;
+    bool _collectionBoundsNeedUpdate;
+
+    // Increased on every change affecting the results of bounds queries
+    std::size_t _changeCount;
+
+    struct CellKeyHash
+    {
+        std::size_t operator()(const std::tuple<int, int, int>& key) const
+        {
+            return static_cast<std::size_t>(std::get<0>(key)) * 73856093u ^
+                static_cast<std::size_t>(std::get<1>(key)) * 19349663u ^
+                static_cast<std::size_t>(std::get<2>(key)) * 83492791u;
+        }
+    };
+
+    // The grid cells, only populated if the collection is large enough
+    std::unordered_map<std::tuple<int, int, int>, std::vector<ObjectEntry*>, CellKeyHash> _grid;
+    bool _gridIsActive;
+
+    // Objects which need to be (re-)sorted into the grid
+    std::vector<ObjectEntry*> _objectsToUpdate;
+
+    // Objects not in the grid, since their bounds are too large or invalid
+    std::vector<ObjectEntry*> _objectsOutsideGrid;
 
 public:
     RenderableObjectCollection() :
-        _collectionBoundsNeedUpdate(true)
+        _collectionBoundsNeedUpdate(true),
+        _changeCount(0),
+        _gridIsActive(false)
     {}
 
     void addRenderable(const render::IRenderableObject::Ptr& object, Shader* shader)
     {
-        sigc::connection subscription = object->signal_boundsChanged().connect(
-            sigc::mem_fun(*this, &RenderableObjectCollection::onObjectBoundsChanged));
-        
-        if (!_objects.try_emplace(object, ObjectData{ shader, subscription }).second)
+        auto [entry, inserted] = _objects.try_emplace(object, ObjectData{ shader });
+
+        if (!inserted)
         {
-            // We've already been subscribed to this one
-            subscription.disconnect();
             rWarning() << "Renderable has already been attached to entity" << std::endl;
             return;
         }
 
-        _collectionBoundsNeedUpdate = true;
+        // Map entries never move, so the signal can be bound to the entry itself
+        entry->second.boundsChangedConnection = object->signal_boundsChanged().connect(
+            sigc::bind(sigc::mem_fun(*this, &RenderableObjectCollection::onObjectBoundsChanged), &*entry));
+
+        onObjectBoundsChanged(&*entry);
     }
 
     void removeRenderable(const render::IRenderableObject::Ptr& object)
@@ -54,6 +132,13 @@ public:
         if (mapping != _objects.end())
         {
             mapping->second.boundsChangedConnection.disconnect();
+            removeFromGrid(*mapping);
+
+            if (mapping->second.needsUpdate)
+            {
+                _objectsToUpdate.erase(std::find(_objectsToUpdate.begin(), _objectsToUpdate.end(), &*mapping));
+            }
+
             _objects.erase(mapping);
         }
         else
@@ -62,6 +147,12 @@ public:
         }
 
         _collectionBoundsNeedUpdate = true;
+        ++_changeCount;
+    }
+
+    std::size_t getChangeCount() const
+    {
+        return _changeCount;
     }
 
     void foreachRenderable(const IRenderEntity::ObjectVisitFunction& functor)
@@ -74,56 +165,253 @@ public:
         }
     }
 
+    // Updates the cached bounds before running the query, this is calling into
+    // the changed objects and must not be used from worker threads
     void foreachRenderableTouchingBounds(const AABB& bounds,
         const IRenderEntity::ObjectVisitFunction& functor)
     {
-        if (_objects.empty()) return;
+        ensureBoundsUpToDate();
 
+        foreachObjectTouchingBounds(bounds, [&](const ObjectEntry& entry)
+        {
+            functor(entry.first, entry.second.shader);
+        });
+    }
+
+    // Updates the cached object bounds, calling into all objects that changed
+    void prepareBoundsQueries()
+    {
         ensureBoundsUpToDate();
+    }
+
+    // Runs a bounds query on the state of the last prepareBoundsQueries() call
+    void foreachPreparedRenderableTouchingBounds(const AABB& bounds,
+        const IRenderEntity::PreparedObjectVisitFunction& functor) const
+    {
+        // Any change since the last preparation would have to be processed here,
+        // which is not possible without modifying the grid
+        assert(!_collectionBoundsNeedUpdate && "prepareBoundsQueries() must be called before this query");
+
+        foreachObjectTouchingBounds(bounds, [&](const ObjectEntry& entry)
+        {
+            functor(entry.first, entry.second.shader, entry.second.bounds);
+        });
+    }
+
+private:
+    template<typename Functor>
+    void foreachObjectTouchingBounds(const AABB& bounds, const Functor& functor) const
+    {
+        if (_objects.empty()) return;
 
         // If the whole collection doesn't intersect, quit early
         if (!_collectionBounds.intersects(bounds)) return;
-        
-        for (const auto& [object, objectData] : _objects)
+
+        auto queryCells = getCellRange(bounds);
+
+        // Check all objects if the query is covering more cells than there are in use
+        if (!_gridIsActive || queryCells.getNumCells() > static_cast<long long>(_grid.size()))
+        {
+            for (const auto& entry : _objects)
+            {
+                if (bounds.intersects(entry.second.bounds))
+                {
+                    functor(entry);
+                }
+            }
+
+            return;
+        }
+
+        for (auto entry : _objectsOutsideGrid)
         {
-            if (objectIntersectsBounds(bounds, *object))
+            if (bounds.intersects(entry->second.bounds))
             {
-                functor(object, objectData.shader);
+                functor(*entry);
+            }
+        }
+
+        for (auto x = queryCells.min[0]; x <= queryCells.max[0]; ++x)
+        {
+            for (auto y = queryCells.min[1]; y <= queryCells.max[1]; ++y)
+            {
+                for (auto z = queryCells.min[2]; z <= queryCells.max[2]; ++z)
+                {
+                    auto cell = _grid.find(std::make_tuple(x, y, z));
+
+                    if (cell == _grid.end()) continue;
+
+                    for (auto entry : cell->second)
+                    {
+                        // Objects spanning multiple cells are only visited in the first cell
+                        // they share with the query, to report every object only once
+                        const auto& cells = entry->second.cells;
+
+                        if (x != std::max(cells.min[0], queryCells.min[0]) ||
+                            y != std::max(cells.min[1], queryCells.min[1]) ||
+                            z != std::max(cells.min[2], queryCells.min[2]))
+                        {
+                            continue;
+                        }
+
+                        if (bounds.intersects(entry->second.bounds))
+                        {
+                            functor(*entry);
+                        }
+                    }
+                }
             }
         }
     }
 
-private:
-    bool objectIntersectsBounds(const AABB& bounds, render::IRenderableObject& object)
+    static AABB getWorldBounds(render::IRenderableObject& object)
+    {
+        return object.isOriented() ?
+            AABB::createFromOrientedAABBSafe(object.getObjectBounds(), object.getObjectTransform()) :
+            object.getObjectBounds();
+    }
+
+    static int getCellIndex(double value)
+    {
+        auto index = std::floor(value / GridCellSize);
+        return static_cast<int>(std::max(std::min(index, 1e6), -1e6));
+    }
+
+    static CellRange getCellRange(const AABB& bounds)
     {
-        if (object.isOriented())
+        CellRange range;
+
+        for (int i = 0; i < 3; ++i)
         {
-            return bounds.intersects(AABB::createFromOrientedAABBSafe(
-                object.getObjectBounds(), object.getObjectTransform()));
+            range.min[i] = getCellIndex(bounds.origin[i] - bounds.extents[i]);
+            range.max[i] = getCellIndex(bounds.origin[i] + bounds.extents[i]);
         }
-        else
+
+        return range;
+    }
+
+    void onObjectBoundsChanged(ObjectEntry* entry)
+    {
+        _collectionBoundsNeedUpdate = true;
+        ++_changeCount;
+
+        if (!entry->second.needsUpdate)
         {
-            return bounds.intersects(object.getObjectBounds());
+            entry->second.needsUpdate = true;
+            _objectsToUpdate.push_back(entry);
         }
     }
 
-    void onObjectBoundsChanged()
+    void addToGrid(ObjectEntry& entry)
     {
-        _collectionBoundsNeedUpdate = true;
+        auto& data = entry.second;
+
+        data.isIndexed = true;
+        data.isOutsideGrid = !data.bounds.isValid() || getCellRange(data.bounds).getNumCells() > MaxCellsPerObject;
+
+        if (data.isOutsideGrid)
+        {
+            _objectsOutsideGrid.push_back(&entry);
+            return;
+        }
+
+        data.cells = getCellRange(data.bounds);
+
+        for (auto x = data.cells.min[0]; x <= data.cells.max[0]; ++x)
+        {
+            for (auto y = data.cells.min[1]; y <= data.cells.max[1]; ++y)
+            {
+                for (auto z = data.cells.min[2]; z <= data.cells.max[2]; ++z)
+                {
+                    _grid[std::make_tuple(x, y, z)].push_back(&entry);
+                }
+            }
+        }
+    }
+
+    void removeFromGrid(ObjectEntry& entry)
+    {
+        auto& data = entry.second;
+
+        if (!data.isIndexed) return;
+
+        data.isIndexed = false;
+
+        if (data.isOutsideGrid)
+        {
+            *std::find(_objectsOutsideGrid.begin(), _objectsOutsideGrid.end(), &entry) = _objectsOutsideGrid.back();
+            _objectsOutsideGrid.pop_back();
+            return;
+        }
+
+        for (auto x = data.cells.min[0]; x <= data.cells.max[0]; ++x)
+        {
+            for (auto y = data.cells.min[1]; y <= data.cells.max[1]; ++y)
+            {
+                for (auto z = data.cells.min[2]; z <= data.cells.max[2]; ++z)
+                {
+                    auto cell = _grid.find(std::make_tuple(x, y, z));
+                    assert(cell != _grid.end());
+
+                    auto& objects = cell->second;
+                    *std::find(objects.begin(), objects.end(), &entry) = objects.back();
+                    objects.pop_back();
+
+                    if (objects.empty())
+                    {
+                        _grid.erase(cell);
+                    }
+                }
+            }
+        }
     }
 
     void ensureBoundsUpToDate()
     {
         if (!_collectionBoundsNeedUpdate) return;
-        
+
         _collectionBoundsNeedUpdate = false;
 
+        auto useGrid = _objects.size() >= MinObjectsForGrid;
+
+        if (useGrid != _gridIsActive)
+        {
+            // Switching between grid and linear mode, start from scratch
+            _grid.clear();
+            _objectsOutsideGrid.clear();
+            _gridIsActive = useGrid;
+
+            for (auto& entry : _objects)
+            {
+                entry.second.isIndexed = false;
+
+                if (!entry.second.needsUpdate)
+                {
+                    entry.second.needsUpdate = true;
+                    _objectsToUpdate.push_back(&entry);
+                }
+            }
+        }
+
+        for (auto entry : _objectsToUpdate)
+        {
+            entry->second.needsUpdate = false;
+            entry->second.bounds = getWorldBounds(*entry->first);
+
+            if (_gridIsActive)
+            {
+                removeFromGrid(*entry);
+                addToGrid(*entry);
+            }
+        }
+
+        _objectsToUpdate.clear();
+
         _collectionBounds = AABB();
 
-        for (const auto& [object, _] : _objects)
+        for (const auto& [_, objectData] : _objects)
         {
-            _collectionBounds.includeAABB(AABB::createFromOrientedAABBSafe(
-                object->getObjectBounds(), object->getObjectTransform()));
+            _collectionBounds.includeAABB(objectData.bounds);
         }
     }
 };
@@ -8,6 +8,8 @@
 #include "iregistry.h"
 #include "igame.h"
 #include "ishaders.h"
+#include "ientity.h"
+#include "ieclass.h"
 
 #include "module/StaticModule.h"
 #include "InstanceUpdateWalker.h"
@@ -32,6 +34,17 @@ namespace
 
 void BasicFilterSystem::setAllFilterStates(bool state)
 {
+	// Only the filters changing their state are affecting the scene
+	RuleTypeMask changedRuleTypes = 0;
+
+	for (const auto& pair : _availableFilters)
+	{
+		if (getFilterState(pair.first) != state)
+		{
+			changedRuleTypes |= pair.second->getRuleTypes();
+		}
+	}
+
 	if (state)
 	{
 		_activeFilters = _availableFilters;
@@ -46,7 +59,7 @@ void BasicFilterSystem::setAllFilterStates(bool state)
 	_visibilityCache.clear();
 
 	// Update the scenegraph instances
-	update();
+	update(changedRuleTypes);
 
 	_filterConfigChangedSignal.emit();
 
@@ -343,12 +356,20 @@ sigc::signal<void> BasicFilterSystem::filterCollectionChangedSignal() const
 }
 
 void BasicFilterSystem::update()
+{
+	update(ALL_RULE_TYPES);
+}
+
+void BasicFilterSystem::update(RuleTypeMask changedRuleTypes)
 {
 	// Update shaders first, so that nodes can judge whether they're hidden on basis of their texture
-	updateShaders();
+	if (changedRuleTypes & getRuleTypeBit(FilterRule::TYPE_TEXTURE))
+	{
+		updateShaders();
+	}
 
 	// Now update the scene
-	updateScene();
+	updateScene(changedRuleTypes);
 }
 
 void BasicFilterSystem::forEachFilter(const std::function<void(const std::string & name)>& func)
@@ -375,12 +396,21 @@ bool BasicFilterSystem::getFilterState(const std::string& filter)
 // Change the state of a named filter
 void BasicFilterSystem::setFilterState(const std::string& filter, bool state)
 {
-	assert(!_availableFilters.empty());
+	auto f = _availableFilters.find(filter);
+
+	if (f == _availableFilters.end())
+	{
+		rWarning() << "Cannot change the state of unknown filter " << filter << std::endl;
+		return;
+	}
+
+	// Nothing to re-evaluate if the state doesn't change
+	RuleTypeMask changedRuleTypes = getFilterState(filter) != state ? f->second->getRuleTypes() : 0;
 
 	if (state)
 	{
 		// Copy the filter to the active filters list
-		_activeFilters.emplace(filter, _availableFilters.find(filter)->second);
+		_activeFilters.emplace(filter, f->second);
 	}
 	else
 	{
@@ -394,7 +424,7 @@ void BasicFilterSystem::setFilterState(const std::string& filter, bool state)
 	_visibilityCache.clear();
 
 	// Update the scenegraph instances
-	update();
+	update(changedRuleTypes);
 
 	_filterConfigChangedSignal.emit();
 
@@ -454,6 +484,8 @@ bool BasicFilterSystem::removeFilter(const std::string& filter)
 		_activeFilters.erase(found);
 	}
 
+	auto changedRuleTypes = f->second->getRuleTypes();
+
 	// Now remove the object from the available filters too
 	_availableFilters.erase(f);
 
@@ -466,7 +498,7 @@ bool BasicFilterSystem::removeFilter(const std::string& filter)
 
 		_filterConfigChangedSignal.emit();
 
-		update();
+		update(changedRuleTypes);
 	}
 
 	return true;
@@ -538,11 +570,13 @@ bool BasicFilterSystem::renameFilter(const std::string& oldFilterName, const std
 // Query whether an item is visible or filtered out
 bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string& name)
 {
+	auto& cache = _visibilityCache[type];
+
 	// Check if this item is in the visibility cache, returning
 	// its cached value if found
-	auto cacheIter = _visibilityCache.find(name);
+	auto cacheIter = cache.find(name);
 
-	if (cacheIter != _visibilityCache.end())
+	if (cacheIter != cache.end())
 	{
 		return cacheIter->second;
 	}
@@ -564,13 +598,30 @@ bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string
 	}
 
 	// Cache the result and return to caller
-	_visibilityCache.emplace(name, visFlag);
+	cache.emplace(name, visFlag);
 
 	return visFlag;
 }
 
 bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entity& entity)
 {
+	// Entity class rules only depend on the class name, which can be looked up in the cache
+	StringFlagCache* cache = nullptr;
+	std::string eclassName;
+
+	if (type == FilterRule::TYPE_ENTITYCLASS)
+	{
+		cache = &_visibilityCache[type];
+		eclassName = entity.getEntityClass()->getDeclName();
+
+		auto cacheIter = cache->find(eclassName);
+
+		if (cacheIter != cache->end())
+		{
+			return cacheIter->second;
+		}
+	}
+
 	// Otherwise, walk the list of active filters to find a value for
 	// this item.
 	bool visFlag = true; // default if no filters modify it
@@ -587,6 +638,11 @@ bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entit
 		}
 	}
 
+	if (cache != nullptr)
+	{
+		cache->emplace(eclassName, visFlag);
+	}
+
 	return visFlag;
 }
 
@@ -603,15 +659,24 @@ bool BasicFilterSystem::setFilterRules(const std::string& filter, const FilterRu
 
 	if (f != _availableFilters.end() && !f->second->isReadOnly())
 	{
+		// Inactive filters are not affecting the scene, for active ones
+		// both the previous and the new rules need to be re-evaluated
+		RuleTypeMask changedRuleTypes = getFilterState(filter) ? f->second->getRuleTypes() : 0;
+
 		// Apply the ruleset
 		f->second->setRules(ruleSet);
 
+		if (getFilterState(filter))
+		{
+			changedRuleTypes |= f->second->getRuleTypes();
+		}
+
 		// Clear the cache, the ruleset has changed
 		_visibilityCache.clear();
 
 		_filterConfigChangedSignal.emit();
 
-		update();
+		update(changedRuleTypes);
 
 		return true;
 	}
@@ -628,14 +693,15 @@ void BasicFilterSystem::updateSubgraph(const scene::INodePtr& root)
 }
 
 // Update scenegraph instances with filtered status
-void BasicFilterSystem::updateScene()
+void BasicFilterSystem::updateScene(RuleTypeMask changedRuleTypes)
 {
     auto rootNode = GlobalSceneGraph().root();
 
     if (!rootNode) return;
 
-	// pass scenegraph root to specialised routine
-	updateSubgraph(rootNode);
+	// Only visit the nodes the changed rules can affect
+	InstanceUpdateWalker walker(*this, changedRuleTypes);
+	rootNode->traverse(walker);
 
     // Invoke onFiltersChanged on the root node
     rootNode->onFiltersChanged();
@@ -5,6 +5,7 @@
 #include "icommandsystem.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -29,10 +30,10 @@ private:
 	// Second table containing just the active filters
 	FilterTable _activeFilters;
 
-	// Cache of visibility flags for item names, to avoid having to
-	// traverse the active filter list for each lookup
-	typedef std::map<std::string, bool> StringFlagCache;
-	StringFlagCache _visibilityCache;
+	// Cache of visibility flags for item names (one table per rule type),
+	// to avoid having to traverse the active filter list for each lookup
+	typedef std::unordered_map<std::string, bool> StringFlagCache;
+	std::map<FilterRule::Type, StringFlagCache> _visibilityCache;
 
     sigc::signal<void> _filterConfigChangedSignal;
     sigc::signal<void> _filterCollectionChangedSignal;
@@ -42,9 +43,13 @@ private:
 
 private:
 
+	// Updates the shaders and the scene after rules of the given types
+	// have been activated, deactivated or changed
+	void update(RuleTypeMask changedRuleTypes);
+
 	// Perform a traversal of the scenegraph, setting or clearing the filtered
 	// flag on Nodes depending on their entity class
-	void updateScene();
+	void updateScene(RuleTypeMask changedRuleTypes);
 
 	void updateShaders();
 
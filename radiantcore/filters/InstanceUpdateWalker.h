@@ -5,6 +5,7 @@
 #include "iselectable.h"
 #include "ipatch.h"
 #include "ibrush.h"
+#include "XMLFilter.h"
 
 namespace filters 
 {
@@ -43,6 +44,11 @@ public:
 /**
  * Scenegraph walker to update filtered status of nodes based on the
  * currently active set of filters.
+ *
+ * If only rules of certain types have changed, the walker is restricted to
+ * the nodes these rules can affect: entities are only re-evaluated if entity
+ * rules changed, and the children of entities that didn't change their
+ * state are only visited if patch, brush or texture rules changed.
  */
 class InstanceUpdateWalker :
 	public scene::NodeVisitor
@@ -59,13 +65,23 @@ private:
 	bool _patchesAreVisible;
 	bool _brushesAreVisible;
 
+	// Which kinds of nodes need to be evaluated
+	bool _updateAll;
+	bool _entitiesAffected;
+	bool _primitivesAffected;
+
 public:
-	InstanceUpdateWalker(IFilterSystem& filterSystem) :
+	InstanceUpdateWalker(IFilterSystem& filterSystem, RuleTypeMask changedRuleTypes = ALL_RULE_TYPES) :
 		_filterSystem(filterSystem),
 		_hideWalker(true),
 		_showWalker(false),
 		_patchesAreVisible(_filterSystem.isVisible(FilterRule::TYPE_OBJECT, "patch")),
-		_brushesAreVisible(_filterSystem.isVisible(FilterRule::TYPE_OBJECT, "brush"))
+		_brushesAreVisible(_filterSystem.isVisible(FilterRule::TYPE_OBJECT, "brush")),
+		_updateAll(changedRuleTypes == ALL_RULE_TYPES),
+		_entitiesAffected((changedRuleTypes & (getRuleTypeBit(FilterRule::TYPE_ENTITYCLASS) |
+			getRuleTypeBit(FilterRule::TYPE_ENTITYKEYVALUE))) != 0),
+		_primitivesAffected((changedRuleTypes & (getRuleTypeBit(FilterRule::TYPE_TEXTURE) |
+			getRuleTypeBit(FilterRule::TYPE_OBJECT))) != 0)
 	{}
 
 	bool pre(const scene::INodePtr& node) override
@@ -73,14 +89,34 @@ public:
 		// Check entity eclass and spawnargs
 		if (Node_isEntity(node))
 		{
-			bool isVisible = evaluateEntity(node);
+			bool wasVisible = !node->isFiltered();
+			bool isVisible = _entitiesAffected ? evaluateEntity(node) : wasVisible;
+
+			if (!_updateAll && isVisible == wasVisible)
+			{
+				// The children keep their state, unless their own rules changed
+				return isVisible && _primitivesAffected;
+			}
 
 			setSubgraphFilterStatus(node, isVisible);
 
+			if (isVisible && !_updateAll)
+			{
+				// All children have just been shown, they need a full evaluation
+				InstanceUpdateWalker fullUpdate(_filterSystem);
+				node->traverseChildren(fullUpdate);
+				return false;
+			}
+
 			// If the entity is hidden, don't traverse its child nodes
 			return isVisible;
 		}
 
+		if (!_primitivesAffected)
+		{
+			return true;
+		}
+
 		// greebo: Check visibility of Patches
 		if (Node_isPatch(node))
 		{
@@ -3,7 +3,7 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "ifilter.h"
-#include <regex>
+#include "itextstream.h"
 #include <algorithm>
 
 namespace filters
@@ -25,24 +25,20 @@ bool XMLFilter::isVisible(const FilterRule::Type type, const std::string& name)
 
 	bool visible = true; // default if unmodified by rules
 
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
 		// Check the item type.
-		if (ruleIter->type != type)
+		if (_rules[i].type != type || !_matchExpressions[i])
 		{
 			continue;
 		}
 
-		// If we have a rule for this item, use a regex to match the query name
+		// If we have a rule for this item, use the regex to match the query name
 		// against the "match" parameter
-		std::regex ex(ruleIter->match);
-
-		if (std::regex_match(name, ex))
+		if (std::regex_match(name, *_matchExpressions[i]))
 		{
 			// Overwrite the visible flag with the value from the rule.
-			visible = ruleIter->show;
+			visible = _rules[i].show;
 		}
 	}
 
@@ -56,31 +52,25 @@ bool XMLFilter::isEntityVisible(const FilterRule::Type type, const Entity& entit
 
 	IEntityClassConstPtr eclass = entity.getEntityClass();
 	
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
-		if (ruleIter->type != type)
+		if (_rules[i].type != type || !_matchExpressions[i])
 		{
 			continue;
 		}
 
 		if (type == FilterRule::TYPE_ENTITYCLASS)
 		{
-			std::regex ex(ruleIter->match);
-
-			if (std::regex_match(eclass->getDeclName(), ex))
+			if (std::regex_match(eclass->getDeclName(), *_matchExpressions[i]))
 			{
-				visible = ruleIter->show;
+				visible = _rules[i].show;
 			}
 		}
 		else if (type == FilterRule::TYPE_ENTITYKEYVALUE)
 		{
-			std::regex ex(ruleIter->match);
-
-			if (std::regex_match(entity.getKeyValue(ruleIter->entityKey), ex))
+			if (std::regex_match(entity.getKeyValue(_rules[i].entityKey), *_matchExpressions[i]))
 			{
-				visible = ruleIter->show;
+				visible = _rules[i].show;
 			}
 		}
 	}
@@ -116,6 +106,25 @@ const FilterRules& XMLFilter::getRuleSet() const
 
 void XMLFilter::setRules(const FilterRules& rules) {
 	_rules = rules;
+
+	_matchExpressions.clear();
+
+	for (const auto& rule : _rules)
+	{
+		_matchExpressions.push_back(compileMatchExpression(rule));
+	}
+}
+
+RuleTypeMask XMLFilter::getRuleTypes() const
+{
+	RuleTypeMask types = 0;
+
+	for (const auto& rule : _rules)
+	{
+		types |= getRuleTypeBit(rule.type);
+	}
+
+	return types;
 }
 
 void XMLFilter::updateEventName() {
@@ -128,4 +137,17 @@ void XMLFilter::updateEventName() {
 	_eventName = "Filter" + _eventName;
 }
 
+std::optional<std::regex> XMLFilter::compileMatchExpression(const FilterRule& rule)
+{
+	try
+	{
+		return std::regex(rule.match, std::regex::ECMAScript | std::regex::optimize);
+	}
+	catch (const std::regex_error& ex)
+	{
+		rWarning() << "Ignoring filter rule with invalid expression " << rule.match << ": " << ex.what() << std::endl;
+		return std::nullopt;
+	}
+}
+
 } // namespace filters
@@ -1,12 +1,24 @@
 #pragma once
 
+#include <regex>
 #include <string>
 #include <vector>
+#include <optional>
 #include "ifilter.h"
 
 namespace filters
 {
 
+// Set of FilterRule types, one bit per type
+using RuleTypeMask = unsigned int;
+
+constexpr RuleTypeMask getRuleTypeBit(FilterRule::Type type)
+{
+	return 1u << type;
+}
+
+constexpr RuleTypeMask ALL_RULE_TYPES = ~0u;
+
 /** Class encapsulting a single filter. This consists of a name, and a list of
  * filter rules, and methods to query textures, entityclasses and objects against
  * these rules.
@@ -24,6 +36,9 @@ private:
 	// Ordered list of rule objects
 	FilterRules _rules;
 
+	// The compiled match expression of each rule, empty if the expression is invalid
+	std::vector<std::optional<std::regex>> _matchExpressions;
+
 	// True if this filter can't be changed
 	bool _readonly;
 
@@ -55,6 +70,7 @@ public:
 	void addRule(const FilterRule::Type type, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::Create(type, match, show));
+		_matchExpressions.push_back(compileMatchExpression(_rules.back()));
 	}
 
 	/** Add an entitykeyvalue rule to this filter.
@@ -72,6 +88,7 @@ public:
 	void addEntityKeyValueRule(const std::string& key, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::CreateEntityKeyValueRule(key, match, show));
+		_matchExpressions.push_back(compileMatchExpression(_rules.back()));
 	}
 
 	/** Test a given item for visibility against all of the rules
@@ -119,8 +136,14 @@ public:
 	// Applies the given ruleset, replacing the existing one.
 	void setRules(const FilterRules& rules);
 
+	// Returns the set of rule types used by this filter. Items of other types
+	// are not affected by (de-)activating this filter.
+	RuleTypeMask getRuleTypes() const;
+
 private:
 	void updateEventName();
+
+	static std::optional<std::regex> compileMatchExpression(const FilterRule& rule);
 };
 
 }
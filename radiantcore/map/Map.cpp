@@ -68,6 +68,34 @@ namespace map
 namespace
 {
     const char* const MAP_UNNAMED_STRING = N_("unnamed.map");
+
+    // Reports the progress of the graph comparison through FileOperation messages,
+    // the comparison is following the import of the map(s) to be merged
+    class ComparisonProgress
+    {
+    public:
+        ComparisonProgress()
+        {
+            FileOperation startedMsg(FileOperation::Type::Import, FileOperation::Started, true);
+            GlobalRadiantCore().getMessageBus().sendMessage(startedMsg);
+        }
+
+        ~ComparisonProgress()
+        {
+            FileOperation finishedMsg(FileOperation::Type::Import, FileOperation::Finished, true);
+            GlobalRadiantCore().getMessageBus().sendMessage(finishedMsg);
+        }
+
+        scene::merge::ProgressCallback getCallback()
+        {
+            return [](float fraction)
+            {
+                FileOperation msg(FileOperation::Type::Import, FileOperation::Progress, true, fraction);
+                msg.setText(_("Comparing maps"));
+                GlobalRadiantCore().getMessageBus().sendMessage(msg);
+            };
+        }
+    };
 }
 
 Map::Map() :
@@ -1349,7 +1377,12 @@ void Map::startMergeOperation(const std::string& sourceMap)
             assignRenderSystem(sourceMapResource->getRootNode());
 
             // Compare the scenes and get the report
-            auto result = scene::merge::GraphComparer::Compare(sourceMapResource->getRootNode(), getRoot());
+            scene::merge::ComparisonResult::Ptr result;
+            {
+                ComparisonProgress progress;
+                result = scene::merge::GraphComparer::Compare(sourceMapResource->getRootNode(), getRoot(),
+                    progress.getCallback());
+            }
 
             // Create the merge actions
             _mergeOperation = scene::merge::MergeOperation::CreateFromComparisonResult(*result);
@@ -1377,6 +1410,10 @@ void Map::startMergeOperation(const std::string& sourceMap)
     {
         radiant::NotificationMessage::SendError(ex.what());
     }
+    catch (const FileOperation::OperationCancelled&)
+    {
+        radiant::NotificationMessage::SendInformation(_("Merge operation cancelled"));
+    }
 }
 
 void Map::startMergeOperation(const std::string& sourceMap, const std::string& baseMap)
@@ -1394,8 +1431,12 @@ void Map::startMergeOperation(const std::string& sourceMap, const std::string& b
             assignRenderSystem(sourceMapResource->getRootNode());
             assignRenderSystem(baseMapResource->getRootNode());
 
-            _mergeOperation = scene::merge::ThreeWayMergeOperation::Create(
-                baseMapResource->getRootNode(), sourceMapResource->getRootNode(), getRoot());
+            {
+                ComparisonProgress progress;
+                _mergeOperation = scene::merge::ThreeWayMergeOperation::Create(
+                    baseMapResource->getRootNode(), sourceMapResource->getRootNode(), getRoot(),
+                    progress.getCallback());
+            }
 
             if (_mergeOperation->hasActions())
             {
@@ -1421,6 +1462,10 @@ void Map::startMergeOperation(const std::string& sourceMap, const std::string& b
     {
         radiant::NotificationMessage::SendError(ex.what());
     }
+    catch (const FileOperation::OperationCancelled&)
+    {
+        radiant::NotificationMessage::SendInformation(_("Merge operation cancelled"));
+    }
 }
 
 void Map::startMergeOperationCmd(const cmd::ArgumentList& args)
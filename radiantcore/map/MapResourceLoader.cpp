@@ -4,12 +4,33 @@
 #include "fmt/format.h"
 #include "scene/ChildPrimitives.h"
 #include "scenelib.h"
+#include "ientity.h"
 #include "algorithm/MapImporter.h"
+#include "algorithm/Models.h"
+#include "patch/algorithm/General.h"
 #include "messages/MapFileOperation.h"
 
 namespace map
 {
 
+namespace
+{
+    // Entities created during the lifetime of this object don't load their models
+    class ScopedModelLoadingSuspension
+    {
+    public:
+        ScopedModelLoadingSuspension()
+        {
+            GlobalEntityModule().suspendModelLoading();
+        }
+
+        ~ScopedModelLoadingSuspension()
+        {
+            GlobalEntityModule().resumeModelLoading();
+        }
+    };
+}
+
 MapResourceLoader::MapResourceLoader(std::istream& stream, const MapFormat& format) :
     _stream(stream),
     _format(format)
@@ -30,12 +51,23 @@ RootNodePtr MapResourceLoader::load()
 
         rMessage() << "Using " << _format.getMapFormatName() << " format to load the data." << std::endl;
 
-        // Start parsing
-        reader->readFromStream(_stream);
+        {
+            // The models are loaded after parsing, all at once
+            ScopedModelLoadingSuspension suspension;
+
+            // Start parsing
+            reader->readFromStream(_stream);
+        }
+
+        // Load the models of all parsed entities concurrently
+        algorithm::loadEntityModels(root);
 
         // Prepare child primitives
         scene::addOriginToChildPrimitives(root);
 
+        // Patches don't generate their meshes while being parsed, do this in one batch
+        patch::algorithm::updateTesselations(root);
+
         // Move the index mapping to this class before destroying the import filter
         _indexMapping.swap(importFilter.getNodeMap());
 
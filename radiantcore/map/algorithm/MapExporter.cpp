@@ -1,6 +1,8 @@
 #include "MapExporter.h"
 
 #include <ostream>
+#include <sstream>
+#include <future>
 #include "i18n.h"
 #include "itextstream.h"
 #include "ibrush.h"
@@ -12,6 +14,7 @@
 
 #include "registry/registry.h"
 #include "string/string.h"
+#include "ParallelForEach.h"
 
 #include "scene/ChildPrimitives.h"
 #include "messages/MapFileOperation.h"
@@ -23,9 +26,163 @@ namespace map
 	{
 		const char* const RKEY_FLOAT_PRECISION = "/mapFormat/floatPrecision";
 		const char* const RKEY_MAP_SAVE_STATUS_INTERLEAVE = "user/ui/map/saveStatusInterleave";
+
+		// Below these numbers the threading overhead outweighs the gain
+		constexpr std::size_t MIN_BRUSHES_FOR_PARALLEL_EVALUATION = 64;
+		constexpr std::size_t MIN_PRIMITIVES_FOR_PARALLEL_EXPORT = 512;
+
+		// Large entities like the worldspawn are split into parts of this size
+		constexpr std::size_t PRIMITIVES_PER_WRITE_JOB = 256;
+
+		enum class ExportedNodeType
+		{
+			None,
+			Entity,
+			Primitive,
+		};
+
+		ExportedNodeType getExportedNodeType(const scene::INodePtr& node)
+		{
+			if (std::dynamic_pointer_cast<IEntityNode>(node))
+			{
+				return ExportedNodeType::Entity;
+			}
+
+			auto brush = Node_getIBrush(node);
+
+			if (brush != nullptr)
+			{
+				// Brushes without any contributing faces are skipped
+				return brush->hasContributingFaces() ? ExportedNodeType::Primitive : ExportedNodeType::None;
+			}
+
+			return Node_isPatch(node) ? ExportedNodeType::Primitive : ExportedNodeType::None;
+		}
+
+		void beginWriteNode(IMapWriter& writer, const scene::INodePtr& node, std::ostream& stream)
+		{
+			if (auto entity = std::dynamic_pointer_cast<IEntityNode>(node); entity)
+			{
+				writer.beginWriteEntity(entity, stream);
+			}
+			else if (auto brush = std::dynamic_pointer_cast<IBrushNode>(node); brush)
+			{
+				writer.beginWriteBrush(brush, stream);
+			}
+			else if (auto patch = std::dynamic_pointer_cast<IPatchNode>(node); patch)
+			{
+				writer.beginWritePatch(patch, stream);
+			}
+		}
+
+		void endWriteNode(IMapWriter& writer, const scene::INodePtr& node, std::ostream& stream)
+		{
+			if (auto entity = std::dynamic_pointer_cast<IEntityNode>(node); entity)
+			{
+				writer.endWriteEntity(entity, stream);
+			}
+			else if (auto brush = std::dynamic_pointer_cast<IBrushNode>(node); brush)
+			{
+				writer.endWriteBrush(brush, stream);
+			}
+			else if (auto patch = std::dynamic_pointer_cast<IPatchNode>(node); patch)
+			{
+				writer.endWritePatch(patch, stream);
+			}
+		}
+
+		// An entity and its exported primitives
+		struct EntityBlock
+		{
+			scene::INodePtr entity;
+			std::vector<scene::INodePtr> primitives;
+		};
+
+		// Collects the exported nodes in traversal order, grouped by entity.
+		// Primitives outside of an entity or nested entities cannot be grouped.
+		class EntityBlockCollector :
+			public scene::NodeVisitor
+		{
+		private:
+			std::vector<EntityBlock> _blocks;
+			std::size_t _numPrimitives;
+			bool _insideEntity;
+			bool _isValid;
+
+		public:
+			EntityBlockCollector() :
+				_numPrimitives(0),
+				_insideEntity(false),
+				_isValid(true)
+			{}
+
+			const std::vector<EntityBlock>& getBlocks() const
+			{
+				return _blocks;
+			}
+
+			std::size_t getNumPrimitives() const
+			{
+				return _numPrimitives;
+			}
+
+			bool isValid() const
+			{
+				return _isValid;
+			}
+
+			bool pre(const scene::INodePtr& node) override
+			{
+				switch (getExportedNodeType(node))
+				{
+				case ExportedNodeType::Entity:
+					_isValid &= !_insideEntity;
+					_insideEntity = true;
+					_blocks.push_back(EntityBlock{ node, {} });
+					break;
+
+				case ExportedNodeType::Primitive:
+					_isValid &= _insideEntity;
+
+					if (_insideEntity)
+					{
+						_blocks.back().primitives.push_back(node);
+						_numPrimitives++;
+					}
+					break;
+
+				default:
+					break;
+				}
+
+				return true;
+			}
+
+			void post(const scene::INodePtr& node) override
+			{
+				if (getExportedNodeType(node) == ExportedNodeType::Entity)
+				{
+					_insideEntity = false;
+				}
+			}
+		};
+
+		// A range of an entity block, written by one worker into its own buffer
+		struct WriteJob
+		{
+			const EntityBlock* block;
+			std::size_t entityNum;
+			std::size_t firstPrimitive;
+			std::size_t endPrimitive;
+		};
 	}
 
 MapExporter::MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root, std::ostream& mapStream, std::size_t nodeCount) :
+	MapExporter(writer, root, mapStream, nodeCount, false)
+{}
+
+MapExporter::MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root, std::ostream& mapStream,
+				std::size_t nodeCount, bool sceneIsPrepared) :
 	_writer(writer),
 	_mapStream(mapStream),
 	_root(root),
@@ -34,7 +191,8 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root,
 	_curNodeCount(0),
 	_entityNum(0),
 	_primitiveNum(0),
-    _sendProgressMessages(true)
+    _sendProgressMessages(true),
+	_sceneIsPrepared(sceneIsPrepared)
 {
 	construct();
 }
@@ -50,7 +208,8 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root,
 	_curNodeCount(0),
 	_entityNum(0),
 	_primitiveNum(0),
-    _sendProgressMessages(true)
+    _sendProgressMessages(true),
+	_sceneIsPrepared(false)
 {
 	construct();
 }
@@ -89,6 +248,12 @@ void MapExporter::exportMap(const scene::INodePtr& root, const GraphTraversalFun
         GlobalRadiantCore().getMessageBus().sendMessage(startedMsg);
     }
 
+	// Copied brushes don't carry their windings, these are needed to skip degenerate brushes
+	if (_sceneIsPrepared)
+	{
+		recalculateBrushWindings();
+	}
+
 	try
 	{
 		auto mapRoot = std::dynamic_pointer_cast<scene::IMapRootNode>(root);
@@ -110,8 +275,11 @@ void MapExporter::exportMap(const scene::INodePtr& root, const GraphTraversalFun
 		rError() << "Failure exporting a node (pre): " << ex.what() << std::endl;
 	}
 
-	// Perform the actual map traversal
-	traverse(root, *this);
+	// Perform the actual map traversal, writers supporting it get the nodes dispatched to several threads
+	if (!exportNodesConcurrently(root, traverse))
+	{
+		traverse(root, *this);
+	}
 
 	try
 	{
@@ -139,94 +307,215 @@ void MapExporter::exportMap(const scene::INodePtr& root, const GraphTraversalFun
 
 bool MapExporter::pre(const scene::INodePtr& node)
 {
-	try
+	auto type = getExportedNodeType(node);
+
+	if (type == ExportedNodeType::None)
 	{
-		auto entity = std::dynamic_pointer_cast<IEntityNode>(node);
+		return true; // full traversal
+	}
 
-		if (entity)
-		{
-			// Progress dialog handling
-			onNodeProgress();
-			
-			_writer.beginWriteEntity(entity, _mapStream);
+	// Progress dialog handling
+	onNodeProgress();
 
-			if (_infoFileExporter) _infoFileExporter->visitEntity(node, _entityNum);
+	try
+	{
+		beginWriteNode(_writer, node, _mapStream);
 
-			return true;
+		if (_infoFileExporter)
+		{
+			if (type == ExportedNodeType::Entity)
+			{
+				_infoFileExporter->visitEntity(node, _entityNum);
+			}
+			else
+			{
+				_infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
+			}
 		}
+	}
+	catch (IMapWriter::FailureException& ex)
+	{
+		rError() << "Failure exporting a node (pre): " << ex.what() << std::endl;
+	}
 
-		auto brush = std::dynamic_pointer_cast<IBrushNode>(node);
+	return true; // full traversal
+}
 
-		if (brush && brush->getIBrush().hasContributingFaces())
-		{
-			// Progress dialog handling
-			onNodeProgress();
+void MapExporter::post(const scene::INodePtr& node)
+{
+	auto type = getExportedNodeType(node);
 
-			_writer.beginWriteBrush(brush, _mapStream);
+	if (type == ExportedNodeType::None)
+	{
+		return;
+	}
 
-			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
+	try
+	{
+		endWriteNode(_writer, node, _mapStream);
 
-			return true;
+		if (type == ExportedNodeType::Entity)
+		{
+			_entityNum++;
 		}
-
-		auto patch = std::dynamic_pointer_cast<IPatchNode>(node);
-
-		if (patch)
+		else
 		{
-			// Progress dialog handling
-			onNodeProgress();
-
-			_writer.beginWritePatch(patch, _mapStream);
-
-			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
-
-			return true;
+			_primitiveNum++;
 		}
 	}
 	catch (IMapWriter::FailureException& ex)
 	{
-		rError() << "Failure exporting a node (pre): " << ex.what() << std::endl;
+		rError() << "Failure exporting a node (post): " << ex.what() << std::endl;
 	}
-
-	return true; // full traversal
 }
 
-void MapExporter::post(const scene::INodePtr& node)
+bool MapExporter::exportNodesConcurrently(const scene::INodePtr& root, const GraphTraversalFunc& traverse)
 {
-	try
+	// Check whether the writer is able to write parts of the map independently
+	if (!_writer.createPartialWriter(0, 0))
 	{
-		auto entity = std::dynamic_pointer_cast<IEntityNode>(node);
+		return false;
+	}
 
-		if (entity)
-		{
-			_writer.endWriteEntity(entity, _mapStream);
+	EntityBlockCollector collector;
+	traverse(root, collector);
 
-			_entityNum++;
-			return;
+	if (!collector.isValid() || collector.getNumPrimitives() < MIN_PRIMITIVES_FOR_PARALLEL_EXPORT)
+	{
+		return false;
+	}
+
+	const auto& blocks = collector.getBlocks();
+
+	std::vector<WriteJob> jobs;
+
+	for (std::size_t entityNum = 0; entityNum < blocks.size(); ++entityNum)
+	{
+		const auto& block = blocks[entityNum];
+		std::size_t first = 0;
+
+		do
+		{
+			auto end = std::min(first + PRIMITIVES_PER_WRITE_JOB, block.primitives.size());
+			jobs.push_back(WriteJob{ &block, entityNum, first, end });
+			first = end;
 		}
+		while (first < block.primitives.size());
+	}
 
-		auto brush = std::dynamic_pointer_cast<IBrushNode>(node);
+	// Each job is writing to a buffer configured like the map stream
+	auto flags = _mapStream.flags();
+	auto precision = _mapStream.precision();
+	auto locale = _mapStream.getloc();
 
-		if (brush && brush->getIBrush().hasContributingFaces())
+	std::vector<std::promise<std::string>> results(jobs.size());
+	std::vector<std::future<std::string>> buffers;
+	buffers.reserve(jobs.size());
+
+	for (auto& result : results)
+	{
+		buffers.emplace_back(result.get_future());
+	}
+
+	auto writeJob = [&](std::size_t j)
+	{
+		try
 		{
-			_writer.endWriteBrush(brush, _mapStream);
-			_primitiveNum++;
-			return;
+			const auto& job = jobs[j];
+			const auto& primitives = job.block->primitives;
+			auto isFirstPart = job.firstPrimitive == 0;
+			auto isLastPart = job.endPrimitive == primitives.size();
+
+			// Past the entity header the writer continues with the next entity number
+			auto writer = _writer.createPartialWriter(isFirstPart ? job.entityNum : job.entityNum + 1, job.firstPrimitive);
+
+			std::ostringstream stream;
+			stream.flags(flags);
+			stream.precision(precision);
+			stream.imbue(locale);
+
+			auto writeNode = [&](const scene::INodePtr& node, bool begin)
+			{
+				try
+				{
+					begin ? beginWriteNode(*writer, node, stream) : endWriteNode(*writer, node, stream);
+				}
+				catch (IMapWriter::FailureException& ex)
+				{
+					rError() << "Failure exporting a node (" << (begin ? "pre" : "post") << "): " << ex.what() << std::endl;
+				}
+			};
+
+			if (isFirstPart)
+			{
+				writeNode(job.block->entity, true);
+			}
+
+			for (auto p = job.firstPrimitive; p < job.endPrimitive; ++p)
+			{
+				writeNode(primitives[p], true);
+				writeNode(primitives[p], false);
+			}
+
+			if (isLastPart)
+			{
+				writeNode(job.block->entity, false);
+			}
+
+			results[j].set_value(stream.str());
+		}
+		catch (...)
+		{
+			results[j].set_exception(std::current_exception());
 		}
+	};
 
-		auto patch = std::dynamic_pointer_cast<IPatchNode>(node);
+	parallel::IndexWorkers workers(jobs.size(), writeJob);
 
-		if (patch)
+	try
+	{
+		// Progress, info file and output are handled here, in the same order as a sequential traversal
+		for (std::size_t j = 0; j < jobs.size(); ++j)
 		{
-			_writer.endWritePatch(patch, _mapStream);
-			_primitiveNum++;
-			return;
+			const auto& job = jobs[j];
+
+			if (job.firstPrimitive == 0)
+			{
+				onNodeProgress();
+
+				if (_infoFileExporter) _infoFileExporter->visitEntity(job.block->entity, _entityNum);
+			}
+
+			for (auto p = job.firstPrimitive; p < job.endPrimitive; ++p)
+			{
+				onNodeProgress();
+
+				if (_infoFileExporter) _infoFileExporter->visitPrimitive(job.block->primitives[p], _entityNum, _primitiveNum);
+
+				_primitiveNum++;
+			}
+
+			if (job.endPrimitive == job.block->primitives.size())
+			{
+				_entityNum++;
+			}
+
+			auto buffer = buffers[j].get();
+			_mapStream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 		}
 	}
-	catch (IMapWriter::FailureException& ex)
+	catch (...)
 	{
-		rError() << "Failure exporting a node (post): " << ex.what() << std::endl;
+		// Let the workers finish their current job before leaving
+		workers.cancel();
+		workers.wait();
+
+		throw;
 	}
+
+	workers.get();
+
+	return true;
 }
 
 void MapExporter::onNodeProgress()
@@ -262,6 +551,9 @@ void MapExporter::disableProgressMessages()
 
 void MapExporter::prepareScene()
 {
+	// The brush windings of a copied scene are evaluated in exportMap()
+	if (_sceneIsPrepared) return;
+
 	// stgatilov: Hack to disable recalculateBrushWindings for hot-reload diffs
 	if (registry::getValue<std::string>("MapExporter_IgnoreBrushes") != "yes")
 	{
@@ -277,16 +569,19 @@ void MapExporter::prepareScene()
 
 void MapExporter::finishScene()
 {
-	// Emit the post-export event to give subscribers a chance to cleanup the scene
-	GlobalMapResourceManager().signal_onResourceExported().emit(_root);
-
-	// stgatilov: Hack to disable recalculateBrushWindings for hot-reload diffs
-	if (registry::getValue<std::string>("MapExporter_IgnoreBrushes") != "yes")
+	if (!_sceneIsPrepared)
 	{
-		scene::addOriginToChildPrimitives(_root);
+		// Emit the post-export event to give subscribers a chance to cleanup the scene
+		GlobalMapResourceManager().signal_onResourceExported().emit(_root);
 
-		// Re-evaluate all brushes, to update the Winding calculations
-		recalculateBrushWindings();
+		// stgatilov: Hack to disable recalculateBrushWindings for hot-reload diffs
+		if (registry::getValue<std::string>("MapExporter_IgnoreBrushes") != "yes")
+		{
+			scene::addOriginToChildPrimitives(_root);
+
+			// Re-evaluate all brushes, to update the Winding calculations
+			recalculateBrushWindings();
+		}
 	}
 
     if (_sendProgressMessages)
@@ -298,17 +593,35 @@ void MapExporter::finishScene()
 
 void MapExporter::recalculateBrushWindings()
 {
-	_root->foreachNode([] (const scene::INodePtr& child)->bool
+	std::vector<IBrush*> brushes;
+
+	_root->foreachNode([&] (const scene::INodePtr& child)->bool
 	{
 		auto* brush = Node_getIBrush(child);
 
 		if (brush != nullptr)
 		{
-			brush->evaluateBRep();
+			brushes.push_back(brush);
 		}
 
 		return true;
 	});
+
+	if (brushes.size() < MIN_BRUSHES_FOR_PARALLEL_EVALUATION)
+	{
+		for (auto* brush : brushes)
+		{
+			brush->evaluateBRep();
+		}
+
+		return;
+	}
+
+	// The windings of each brush are independent of all the others
+	parallel::forEachIndex(brushes.size(), [&](std::size_t b)
+	{
+		brushes[b]->evaluateBRep();
+	});
 }
 
 } // namespace
@@ -55,11 +55,20 @@ private:
 
     bool _sendProgressMessages;
 
+	// True if the scene has been prepared by another exporter
+	bool _sceneIsPrepared;
+
 public:
 	// The constructor prepares the scene and the output stream
 	MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root,
 				std::ostream& mapStream, std::size_t nodeCount = 0);
 
+	// Constructor for writing a copy of a scene taken while another exporter had it
+	// prepared. The copy is left as it is and no export signals are emitted, such
+	// that it can be written by a thread other than the main thread.
+	MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root,
+				std::ostream& mapStream, std::size_t nodeCount, bool sceneIsPrepared);
+
 	// Additional constructor allowed to write to the auxiliary .darkradiant file
 	MapExporter(IMapWriter& writer, const scene::IMapRootNodePtr& root,
 				std::ostream& mapStream, std::ostream& auxStream, std::size_t nodeCount = 0);
@@ -86,6 +95,10 @@ private:
 
 	void onNodeProgress();
 
+	// Writes the nodes using several threads, each filling its own buffer, if the writer supports it.
+	// Returns false if the nodes need to be passed to the writer in a single traversal instead.
+	bool exportNodesConcurrently(const scene::INodePtr& root, const GraphTraversalFunc& traverse);
+
 	// Is called before exporting the scene to prepare func_* groups.
 	void prepareScene();
 
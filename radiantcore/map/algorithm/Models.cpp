@@ -1,6 +1,7 @@
 #include "Models.h"
 
 #include <set>
+#include <vector>
 
 #include "i18n.h"
 #include "inode.h"
@@ -9,6 +10,9 @@
 #include "imodel.h"
 #include "imodelcache.h"
 #include "iscenegraph.h"
+#include "ieclass.h"
+
+#include "string/replace.h"
 
 #include "messages/ScopedLongRunningOperation.h"
 
@@ -70,21 +74,39 @@ public:
 	}
 };
 
-class ModelRefreshWalker :
+// Collects the entities and the model paths they are going to request
+class EntityModelCollector :
 	public scene::NodeVisitor
 {
 public:
-	bool pre(const scene::INodePtr& node)
+	std::vector<IEntityNodePtr> entities;
+	std::set<std::string> modelPaths;
+
+	bool pre(const scene::INodePtr& node) override
 	{
-		IEntityNodePtr entity = std::dynamic_pointer_cast<IEntityNode>(node);
+		auto entity = std::dynamic_pointer_cast<IEntityNode>(node);
 
-		if (entity)
+		if (!entity)
 		{
-			entity->refreshModel();
-			return false;
+			return true;
 		}
 
-		return true;
+		entities.push_back(entity);
+
+		// Resolve the path the same way the entity's ModelKey does
+		auto modelPath = string::replace_all_copy(entity->getEntity().getKeyValue("model"), "\\", "/");
+
+		if (auto modelDef = GlobalEntityClassManager().findModel(modelPath); modelDef)
+		{
+			modelPath = modelDef->getMesh();
+		}
+
+		if (!modelPath.empty())
+		{
+			modelPaths.insert(modelPath);
+		}
+
+		return false;
 	}
 };
 
@@ -102,8 +124,7 @@ void refreshModels(bool blockScreenUpdates)
 	GlobalModelCache().clear();
 
 	// Update all model nodes
-	ModelRefreshWalker walker;
-	GlobalSceneGraph().root()->traverse(walker);
+	loadEntityModels(GlobalSceneGraph().root());
 
 	// Send the signal to the UI
 	GlobalModelCache().signal_modelsReloaded().emit();
@@ -140,6 +161,20 @@ void refreshSelectedModels(bool blockScreenUpdates)
 	}
 }
 
+void loadEntityModels(const scene::INodePtr& root)
+{
+	EntityModelCollector collector;
+	root->traverse(collector);
+
+	// Get the cache started on all models, the entities will pick them up in turn
+	GlobalModelCache().preloadModels(collector.modelPaths);
+
+	for (const auto& entity : collector.entities)
+	{
+		entity->refreshModel();
+	}
+}
+
 // Reloads all entities with their model spawnarg referencing the given model path.
 // The given model path denotes a VFS path, i.e. it is mod/game-relative
 void refreshModelsByPath(const std::string& relativeModelPath)
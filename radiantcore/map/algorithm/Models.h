@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include "inode.h"
 
 namespace map
 {
@@ -14,6 +15,11 @@ void refreshModels(bool blockScreenUpdates);
 // This reloads all selected models in the map
 void refreshSelectedModels(bool blockScreenUpdates);
 
+// Loads and attaches the models of all entities below the given root node.
+// The distinct models are loaded concurrently before being assigned to the entities,
+// which is meant to be used after creating entities with their model loading suspended.
+void loadEntityModels(const scene::INodePtr& root);
+
 // Reloads all entities with their model spawnarg referencing the given model path.
 // The given model path denotes a VFS path, i.e. it is mod/game-relative
 void refreshModelsByPath(const std::string& relativeModelPath);
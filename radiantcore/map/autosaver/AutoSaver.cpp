@@ -3,12 +3,15 @@
 #include "i18n.h"
 #include <numeric>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include "imapfilechangetracker.h"
 #include "itextstream.h"
 #include "iscenegraph.h"
 #include "iradiant.h"
 #include "iregistry.h"
 #include "igame.h"
+#include "imapformat.h"
 #include "ipreferencesystem.h"
 #include "icommandsystem.h"
 
@@ -27,6 +30,10 @@
 #include "messages/NotificationMessage.h"
 #include "messages/AutomaticMapSaveRequest.h"
 #include "map/Map.h"
+#include "map/RootNode.h"
+#include "map/algorithm/MapExporter.h"
+#include "scene/Clone.h"
+#include "scene/Traverse.h"
 
 #include <fmt/format.h>
 
@@ -38,10 +45,9 @@ namespace
 	// Registry key names
 	const char* GKEY_MAP_EXTENSION = "/mapFormat/fileExtension";
 
-	std::string constructSnapshotName(const fs::path& snapshotPath, const std::string& mapName, int num)
+	std::string constructSnapshotName(const fs::path& snapshotPath, const std::string& mapName,
+		const std::string& mapExt, int num)
 	{
-		std::string mapExt = game::current::getValue<std::string>(GKEY_MAP_EXTENSION);
-
 		// Construct the base name without numbered extension
 		std::string filename = (snapshotPath / mapName).replace_extension().string();
 
@@ -53,6 +59,21 @@ namespace
 
 		return filename;
 	}
+
+	// Writer producing no map output, for running the info file modules over the scene
+	class InfoFileOnlyMapWriter :
+		public IMapWriter
+	{
+	public:
+		void beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override {}
+		void endWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override {}
+		void beginWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override {}
+		void endWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override {}
+		void beginWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override {}
+		void endWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override {}
+		void beginWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override {}
+		void endWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override {}
+	};
 }
 
 AutoMapSaver::AutoMapSaver() :
@@ -96,33 +117,210 @@ void AutoMapSaver::saveSnapshot()
 	// Retrieve the mapname
 	auto mapName = fullPath.filename().string();
 
-	// Check if the folder exists and create it if necessary
-	if (os::fileOrDirExists(snapshotPath.string()) || os::makeDirectory(snapshotPath.string()))
+	auto mapExtension = game::current::getValue<std::string>(GKEY_MAP_EXTENSION);
+	auto infoFileExtension = game::current::getInfoFileExtension();
+
+	// The snapshot number is determined by the worker, the extension is the same for all of them
+	auto snapshot = createSnapshot(constructSnapshotName(snapshotPath, mapName, mapExtension, 0));
+
+	_pendingSave = std::async(std::launch::async, [=, snapshot = std::move(snapshot)]() mutable
+	{
+		SaveResult result;
+		result.snapshot = std::move(snapshot);
+
+		// Check if the folder exists and create it if necessary
+		if (!os::fileOrDirExists(snapshotPath.string()) && !os::makeDirectory(snapshotPath.string()))
+		{
+			result.error = "Unable to create directory " + snapshotPath.string();
+			return result;
+		}
+
+		try
+		{
+			// Map existing snapshots (snapshot num => path)
+			std::map<int, std::string> existingSnapshots;
+
+			collectExistingSnapshots(existingSnapshots, snapshotPath, mapName, mapExtension);
+
+			int highestNum = existingSnapshots.empty() ? 0 : existingSnapshots.rbegin()->first + 1;
+
+			std::string filename = constructSnapshotName(snapshotPath, mapName, mapExtension, highestNum);
+
+			rMessage() << "Autosaving snapshot to " << filename << std::endl;
+
+			// Dump to map to the next available filename
+			writeSnapshotFiles(*result.snapshot, filename, infoFileExtension);
+
+			result.isSnapshot = true;
+			result.snapshotPath = snapshotPath;
+			result.mapName = mapName;
+
+			// Sum up the total folder size
+			for (const auto& pair : existingSnapshots)
+			{
+				result.snapshotFolderSize += os::getFileSize(pair.second);
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			result.error = ex.what();
+		}
+
+		return result;
+	});
+}
+
+void AutoMapSaver::saveToFile(const std::string& filename)
+{
+	auto snapshot = createSnapshot(filename);
+	auto infoFileExtension = game::current::getInfoFileExtension();
+
+	_pendingSave = std::async(std::launch::async, [=, snapshot = std::move(snapshot)]() mutable
 	{
-        // Map existing snapshots (snapshot num => path)
-        std::map<int, std::string> existingSnapshots;
+		SaveResult result;
+		result.snapshot = std::move(snapshot);
 
-		collectExistingSnapshots(existingSnapshots, snapshotPath, mapName);
+		try
+		{
+			writeSnapshotFiles(*result.snapshot, filename, infoFileExtension);
+		}
+		catch (const std::exception& ex)
+		{
+			result.error = ex.what();
+		}
 
-		int highestNum = existingSnapshots.empty() ? 0 : existingSnapshots.rbegin()->first + 1;
+		return result;
+	});
+}
 
-		std::string filename = constructSnapshotName(snapshotPath, mapName, highestNum);
+AutoMapSaver::MapSnapshotPtr AutoMapSaver::createSnapshot(const std::string& filename)
+{
+	auto format = GlobalMap().getMapFormatForFilenameSafe(filename);
+	const auto& root = GlobalSceneGraph().root();
+
+	auto snapshot = std::make_shared<MapSnapshot>();
+	snapshot->root = std::make_shared<RootNode>(root->name());
+	snapshot->hasInfoFile = format->allowInfoFileCreation();
+
+	{
+		InfoFileOnlyMapWriter infoFileOnlyWriter;
+		std::ostringstream unusedMapStream;
+		std::ostringstream infoFileStream;
+
+		// The exporter is preparing the scene on construction and restores it on destruction
+		auto exporter = snapshot->hasInfoFile ?
+			std::make_unique<MapExporter>(infoFileOnlyWriter, root, unusedMapStream, infoFileStream) :
+			std::make_unique<MapExporter>(infoFileOnlyWriter, root, unusedMapStream);
 
-		rMessage() << "Autosaving snapshot to " << filename << std::endl;
+		exporter->disableProgressMessages();
 
-		// Dump to map to the next available filename
-        GlobalCommandSystem().executeCommand("SaveAutomaticBackup", filename);
+		// Copying the prepared scene is much cheaper than serialising it
+		root->foreachNode([&](const scene::INodePtr& node)
+		{
+			auto clone = scene::cloneNodeIncludingDescendants(node, scene::PostCloneCallback());
 
-		handleSnapshotSizeLimit(existingSnapshots, snapshotPath, mapName);
+			if (clone)
+			{
+				snapshot->root->addChildNode(clone);
+			}
+
+			return true;
+		});
+
+		// The info file modules need the original scene with its layers, groups and sets.
+		// Without any map output this is a quick traversal.
+		if (snapshot->hasInfoFile)
+		{
+			exporter->exportMap(root, scene::traverse);
+		}
+
+		exporter.reset();
+		snapshot->infoFileContents = infoFileStream.str();
 	}
-	else
+
+	// The exporter for the copy doesn't touch any global state while writing
+	snapshot->writer = format->getMapWriter();
+
+	auto exporter = std::make_shared<MapExporter>(*snapshot->writer, snapshot->root, snapshot->mapStream, 0, true);
+	exporter->disableProgressMessages();
+
+	snapshot->exporter = exporter;
+
+	return snapshot;
+}
+
+void AutoMapSaver::writeSnapshotFiles(MapSnapshot& snapshot, const fs::path& mapPath,
+	const std::string& infoFileExtension)
+{
+	// Serialise the copied scene before touching any file
+	snapshot.exporter->exportMap(snapshot.root, scene::traverse);
+	snapshot.exporter.reset();
+
+	auto writeFile = [](const fs::path& path, const std::string& contents)
 	{
-		rError() << "Snapshot save failed, unable to create directory " << snapshotPath << std::endl;
+		if (os::fileOrDirExists(path.string()) && !os::fileIsWritable(path))
+		{
+			throw std::runtime_error("File is write-protected: " + path.string());
+		}
+
+		std::ofstream stream(path.string());
+
+		if (!stream.is_open())
+		{
+			throw std::runtime_error("Could not open file for writing: " + path.string());
+		}
+
+		stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+		if (stream.fail())
+		{
+			throw std::runtime_error("Failure writing to file " + path.string());
+		}
+	};
+
+	writeFile(mapPath, snapshot.mapStream.str());
+
+	if (snapshot.hasInfoFile)
+	{
+		fs::path infoFilePath = mapPath;
+		infoFilePath.replace_extension(infoFileExtension);
+
+		writeFile(infoFilePath, snapshot.infoFileContents);
+	}
+}
+
+void AutoMapSaver::checkPendingSave()
+{
+	if (_pendingSave.valid() && _pendingSave.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		processSaveResult(_pendingSave.get());
 	}
 }
 
-void AutoMapSaver::handleSnapshotSizeLimit(const std::map<int, std::string>& existingSnapshots,
-	const fs::path& snapshotPath, const std::string& mapName)
+void AutoMapSaver::finishPendingSave()
+{
+	if (_pendingSave.valid())
+	{
+		processSaveResult(_pendingSave.get());
+	}
+}
+
+void AutoMapSaver::processSaveResult(const SaveResult& result)
+{
+	if (!result.error.empty())
+	{
+		rError() << "Autosave failed: " << result.error << std::endl;
+		radiant::NotificationMessage::SendError(fmt::format(_("Autosave failed: {0}"), result.error));
+		return;
+	}
+
+	if (result.isSnapshot)
+	{
+		handleSnapshotSizeLimit(result.snapshotFolderSize, result.snapshotPath, result.mapName);
+	}
+}
+
+void AutoMapSaver::handleSnapshotSizeLimit(std::size_t folderSize, const fs::path& snapshotPath, const std::string& mapName)
 {
 	std::size_t maxSnapshotFolderSize =
 		registry::getValue<std::size_t>(RKEY_AUTOSAVE_MAX_SNAPSHOT_FOLDER_SIZE);
@@ -133,14 +331,6 @@ void AutoMapSaver::handleSnapshotSizeLimit(const std::map<int, std::string>& exi
 		maxSnapshotFolderSize = 100;
 	}
 
-	// Sum up the total folder size
-	std::size_t folderSize = 0;
-
-	for (const std::pair<int, std::string>& pair : existingSnapshots)
-	{
-		folderSize += os::getFileSize(pair.second);
-	}
-
 	std::size_t maxSize = maxSnapshotFolderSize * 1024 * 1024;
 
 	// The key containing the previously calculated size
@@ -182,12 +372,12 @@ void AutoMapSaver::handleSnapshotSizeLimit(const std::map<int, std::string>& exi
 }
 
 void AutoMapSaver::collectExistingSnapshots(std::map<int, std::string>& existingSnapshots,
-	const fs::path& snapshotPath, const std::string& mapName)
+	const fs::path& snapshotPath, const std::string& mapName, const std::string& mapExtension)
 {
 	for (int num = 0; num < INT_MAX; num++)
 	{
 		// Construct the base name without numbered extension
-		std::string filename = constructSnapshotName(snapshotPath, mapName, num);
+		std::string filename = constructSnapshotName(snapshotPath, mapName, mapExtension, num);
 
 		if (!os::fileOrDirExists(filename))
 		{
@@ -200,6 +390,9 @@ void AutoMapSaver::collectExistingSnapshots(std::map<int, std::string>& existing
 
 bool AutoMapSaver::runAutosaveCheck()
 {
+    // Report the outcome of the previous save, if it's done by now
+    checkPendingSave();
+
     // Check, if changes have been made since the last autosave
     if (!GlobalSceneGraph().root() || _savedChangeCount == GlobalSceneGraph().root()->getUndoChangeTracker().getCurrentChangeCount())
     {
@@ -220,6 +413,9 @@ bool AutoMapSaver::runAutosaveCheck()
 
 void AutoMapSaver::performAutosave()
 {
+    // Don't let two saves write to the same files
+    finishPendingSave();
+
     // Remember the change tracking counter
     _savedChangeCount = GlobalSceneGraph().root()->getUndoChangeTracker().getCurrentChangeCount();
 
@@ -234,6 +430,10 @@ void AutoMapSaver::performAutosave()
         {
             rError() << "AutoSaver::saveSnapshot: " << f.what() << std::endl;
         }
+        catch (const IMapResource::OperationException& ex)
+        {
+            radiant::NotificationMessage::SendError(ex.what());
+        }
     }
     else
     {
@@ -251,8 +451,7 @@ void AutoMapSaver::performAutosave()
 
             rMessage() << "Autosaving unnamed map to " << autoSaveFilename << std::endl;
 
-            // Invoke the save call
-            GlobalCommandSystem().executeCommand("SaveAutomaticBackup", autoSaveFilename);
+            saveToFile(autoSaveFilename);
         }
         else
         {
@@ -267,8 +466,7 @@ void AutoMapSaver::performAutosave()
 
             rMessage() << "Autosaving map to " << filename << std::endl;
 
-            // Invoke the save call
-            GlobalCommandSystem().executeCommand("SaveAutomaticBackup", filename);
+            saveToFile(filename);
         }
     }
 }
@@ -343,6 +541,17 @@ void AutoMapSaver::initialiseModule(const IApplicationContext& ctx)
 
 void AutoMapSaver::shutdownModule()
 {
+	// Wait for the last autosave to reach the disk
+	if (_pendingSave.valid())
+	{
+		auto result = _pendingSave.get();
+
+		if (!result.error.empty())
+		{
+			rError() << "Autosave failed: " << result.error << std::endl;
+		}
+	}
+
 	// Unsubscribe from all connections
 	for (sigc::connection& connection : _signalConnections)
 	{
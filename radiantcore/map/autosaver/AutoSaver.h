@@ -4,8 +4,11 @@
 
 #include "imap.h"
 #include "iautosaver.h"
+#include "imapexporter.h"
 
 #include <vector>
+#include <future>
+#include <sstream>
 #include <sigc++/connection.h>
 #include "os/fs.h"
 
@@ -15,6 +18,10 @@ namespace map
 /**
  * greebo: The AutoMapSaver class lets itself being called in distinct intervals
  * and saves the map files either to snapshots or to a single yyyy.autosave.map file.
+ *
+ * The scene is copied on the calling thread, while the info file is written
+ * there too. A worker thread serialises the copied scene, writes the files
+ * and does the snapshot folder housekeeping.
  */
 class AutoMapSaver final : 
 	public IAutomaticMapSaver
@@ -27,6 +34,39 @@ private:
 
 	std::vector<sigc::connection> _signalConnections;
 
+	// The scene and the info file contents captured at the time of the autosave
+	struct MapSnapshot
+	{
+		// Copy of the scene, as prepared for export
+		scene::IMapRootNodePtr root;
+
+		IMapWriterPtr writer;
+		IMapExporter::Ptr exporter;
+		std::ostringstream mapStream;
+
+		std::string infoFileContents;
+		bool hasInfoFile = false;
+	};
+	using MapSnapshotPtr = std::shared_ptr<MapSnapshot>;
+
+	// Outcome of a background save, processed on the main thread
+	struct SaveResult
+	{
+		// Non-empty if writing the files failed
+		std::string error;
+
+		// Snapshot mode: the total size of the snapshots existing before this one
+		bool isSnapshot = false;
+		std::size_t snapshotFolderSize = 0;
+		fs::path snapshotPath;
+		std::string mapName;
+
+		// Handed back to release the copied scene on the main thread
+		MapSnapshotPtr snapshot;
+	};
+
+	std::future<SaveResult> _pendingSave;
+
 public:
 	// Constructor
 	AutoMapSaver();
@@ -46,6 +86,8 @@ public:
 
     void performAutosave() override;
 
+    void finishPendingSave() override;
+
 private:
 	void constructPreferences();
 
@@ -56,11 +98,26 @@ private:
 	// Saves a snapshot of the currently active map (only named maps)
 	void saveSnapshot();
 
-	void collectExistingSnapshots(std::map<int, std::string>& existingSnapshots,
-		const fs::path& snapshotPath, const std::string& mapName);
+	// Saves the current map to the given file
+	void saveToFile(const std::string& filename);
+
+	// Copies the current map for the format matching the given filename
+	// and writes its info file
+	MapSnapshotPtr createSnapshot(const std::string& filename);
+
+	// Processes the result of the previous save if it is done, without blocking
+	void checkPendingSave();
+
+	void processSaveResult(const SaveResult& result);
+
+	// Writes the map and its info file, throws std::runtime_error on failure
+	static void writeSnapshotFiles(MapSnapshot& snapshot, const fs::path& mapPath,
+		const std::string& infoFileExtension);
+
+	static void collectExistingSnapshots(std::map<int, std::string>& existingSnapshots,
+		const fs::path& snapshotPath, const std::string& mapName, const std::string& mapExtension);
 
-	void handleSnapshotSizeLimit(const std::map<int, std::string>& existingSnapshots,
-		const fs::path& snapshotPath, const std::string& mapName);
+	void handleSnapshotSizeLimit(std::size_t folderSize, const fs::path& snapshotPath, const std::string& mapName);
 };
 
 } // namespace map
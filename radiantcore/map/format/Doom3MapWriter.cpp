@@ -98,4 +98,19 @@ void Doom3MapWriter::endWritePatch(const IPatchNodePtr& patch, std::ostream& str
 	// nothing
 }
 
+IMapWriterPtr Doom3MapWriter::createPartialWriter(std::size_t entityNum, std::size_t primitiveNum)
+{
+	auto writer = clone();
+
+	writer->_entityCount = entityNum;
+	writer->_primitiveCount = primitiveNum;
+
+	return writer;
+}
+
+std::shared_ptr<Doom3MapWriter> Doom3MapWriter::clone() const
+{
+	return std::make_shared<Doom3MapWriter>(*this);
+}
+
 } // namespace
@@ -36,8 +36,14 @@ public:
 	virtual void beginWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override;
 	virtual void endWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override;
 
+	// The numbering comments are the only state carried from one node to the next
+	virtual IMapWriterPtr createPartialWriter(std::size_t entityNum, std::size_t primitiveNum) override;
+
 protected:
 	void writeEntityKeyValues(const IEntityNodePtr& entity, std::ostream& stream);
+
+	// Creates a copy of this writer, subclasses need to return their own type
+	virtual std::shared_ptr<Doom3MapWriter> clone() const;
 };
 
 } // namespace
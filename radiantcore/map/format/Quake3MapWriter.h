@@ -39,6 +39,12 @@ public:
 		// Export patchDef2 to stream (patchDef3 is not supported)
 		PatchDefExporter::exportQ3PatchDef2(stream, patch);
 	}
+
+protected:
+	virtual std::shared_ptr<Doom3MapWriter> clone() const override
+	{
+		return std::make_shared<Quake3MapWriter>(*this);
+	}
 };
 
 class Quake3AlternateMapWriter :
@@ -54,6 +60,12 @@ public:
         // Export brushDef definition to stream
         BrushDefExporter::exportBrush(stream, brush);
     }
+
+protected:
+    virtual std::shared_ptr<Doom3MapWriter> clone() const override
+    {
+        return std::make_shared<Quake3AlternateMapWriter>(*this);
+    }
 };
 
 } // namespace
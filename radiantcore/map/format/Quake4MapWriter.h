@@ -28,6 +28,12 @@ public:
 		// Export brushDef3 definition to stream, but without contents flags
 		BrushDef3Exporter::exportBrush(stream, brush, false);
 	}
+
+protected:
+	virtual std::shared_ptr<Doom3MapWriter> clone() const override
+	{
+		return std::make_shared<Quake4MapWriter>(*this);
+	}
 };
 
 } // namespace
@@ -1,10 +1,7 @@
 #pragma once
 
 #include <string>
-#include <set>
-
-/// Set of unique postfixes, e.g. "1", "6" or "04"
-typedef std::set<std::string> PostfixSet;
+#include "PostfixSet.h"
 
 /// Name consisting of initial text and optional unique-making number-postfix 
 /// e.g. "Carl" + "6", or "Mary" + "03"
@@ -46,4 +43,11 @@ public:
      * Set of existing postfixes which must not be used.
      */
     std::string makePostfixUnique(const PostfixSet& postfixes);
+
+    /**
+     * \brief
+     * Variant of the above, the resulting postfix will not be used in
+     * either of the given sets.
+     */
+    std::string makePostfixUnique(const PostfixSet& postfixes, const PostfixSet& otherPostfixes);
 };
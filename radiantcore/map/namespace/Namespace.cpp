@@ -280,38 +280,33 @@ void Namespace::ensureNoConflicts(const scene::INodePtr& foreignRoot, const std:
     rDebug() << "Namespace::ensureNoConflicts(): importing set of "
         << foreignNodes.size() << " namespaced nodes" << std::endl;
 
-    // Build a union set containing all imported names and all existing names.
-    // We need to know all existing names to ensure that newly created names are
-    // unique in *both* namespaces
-    UniqueNameSet allNames = _uniqueNames;
-    allNames.merge(foreignNamespace._uniqueNames);
+    // The temporary namespace knows all imported names. Every node conflicting with
+    // a name in THIS namespace is assigned a name that is unique in *both* namespaces,
+    // which is reserved in the foreign set right away. This way the whole batch can be
+    // processed without building a union of all existing and all imported names.
+    auto& importedNames = foreignNamespace._uniqueNames;
 
     // Process each object in the to-be-imported tree of nodes, ensuring that it
     // has a unique name
     for (const auto& foreignNode : foreignNodes)
     {
-        // If the imported node conflicts with a name in THIS namespace, then it
-        // needs to be given a new name which is unique in BOTH namespaces.
-        if (_uniqueNames.nameExists(foreignNode->getName()))
+        // Names that don't exist in the target namespace can be left alone, they
+        // will be inserted into our destination namespace in the subsequent call to connect().
+        if (!_uniqueNames.nameExists(foreignNode->getName()))
         {
-            // Name exists in the target namespace, get a new name
-            std::string uniqueName = allNames.insertUnique(foreignNode->getName());
+            continue;
+        }
 
-            rMessage() << "Namespace::ensureNoConflicts(): '" << foreignNode->getName()
-                << "' already exists in this namespace. Rename it to '"
-                << uniqueName << "'\n";
+        // Name exists in the target namespace, get a new name
+        std::string uniqueName = importedNames.insertUnique(foreignNode->getName(), _uniqueNames);
 
-            // Change the name of the imported node, this should trigger all
-            // observers in the foreign namespace
-            foreignNode->changeName(uniqueName);
-        }
-        else
-        {
-            // Name does not exist yet, insert it into the local combined
-            // namespace (but not our destination namespace, this will be
-            // populated in the subsequent call to connect()).
-            allNames.insert(foreignNode->getName());
-        }
+        rMessage() << "Namespace::ensureNoConflicts(): '" << foreignNode->getName()
+            << "' already exists in this namespace. Rename it to '"
+            << uniqueName << "'\n";
+
+        // Change the name of the imported node, this should trigger all
+        // observers in the foreign namespace
+        foreignNode->changeName(uniqueName);
     }
 
     // at this point, all names in the foreign namespace have been converted to
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <string>
+#include <set>
+#include <map>
+#include <climits>
+#include <cassert>
+#include <iterator>
+
+/**
+ * Set of unique postfixes, e.g. "1", "6" or "04".
+ *
+ * Next to the postfix strings this keeps track of the used numbers in
+ * their canonical form ("6" but not "06") as a set of closed intervals,
+ * such that the lowest free number can be found in logarithmic time,
+ * regardless of how many postfixes are in use.
+ */
+class PostfixSet
+{
+    // The postfixes in string form, including non-canonical ones like "04"
+    std::set<std::string> _postfixes;
+
+    // Used canonical numbers, stored as disjoint, non-adjacent
+    // intervals mapping first => last (both inclusive)
+    std::map<int, int> _usedNumbers;
+
+public:
+    static constexpr int LOWEST_VALUE = 1;
+
+    bool empty() const
+    {
+        return _postfixes.empty();
+    }
+
+    std::size_t size() const
+    {
+        return _postfixes.size();
+    }
+
+    bool contains(const std::string& postfix) const
+    {
+        return _postfixes.count(postfix) > 0;
+    }
+
+    /// Insert the given postfix, returns true if it wasn't present yet
+    bool insert(const std::string& postfix)
+    {
+        if (!_postfixes.insert(postfix).second)
+        {
+            return false;
+        }
+
+        if (int number = 0; getCanonicalNumber(postfix, number))
+        {
+            insertNumber(number);
+        }
+
+        return true;
+    }
+
+    /// Remove the given postfix, returns true if it has been present
+    bool erase(const std::string& postfix)
+    {
+        if (_postfixes.erase(postfix) == 0)
+        {
+            return false;
+        }
+
+        if (int number = 0; getCanonicalNumber(postfix, number))
+        {
+            eraseNumber(number);
+        }
+
+        return true;
+    }
+
+    /// Copies all postfixes of the other set into this one
+    void merge(const PostfixSet& other)
+    {
+        for (const auto& postfix : other._postfixes)
+        {
+            insert(postfix);
+        }
+    }
+
+    /// Returns the lowest number >= start which is not used by this set
+    int findFirstUnusedNumber(int start = LOWEST_VALUE) const
+    {
+        // Find the last interval beginning at or before the start value
+        auto interval = _usedNumbers.upper_bound(start);
+
+        if (interval == _usedNumbers.begin())
+        {
+            return start;
+        }
+
+        --interval;
+
+        // Intervals are never adjacent, so the number after a covering interval is free
+        if (interval->second < start)
+        {
+            return start;
+        }
+
+        // Pathological case, could not find a value
+        return interval->second < INT_MAX ? interval->second + 1 : INT_MAX;
+    }
+
+    /// Returns the lowest number >= start that is neither used by this nor the other set
+    int findFirstUnusedNumber(const PostfixSet& other, int start = LOWEST_VALUE) const
+    {
+        int candidate = start;
+
+        while (true)
+        {
+            int next = other.findFirstUnusedNumber(findFirstUnusedNumber(candidate));
+
+            // Stop once both sets agree on the value, or when running out of numbers
+            if (next == candidate || next == INT_MAX)
+            {
+                return next;
+            }
+
+            candidate = next;
+        }
+    }
+
+private:
+    // Returns true if the postfix is the canonical string form of a positive number
+    static bool getCanonicalNumber(const std::string& postfix, int& number)
+    {
+        if (postfix.empty() || postfix.size() > 10 || postfix[0] < '1' || postfix[0] > '9')
+        {
+            return false; // no leading zeros, no "-" placeholder
+        }
+
+        long long value = 0;
+
+        for (auto c : postfix)
+        {
+            if (c < '0' || c > '9') return false;
+
+            value = value * 10 + (c - '0');
+        }
+
+        if (value > INT_MAX)
+        {
+            return false;
+        }
+
+        number = static_cast<int>(value);
+        return true;
+    }
+
+    void insertNumber(int number)
+    {
+        int first = number;
+        int last = number;
+
+        // Check for an interval ending right before the number
+        auto next = _usedNumbers.upper_bound(number);
+
+        if (next != _usedNumbers.begin())
+        {
+            auto prev = std::prev(next);
+
+            assert(prev->second < number); // number must not be contained yet
+
+            if (prev->second == number - 1)
+            {
+                first = prev->first;
+                _usedNumbers.erase(prev);
+            }
+        }
+
+        // Check for an interval starting right after the number
+        if (next != _usedNumbers.end() && next->first == number + 1)
+        {
+            last = next->second;
+            _usedNumbers.erase(next);
+        }
+
+        _usedNumbers.emplace(first, last);
+    }
+
+    void eraseNumber(int number)
+    {
+        auto interval = _usedNumbers.upper_bound(number);
+
+        assert(interval != _usedNumbers.begin());
+        --interval;
+
+        int first = interval->first;
+        int last = interval->second;
+
+        assert(number >= first && number <= last);
+        _usedNumbers.erase(interval);
+
+        // Re-insert the remaining parts of the interval
+        if (first < number)
+        {
+            _usedNumbers.emplace(first, number - 1);
+        }
+
+        if (number < last)
+        {
+            _usedNumbers.emplace(number + 1, last);
+        }
+    }
+};
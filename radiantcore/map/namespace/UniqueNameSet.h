@@ -1,6 +1,5 @@
 #pragma once
 
-#include <set>
 #include <map>
 
 #include "ComplexName.h"
@@ -59,10 +58,8 @@ public:
         }
 
         // The prefix is inserted at this point, add the postfix to the set
-        auto result = found->second.insert(name.getPostfix());
-
-        // Return the boolean of the insertion result, it is true on successful insertion
-        return result.second;
+        // The insertion result is true on successful insertion
+        return found->second.insert(name.getPostfix());
     }
 
     /**
@@ -83,7 +80,7 @@ public:
 
         // The prefix has been found, remove the postfix from the set
         // Return true if the erase method removed any elements
-        return found->second.erase(name.getPostfix()) > 0;
+        return found->second.erase(name.getPostfix());
     }
 
     /**
@@ -126,6 +123,36 @@ public:
         return uniqueName.getFullname();
     }
 
+    /**
+     * \brief
+     * Insert the given ComplexName into this set, changing its postfix if
+     * necessary to ensure that is is unique in this set as well as in the
+     * given other set. The other set is not modified.
+     *
+     * This allows to allocate names for a batch of imported nodes without
+     * having to build the union of both sets first.
+     */
+    std::string insertUnique(const ComplexName& name, const UniqueNameSet& other)
+    {
+        auto otherFound = other._names.find(name.getNameWithoutPostfix());
+
+        // If the other set doesn't know this prefix, only this set is relevant
+        if (otherFound == other._names.end())
+        {
+            return insertUnique(name);
+        }
+
+        // Ensure the prefix exists in this set
+        auto& postfixSet = _names[name.getNameWithoutPostfix()];
+
+        ComplexName uniqueName(name);
+
+        std::string postfix = uniqueName.makePostfixUnique(postfixSet, otherFound->second);
+        postfixSet.insert(postfix);
+
+        return uniqueName.getFullname();
+    }
+
     /**
      * greebo: Returns true if the full name already exists in this set.
      */
@@ -155,7 +182,7 @@ public:
             const PostfixSet& postfixSet = found->second;
 
             // If we know the number too, the full name exists
-            return postfixSet.find(name.getPostfix()) != postfixSet.end();
+            return postfixSet.contains(name.getPostfix());
         }
 
         // Prefix is not known, hence full name is not known
@@ -178,7 +205,7 @@ public:
             if (local != _names.end())
 			{
                 // Prefix exists, merge the postfixes
-                local->second.insert(i.second.begin(), i.second.end());
+                local->second.merge(i.second);
             }
             else
 			{
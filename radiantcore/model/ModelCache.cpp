@@ -9,6 +9,7 @@
 
 #include "module/StaticModule.h"
 #include <functional>
+#include <algorithm>
 
 #include "map/algorithm/Models.h"
 
@@ -50,6 +51,25 @@ IModelPtr ModelCache::getModel(const std::string& modelPath)
 		return found->second;
 	}
 
+	// A preload worker might have been assigned to this model, use its result
+	auto loading = _loadingModels.find(modelPath);
+
+	if (_enabled && loading != _loadingModels.end())
+	{
+		auto result = std::move(loading->second);
+		_loadingModels.erase(loading);
+
+		// Blocks until the worker is done with this model
+		auto model = result.get();
+
+		if (model)
+		{
+			_modelMap.emplace(modelPath, model);
+		}
+
+		return model;
+	}
+
 	// The model is not cached or the cache is disabled, load afresh
 
 	// Get the extension of this model
@@ -69,6 +89,67 @@ IModelPtr ModelCache::getModel(const std::string& modelPath)
 	return model;
 }
 
+void ModelCache::preloadModels(const std::set<std::string>& modelPaths)
+{
+	struct LoadRequest
+	{
+		std::string modelPath;
+		IModelImporterPtr importer;
+		std::promise<IModelPtr> result;
+	};
+
+	auto requests = std::make_shared<std::vector<LoadRequest>>();
+
+	for (const auto& modelPath : modelPaths)
+	{
+		if (_modelMap.count(modelPath) > 0 || _loadingModels.count(modelPath) > 0)
+		{
+			continue; // already here or on its way
+		}
+
+		auto modelLoader = GlobalModelFormatManager().getImporter(os::getExtension(modelPath));
+
+		// The importers are using the relative VFS path of a model as cache key,
+		// leave everything else to the regular code path. The NullModelLoader
+		// doesn't need to be run in the background either.
+		if (path_is_absolute(modelPath.c_str()) || modelLoader->getExtension().empty())
+		{
+			continue;
+		}
+
+		requests->push_back(LoadRequest{ modelPath, modelLoader });
+	}
+
+	if (requests->empty()) return;
+
+	// Register the requests before any worker starts to fulfil them
+	for (auto& request : *requests)
+	{
+		_loadingModels.emplace(request.modelPath, request.result.get_future());
+	}
+
+	// Forget about the workers that are done
+	_preloadWorkers.erase(std::remove_if(_preloadWorkers.begin(), _preloadWorkers.end(), [](const parallel::IndexWorkers& workers)
+	{
+		return workers.isFinished();
+	}), _preloadWorkers.end());
+
+	_preloadWorkers.emplace_back(requests->size(), [requests](std::size_t r)
+	{
+		auto& request = (*requests)[r];
+
+		try
+		{
+			request.result.set_value(request.importer->loadModelFromPath(request.modelPath));
+		}
+		catch (...)
+		{
+			// Pass the exception to the thread requesting the model
+			request.result.set_exception(std::current_exception());
+		}
+	});
+}
+
 scene::INodePtr ModelCache::getModelNodeForStaticResource(const std::string& resourcePath)
 {
     // Get the extension of this model
@@ -105,6 +186,9 @@ void ModelCache::removeModel(const std::string& modelPath)
 		_modelMap.erase(found);
 	}
 
+	// A model still being preloaded might be outdated too, drop the result
+	_loadingModels.erase(modelPath);
+
 	// Allow usage of the modelnodemap again.
 	_enabled = true;
 }
@@ -116,6 +200,7 @@ void ModelCache::clear()
 	_enabled = false;
 
 	_modelMap.clear();
+	_loadingModels.clear();
 
 	// Allow usage of the modelnodemap again.
 	_enabled = true;
@@ -157,6 +242,17 @@ void ModelCache::initialiseModule(const IApplicationContext& ctx)
 void ModelCache::shutdownModule()
 {
 	clear();
+	waitForPreloadWorkers();
+}
+
+void ModelCache::waitForPreloadWorkers()
+{
+	for (const auto& workers : _preloadWorkers)
+	{
+		workers.wait();
+	}
+
+	_preloadWorkers.clear();
 }
 
 void ModelCache::refreshModels(bool blockScreenUpdates)
@@ -2,8 +2,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <future>
 #include "imodelcache.h"
 #include "icommandsystem.h"
+#include "ParallelForEach.h"
 
 namespace model
 {
@@ -16,6 +19,11 @@ private:
 	typedef std::map<std::string, IModelPtr> ModelMap;
 	ModelMap _modelMap;
 
+	// Models still being loaded by the preload workers, keyed by their path.
+	// A result is moved to the model map when the model is first requested.
+	std::map<std::string, std::future<IModelPtr>> _loadingModels;
+	std::vector<parallel::IndexWorkers> _preloadWorkers;
+
 	// Flag to disable the cache on demand (used during clear())
 	bool _enabled;
 
@@ -30,6 +38,8 @@ public:
 	// greebo: For documentation, see the abstract base class.
 	IModelPtr getModel(const std::string& modelPath) override;
 
+	void preloadModels(const std::set<std::string>& modelPaths) override;
+
     scene::INodePtr getModelNodeForStaticResource(const std::string& resourcePath) override;
 
 	// Clear methods
@@ -51,6 +61,9 @@ public:
 private:
     scene::INodePtr loadNullModel(const std::string& modelPath);
 
+	// Blocks until all preload workers are done, discarding their results
+	void waitForPreloadWorkers();
+
 	// Command targets
 	void refreshModelsCmd(const cmd::ArgumentList& args);
 	void refreshSelectedModelsCmd(const cmd::ArgumentList& args);
@@ -35,14 +35,15 @@ private:
 	std::string _activeMaterial;
 
 	// Vector of MeshVertex structures, containing the coordinates,
-	// normals, tangents and texture coordinates of the component vertices
+	// normals, tangents and texture coordinates of the component vertices.
+	// The vertices are shared between copies of this surface until a scale is applied.
 	typedef std::vector<MeshVertex> VertexVector;
-	VertexVector _vertices;
+	std::shared_ptr<VertexVector> _vertices;
 
 	// Vector of render indices, representing the groups of vertices to be
-	// used to create triangles
+	// used to create triangles. These never change and are always shared by all copies.
 	typedef std::vector<unsigned int> Indices;
-	Indices _indices;
+	std::shared_ptr<const Indices> _indices;
 
 	// The AABB containing this surface, in local object space.
 	AABB _localAABB;
@@ -52,10 +53,12 @@ private:
 	void calculateTangents();
 
 public:
-    // Move-construct this static model surface from the given vertex- and index array
+    // Move-construct this static model surface from the given vertex- and index array.
+	// Duplicate vertices are merged and the triangles are re-ordered for rendering.
 	StaticModelSurface(std::vector<MeshVertex>&& vertices, std::vector<unsigned int>&& indices);
 
-	// Copy-constructor. All vertices and indices will be copied from 'other'.
+	// Copy-constructor. The vertex and index data is shared with 'other',
+	// such that copies of the same model surface can share their render storage.
 	StaticModelSurface(const StaticModelSurface& other);
 
 	/** Get the containing AABB for this surface.
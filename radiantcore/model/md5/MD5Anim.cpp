@@ -2,6 +2,7 @@
 
 #include "itextstream.h"
 #include "string/convert.h"
+#include "MD5BinaryCache.h"
 
 namespace md5
 {
@@ -11,6 +12,27 @@ MD5Anim::MD5Anim() :
 	_numAnimatedComponents(0)
 {}
 
+namespace
+{
+
+// The number of frame values used by a joint animating the given components
+std::size_t getNumKeys(std::size_t animComponents)
+{
+	std::size_t numKeys = 0;
+
+	for (std::size_t bit = Joint::X; bit < Joint::INVALID_COMPONENT; bit <<= 1)
+	{
+		if (animComponents & bit)
+		{
+			++numKeys;
+		}
+	}
+
+	return numKeys;
+}
+
+}
+
 void MD5Anim::parseJointHierarchy(parser::DefTokeniser& tok)
 {
 	tok.assertNextToken("hierarchy");
@@ -133,65 +155,169 @@ void MD5Anim::parseFrame(std::size_t frame, parser::DefTokeniser& tok)
 	tok.assertNextToken("}");
 }
 
-void MD5Anim::parseFromStream(std::istream& stream)
+bool MD5Anim::parseFromStream(std::istream& stream)
 {
-	parser::BasicDefTokeniser<std::istream> tokeniser(stream);
-	parseFromTokens(tokeniser);
+	try
+	{
+		parser::BasicDefTokeniser<std::istream> tokeniser(stream);
+		parseFromTokens(tokeniser);
+		return true;
+	}
+	catch (parser::ParseException& ex)
+	{
+		rError() << "Error parsing MD5 Animation: " << ex.what() << std::endl;
+		return false;
+	}
 }
 
 void MD5Anim::parseFromTokens(parser::DefTokeniser& tok)
 {
-	try
+	tok.assertNextToken("MD5Version");
+
+	int version = string::convert<int>(tok.nextToken());
+
+	if (version != 10)
 	{
-		tok.assertNextToken("MD5Version");
+		rWarning() << "Unexpected version encountered: " << version 
+			<< " (expected 10), will attempt to load anyway." << std::endl;
+	}
 
-		int version = string::convert<int>(tok.nextToken());
+	tok.assertNextToken("commandline");
+	_commandLine = tok.nextToken();
 
-		if (version != 10)
-		{
-			rWarning() << "Unexpected version encountered: " << version 
-				<< " (expected 10), will attempt to load anyway." << std::endl;
-		}
+	tok.assertNextToken("numFrames");
+	int numFrames = string::convert<int>(tok.nextToken());
 
-		tok.assertNextToken("commandline");
-		_commandLine = tok.nextToken();
+	tok.assertNextToken("numJoints");
+	std::size_t numJoints = string::convert<std::size_t>(tok.nextToken());
 
-		tok.assertNextToken("numFrames");
-		int numFrames = string::convert<int>(tok.nextToken());
+	// Adjust the arrays
+	_joints.resize(numJoints);
+	_bounds.resize(numFrames);
+	_baseFrame.resize(numJoints);
+	_frames.resize(numFrames);
 
-		tok.assertNextToken("numJoints");
-		std::size_t numJoints = string::convert<std::size_t>(tok.nextToken());
+	tok.assertNextToken("frameRate");
+	_frameRate = string::convert<int>(tok.nextToken());
 
-		// Adjust the arrays
-		_joints.resize(numJoints);
-		_bounds.resize(numFrames);
-		_baseFrame.resize(numJoints);
-		_frames.resize(numFrames);
+	tok.assertNextToken("numAnimatedComponents");
+	_numAnimatedComponents = string::convert<std::size_t>(tok.nextToken());
 
-		tok.assertNextToken("frameRate");
-		_frameRate = string::convert<int>(tok.nextToken());
+	// Parse hierarchy block
+	parseJointHierarchy(tok);
+	
+	// Parse bounds block
+	parseFrameBounds(tok);
 
-		tok.assertNextToken("numAnimatedComponents");
-		_numAnimatedComponents = string::convert<std::size_t>(tok.nextToken());
+	// Parse base frame
+	parseBaseFrame(tok);
 
-		// Parse hierarchy block
-		parseJointHierarchy(tok);
-		
-		// Parse bounds block
-		parseFrameBounds(tok);
+	// Parse each actual frame
+	for (std::size_t i = 0; i < _frames.size(); ++i)
+	{
+		parseFrame(i, tok);
+	}
+}
+
+void MD5Anim::writeToBinary(BinaryWriter& writer) const
+{
+	writer.writeString(_commandLine);
+	writer.write(static_cast<std::int32_t>(_frameRate));
+	writer.write(static_cast<std::uint32_t>(_numAnimatedComponents));
+
+	writer.write(static_cast<std::uint32_t>(_joints.size()));
+
+	for (std::size_t i = 0; i < _joints.size(); ++i)
+	{
+		writer.writeString(_joints[i].name);
+		writer.write(static_cast<std::int32_t>(_joints[i].parentId));
+		writer.write(static_cast<std::uint32_t>(_joints[i].animComponents));
+		writer.write(static_cast<std::uint32_t>(_joints[i].firstKey));
 
-		// Parse base frame
-		parseBaseFrame(tok);
+		writer.writeVector3(_baseFrame[i].origin);
+		writer.writeQuaternion(_baseFrame[i].orientation);
+	}
+
+	writer.write(static_cast<std::uint32_t>(_frames.size()));
+
+	for (std::size_t i = 0; i < _frames.size(); ++i)
+	{
+		writer.writeVector3(_bounds[i].origin);
+		writer.writeVector3(_bounds[i].extents);
+
+		// The frame values are stored in one block
+		writer.writeArray(_frames[i]);
+	}
+}
+
+void MD5Anim::readFromBinary(BinaryReader& reader)
+{
+	_commandLine = reader.readString();
+	_frameRate = reader.read<std::int32_t>();
+	_numAnimatedComponents = reader.read<std::uint32_t>();
+
+	// Name length, parent, components, first key, base frame origin and orientation
+	constexpr std::size_t MinJointSize = 4 * sizeof(std::uint32_t) + 7 * sizeof(double);
+
+	auto numJoints = reader.readCount(MinJointSize);
+
+	_joints.resize(numJoints);
+	_baseFrame.resize(numJoints);
+
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		_joints[i].id = static_cast<int>(i);
+		_joints[i].name = reader.readString();
+		_joints[i].parentId = reader.read<std::int32_t>();
+		_joints[i].animComponents = reader.read<std::uint32_t>();
+		_joints[i].firstKey = reader.read<std::uint32_t>();
+
+		if (_joints[i].parentId < -1 || _joints[i].parentId >= static_cast<int>(numJoints) ||
+			_joints[i].parentId == static_cast<int>(i))
+		{
+			throw BinaryCacheException("Invalid joint parent");
+		}
 
-		// Parse each actual frame
-		for (std::size_t i = 0; i < _frames.size(); ++i)
+		if (_joints[i].animComponents >= Joint::INVALID_COMPONENT)
 		{
-			parseFrame(i, tok);
+			throw BinaryCacheException("Invalid joint components");
 		}
+
+		// The frame keys of the joint are read without checks, they must be within the frame data
+		if (_joints[i].firstKey + getNumKeys(_joints[i].animComponents) > _numAnimatedComponents)
+		{
+			throw BinaryCacheException("Joint keys out of range");
+		}
+
+		// Add this joint as child to its parent joint
+		if (_joints[i].parentId >= 0)
+		{
+			_joints[_joints[i].parentId].children.push_back(_joints[i].id);
+		}
+
+		_baseFrame[i].origin = reader.readVector3();
+		_baseFrame[i].orientation = reader.readQuaternion();
 	}
-	catch (parser::ParseException& ex)
+
+	// Bounds and the value count of the frame
+	constexpr std::size_t MinFrameSize = 6 * sizeof(double) + sizeof(std::uint32_t);
+
+	auto numFrames = reader.readCount(MinFrameSize);
+
+	_bounds.resize(numFrames);
+	_frames.resize(numFrames);
+
+	for (std::size_t i = 0; i < numFrames; ++i)
 	{
-		rError() << "Error parsing MD5 Animation: " << ex.what() << std::endl;
+		_bounds[i].origin = reader.readVector3();
+		_bounds[i].extents = reader.readVector3();
+
+		reader.readArray(_frames[i]);
+
+		if (_frames[i].size() != _numAnimatedComponents)
+		{
+			throw BinaryCacheException("Frame value count mismatch");
+		}
 	}
 }
 
@@ -11,6 +11,8 @@ namespace md5
 {
 
 class MD5AnimTokeniser;
+class BinaryWriter;
+class BinaryReader;
 
 class MD5Anim :
 	public IMD5Anim
@@ -72,9 +74,17 @@ public:
 		return _frames[index];
 	}
 
-	void parseFromStream(std::istream& stream);
+	// Parses the anim from its text form, returns false if the text is malformed
+	bool parseFromStream(std::istream& stream);
+
+	// Stores the parsed anim in its compiled binary form
+	void writeToBinary(BinaryWriter& writer) const;
+
+	// Reads the anim from its compiled binary form, throws BinaryCacheException on failure
+	void readFromBinary(BinaryReader& reader);
 
 private:
+	// Throws parser::ParseException on failure
 	void parseFromTokens(parser::DefTokeniser& tok);
 	void parseJointHierarchy(parser::DefTokeniser& tok);
 	void parseFrameBounds(parser::DefTokeniser& tok);
@@ -4,6 +4,10 @@
 #include "ifilesystem.h"
 #include "itextstream.h"
 #include "parser/DefTokeniser.h"
+#include "stream/BufferInputStream.h"
+#include "stream/ScopedArchiveBuffer.h"
+#include "MD5BinaryCache.h"
+#include "MD5Skeleton.h"
 
 namespace md5
 {
@@ -19,7 +23,7 @@ IMD5AnimPtr MD5AnimationCache::getAnim(const std::string& vfsPath)
 	}
 
 	// Not found, construct new animation with the given path
-	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(vfsPath);
+	ArchiveFilePtr file = GlobalFileSystem().openFile(vfsPath);
 
 	if (file == NULL)
 	{
@@ -27,11 +31,27 @@ IMD5AnimPtr MD5AnimationCache::getAnim(const std::string& vfsPath)
 		return IMD5AnimPtr();
 	}
 
-	std::istream inputStream(&file->getInputStream());
-	
-	// Create the anim from scratch
+	// Read the whole file, its contents are identifying the compiled version
+	archive::ScopedArchiveBuffer buffer(*file);
+	auto sourceData = reinterpret_cast<const char*>(buffer.buffer);
+	auto sourceHash = MD5BinaryCache::getSourceHash(sourceData, buffer.length);
+
 	MD5AnimPtr anim(new MD5Anim);
-	anim->parseFromStream(inputStream);
+
+	if (!MD5BinaryCache::load(vfsPath, sourceHash, [&](BinaryReader& reader) { anim->readFromBinary(reader); }))
+	{
+		// Create the anim from scratch
+		anim.reset(new MD5Anim);
+
+		stream::BufferInputStream textStream(sourceData, buffer.length);
+		std::istream inputStream(&textStream);
+
+		// Only store a compiled version of anims that have been parsed completely
+		if (anim->parseFromStream(inputStream))
+		{
+			MD5BinaryCache::save(vfsPath, sourceHash, [&](BinaryWriter& writer) { anim->writeToBinary(writer); });
+		}
+	}
 
 	// Store the anim in our cache
 	_animations.insert(AnimationMap::value_type(vfsPath, anim));
@@ -39,6 +59,43 @@ IMD5AnimPtr MD5AnimationCache::getAnim(const std::string& vfsPath)
 	return anim;
 }
 
+IMD5Anim::FramePosePtr MD5AnimationCache::getFramePose(const IMD5AnimPtr& anim, std::size_t frame)
+{
+	std::lock_guard<std::mutex> lock(_framePoseLock);
+
+	auto found = _framePoses.find(anim.get());
+
+	// A different anim might have been allocated at the address of an old one
+	if (found == _framePoses.end() || found->second.anim.lock() != anim)
+	{
+		// Drop the poses of all anims which are gone
+		for (auto i = _framePoses.begin(); i != _framePoses.end();)
+		{
+			if (i->second.anim.expired())
+			{
+				_framePoses.erase(i++);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		found = _framePoses.emplace(anim.get(), FramePoses()).first;
+		found->second.anim = anim;
+		found->second.frames.resize(anim->getNumFrames());
+	}
+
+	auto& pose = found->second.frames[frame];
+
+	if (!pose)
+	{
+		pose = MD5Skeleton::calculateFramePose(*anim, frame);
+	}
+
+	return pose;
+}
+
 const std::string& MD5AnimationCache::getName() const
 {
 	static std::string _name(MODULE_ANIMATIONCACHE);
@@ -64,6 +121,7 @@ void MD5AnimationCache::initialiseModule(const IApplicationContext& ctx)
 void MD5AnimationCache::shutdownModule()
 {
 	_animations.clear();
+	_framePoses.clear();
 }
 
 } // namespace
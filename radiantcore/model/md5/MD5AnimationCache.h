@@ -2,6 +2,7 @@
 
 #include "imd5anim.h"
 #include <map>
+#include <mutex>
 
 #include "MD5Anim.h"
 
@@ -16,9 +17,21 @@ private:
 	typedef std::map<std::string, MD5AnimPtr> AnimationMap;
 	AnimationMap _animations;
 
+	// The calculated frame poses of an animation
+	struct FramePoses
+	{
+		// Used to detect anims which have been destroyed in the meantime
+		std::weak_ptr<IMD5Anim> anim;
+		std::vector<IMD5Anim::FramePosePtr> frames;
+	};
+
+	std::map<const IMD5Anim*, FramePoses> _framePoses;
+	std::mutex _framePoseLock;
+
 public:
 	// IAnimationCache implementation
 	IMD5AnimPtr getAnim(const std::string& vfsPath);
+	IMD5Anim::FramePosePtr getFramePose(const IMD5AnimPtr& anim, std::size_t frame) override;
 
 	// RegisterableModule implementation
 	const std::string& getName() const;
@@ -0,0 +1,141 @@
+#include "MD5BinaryCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "imodule.h"
+#include "itextstream.h"
+#include "os/fs.h"
+#include "math/Hash.h"
+
+namespace md5
+{
+
+namespace
+{
+	constexpr char FileMagic[8] = { 'D', 'R', 'M', 'D', '5', 'B', 'I', 'N' };
+
+	// Increase this whenever the layout of the compiled data changes
+	constexpr std::uint32_t FormatVersion = 1;
+
+	constexpr std::uint32_t EndMarker = 0x444E4521; // "!END"
+}
+
+std::string MD5BinaryCache::getSourceHash(const char* data, std::size_t length)
+{
+	math::Hash hash;
+	hash.addString(std::string(data, length));
+
+	return hash;
+}
+
+bool MD5BinaryCache::load(const std::string& vfsPath, const std::string& sourceHash,
+	const std::function<void(BinaryReader&)>& readFunc)
+{
+	std::ifstream stream(getCacheFilePath(vfsPath), std::ios::binary | std::ios::ate);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	// Read the whole file in one go, the data is decoded from memory
+	std::vector<char> data(static_cast<std::size_t>(stream.tellg()));
+
+	stream.seekg(0);
+
+	if (!stream.read(data.data(), data.size()))
+	{
+		return false;
+	}
+
+	try
+	{
+		BinaryReader reader(data.data(), data.size());
+
+		for (auto c : FileMagic)
+		{
+			if (reader.read<char>() != c) return false;
+		}
+
+		if (reader.read<std::uint32_t>() != FormatVersion ||
+			reader.read<std::uint8_t>() != sizeof(std::size_t))
+		{
+			return false; // created by a different build
+		}
+
+		if (reader.readString() != sourceHash)
+		{
+			return false; // source file has been changed
+		}
+
+		readFunc(reader);
+
+		return reader.read<std::uint32_t>() == EndMarker && reader.isAtEnd();
+	}
+	catch (const BinaryCacheException& ex)
+	{
+		rWarning() << "Compiled file for " << vfsPath << " is damaged: " << ex.what() << std::endl;
+		return false;
+	}
+}
+
+void MD5BinaryCache::save(const std::string& vfsPath, const std::string& sourceHash,
+	const std::function<void(BinaryWriter&)>& writeFunc)
+{
+	BinaryWriter writer;
+
+	for (auto c : FileMagic)
+	{
+		writer.write(c);
+	}
+
+	writer.write(FormatVersion);
+	writer.write(static_cast<std::uint8_t>(sizeof(std::size_t)));
+	writer.writeString(sourceHash);
+
+	writeFunc(writer);
+
+	writer.write(EndMarker);
+
+	fs::path path = getCacheFilePath(vfsPath);
+
+	// Write to a temporary file first, readers must never see a half-written file
+	auto tempPath = path;
+	tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+	try
+	{
+		fs::create_directories(path.parent_path());
+
+		std::ofstream stream(tempPath.string(), std::ios::binary | std::ios::trunc);
+		stream.write(writer.getData().data(), writer.getData().size());
+		stream.close();
+
+		if (stream.fail())
+		{
+			rWarning() << "Could not write compiled file " << tempPath.string() << std::endl;
+			std::remove(tempPath.string().c_str());
+			return;
+		}
+
+		fs::rename(tempPath, path);
+	}
+	catch (const fs::filesystem_error& ex)
+	{
+		rWarning() << "Could not store compiled file for " << vfsPath << ": " << ex.what() << std::endl;
+
+		std::remove(tempPath.string().c_str());
+	}
+}
+
+std::string MD5BinaryCache::getCacheFilePath(const std::string& vfsPath)
+{
+	math::Hash pathHash;
+	pathHash.addString(vfsPath);
+
+	return module::GlobalModuleRegistry().getApplicationContext().getCacheDataPath() +
+		"md5/" + static_cast<std::string>(pathHash) + ".bin";
+}
+
+}
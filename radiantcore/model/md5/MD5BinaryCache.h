@@ -0,0 +1,201 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "math/Vector3.h"
+#include "math/Quaternion.h"
+
+namespace md5
+{
+
+// Thrown when reading beyond the end of the binary data
+class BinaryCacheException :
+	public std::runtime_error
+{
+public:
+	BinaryCacheException(const std::string& message) :
+		std::runtime_error(message)
+	{}
+};
+
+// Appends values in native byte order to a memory block
+class BinaryWriter
+{
+private:
+	std::string _data;
+
+public:
+	template<typename T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written");
+		_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// Writes the number of elements, followed by all of them in one block
+	template<typename T>
+	void writeArray(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written");
+		write(static_cast<std::uint32_t>(values.size()));
+		_data.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+
+	void writeString(const std::string& value)
+	{
+		write(static_cast<std::uint32_t>(value.size()));
+		_data.append(value);
+	}
+
+	void writeVector3(const Vector3& value)
+	{
+		write(value.x());
+		write(value.y());
+		write(value.z());
+	}
+
+	void writeQuaternion(const Quaternion& value)
+	{
+		write(value.x());
+		write(value.y());
+		write(value.z());
+		write(value.w());
+	}
+
+	const std::string& getData() const
+	{
+		return _data;
+	}
+};
+
+// Reads the values stored by the BinaryWriter from a memory block
+class BinaryReader
+{
+private:
+	const char* _pos;
+	const char* _end;
+
+public:
+	BinaryReader(const char* data, std::size_t length) :
+		_pos(data),
+		_end(data + length)
+	{}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		readBlock(&value, sizeof(T));
+		return value;
+	}
+
+	// Reads an element count and checks that the remaining data can hold that many
+	// elements of (at least) the given size. Counts read from a damaged file
+	// must not be used to allocate storage before they have been checked.
+	std::size_t readCount(std::size_t minElementSize)
+	{
+		auto count = read<std::uint32_t>();
+
+		if (static_cast<std::size_t>(_end - _pos) / minElementSize < count)
+		{
+			throw BinaryCacheException("Element count exceeds data size");
+		}
+
+		return count;
+	}
+
+	template<typename T>
+	void readArray(std::vector<T>& values)
+	{
+		auto size = readCount(sizeof(T));
+
+		values.resize(size);
+		readBlock(values.data(), size * sizeof(T));
+	}
+
+	std::string readString()
+	{
+		auto length = read<std::uint32_t>();
+		ensureAvailable(length);
+
+		std::string value(_pos, length);
+		_pos += length;
+
+		return value;
+	}
+
+	Vector3 readVector3()
+	{
+		auto x = read<double>();
+		auto y = read<double>();
+		auto z = read<double>();
+
+		return Vector3(x, y, z);
+	}
+
+	Quaternion readQuaternion()
+	{
+		auto x = read<double>();
+		auto y = read<double>();
+		auto z = read<double>();
+		auto w = read<double>();
+
+		return Quaternion(x, y, z, w);
+	}
+
+	bool isAtEnd() const
+	{
+		return _pos == _end;
+	}
+
+private:
+	void ensureAvailable(std::size_t length)
+	{
+		if (static_cast<std::size_t>(_end - _pos) < length)
+		{
+			throw BinaryCacheException("Unexpected end of data");
+		}
+	}
+
+	void readBlock(void* target, std::size_t length)
+	{
+		ensureAvailable(length);
+
+		std::memcpy(target, _pos, length);
+		_pos += length;
+	}
+};
+
+/**
+ * Stores the parsed contents of md5mesh and md5anim files in a compiled binary
+ * form in the user's cache folder, such that later loads of the same file can
+ * skip the text parsing.
+ *
+ * A compiled file is identified by the VFS path of its source and is only used
+ * if the source file still has the same contents.
+ */
+class MD5BinaryCache
+{
+public:
+	// Calculates the hash of the given source file contents
+	static std::string getSourceHash(const char* data, std::size_t length);
+
+	// Tries to read the compiled file of the given source, returns false if there
+	// is no such file, or if it is outdated or damaged
+	static bool load(const std::string& vfsPath, const std::string& sourceHash,
+		const std::function<void(BinaryReader&)>& readFunc);
+
+	// Writes the compiled file for the given source
+	static void save(const std::string& vfsPath, const std::string& sourceHash,
+		const std::function<void(BinaryWriter&)>& writeFunc);
+
+private:
+	static std::string getCacheFilePath(const std::string& vfsPath);
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 #include "math/Vector3.h"
 #include "math/Quaternion.h"
 
@@ -77,6 +78,19 @@ struct MD5Weight
 
 typedef std::vector<MD5Weight> MD5Weights;
 
+/**
+ * The weights of a mesh in structure-of-arrays layout, used for skinning.
+ * The positions are pre-multiplied with the weight factors.
+ */
+struct MD5SkinningWeights
+{
+	std::vector<std::uint32_t> joints;
+	std::vector<double> factors;
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> z;
+};
+
 // The combination of vertices, triangles and weighting information
 // represents our MD5 mesh - using this info it's possible to create
 // the actual rendered geometry (position, normals, etc.)
@@ -85,6 +99,9 @@ struct MD5Mesh
 	MD5Verts	vertices;
 	MD5Tris		triangles;
 	MD5Weights	weights;
+
+	// The weights above, prepared for skinning
+	MD5SkinningWeights skinningWeights;
 };
 typedef std::shared_ptr<MD5Mesh> MD5MeshPtr;
 
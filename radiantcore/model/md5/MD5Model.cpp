@@ -6,11 +6,19 @@
 #include "string/convert.h"
 #include "math/Quaternion.h"
 #include "math/Ray.h"
+#include "ParallelForEach.h"
 #include "MD5DataStructures.h"
+#include "MD5BinaryCache.h"
 
 namespace md5
 {
 
+namespace
+{
+	// Models with fewer vertices are not worth the thread overhead
+	constexpr std::size_t MIN_VERTICES_FOR_PARALLEL_SKINNING = 4096;
+}
+
 MD5Model::MD5Model() :
 	_polyCount(0),
 	_vertexCount(0)
@@ -270,23 +278,87 @@ void MD5Model::parseFromTokens(parser::DefTokeniser& tok)
 
 		surface.parseFromTokens(tok);
 
-		// Build the index array - this has to happen at least once
-		surface.buildIndexArray();
+		finishSurface(surface);
+	}
+
+	updateAABB();
+	updateMaterialList();
+}
+
+void MD5Model::writeToBinary(BinaryWriter& writer) const
+{
+	writer.write(static_cast<std::uint32_t>(_joints.size()));
+
+	for (const auto& joint : _joints)
+	{
+		writer.write(static_cast<std::int32_t>(joint.parent));
+		writer.writeVector3(joint.position);
+		writer.writeQuaternion(joint.rotation);
+	}
+
+	writer.write(static_cast<std::uint32_t>(_surfaces.size()));
+
+	for (const auto& surface : _surfaces)
+	{
+		surface->writeToBinary(writer);
+	}
+}
+
+void MD5Model::readFromBinary(BinaryReader& reader)
+{
+	_vertexCount = 0;
+	_polyCount = 0;
+
+	// Parent, position and rotation
+	constexpr std::size_t JointSize = sizeof(std::int32_t) + 7 * sizeof(double);
+
+	_joints.resize(reader.readCount(JointSize));
 
-		// Build the default vertex array
-		surface.updateToDefaultPose(joints);
+	for (auto& joint : _joints)
+	{
+		joint.parent = reader.read<std::int32_t>();
+		joint.position = reader.readVector3();
+		joint.rotation = reader.readQuaternion();
 
-		// Update the vertexcount
-		_vertexCount += surface.getNumVertices();
+		if (joint.parent < -1 || joint.parent >= static_cast<int>(_joints.size()))
+		{
+			throw BinaryCacheException("Invalid joint parent");
+		}
+	}
 
-		// Update the polycount
-		_polyCount += surface.getNumTriangles();
+	// Shader name length and the vertex, triangle and weight counts
+	constexpr std::size_t MinMeshSize = 4 * sizeof(std::uint32_t);
+
+	auto numMeshes = reader.readCount(MinMeshSize);
+
+	for (std::size_t i = 0; i < numMeshes; ++i)
+	{
+		MD5Surface& surface = createNewSurface();
+
+		surface.readFromBinary(reader, _joints.size());
+
+		finishSurface(surface);
 	}
 
 	updateAABB();
 	updateMaterialList();
 }
 
+void MD5Model::finishSurface(MD5Surface& surface)
+{
+	// Build the index array - this has to happen at least once
+	surface.buildIndexArray();
+
+	// Build the default vertex array
+	surface.updateToDefaultPose(_joints);
+
+	// Update the vertexcount
+	_vertexCount += surface.getNumVertices();
+
+	// Update the polycount
+	_polyCount += surface.getNumTriangles();
+}
+
 Vector3 MD5Model::parseVector3(parser::DefTokeniser& tok) {
 	tok.assertNextToken("(");
 
@@ -303,6 +375,9 @@ void MD5Model::setAnim(const IMD5AnimPtr& anim)
 {
 	_anim = anim;
 
+	// The surfaces might be reset below, don't let the skeleton skip the next update
+	_skeleton.clear();
+
 	if (!_anim)
 	{
         for (const auto& surface : _surfaces)
@@ -321,13 +396,24 @@ void MD5Model::updateAnim(std::size_t time)
 {
 	if (!_anim) return; // nothing to do
 
-	// Update our joint hierarchy first
-	_skeleton.update(_anim, time);
+	// Update our joint hierarchy first, nothing to do if the pose didn't change
+	if (!_skeleton.update(_anim, time)) return;
 
-    for (const auto& surface : _surfaces)
-	{
-		surface->updateToSkeleton(_skeleton);
-	}
+    if (_surfaces.size() < 2 || _vertexCount < MIN_VERTICES_FOR_PARALLEL_SKINNING)
+    {
+        for (const auto& surface : _surfaces)
+        {
+            surface->updateToSkeleton(_skeleton);
+        }
+    }
+    else
+    {
+        // The surfaces are independent of each other, skin them in parallel
+        parallel::forEachIndex(_surfaces.size(), [&](std::size_t s)
+        {
+            _surfaces[s]->updateToSkeleton(_skeleton);
+        });
+    }
 
     updateAABB();
 
@@ -12,6 +12,9 @@
 namespace md5
 {
 
+class BinaryWriter;
+class BinaryReader;
+
 /**
  * A geometry/anim/shader/skin managing object for MD5 models which
  * is embedded into an MD5ModelNode. Each MD5Model object references
@@ -66,6 +69,12 @@ public:
 	 */
 	void parseFromTokens(parser::DefTokeniser& tok);
 
+	// Stores the parsed model data in its compiled binary form
+	void writeToBinary(BinaryWriter& writer) const;
+
+	// Reads the model data from its compiled binary form, throws BinaryCacheException on failure
+	void readFromBinary(BinaryReader& reader);
+
     const MD5Skeleton& getSkeleton() const
     {
         return _skeleton;
@@ -133,6 +142,9 @@ private:
 	// Creates a new MD5Surface, adds it to the local list and returns the reference
 	MD5Surface& createNewSurface();
 
+	// Builds the render data of a freshly loaded surface
+	void finishSurface(MD5Surface& surface);
+
 	// Re-populates the list of active shader names
 	void updateMaterialList();
 };
@@ -6,10 +6,12 @@
 #include "ishaders.h"
 #include "imodelcache.h"
 #include "ifilesystem.h"
-#include "stream/BinaryToTextInputStream.h"
+#include "stream/BufferInputStream.h"
+#include "stream/ScopedArchiveBuffer.h"
 #include "os/path.h"
 
 #include "MD5ModelNode.h"
+#include "MD5BinaryCache.h"
 
 namespace md5
  {
@@ -82,8 +84,22 @@ model::IModelPtr MD5ModelLoader::loadModelFromPath(const std::string& path)
     // Set the filename this model was loaded from
     model->setFilename(os::getFilename(file->getName()));
 
-    // greebo: Get the Inputstream from the given file
-    stream::BinaryToTextInputStream<InputStream> inputStream(file->getInputStream());
+    // Read the whole file, its contents are identifying the compiled version
+    archive::ScopedArchiveBuffer buffer(*file);
+    auto sourceData = reinterpret_cast<const char*>(buffer.buffer);
+    auto sourceHash = MD5BinaryCache::getSourceHash(sourceData, buffer.length);
+
+    if (MD5BinaryCache::load(path, sourceHash, [&](BinaryReader& reader) { model->readFromBinary(reader); }))
+    {
+        return model;
+    }
+
+    // No usable compiled file, start over with a fresh model
+    model = std::make_shared<MD5Model>();
+    model->setModelPath(path);
+    model->setFilename(os::getFilename(file->getName()));
+
+    stream::BufferInputStream inputStream(sourceData, buffer.length);
 
     // Construct a Tokeniser object and start reading the file
     try
@@ -94,6 +110,8 @@ model::IModelPtr MD5ModelLoader::loadModelFromPath(const std::string& path)
         // Invoke the parser routine (might throw)
         model->parseFromTokens(tokeniser);
 
+        MD5BinaryCache::save(path, sourceHash, [&](BinaryWriter& writer) { model->writeToBinary(writer); });
+
         // Load was successful, return the model
         return model;
     }
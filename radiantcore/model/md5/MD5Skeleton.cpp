@@ -65,142 +65,261 @@ namespace
 	}
 }
 
-void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
-{
-	_anim = anim;
+MD5Skeleton::MD5Skeleton() :
+	_curFrame(0),
+	_nextFrame(0),
+	_nextFrameFrac(0)
+{}
 
-	// Update the joint positions, recursively, starting from the first
-	// Only root nodes need to be processed, the children are reached through them
-	std::size_t numJoints = _anim ? _anim->getNumJoints() : 0;
+bool MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
+{
+	std::size_t numFrames = anim ? anim->getNumFrames() : 0;
 
-	// Ensure the correct size
-	if (_skeleton.size() != numJoints)
+	if (numFrames == 0 || anim->getNumJoints() == 0)
 	{
-		_skeleton.resize(numJoints);
+		// Nothing to pose
+		clear();
+		return false;
 	}
 
 	// Calculate the current frame number
-	float timePerFrameMsec = 1000 / static_cast<float>(_anim->getFrameRate());
+	float timePerFrameMsec = 1000 / static_cast<float>(anim->getFrameRate());
 	
 	float frameTime = time / timePerFrameMsec;
 
 	// Pre-calculate the weighting of each frame
 	float nextFrameFrac = float_mod(frameTime, 1.0f);
+
+	std::size_t curFrame = static_cast<std::size_t>(std::floor(frameTime)) % numFrames;
+	std::size_t nextFrame = curFrame == numFrames - 1 ? curFrame : (curFrame + 1) % numFrames;
+
+	// Nothing to do if the skeleton is already in this pose
+	if (anim == _anim && !_skeleton.empty() && curFrame == _curFrame &&
+		nextFrame == _nextFrame && nextFrameFrac == _nextFrameFrac)
+	{
+		return false;
+	}
+
+	_anim = anim;
+	_curFrame = curFrame;
+	_nextFrame = nextFrame;
+	_nextFrameFrac = nextFrameFrac;
+
+	// The poses of the animation frames are shared by all models
+	auto curPose = GlobalAnimationCache().getFramePose(_anim, curFrame);
+
+	if (nextFrameFrac == 0 || nextFrame == curFrame)
+	{
+		// Exactly on a frame, the finished pose can be used as it is
+		_skeleton = curPose->keys;
+		updateJointTransforms();
+		return true;
+	}
+
+	auto nextPose = GlobalAnimationCache().getFramePose(_anim, nextFrame);
+
+	std::size_t numJoints = _anim->getNumJoints();
 	float curFrameFrac = 1.0f - nextFrameFrac;
 
-	std::size_t curFrame = static_cast<std::size_t>(std::floor(frameTime)) % _anim->getNumFrames();
-	std::size_t nextFrame = curFrame == _anim->getNumFrames() -1 ? curFrame : (curFrame + 1) % _anim->getNumFrames();
+	_skeleton.resize(numJoints);
 
-	// Apply the current frame keys to the base frame
+	// Interpolate the frame keys relative to their parents
 	for (std::size_t i = 0; i < numJoints; ++i)
 	{
 		const Joint& joint = _anim->getJoint(i);
-		const IMD5Anim::Key& baseKey = _anim->getBaseFrameKey(joint.id);
+		const IMD5Anim::Key& cur = curPose->localKeys[i];
+		const IMD5Anim::Key& next = nextPose->localKeys[i];
+
+		_skeleton[i].origin = cur.origin;
+
+		// Animate each vector component, interpolating values in between frames
+		if (joint.animComponents & Joint::X)
+		{
+			_skeleton[i].origin.x() = cur.origin.x() * curFrameFrac + next.origin.x() * nextFrameFrac;
+		}
+
+		if (joint.animComponents & Joint::Y)
+		{
+			_skeleton[i].origin.y() = cur.origin.y() * curFrameFrac + next.origin.y() * nextFrameFrac;
+		}
+
+		if (joint.animComponents & Joint::Z)
+		{
+			_skeleton[i].origin.z() = cur.origin.z() * curFrameFrac + next.origin.z() * nextFrameFrac;
+		}
+
+		if (joint.animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL))
+		{
+			_skeleton[i].orientation = slerp(cur.orientation, next.orientation, nextFrameFrac).getNormalised();
+		}
+		else
+		{
+			_skeleton[i].orientation = cur.orientation;
+		}
+	}
+
+	// Update the joint positions, recursively, starting from the first
+	// Only root nodes need to be processed, the children are reached through them
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		if (_anim->getJoint(i).parentId == -1)
+		{
+			updateJointRecursively(*_anim, _skeleton, i);
+		}
+	}
+
+	updateJointTransforms();
+	return true;
+}
+
+void MD5Skeleton::clear()
+{
+	_anim.reset();
+	_skeleton.clear();
+	_jointTransforms.clear();
+}
+
+IMD5Anim::FramePosePtr MD5Skeleton::calculateFramePose(const IMD5Anim& anim, std::size_t frame)
+{
+	auto pose = std::make_shared<IMD5Anim::FramePose>();
+
+	std::size_t numJoints = anim.getNumJoints();
+	const IMD5Anim::FrameKeys& frameKeys = anim.getFrameKeys(frame);
+
+	pose->localKeys.resize(numJoints);
+
+	// Apply the frame keys to the base frame
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		const Joint& joint = anim.getJoint(i);
 
 		// Apply base frame
-		_skeleton[i].origin = baseKey.origin;
-		_skeleton[i].orientation = baseKey.orientation;
-		
-		// Apply actual frame data
-		const IMD5Anim::FrameKeys& cur = _anim->getFrameKeys(curFrame);
-		const IMD5Anim::FrameKeys& next = _anim->getFrameKeys(nextFrame);
+		IMD5Anim::Key& localKey = pose->localKeys[i];
+		localKey = anim.getBaseFrameKey(joint.id);
 
 		// The joint.firstKey member holds the offset into the frame data array
 		std::size_t key = joint.firstKey;
 
-		// Shortcuts for handling the rotations
-		Quaternion& orientation = _skeleton[i].orientation;
-		Quaternion nextOrientation = baseKey.orientation;
-
-		// Animate each vector component, interpolating values in between frames
-
 		if (joint.animComponents & Joint::X)
 		{
-			_skeleton[i].origin.x() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
+			localKey.origin.x() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & Joint::Y)
 		{
-			_skeleton[i].origin.y() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
+			localKey.origin.y() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & Joint::Z)
 		{
-			_skeleton[i].origin.z() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
+			localKey.origin.z() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & Joint::YAW)
 		{
-			orientation.x() = cur[key];
-			nextOrientation.x() = next[key];
-			key++;
+			localKey.orientation.x() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & Joint::PITCH)
 		{
-			orientation.y() = cur[key];
-			nextOrientation.y() = next[key];
-			key++;
+			localKey.orientation.y() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & Joint::ROLL)
 		{
-			orientation.z() = cur[key];
-			nextOrientation.z() = next[key];
-			key++;
+			localKey.orientation.z() = frameKeys[key++];
 		}
 
 		if (joint.animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL))
 		{
-			auto lSq = orientation.getVector3().getLengthSquared();
-            auto w = -sqrt(1.0 - lSq);
-
-			orientation.w() = isNaN(w) ? 0 : w;
+			auto lSq = localKey.orientation.getVector3().getLengthSquared();
+			auto w = -sqrt(1.0 - lSq);
 
-			lSq = nextOrientation.getVector3().getLengthSquared();
-			w = -sqrt(1.0f - lSq);
+			localKey.orientation.w() = isNaN(w) ? 0 : w;
+		}
+	}
 
-			nextOrientation.w() = isNaN(w) ? 0 : w;
+	// The finished pose is using the normalised rotations, with the hierarchy applied
+	pose->keys = pose->localKeys;
 
-			orientation = slerp(orientation, nextOrientation, nextFrameFrac).getNormalised();
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		if (anim.getJoint(i).animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL))
+		{
+			pose->keys[i].orientation = pose->keys[i].orientation.getNormalised();
 		}
 	}
 
 	for (std::size_t i = 0; i < numJoints; ++i)
 	{
-		const Joint& joint = _anim->getJoint(i);
-
-		if (joint.parentId == -1)
+		if (anim.getJoint(i).parentId == -1)
 		{
-			updateJointRecursively(i);
+			updateJointRecursively(anim, pose->keys, i);
 		}
 	}
+
+	return pose;
+}
+
+void MD5Skeleton::updateJointTransforms()
+{
+	_jointTransforms.resize(_skeleton.size());
+
+	// Convert the joint rotations to matrices once, instead of once per weight
+	for (std::size_t i = 0; i < _skeleton.size(); ++i)
+	{
+		const Quaternion& q = _skeleton[i].orientation;
+		JointTransform& transform = _jointTransforms[i];
+
+		double xx = q.x() * q.x();
+		double yy = q.y() * q.y();
+		double zz = q.z() * q.z();
+		double ww = q.w() * q.w();
+
+		double xy2 = q.x() * q.y() * 2;
+		double xz2 = q.x() * q.z() * 2;
+		double xw2 = q.x() * q.w() * 2;
+		double yz2 = q.y() * q.z() * 2;
+		double yw2 = q.y() * q.w() * 2;
+		double zw2 = q.z() * q.w() * 2;
+
+		// Same as Quaternion::transformPoint
+		transform.rotation[0] = ww + xx - yy - zz;
+		transform.rotation[1] = xy2 - zw2;
+		transform.rotation[2] = xz2 + yw2;
+		transform.rotation[3] = xy2 + zw2;
+		transform.rotation[4] = ww - xx + yy - zz;
+		transform.rotation[5] = yz2 - xw2;
+		transform.rotation[6] = xz2 - yw2;
+		transform.rotation[7] = yz2 + xw2;
+		transform.rotation[8] = ww - xx - yy + zz;
+
+		transform.translation[0] = _skeleton[i].origin.x();
+		transform.translation[1] = _skeleton[i].origin.y();
+		transform.translation[2] = _skeleton[i].origin.z();
+	}
 }
 
-void MD5Skeleton::updateJointRecursively(std::size_t jointId)
+void MD5Skeleton::updateJointRecursively(const IMD5Anim& anim, std::vector<IMD5Anim::Key>& keys, std::size_t jointId)
 {
-	// Reset info to base first
-	const Joint& joint = _anim->getJoint(jointId);
+	const Joint& joint = anim.getJoint(jointId);
 
 	if (joint.parentId >= 0)
 	{
 		// Joint has a parent, update this position and rotation
-		_skeleton[joint.id].orientation.preMultiplyBy(_skeleton[joint.parentId].orientation);
+		keys[joint.id].orientation.preMultiplyBy(keys[joint.parentId].orientation);
 
 		// Transform the origin of this joint using the rotation of the parent joint
-		_skeleton[joint.id].origin = _skeleton[joint.parentId].orientation.transformPoint(_skeleton[joint.id].origin);
+		keys[joint.id].origin = keys[joint.parentId].orientation.transformPoint(keys[joint.id].origin);
 			
 		// Apply the parent joint's translation to this child bone
-		_skeleton[joint.id].origin += _skeleton[joint.parentId].origin;
+		keys[joint.id].origin += keys[joint.parentId].origin;
 	}
 
 	// Update all children as well
 	for (std::vector<int>::const_iterator i = joint.children.begin(); i != joint.children.end(); ++i)
 	{
-		updateJointRecursively(*i);
+		updateJointRecursively(anim, keys, *i);
 	}
 }
 
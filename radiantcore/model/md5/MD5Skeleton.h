@@ -13,16 +13,38 @@ namespace md5
  */
 class MD5Skeleton
 {
+public:
+	// Rotation matrix (row-major) and translation of a posed joint, as used for skinning
+	struct JointTransform
+	{
+		double rotation[9];
+		double translation[3];
+	};
+
 protected:
 	// The position and orientation of the animated joints at the current time
 	std::vector<IMD5Anim::Key> _skeleton;
 
+	// The matrix form of the joint keys above
+	std::vector<JointTransform> _jointTransforms;
+
 	// The current animation, needed to get joint information etc.
 	IMD5AnimPtr _anim;
 
+	// The frames and interpolation factor the skeleton has been posed with
+	std::size_t _curFrame;
+	std::size_t _nextFrame;
+	float _nextFrameFrac;
+
 public:
-	// Update the skeleton to match the given animation at the given time
-	void update(const IMD5AnimPtr& anim, std::size_t time);
+	MD5Skeleton();
+
+	// Update the skeleton to match the given animation at the given time.
+	// Returns false if the skeleton is already in this pose (or the anim is empty).
+	bool update(const IMD5AnimPtr& anim, std::size_t time);
+
+	// Forgets the current pose, the next update() will always recalculate it
+	void clear();
 
 	std::size_t size() const
 	{
@@ -39,8 +61,18 @@ public:
 		return _anim->getJoint(index);
 	}
 
+	const std::vector<JointTransform>& getJointTransforms() const
+	{
+		return _jointTransforms;
+	}
+
+	// Calculates the pose of a single animation frame
+	static IMD5Anim::FramePosePtr calculateFramePose(const IMD5Anim& anim, std::size_t frame);
+
 private:
-	void updateJointRecursively(std::size_t jointId);
+	void updateJointTransforms();
+
+	static void updateJointRecursively(const IMD5Anim& anim, std::vector<IMD5Anim::Key>& keys, std::size_t jointId);
 };
 
 } // namespace
@@ -3,6 +3,7 @@
 #include "ivolumetest.h"
 #include "string/convert.h"
 #include "MD5Model.h"
+#include "MD5BinaryCache.h"
 #include "math/Ray.h"
 
 namespace md5
@@ -226,24 +227,53 @@ void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
 		_vertices.resize(_mesh->vertices.size());
 	}
 
-	// Deform vertices to fit the skeleton
+	const auto& transforms = skeleton.getJointTransforms();
+	const auto& weights = _mesh->skinningWeights;
+	std::size_t numWeights = weights.factors.size();
+
+	assert(numWeights == _mesh->weights.size());
+
+	_skinnedX.resize(numWeights);
+	_skinnedY.resize(numWeights);
+	_skinnedZ.resize(numWeights);
+
+	// Transform all weights in one branch-free pass over contiguous arrays,
+	// which the compiler is able to vectorise
+	const std::uint32_t* joints = weights.joints.data();
+	const double* factors = weights.factors.data();
+	const double* weightX = weights.x.data();
+	const double* weightY = weights.y.data();
+	const double* weightZ = weights.z.data();
+	double* skinnedX = _skinnedX.data();
+	double* skinnedY = _skinnedY.data();
+	double* skinnedZ = _skinnedZ.data();
+
+	for (std::size_t i = 0; i < numWeights; ++i)
+	{
+		const auto& transform = transforms[joints[i]];
+		const double* m = transform.rotation;
+		const double* t = transform.translation;
+
+		skinnedX[i] = m[0] * weightX[i] + m[1] * weightY[i] + m[2] * weightZ[i] + t[0] * factors[i];
+		skinnedY[i] = m[3] * weightX[i] + m[4] * weightY[i] + m[5] * weightZ[i] + t[1] * factors[i];
+		skinnedZ[i] = m[6] * weightX[i] + m[7] * weightY[i] + m[8] * weightZ[i] + t[2] * factors[i];
+	}
+
+	// Sum up the weights of each vertex
 	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
 	{
-		MD5Vert& vert = _mesh->vertices[j];
+		const MD5Vert& vert = _mesh->vertices[j];
 
-		Vector3 skinned(0, 0, 0);
+		double x = 0, y = 0, z = 0;
 
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
+		for (std::size_t k = vert.weight_index; k < vert.weight_index + vert.weight_count; ++k)
 		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
-			//const Joint& joint = skeleton.getJoint(weight.joint);
-
-			Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
-			skinned += (rotatedPoint + key.origin) * weight.t;
+			x += skinnedX[k];
+			y += skinnedY[k];
+			z += skinnedZ[k];
 		}
 
-		_vertices[j].vertex = skinned;
+		_vertices[j].vertex = Vertex3(x, y, z);
 		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
 		_vertices[j].normal = Normal3(0,0,0);
 	}
@@ -259,6 +289,28 @@ void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
 	updateGeometry();
 }
 
+void MD5Surface::buildSkinningWeights()
+{
+	const auto& weights = _mesh->weights;
+	auto& skinningWeights = _mesh->skinningWeights;
+
+	skinningWeights.joints.resize(weights.size());
+	skinningWeights.factors.resize(weights.size());
+	skinningWeights.x.resize(weights.size());
+	skinningWeights.y.resize(weights.size());
+	skinningWeights.z.resize(weights.size());
+
+	for (std::size_t i = 0; i < weights.size(); ++i)
+	{
+		// t * (R*v + origin) == R*(t*v) + t*origin
+		skinningWeights.joints[i] = static_cast<std::uint32_t>(weights[i].joint);
+		skinningWeights.factors[i] = weights[i].t;
+		skinningWeights.x[i] = weights[i].v.x() * weights[i].t;
+		skinningWeights.y[i] = weights[i].v.y() * weights[i].t;
+		skinningWeights.z[i] = weights[i].v.z() * weights[i].t;
+	}
+}
+
 void MD5Surface::buildVertexNormals()
 {
 	for (Indices::iterator j = _indices.begin(); j != _indices.end(); j += 3)
@@ -388,6 +440,79 @@ void MD5Surface::parseFromTokens(parser::DefTokeniser& tok)
 	// ----- END OF MESH DECL -----
 
 	tok.assertNextToken("}");
+
+	buildSkinningWeights();
+}
+
+void MD5Surface::writeToBinary(BinaryWriter& writer) const
+{
+	const MD5Mesh& mesh = *_mesh;
+
+	writer.writeString(_originalShaderName);
+
+	// Vertices and triangles are plain structs, store them in one block
+	writer.writeArray(mesh.vertices);
+	writer.writeArray(mesh.triangles);
+
+	writer.write(static_cast<std::uint32_t>(mesh.weights.size()));
+
+	for (const auto& weight : mesh.weights)
+	{
+		writer.write(weight.index);
+		writer.write(weight.joint);
+		writer.write(weight.t);
+		writer.writeVector3(weight.v);
+	}
+}
+
+void MD5Surface::readFromBinary(BinaryReader& reader, std::size_t numJoints)
+{
+	MD5Mesh& mesh = *_mesh;
+
+	setDefaultMaterial(reader.readString());
+
+	reader.readArray(mesh.vertices);
+	reader.readArray(mesh.triangles);
+
+	// Index, joint, bias and position
+	constexpr std::size_t WeightSize = 2 * sizeof(std::size_t) + sizeof(float) + 3 * sizeof(double);
+
+	mesh.weights.resize(reader.readCount(WeightSize));
+
+	for (auto& weight : mesh.weights)
+	{
+		weight.index = reader.read<std::size_t>();
+		weight.joint = reader.read<std::size_t>();
+		weight.t = reader.read<float>();
+		weight.v = reader.readVector3();
+	}
+
+	// The indices are used without checks, reject any data not matching the mesh
+	for (const auto& weight : mesh.weights)
+	{
+		if (weight.joint >= numJoints)
+		{
+			throw BinaryCacheException("Weight joint out of range");
+		}
+	}
+
+	for (const auto& vert : mesh.vertices)
+	{
+		if (vert.weight_index + vert.weight_count > mesh.weights.size())
+		{
+			throw BinaryCacheException("Vertex weight out of range");
+		}
+	}
+
+	for (const auto& tri : mesh.triangles)
+	{
+		if (tri.a >= mesh.vertices.size() || tri.b >= mesh.vertices.size() || tri.c >= mesh.vertices.size())
+		{
+			throw BinaryCacheException("Triangle vertex out of range");
+		}
+	}
+
+	buildSkinningWeights();
 }
 
 } // namespace
@@ -17,6 +17,8 @@ namespace md5
 {
 
 class MD5Skeleton;
+class BinaryWriter;
+class BinaryReader;
 
 class MD5Surface final :
 	public model::IIndexedModelSurface
@@ -42,6 +44,11 @@ private:
 	Vertices _vertices;
 	Indices _indices;
 
+	// The skinned weight positions, one array per component
+	std::vector<double> _skinnedX;
+	std::vector<double> _skinnedY;
+	std::vector<double> _skinnedZ;
+
 public:
 
 	MD5Surface();
@@ -91,12 +98,20 @@ public:
 
 	void parseFromTokens(parser::DefTokeniser& tok);
 
+	// Stores/restores the parsed mesh in its compiled binary form. The weights
+	// read from binary must refer to one of the model's numJoints joints.
+	void writeToBinary(BinaryWriter& writer) const;
+	void readFromBinary(BinaryReader& reader, std::size_t numJoints);
+
 	// Rebuild the render index array - usually needs to be called only once
 	void buildIndexArray();
 
 private:
     // Re-calculate the normal vectors
     void buildVertexNormals();
+
+	// Converts the parsed weights to the layout used for skinning
+	void buildSkinningWeights();
 };
 typedef std::shared_ptr<MD5Surface> MD5SurfacePtr;
 
@@ -64,6 +64,14 @@ extern "C"
 	#define _pico_strnicmp strncasecmp
 #endif
 
+/* storage for the few globals that are used while loading a model, such that
+   several models can be loaded in parallel */
+#if _MSC_VER
+	#define PICO_THREAD_LOCAL __declspec(thread)
+#else
+	#define PICO_THREAD_LOCAL __thread
+#endif
+
 
 /* constants */
 #define	PICO_PI	3.14159265358979323846
@@ -19,16 +19,46 @@ RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
     _offset(_stage.getOffset()),
     _viewRotation(viewRotation),
     _direction(direction),
-    _entityColour(entityColour)
+    _entityColour(entityColour),
+    _quadsValid(false),
+    _quadsTime(0)
 {
     // Geometry is written in update(), just reserve the space
 }
 
+void RenderableParticleBunch::reset(std::size_t index, Rand48::result_type randSeed)
+{
+    _index = index;
+    _randSeed = randSeed;
+
+    // Keep the allocated quad memory for the next update
+    _quads.clear();
+    _bounds = AABB();
+    _quadsValid = false;
+}
+
+bool RenderableParticleBunch::quadsAreUpToDate(std::size_t time) const
+{
+    return _quadsValid && _quadsTime == time && _quadsViewRotation == _viewRotation &&
+        _quadsDirection == _direction && _quadsEntityColour == _entityColour;
+}
+
 void RenderableParticleBunch::update(std::size_t time)
 {
+    if (quadsAreUpToDate(time))
+    {
+        return; // nothing changed since the last update
+    }
+
     _bounds = AABB();
     _quads.clear();
 
+    _quadsValid = true;
+    _quadsTime = time;
+    _quadsViewRotation = _viewRotation;
+    _quadsDirection = _direction;
+    _quadsEntityColour = _entityColour;
+
     // Length of one cycle (duration + deadtime)
     std::size_t cycleMsec = static_cast<std::size_t>(_stage.getCycleMsec());
 
@@ -56,9 +86,27 @@ void RenderableParticleBunch::update(std::size_t time)
     // This is the spacing between each particle
     std::size_t spawnSpacingMsec = static_cast<std::size_t>(spawnSpacing);
 
+    std::size_t numParticles = static_cast<std::size_t>(_stage.getCount());
+
+    // Once the last spawned particle has expired, this bunch won't produce any more quads
+    if (numParticles == 0 || cycleTime > (numParticles - 1) * spawnSpacingMsec + stageDurationMsec)
+    {
+        return;
+    }
+
+    // The emitter direction is the same for all particles, calculate the rotation
+    // of the z axis into the main direction and the gravity vector only once
+    Vector3 dir = _direction.getNormalised();
+    Vector3 zDir(0,0,1);
+
+    _directionRotation = dir.angle(zDir) != 0 ? Matrix4::getRotation(zDir, dir) : Matrix4::getIdentity();
+
+    // if "world" is set, use -z as gravity direction, otherwise use the reverse emitter direction
+    _gravity = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -dir;
+
     // Generate all particle quads, regardless of their visibility
     // Visibility is considered by not rendering particles that haven't been spawned yet
-    for (std::size_t i = 0; i < static_cast<std::size_t>(_stage.getCount()); ++i)
+    for (std::size_t i = 0; i < numParticles; ++i)
     {
         // Consider bunching parameter
         std::size_t particleStartTimeMsec = i * spawnSpacingMsec;
@@ -314,13 +362,8 @@ void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
 
 void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
 {
-    // Check if the main direction is different to the z axis
-    Vector3 dir = _direction.getNormalised();
-    Vector3 zDir(0,0,1);
-
-    double deviation = dir.angle(zDir);
-
-    Matrix4 rotation = deviation != 0 ? Matrix4::getRotation(zDir, dir) : Matrix4::getIdentity();
+    // Rotation of the z axis into the main direction (calculated in update())
+    const Matrix4& rotation = _directionRotation;
 
     // Consider offset as starting point
     particle.origin = rotation.transformPoint(_offset);
@@ -422,11 +465,8 @@ void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
         break;
     };
 
-    // Consider gravity
-    // if "world" is set, use -z as gravity direction, otherwise use the reverse emitter direction
-    Vector3 gravity = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -_direction.getNormalised();
-
-    particle.origin += gravity * _stage.getGravity() * particle.timeSecs * particle.timeSecs * 0.5f;
+    // Consider gravity (direction calculated in update())
+    particle.origin += _gravity * _stage.getGravity() * particle.timeSecs * particle.timeSecs * 0.5f;
 }
 
 Vector3 RenderableParticleBunch::getDirection(ParticleRenderInfo& particle, const Matrix4& rotation, const Vector3& distributionOffset)
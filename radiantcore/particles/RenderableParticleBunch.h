@@ -55,6 +55,18 @@ class RenderableParticleBunch
 	// The entity colour (instance owned by RenderableParticle)
 	const Vector3& _entityColour;
 
+	// The inputs the current set of quads has been generated from. The geometry of a bunch
+	// is a pure function of these, so update() can skip the regeneration if none has changed.
+	bool _quadsValid;
+	std::size_t _quadsTime;
+	Matrix4 _quadsViewRotation;
+	Vector3 _quadsDirection;
+	Vector3 _quadsEntityColour;
+
+	// Values shared by all particles of one update() pass
+	Matrix4 _directionRotation;
+	Vector3 _gravity;
+
 public:
 	// Each bunch has a defined zero-based index
 	RenderableParticleBunch(std::size_t index,
@@ -69,8 +81,13 @@ public:
 		return _index;
 	}
 
+	// Re-assigns this bunch to a different cycle, such that the instance and
+	// its quad buffer can be re-used when the particle stage moves on.
+	void reset(std::size_t index, Rand48::result_type randSeed);
+
 	// Update the particle geometry and render information.
 	// Time is specified in stage time without offset,in msecs.
+	// Does nothing if the geometry is still up to date for the given time.
 	void update(std::size_t time);
 
     // Add the renderable geometry to the given arrays
@@ -122,6 +139,9 @@ private:
 	// Makes the quad transition seamless by snapping the adjacent vertices at the midpoint
 	void snapQuads(ParticleQuad& curQuad, ParticleQuad& prevQuad);
 
+	// Returns true if the quads have been generated for the given time and the current view/direction/colour
+	bool quadsAreUpToDate(std::size_t time) const;
+
 	void calculateBounds();
 };
 typedef std::shared_ptr<RenderableParticleBunch> RenderableParticleBunchPtr;
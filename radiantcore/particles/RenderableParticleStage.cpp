@@ -37,8 +37,7 @@ void RenderableParticleStage::update(std::size_t time, const Matrix4& viewRotati
 	if (time < timeOffset)
 	{
 		// We're still in the timeoffset zone where particle spawn is inhibited
-		_bunches[0].reset();
-		_bunches[1].reset();
+		releaseBunches({}, {});
 		return;
 	}
 
@@ -170,66 +169,77 @@ void RenderableParticleStage::ensureBunches(std::size_t localTimeMSec)
 
 	std::size_t curCycleIndex = static_cast<std::size_t>(cycleFrac);
 
+	RenderableParticleBunchPtr cur;
+	RenderableParticleBunchPtr prev;
+
 	if (curCycleIndex == 0)
 	{
 		// This is the only active bunch (the first one), there is no previous cycle
 		// it's possible that this one is already existing.
-		if (!_bunches[0] || _bunches[0]->getIndex() != curCycleIndex)
-		{
-			// First bunch is not matching, re-assign
-			_bunches[0] = createBunch(curCycleIndex);
-		}
-
-		// Reset the previous bunch in any case
-		_bunches[1].reset();
+		cur = getBunch(curCycleIndex);
 	}
 	else
 	{
 		// Current cycle > 0, this means we have possibly two active ones
 		std::size_t prevCycleIndex = curCycleIndex - 1;
 
-		// Reuse any existing instances, to avoid re-instancing them all over again
-		RenderableParticleBunchPtr cur = getExistingBunchByIndex(curCycleIndex);
-		RenderableParticleBunchPtr prev = getExistingBunchByIndex(prevCycleIndex);
-
 		std::size_t numCycles = static_cast<std::size_t>(_stageDef.getCycles());
 
-		if (numCycles > 0 && curCycleIndex > numCycles)
-		{
-			// We've exceeded the maximum number of cycles
-			_bunches[0].reset();
-		}
-		else if (cur)
-		{
-			_bunches[0] = cur;
-		}
-		else
+		// Bunches beyond the maximum number of cycles stay empty
+		if (numCycles == 0 || curCycleIndex <= numCycles)
 		{
-			_bunches[0] = createBunch(curCycleIndex);
+			cur = getBunch(curCycleIndex);
 		}
 
-		if (numCycles > 0 && prevCycleIndex > numCycles)
-		{
-			// We've exceeded the maximum number of cycles
-			_bunches[1].reset();
-		}
-		else if (prev)
-		{
-			_bunches[1] = prev;
-		}
-		else
+		if (numCycles == 0 || prevCycleIndex <= numCycles)
 		{
-			_bunches[1] = createBunch(prevCycleIndex);
+			prev = getBunch(prevCycleIndex);
 		}
 	}
+
+	releaseBunches(cur, prev);
+
+	_bunches[0] = cur;
+	_bunches[1] = prev;
+}
+
+RenderableParticleBunchPtr RenderableParticleStage::getBunch(std::size_t cycleIndex)
+{
+	// Reuse any existing instances, their geometry might still be valid
+	auto existing = getExistingBunchByIndex(cycleIndex);
+
+	return existing ? existing : createBunch(cycleIndex);
 }
 
 RenderableParticleBunchPtr RenderableParticleStage::createBunch(std::size_t cycleIndex)
 {
+	// Take a bunch of a past cycle if possible, to avoid re-allocating the quad buffers
+	if (!_unusedBunches.empty())
+	{
+		auto bunch = std::move(_unusedBunches.back());
+		_unusedBunches.pop_back();
+
+		bunch->reset(cycleIndex, getSeed(cycleIndex));
+		return bunch;
+	}
+
 	return std::make_shared<RenderableParticleBunch>(cycleIndex, getSeed(cycleIndex), 
         _stageDef, _viewRotation, _direction, _entityColour);
 }
 
+void RenderableParticleStage::releaseBunches(const RenderableParticleBunchPtr& cur, const RenderableParticleBunchPtr& prev)
+{
+	for (auto& bunch : _bunches)
+	{
+		if (bunch && bunch != cur && bunch != prev)
+		{
+			_unusedBunches.emplace_back(std::move(bunch));
+		}
+
+		bunch.reset();
+	}
+}
+
 Rand48::result_type RenderableParticleStage::getSeed(std::size_t cycleIndex)
 {
 	return _seeds[cycleIndex % _seeds.size()];
@@ -30,6 +30,9 @@ class RenderableParticleStage :
 
 	std::vector<RenderableParticleBunchPtr> _bunches;
 
+	// Bunches of past cycles, waiting to be re-used by the next cycles
+	std::vector<RenderableParticleBunchPtr> _unusedBunches;
+
 	// The rotation matrix to orient particles
 	Matrix4 _viewRotation;
     // Matrix to produce world coordinates
@@ -72,8 +75,14 @@ private:
 
 	void ensureBunches(std::size_t localTimeMSec);
 
+	// Returns the existing bunch for the given cycle or creates a new one
+	RenderableParticleBunchPtr getBunch(std::size_t cycleIndex);
+
 	RenderableParticleBunchPtr createBunch(std::size_t cycleIndex);
 
+	// Moves the active bunches not contained in the given ones to the pool of unused bunches
+	void releaseBunches(const RenderableParticleBunchPtr& cur, const RenderableParticleBunchPtr& prev);
+
 	Rand48::result_type getSeed(std::size_t cycleIndex);
 
 	RenderableParticleBunchPtr getExistingBunchByIndex(std::size_t index);
@@ -22,10 +22,6 @@
 
 // ====== Helper Functions ==================================================================
 
-inline VertexPointer vertexpointer_Meshvertex(const MeshVertex* array) {
-  return VertexPointer(&array->vertex, sizeof(MeshVertex));
-}
-
 inline const Colour4b colour_for_index(std::size_t i, std::size_t width)
 {
 	static const Vector3& cornerColourVec = GlobalPatchModule().getSettings().getVertexColour(patch::PatchEditVertexType::Corners);
@@ -50,6 +46,7 @@ Patch::Patch(PatchNode& node) :
     _undoStateSaver(nullptr),
     _transformChanged(false),
     _tesselationChanged(true),
+    _controlPointsExposed(false),
     _shader(texdef_name_default())
 {
     construct();
@@ -65,6 +62,7 @@ Patch::Patch(const Patch& other, PatchNode& node) :
     _undoStateSaver(nullptr),
     _transformChanged(false),
     _tesselationChanged(true),
+    _controlPointsExposed(false),
     _shader(other._shader.getMaterialName())
 {
     // Initalise the default values
@@ -92,6 +90,7 @@ void Patch::construct()
 
 // Get the current control point array
 PatchControlArray& Patch::getControlPoints() {
+    _controlPointsExposed = true;
     return _ctrl;
 }
 
@@ -100,6 +99,11 @@ const PatchControlArray& Patch::getControlPoints() const {
     return _ctrl;
 }
 
+bool Patch::controlPointsExposed() const
+{
+    return _controlPointsExposed;
+}
+
 // Get the (temporary) transformed control point array, not the saved ones
 PatchControlArray& Patch::getControlPointsTransformed() {
     return _ctrlTransformed;
@@ -137,6 +141,7 @@ void Patch::setDims(std::size_t w, std::size_t h)
 
     _width = w;
     _height = h;
+    _node.invalidateFingerprint();
 
     if(_width * _height != _ctrl.size())
     {
@@ -195,13 +200,9 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
     // The updateTesselation routine might have produced a degenerate patch, catch this
     if (_mesh.vertices.empty()) return;
 
+    // The tesselation is culling the parts of the mesh outside the test volume
     SelectionIntersection best;
-    IndexPointer::index_type* pIndex = &_mesh.indices.front();
-
-    for (std::size_t s=0; s<_mesh.numStrips; s++) {
-        test.TestQuadStrip(vertexpointer_Meshvertex(&_mesh.vertices.front()), IndexPointer(pIndex, _mesh.lenStrips), best);
-        pIndex += _mesh.lenStrips;
-    }
+    _mesh.testSelect(test, best, _node.localToWorld());
 
     if (best.isValid()) {
         selector.addIntersection(best);
@@ -265,7 +266,7 @@ void Patch::freezeTransform()
     // Don't call controlPointsChanged() here since that one will re-apply the
     // current transformation matrix, possible the second time.
     transformChanged();
-    updateTesselation();
+    updateTesselationOrBounds();
 
     for (Observers::iterator i = _observers.begin(); i != _observers.end();)
     {
@@ -276,9 +277,11 @@ void Patch::freezeTransform()
 // callback for changed control points
 void Patch::controlPointsChanged()
 {
+    _controlPointsExposed = false;
+
     transformChanged();
     evaluateTransform();
-    updateTesselation();
+    updateTesselationOrBounds();
     _node.onControlPointsChanged();
 
     for (Observers::iterator i = _observers.begin(); i != _observers.end();)
@@ -352,6 +355,7 @@ int Patch::getShaderFlags() const
 
 // Return a defined patch control vertex at <row>,<col>
 PatchControl& Patch::ctrlAt(std::size_t row, std::size_t col) {
+    _controlPointsExposed = true;
     return _ctrl[row*_width+col];
 }
 
@@ -373,6 +377,8 @@ PatchControl& Patch::getTransformedCtrlAt(std::size_t row, std::size_t col)
 // called just before an action to save the undo state
 void Patch::undoSave()
 {
+    _node.invalidateFingerprint();
+
     // Notify the undo observer to save this patch state
     if (_undoStateSaver != NULL)
     {
@@ -484,23 +490,67 @@ void Patch::updateTesselation(bool force)
     // Only do something if the tesselation has actually changed
     if (!_tesselationChanged && !force) return;
 
-    _tesselationChanged = false;
+    generateTesselation(getVertexColour());
+    finishTesselation();
+}
 
+bool Patch::tesselationChanged() const
+{
+    return _tesselationChanged;
+}
+
+Vector4 Patch::getVertexColour() const
+{
+    auto renderEntity = _node.getRenderEntity();
+    return renderEntity ? renderEntity->getEntityColour() : Vector4(1, 1, 1, 1);
+}
+
+void Patch::generateTesselation(const Vector4& vertexColour)
+{
     if (!isValid())
     {
         _mesh.clear();
-        _localAABB = AABB();
         return;
     }
 
     // Run the tesselation code
-    _mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions(), _node.getRenderEntity());
+    _mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions(), vertexColour);
+}
+
+void Patch::finishTesselation()
+{
+    _tesselationChanged = false;
+
+    if (!isValid())
+    {
+        _localAABB = AABB();
+        return;
+    }
 
     updateAABB();
 
     _node.onTesselationChanged();
 }
 
+void Patch::updateTesselationOrBounds()
+{
+    if (_node.inScene())
+    {
+        updateTesselation();
+        return;
+    }
+
+    // Patches outside the scene (like the ones of a map being parsed) defer
+    // the mesh generation, such that it can be batched by updateTesselations()
+    if (!isValid())
+    {
+        _localAABB = AABB();
+        return;
+    }
+
+    updateAABB();
+}
+
 void Patch::invertMatrix()
 {
   undoSave();
@@ -2516,47 +2566,10 @@ bool Patch::subdivisionsFixed() const
 
 bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 {
-    std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
-
-    // Go over each quad strip and intersect the ray with its triangles
-    for (std::size_t strip = 0; strip < _mesh.numStrips; ++strip)
-    {
-        // Iterate over the indices. The +2 increment will lead up to the next quad
-        for (std::vector<RenderIndex>::const_iterator indexIter = stripStartIndex;
-            indexIter + 2 < stripStartIndex + _mesh.lenStrips; indexIter += 2)
-        {
-            Vector3 triangleIntersection;
-
-            // Run a selection test against the quad's triangles
-            {
-                const Vector3& p1 = _mesh.vertices[*indexIter].vertex;
-                const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-                const Vector3& p3 = _mesh.vertices[*(indexIter + 2)].vertex;
-
-                if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
-                {
-                    intersection = triangleIntersection;
-                    return true;
-                }
-            }
-
-            {
-                const Vector3& p1 = _mesh.vertices[*(indexIter + 2)].vertex;
-                const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-                const Vector3& p3 = _mesh.vertices[*(indexIter + 3)].vertex;
-
-                if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
-                {
-                    intersection = triangleIntersection;
-                    return true;
-                }
-            }
-        }
-
-        stripStartIndex += _mesh.lenStrips;
-    }
+    // ensure the tesselation is up to date
+    updateTesselation();
 
-    return false;
+    return _mesh.intersectRay(ray, intersection);
 }
 
 void Patch::textureChanged()
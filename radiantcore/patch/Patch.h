@@ -58,6 +58,11 @@ class Patch :
 	// TRUE if the patch tesselation needs an update
 	bool _tesselationChanged;
 
+	// TRUE if a writable reference to the control points has been handed out
+	// since the last controlPointsChanged() call. The control points might be
+	// modified through it at any time, so the node can't cache its fingerprint.
+	bool _controlPointsExposed;
+
 	// The rendersystem we're attached to, to acquire materials
 	RenderSystemWeakPtr _renderSystem;
 
@@ -167,6 +172,10 @@ public:
 	// Get the current control point array
 	PatchControlArray& getControlPoints();
 	const PatchControlArray& getControlPoints() const;
+
+	// Returns true if the control points might have been modified in place,
+	// through a reference handed out since the last controlPointsChanged() call
+	bool controlPointsExposed() const;
 	// Get the (temporary) transformed control point array, not the saved ones
 	PatchControlArray& getControlPointsTransformed();
 	const PatchControlArray& getControlPointsTransformed() const;
@@ -328,6 +337,21 @@ public:
     void updateTesselation(bool force = false) override;
     void queueTesselationUpdate();
 
+    // Returns true if the tesselation needs to be updated
+    bool tesselationChanged() const;
+
+    // The colour assigned to the tesselated vertices, as defined by the parent entity
+    Vector4 getVertexColour() const;
+
+    // Generates the mesh from the transformed control points, without notifying
+    // anyone. This doesn't touch any state shared with other patches, so it's safe
+    // to call this on several patches in parallel. finishTesselation() needs
+    // to be invoked afterwards, from the main thread.
+    void generateTesselation(const Vector4& vertexColour);
+
+    // Updates the bounds and renderables after generateTesselation()
+    void finishTesselation();
+
 private:
 	// This notifies the surfaceinspector/patchinspector about the texture change
 	void textureChanged();
@@ -336,4 +360,7 @@ private:
 	void check_shader();
 
 	void updateAABB();
+
+	// Updates the tesselation if the patch is part of a scene, otherwise just the bounds
+	void updateTesselationOrBounds();
 };
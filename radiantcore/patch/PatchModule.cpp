@@ -43,6 +43,11 @@ IPatchSettings& PatchModule::getSettings()
 	return *_settings;
 }
 
+std::size_t PatchModule::getNumQueuedTesselations()
+{
+	return algorithm::getNumQueuedTesselations();
+}
+
 const std::string& PatchModule::getName() const
 {
 	static std::string _name(MODULE_PATCH);
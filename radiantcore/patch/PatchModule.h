@@ -21,6 +21,8 @@ public:
 
 	IPatchSettings& getSettings() override;
 
+	std::size_t getNumQueuedTesselations() override;
+
 	// RegisterableModule implementation
 	const std::string& getName() const override;
 	const StringSet& getDependencies() const override;
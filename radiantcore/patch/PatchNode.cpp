@@ -6,6 +6,7 @@
 #include "icounter.h"
 #include "math/Frustum.h"
 #include "math/Hash.h"
+#include "algorithm/General.h"
 
 PatchNode::PatchNode(patch::PatchDefType type) :
 	scene::SelectableNode(),
@@ -15,7 +16,8 @@ PatchNode::PatchNode(patch::PatchDefType type) :
     _renderableSurfaceSolid(m_patch.getTesselation(), true),
     _renderableSurfaceWireframe(m_patch.getTesselation(), false),
     _renderableCtrlLattice(m_patch, m_ctrl_instances),
-    _renderableCtrlPoints(m_patch, m_ctrl_instances)
+    _renderableCtrlPoints(m_patch, m_ctrl_instances),
+    _fingerprintNeedsUpdate(true)
 {
 	m_patch.setFixedSubdivisions(type == patch::PatchDefType::Def3, Subdivisions(m_patch.getSubdivisions()));
 }
@@ -37,25 +39,41 @@ PatchNode::PatchNode(const PatchNode& other) :
     _renderableSurfaceSolid(m_patch.getTesselation(), true),
     _renderableSurfaceWireframe(m_patch.getTesselation(), false),
     _renderableCtrlLattice(m_patch, m_ctrl_instances),
-    _renderableCtrlPoints(m_patch, m_ctrl_instances)
+    _renderableCtrlPoints(m_patch, m_ctrl_instances),
+    _fingerprintNeedsUpdate(true)
 {
 }
 
+PatchNode::~PatchNode()
+{
+    // Don't leave a stale entry behind, a new node might be allocated at the same address
+    patch::algorithm::removeQueuedTesselation(*this);
+}
+
 scene::INode::Type PatchNode::getNodeType() const
 {
 	return Type::Patch;
 }
 
-std::string PatchNode::getFingerprint()
+scene::Fingerprint PatchNode::getFingerprint()
 {
     constexpr std::size_t SignificantDigits = scene::SignificantFingerprintDoubleDigits;
 
+    // Control points edited in place are not reported, don't trust the cached value then
+    if (!_fingerprintNeedsUpdate && !m_patch.controlPointsExposed())
+    {
+        return _fingerprint;
+    }
+
+    _fingerprintNeedsUpdate = false;
+
     if (m_patch.getHeight() * m_patch.getWidth() == 0)
     {
-        return std::string(); // empty patches produce an empty fingerprint
+        _fingerprint = scene::Fingerprint(); // empty patches produce an empty fingerprint
+        return _fingerprint;
     }
 
-    math::Hash hash;
+    math::FastHash hash;
 
     // Width & Height
     hash.addSizet(m_patch.getHeight());
@@ -71,15 +89,18 @@ std::string PatchNode::getFingerprint()
     // Material Name
     hash.addString(m_patch.getShader());
 
-    // Combine all control point data
-    for (const auto& ctrl : m_patch.getControlPoints())
+    // Combine all control point data (using the const overload, which is not exposing them)
+    const auto& patch = m_patch;
+
+    for (const auto& ctrl : patch.getControlPoints())
     {
         hash.addVector3(ctrl.vertex, SignificantDigits);
         hash.addDouble(ctrl.texcoord.x(), SignificantDigits);
         hash.addDouble(ctrl.texcoord.y(), SignificantDigits);
     }
 
-    return hash;
+    _fingerprint = hash;
+    return _fingerprint;
 }
 
 void PatchNode::updateSelectableControls()
@@ -336,6 +357,9 @@ void PatchNode::onRemoveFromScene(scene::IMapRootNode& root)
 
     clearAllRenderables();
 
+    // Nodes outside the scene are not rendered, the queue would keep them forever
+    patch::algorithm::removeQueuedTesselation(*this);
+
     m_patch.getSurfaceShader().setInUse(false);
 
 	SelectableNode::onRemoveFromScene(root);
@@ -348,7 +372,10 @@ bool PatchNode::getIntersection(const Ray& ray, Vector3& intersection)
 
 void PatchNode::onPreRender(const VolumeTest& volume)
 {
-    // Defer the tesselation calculation to the last minute
+    // Defer the tesselation calculation to the last minute, the first
+    // rendered patch is updating all transformed ones in one batch
+    patch::algorithm::updateQueuedTesselations();
+
     m_patch.evaluateTransform();
     m_patch.updateTesselation();
 
@@ -479,6 +506,8 @@ void PatchNode::_onTransformationChanged()
 {
 	m_patch.transformChanged();
 
+    patch::algorithm::queueTesselationUpdate(weak_from_this());
+
     updateAllRenderables();
 }
 
@@ -510,15 +539,22 @@ void PatchNode::onTesselationChanged()
 
 void PatchNode::onControlPointsChanged()
 {
+    invalidateFingerprint();
     updateAllRenderables();
 }
 
 void PatchNode::onMaterialChanged()
 {
+    invalidateFingerprint();
     _renderableSurfaceSolid.queueUpdate();
     _renderableSurfaceWireframe.queueUpdate();
 }
 
+void PatchNode::invalidateFingerprint()
+{
+    _fingerprintNeedsUpdate = true;
+}
+
 void PatchNode::onVisibilityChanged(bool visible)
 {
     SelectableNode::onVisibilityChanged(visible);
@@ -51,17 +51,23 @@ class PatchNode final :
     RenderablePatchLattice _renderableCtrlLattice; // Wireframe connecting the control points
     RenderablePatchControlPoints _renderableCtrlPoints; // the coloured control points
 
+    // Cached fingerprint, recalculated on demand after the patch changed
+    scene::Fingerprint _fingerprint;
+    bool _fingerprintNeedsUpdate;
+
 public:
 	PatchNode(patch::PatchDefType type);
 
 	// Copy Constructor
 	PatchNode(const PatchNode& other);
 
+	~PatchNode() override;
+
 	std::string name() const override;
 	Type getNodeType() const override;
 
     // IComparableNode implementation
-    std::string getFingerprint() override;
+    scene::Fingerprint getFingerprint() override;
 
 	// Bounded implementation
 	const AABB& localAABB() const override;
@@ -140,6 +146,9 @@ public:
     void onTesselationChanged();
     void updateSelectableControls();
 
+    // Called by the contained patch when its dimensions, shader or control points are changing
+    void invalidateFingerprint();
+
 protected:
 	// Gets called by the Transformable implementation whenever
 	// scale, rotation or translation is changed.
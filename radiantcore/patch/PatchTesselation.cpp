@@ -1,6 +1,25 @@
 #include "PatchTesselation.h"
 
 #include "Patch.h"
+#include "iselectiontest.h"
+#include "math/Ray.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	// Maximum number of triangles stored in a single leaf of the triangle tree
+	constexpr std::size_t TRIANGLES_PER_LEAF = 8;
+
+	// Tree node bounds are padded by this amount, to avoid missing
+	// ray hits on flat (zero-thickness) boxes due to rounding errors
+	constexpr double TRIANGLE_TREE_BOUNDS_EPSILON = 0.01;
+
+	inline VertexPointer vertexpointer_Meshvertex(const MeshVertex* array)
+	{
+		return VertexPointer(&array->vertex, sizeof(MeshVertex));
+	}
+}
 
 void PatchTesselation::clear()
 {
@@ -197,67 +216,61 @@ void PatchTesselation::generateNormals()
 	}
 }
 
-void PatchTesselation::sampleSinglePatchPoint(const MeshVertex ctrl[3][3], float u, float v, MeshVertex& out) const
+namespace
 {
-	double vCtrl[3][8];
 
-	// find the control points for the v coordinate
-	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
-	{
-		for (std::size_t axis = 0; axis < 8; axis++)
-		{
-			double a, b, c;
-
-			if (axis < 3)
-			{
-				a = ctrl[0][vPoint].vertex[axis];
-				b = ctrl[1][vPoint].vertex[axis];
-				c = ctrl[2][vPoint].vertex[axis];
-			}
-			else if (axis < 6)
-			{
-				a = ctrl[0][vPoint].normal[axis - 3];
-				b = ctrl[1][vPoint].normal[axis - 3];
-				c = ctrl[2][vPoint].normal[axis - 3];
-			}
-			else
-			{
-				a = ctrl[0][vPoint].texcoord[axis - 6];
-				b = ctrl[1][vPoint].texcoord[axis - 6];
-				c = ctrl[2][vPoint].texcoord[axis - 6];
-			}
+// Number of interpolated components per mesh vertex: 3 vertex, 3 normal and 2 texcoord values
+constexpr std::size_t NUM_SAMPLE_COMPONENTS = 8;
 
-			double qA = a - 2.0 * b + c;
-			double qB = 2.0 * b - 2.0 * a;
-			double qC = a;
+// Coefficients of a quadratic bezier curve for each vertex component,
+// the curve is evaluated as a * t^2 + b * t + c
+struct QuadraticCurve
+{
+	double a[NUM_SAMPLE_COMPONENTS];
+	double b[NUM_SAMPLE_COMPONENTS];
+	double c[NUM_SAMPLE_COMPONENTS];
 
-			vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
+	void setControlPoints(const double p0[NUM_SAMPLE_COMPONENTS],
+		const double p1[NUM_SAMPLE_COMPONENTS], const double p2[NUM_SAMPLE_COMPONENTS])
+	{
+		for (std::size_t axis = 0; axis < NUM_SAMPLE_COMPONENTS; axis++)
+		{
+			a[axis] = p0[axis] - 2.0 * p1[axis] + p2[axis];
+			b[axis] = 2.0 * p1[axis] - 2.0 * p0[axis];
+			c[axis] = p0[axis];
 		}
 	}
 
-	// interpolate the v value
-	for (std::size_t axis = 0; axis < 8; axis++)
+	// The loop runs over contiguous arrays without branches, allowing the compiler to vectorise it
+	void evaluate(float t, double out[NUM_SAMPLE_COMPONENTS]) const
 	{
-		double a = vCtrl[0][axis];
-		double b = vCtrl[1][axis];
-		double c = vCtrl[2][axis];
-		double qA = a - 2.0 * b + c;
-		double qB = 2.0 * b - 2.0 * a;
-		double qC = a;
-
-		if (axis < 3)
-		{
-			out.vertex[axis] = qA * v * v + qB * v + qC;
-		}
-		else if (axis < 6)
-		{
-			out.normal[axis - 3] = qA * v * v + qB * v + qC;
-		}
-		else
+		for (std::size_t axis = 0; axis < NUM_SAMPLE_COMPONENTS; axis++)
 		{
-			out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+			out[axis] = a[axis] * t * t + b[axis] * t + c[axis];
 		}
 	}
+};
+
+inline void getSampleComponents(const MeshVertex& vertex, double out[NUM_SAMPLE_COMPONENTS])
+{
+	out[0] = vertex.vertex[0];
+	out[1] = vertex.vertex[1];
+	out[2] = vertex.vertex[2];
+	out[3] = vertex.normal[0];
+	out[4] = vertex.normal[1];
+	out[5] = vertex.normal[2];
+	out[6] = vertex.texcoord[0];
+	out[7] = vertex.texcoord[1];
+}
+
+inline void setSampleComponents(const double components[NUM_SAMPLE_COMPONENTS], MeshVertex& vertex)
+{
+	vertex.vertex.set(components[0], components[1], components[2]);
+	vertex.normal.set(components[3], components[4], components[5]);
+	vertex.texcoord[0] = components[6];
+	vertex.texcoord[1] = components[7];
+}
+
 }
 
 void PatchTesselation::sampleSinglePatch(const MeshVertex ctrl[3][3],
@@ -268,14 +281,48 @@ void PatchTesselation::sampleSinglePatch(const MeshVertex ctrl[3][3],
 	horzSub++;
 	vertSub++;
 
+	double ctrlComponents[3][3][NUM_SAMPLE_COMPONENTS];
+
+	for (std::size_t k = 0; k < 3; k++)
+	{
+		for (std::size_t l = 0; l < 3; l++)
+		{
+			getSampleComponents(ctrl[k][l], ctrlComponents[k][l]);
+		}
+	}
+
+	// The curves running along u, one for each row of control points
+	QuadraticCurve uCurves[3];
+
+	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+	{
+		uCurves[vPoint].setControlPoints(ctrlComponents[0][vPoint], ctrlComponents[1][vPoint], ctrlComponents[2][vPoint]);
+	}
+
 	for (std::size_t i = 0; i < horzSub; i++)
 	{
+		float u = static_cast<float>(i) / (horzSub - 1);
+
+		// Find the control points for the v coordinate, they're shared by the whole column
+		double vCtrl[3][NUM_SAMPLE_COMPONENTS];
+
+		for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+		{
+			uCurves[vPoint].evaluate(u, vCtrl[vPoint]);
+		}
+
+		QuadraticCurve vCurve;
+		vCurve.setControlPoints(vCtrl[0], vCtrl[1], vCtrl[2]);
+
+		// Interpolate the v values of this column
 		for (std::size_t j = 0; j < vertSub; j++)
 		{
-			float u = static_cast<float>(i) / (horzSub - 1);
 			float v = static_cast<float>(j) / (vertSub - 1);
 
-			sampleSinglePatchPoint(ctrl, u, v, outVerts[((baseRow + j) * w) + i + baseCol]);
+			double sample[NUM_SAMPLE_COMPONENTS];
+			vCurve.evaluate(v, sample);
+
+			setSampleComponents(sample, outVerts[((baseRow + j) * w) + i + baseCol]);
 		}
 	}
 }
@@ -837,11 +884,15 @@ void PatchTesselation::generateIndices()
 
 void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	const PatchControlArray& controlPoints, bool subdivionsFixed, const Subdivisions& subdivs,
-    IRenderEntity* renderEntity)
+    const Vector4& colour)
 {
 	width = patchWidth;
 	height = patchHeight;
 
+	// Any previous triangle tree is outdated now
+	_triangleTreeNodes.clear();
+	_triangleTreeIndices.clear();
+
 	_maxWidth = width;
 	_maxHeight = height;
 
@@ -870,8 +921,6 @@ void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	}
 
     // Final update: assign colours and normalise normals
-    auto colour = renderEntity ? renderEntity->getEntityColour() : Vector4(1, 1, 1, 1);
-
 	for (MeshVertex& vertex : vertices)
 	{
 	    // normalize all the lerped normals
@@ -890,3 +939,198 @@ void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	// With indices in place we can derive the tangent/bitangent vectors
 	deriveTangents();
 }
+
+void PatchTesselation::ensureTriangleTree()
+{
+	if (!_triangleTreeNodes.empty() || vertices.empty() || indices.empty())
+	{
+		return;
+	}
+
+	// Split the quad strips into triangles, using the same winding as SelectionTest::TestQuadStrip
+	std::vector<RenderIndex> triangleIndices;
+	triangleIndices.reserve(numStrips * lenStrips * 3);
+
+	for (std::size_t strip = 0; strip < numStrips; ++strip)
+	{
+		const auto* stripIndices = &indices[strip * lenStrips];
+
+		for (std::size_t i = 0; i + 2 < lenStrips; i += 2)
+		{
+			triangleIndices.insert(triangleIndices.end(), { stripIndices[i], stripIndices[i + 1], stripIndices[i + 2] });
+			triangleIndices.insert(triangleIndices.end(), { stripIndices[i + 2], stripIndices[i + 1], stripIndices[i + 3] });
+		}
+	}
+
+	auto numTriangles = triangleIndices.size() / 3;
+
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	std::vector<Vector3> centroids(numTriangles);
+	std::vector<std::size_t> triangles(numTriangles);
+
+	for (std::size_t t = 0; t < numTriangles; ++t)
+	{
+		centroids[t] = (vertices[triangleIndices[t * 3]].vertex +
+			vertices[triangleIndices[t * 3 + 1]].vertex +
+			vertices[triangleIndices[t * 3 + 2]].vertex) / 3.0;
+		triangles[t] = t;
+	}
+
+	_triangleTreeNodes.reserve(2 * numTriangles / TRIANGLES_PER_LEAF + 1);
+	_triangleTreeIndices.reserve(triangleIndices.size());
+
+	buildTriangleTreeNode(triangles, 0, numTriangles, triangleIndices, centroids);
+}
+
+std::size_t PatchTesselation::buildTriangleTreeNode(std::vector<std::size_t>& triangles,
+	std::size_t begin, std::size_t end, const std::vector<RenderIndex>& triangleIndices,
+	const std::vector<Vector3>& centroids)
+{
+	auto nodeIndex = _triangleTreeNodes.size();
+	_triangleTreeNodes.emplace_back();
+
+	AABB bounds;
+	AABB centroidBounds;
+
+	for (auto t = begin; t < end; ++t)
+	{
+		auto triangle = triangles[t];
+
+		bounds.includePoint(vertices[triangleIndices[triangle * 3]].vertex);
+		bounds.includePoint(vertices[triangleIndices[triangle * 3 + 1]].vertex);
+		bounds.includePoint(vertices[triangleIndices[triangle * 3 + 2]].vertex);
+
+		centroidBounds.includePoint(centroids[triangle]);
+	}
+
+	bounds.extents += Vector3(TRIANGLE_TREE_BOUNDS_EPSILON, TRIANGLE_TREE_BOUNDS_EPSILON, TRIANGLE_TREE_BOUNDS_EPSILON);
+
+	if (end - begin <= TRIANGLES_PER_LEAF)
+	{
+		// Leaf node, copy the triangles into the sorted index array
+		auto firstTriangle = _triangleTreeIndices.size() / 3;
+
+		for (auto t = begin; t < end; ++t)
+		{
+			auto triangle = triangles[t];
+
+			_triangleTreeIndices.insert(_triangleTreeIndices.end(), {
+				triangleIndices[triangle * 3], triangleIndices[triangle * 3 + 1], triangleIndices[triangle * 3 + 2]
+			});
+		}
+
+		_triangleTreeNodes[nodeIndex] = TriangleTreeNode{ bounds, firstTriangle, end - begin, true };
+		return nodeIndex;
+	}
+
+	// Split the triangles at the median of the centroids, along the longest axis
+	const auto& extents = centroidBounds.getExtents();
+	auto axis = extents.x() >= extents.y() && extents.x() >= extents.z() ? 0 : (extents.y() >= extents.z() ? 1 : 2);
+	auto middle = begin + (end - begin) / 2;
+
+	std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+		[&](std::size_t a, std::size_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+	// Don't hold any references into the node array while recursing, it's going to grow
+	auto left = buildTriangleTreeNode(triangles, begin, middle, triangleIndices, centroids);
+	auto right = buildTriangleTreeNode(triangles, middle, end, triangleIndices, centroids);
+
+	_triangleTreeNodes[nodeIndex] = TriangleTreeNode{ bounds, left, right, false };
+	return nodeIndex;
+}
+
+bool PatchTesselation::intersectRay(const Ray& ray, Vector3& intersection)
+{
+	ensureTriangleTree();
+
+	if (_triangleTreeNodes.empty()) return false;
+
+	auto bestDistanceSquared = std::numeric_limits<double>::max();
+	bool found = false;
+
+	std::vector<std::size_t> stack{ 0 };
+
+	while (!stack.empty())
+	{
+		const auto& node = _triangleTreeNodes[stack.back()];
+		stack.pop_back();
+
+		Vector3 boxIntersection;
+
+		// Skip nodes that are missed by the ray or that are farther away than the best hit so far
+		if (!ray.intersectAABB(node.bounds, boxIntersection) ||
+			(boxIntersection - ray.origin).getLengthSquared() > bestDistanceSquared)
+		{
+			continue;
+		}
+
+		if (!node.isLeaf)
+		{
+			stack.push_back(node.first);
+			stack.push_back(node.second);
+			continue;
+		}
+
+		for (auto t = node.first; t < node.first + node.second; ++t)
+		{
+			const auto& p1 = vertices[_triangleTreeIndices[t * 3]].vertex;
+			const auto& p2 = vertices[_triangleTreeIndices[t * 3 + 1]].vertex;
+			const auto& p3 = vertices[_triangleTreeIndices[t * 3 + 2]].vertex;
+
+			Vector3 triangleIntersection;
+
+			if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) != Ray::POINT)
+			{
+				continue;
+			}
+
+			auto distanceSquared = (triangleIntersection - ray.origin).getLengthSquared();
+
+			if (distanceSquared < bestDistanceSquared)
+			{
+				bestDistanceSquared = distanceSquared;
+				intersection = triangleIntersection;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+void PatchTesselation::testSelect(SelectionTest& test, SelectionIntersection& best, const Matrix4& localToWorld)
+{
+	ensureTriangleTree();
+
+	if (_triangleTreeNodes.empty()) return;
+
+	const auto& volume = test.getVolume();
+	auto vertexPointer = vertexpointer_Meshvertex(&vertices.front());
+
+	std::vector<std::size_t> stack{ 0 };
+
+	while (!stack.empty())
+	{
+		const auto& node = _triangleTreeNodes[stack.back()];
+		stack.pop_back();
+
+		if (volume.TestAABB(node.bounds, localToWorld) == VOLUME_OUTSIDE)
+		{
+			continue;
+		}
+
+		if (node.isLeaf)
+		{
+			test.TestTriangles(vertexPointer, IndexPointer(&_triangleTreeIndices[node.first * 3], node.second * 3), best);
+		}
+		else
+		{
+			stack.push_back(node.first);
+			stack.push_back(node.second);
+		}
+	}
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "render.h"
+#include "math/AABB.h"
 #include "PatchControl.h"
 
 struct FaceTangents;
+class Ray;
+class SelectionTest;
+class SelectionIntersection;
 
 /// Representation of a patch as mesh geometry
 class PatchTesselation
@@ -29,6 +33,24 @@ private:
 	std::size_t _maxWidth;
 	std::size_t _maxHeight;
 
+	// Node of the bounding volume hierarchy over the mesh triangles.
+	// Leaf nodes reference a range of triangles in _triangleTreeIndices,
+	// inner nodes reference their two child nodes.
+	struct TriangleTreeNode
+	{
+		AABB bounds;
+		std::size_t first;	// first triangle (leaf) or left child (inner node)
+		std::size_t second;	// number of triangles (leaf) or right child (inner node)
+		bool isLeaf;
+	};
+
+	// The tree is built on demand by the first ray or selection test after
+	// the mesh has been (re-)generated. generate() and clear() discard it.
+	std::vector<TriangleTreeNode> _triangleTreeNodes;
+
+	// Triangle indices (3 per triangle), sorted such that each leaf covers a contiguous range
+	std::vector<RenderIndex> _triangleTreeIndices;
+
 public:
 
     /// Construct an uninitialised patch tesselation
@@ -44,9 +66,18 @@ public:
     /// Clear all patch data
     void clear();
 
-	// Generates the tesselated mesh based on the input parameters
+	// Generates the tesselated mesh based on the input parameters,
+	// all vertices are assigned the given colour
 	void generate(std::size_t width, std::size_t height, const PatchControlArray& controlPoints, 
-		bool subdivionsFixed, const Subdivisions& subdivs, IRenderEntity* renderEntity);
+		bool subdivionsFixed, const Subdivisions& subdivs, const Vector4& colour);
+
+	// Intersects the given ray with the mesh triangles, returning true on hit.
+	// The intersection point closest to the ray origin is stored in the given vector.
+	bool intersectRay(const Ray& ray, Vector3& intersection);
+
+	// Runs the selection test against the mesh triangles, skipping all parts
+	// of the mesh whose bounds are outside the test volume
+	void testSelect(SelectionTest& test, SelectionIntersection& best, const Matrix4& localToWorld);
 
 private:
 	// Private methods used for tesselation, modeled after the patch subdivision code found in idTech4
@@ -66,7 +97,10 @@ private:
 	void sampleSinglePatch(const MeshVertex ctrl[3][3], std::size_t baseCol, std::size_t baseRow, 
 		std::size_t width, std::size_t horzSub, std::size_t vertSub, 
 		std::vector<MeshVertex>& outVerts) const;
-	void sampleSinglePatchPoint(const MeshVertex ctrl[3][3], float u, float v, MeshVertex& out) const;
 	void deriveTangents();
 	void deriveFaceTangents(std::vector<FaceTangents>& faceTangents);
+
+	void ensureTriangleTree();
+	std::size_t buildTriangleTreeNode(std::vector<std::size_t>& triangles, std::size_t begin, std::size_t end,
+		const std::vector<RenderIndex>& triangleIndices, const std::vector<Vector3>& centroids);
 };
@@ -13,6 +13,7 @@
 #include "selectionlib.h"
 #include "command/ExecutionFailure.h"
 #include "patch/PatchIterators.h"
+#include "ParallelForEach.h"
 
 #include <map>
 
@@ -22,6 +23,17 @@ namespace patch
 namespace algorithm
 {
 
+namespace
+{
+    // Below this number of changed patches the tesselation runs in the calling thread
+    constexpr std::size_t MIN_PATCHES_FOR_PARALLEL_TESSELATION = 16;
+
+    // Transformed patches waiting for their tesselation update, keyed by
+    // node to not hand the same patch to two workers. Nodes are removing
+    // their entry when leaving the scene or being destroyed.
+    std::map<const scene::INode*, scene::INodeWeakPtr> _queuedTesselations;
+}
+
 void thicken(const PatchNodePtr& sourcePatch, float thickness, bool createSeams, int axis)
 {
 	if (axis < 0 || axis > 3)  throw cmd::ExecutionFailure(fmt::format(_("Invalid axis value: {0}"), string::to_string(axis)));
@@ -454,6 +466,116 @@ void weldSelectedPatches(const cmd::ArgumentList& args)
     }
 }
 
+void updateTesselations(const std::vector<Patch*>& patches)
+{
+    std::vector<Patch*> changedPatches;
+
+    for (auto patch : patches)
+    {
+        // Transforms are evaluated up front, this is calling into the node
+        patch->evaluateTransform();
+
+        if (patch->tesselationChanged())
+        {
+            changedPatches.push_back(patch);
+        }
+    }
+
+    if (changedPatches.size() < MIN_PATCHES_FOR_PARALLEL_TESSELATION)
+    {
+        for (auto patch : changedPatches)
+        {
+            patch->updateTesselation();
+        }
+
+        return;
+    }
+
+    // The entity colours might be evaluated lazily, acquire them before going parallel
+    std::vector<Vector4> vertexColours;
+    vertexColours.reserve(changedPatches.size());
+
+    for (auto patch : changedPatches)
+    {
+        vertexColours.emplace_back(patch->getVertexColour());
+    }
+
+    parallel::forEachIndex(changedPatches.size(), [&](std::size_t p)
+    {
+        changedPatches[p]->generateTesselation(vertexColours[p]);
+    });
+
+    // Bounds and renderable updates are sending signals, do this in the calling thread
+    for (auto patch : changedPatches)
+    {
+        patch->finishTesselation();
+    }
+}
+
+void updateTesselations(const scene::INodePtr& root)
+{
+    std::vector<Patch*> patches;
+
+    root->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isPatch(node))
+        {
+            patches.push_back(Node_getPatch(node));
+        }
+
+        return true;
+    });
+
+    updateTesselations(patches);
+}
+
+void queueTesselationUpdate(const scene::INodeWeakPtr& patchNode)
+{
+    auto node = patchNode.lock();
+
+    // Patches not (yet) owned by a shared_ptr are updated by themselves
+    if (!node) return;
+
+    _queuedTesselations[node.get()] = patchNode;
+}
+
+void removeQueuedTesselation(const scene::INode& patchNode)
+{
+    _queuedTesselations.erase(&patchNode);
+}
+
+std::size_t getNumQueuedTesselations()
+{
+    return _queuedTesselations.size();
+}
+
+void updateQueuedTesselations()
+{
+    if (_queuedTesselations.empty()) return;
+
+    // Finishing the tesselations is emitting signals, don't let them
+    // modify the container we're iterating over
+    std::map<const scene::INode*, scene::INodeWeakPtr> queued;
+    queued.swap(_queuedTesselations);
+
+    // Keep the nodes alive until the update is done
+    std::vector<scene::INodePtr> nodes;
+    std::vector<Patch*> patches;
+
+    for (const auto& [_, weakNode] : queued)
+    {
+        auto node = weakNode.lock();
+
+        if (node && Node_isPatch(node))
+        {
+            nodes.push_back(node);
+            patches.push_back(Node_getPatch(node));
+        }
+    }
+
+    updateTesselations(patches);
+}
+
 } // namespace
 
 } // namespace
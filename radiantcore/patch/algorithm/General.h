@@ -1,8 +1,11 @@
 #pragma once
 
 #include "icommandsystem.h"
+#include "inode.h"
 #include <memory>
+#include <vector>
 
+class Patch;
 class PatchNode;
 typedef std::shared_ptr<PatchNode> PatchNodePtr;
 
@@ -29,6 +32,32 @@ void bulge(const cmd::ArgumentList& args);
 
 void weldSelectedPatches(const cmd::ArgumentList& args);
 
+/**
+ * Brings the tesselation of the given patches up to date. The meshes of all
+ * changed patches are generated on worker threads, the bounds and renderables
+ * are updated afterwards in the calling thread.
+ */
+void updateTesselations(const std::vector<Patch*>& patches);
+
+// Updates the tesselation of all patches below the given node (see above)
+void updateTesselations(const scene::INodePtr& root);
+
+/**
+ * Remembers the given patch node for the next call to updateQueuedTesselations().
+ * Used by transformed patches, such that moving a large selection is
+ * re-tesselating all affected patches in one batch. Main thread only.
+ */
+void queueTesselationUpdate(const scene::INodeWeakPtr& patchNode);
+
+// Updates the tesselation of all queued patches that are still alive (see above)
+void updateQueuedTesselations();
+
+// Removes the given patch node from the queue, called when it leaves the scene or is destroyed
+void removeQueuedTesselation(const scene::INode& patchNode);
+
+// Returns the number of patch nodes waiting for updateQueuedTesselations()
+std::size_t getNumQueuedTesselations();
+
 } // namespace
 
 } // namespace
@@ -250,6 +250,11 @@ void OpenGLRenderSystem::unrealise()
         // Unrealise the GLPrograms
         _glProgramFactory->unrealise();
     }
+
+    if (GlobalOpenGLContext().getSharedContext())
+    {
+        _objectRenderer.releaseBuffers();
+    }
 }
 
 GLProgramFactory& OpenGLRenderSystem::getGLProgramFactory()
@@ -19,49 +19,38 @@ bool BlendLight::isInView(const IRenderView& view)
     return view.TestAABB(_lightBounds) != VOLUME_OUTSIDE;
 }
 
-void BlendLight::collectSurfaces(const IRenderView& view, const std::set<IRenderEntityPtr>& entities)
+void BlendLight::collectSurfaces(const IRenderView& view, const LightSurfaceCache& surfaces)
 {
-    // Now check all the entities intersecting with this light
-    for (const auto& entity : entities)
+    // Check all the objects intersecting with this light
+    surfaces.foreachSurface([&](IRenderEntity&, IRenderableObject& object, Shader* shader, const AABB& bounds)
     {
-        entity->foreachRenderableTouchingBounds(_lightBounds,
-            [&](const IRenderableObject::Ptr& object, Shader* shader)
-        {
-            // Skip empty objects and invisible surfaces
-            if (!object->isVisible() || !shader->isVisible()) return;
+        // Skip empty objects and invisible surfaces
+        if (!object.isVisible() || !shader->isVisible()) return;
 
-            // Cull surfaces that are not in view
-            if (object->isOriented())
-            {
-                if (view.TestAABB(object->getObjectBounds(), object->getObjectTransform()) == VOLUME_OUTSIDE)
-                {
-                    return;
-                }
-            }
-            else if (view.TestAABB(object->getObjectBounds()) == VOLUME_OUTSIDE) // non-oriented AABB test
-            {
-                return;
-            }
+        // Cull surfaces that are not in view, using the cached world bounds
+        if (view.TestAABB(bounds) == VOLUME_OUTSIDE)
+        {
+            return;
+        }
 
-            auto glShader = static_cast<OpenGLShader*>(shader);
+        auto glShader = static_cast<OpenGLShader*>(shader);
 
-            // We only consider materials designated for camera rendering
-            if (!glShader->isApplicableTo(RenderViewType::Camera))
-            {
-                return;
-            }
+        // We only consider materials designated for camera rendering
+        if (!glShader->isApplicableTo(RenderViewType::Camera))
+        {
+            return;
+        }
 
-            // Blend lights only affect materials that interact with lighting
-            if (!glShader->getInteractionPass())
-            {
-                return;
-            }
+        // Blend lights only affect materials that interact with lighting
+        if (!glShader->getInteractionPass())
+        {
+            return;
+        }
 
-            _objects.emplace_back(std::ref(*object));
+        _objects.emplace_back(std::ref(object));
 
-            ++_objectCount;
-        });
-    }
+        ++_objectCount;
+    });
 }
 
 void BlendLight::draw(OpenGLState& state, RenderStateFlags globalFlagsMask, 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "irender.h"
+#include "LightSurfaceCache.h"
 
 namespace render
 {
@@ -36,8 +37,14 @@ public:
     BlendLight(RendererLight& light, IGeometryStore& store, IObjectRenderer& objectRenderer);
     BlendLight(BlendLight&& other) = default;
 
+    const AABB& getLightBounds() const
+    {
+        return _lightBounds;
+    }
+
     bool isInView(const IRenderView& view);
-    void collectSurfaces(const IRenderView& view, const std::set<IRenderEntityPtr>& entities);
+    // Collects the cached surfaces that are affected by this light in the given view
+    void collectSurfaces(const IRenderView& view, const LightSurfaceCache& surfaces);
 
     std::size_t getObjectCount() const
     {
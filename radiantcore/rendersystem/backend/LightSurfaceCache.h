@@ -0,0 +1,126 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "irender.h"
+#include "irenderableobject.h"
+
+namespace render
+{
+
+/**
+ * Remembers the objects touching the bounds of a single light, as reported
+ * by IRenderEntity::foreachPreparedRenderableTouchingBounds(), across render passes.
+ * The world bounds of the objects are stored along with them. Updating the cache
+ * is not calling into the objects, so it is safe to update the caches of
+ * several lights at once, after the entities have been prepared.
+ *
+ * No references are held: an entity removing an object is reporting a change,
+ * which makes the cache drop the object before it's accessed again. Removed
+ * entities are handled by the renderer, it is discarding all caches then.
+ *
+ * The objects of an entity are only queried again when the light bounds
+ * changed or the entity reported a change of its renderables. Everything
+ * depending on the view or the material state is not cached and needs to
+ * be checked by the light in every pass.
+ */
+class LightSurfaceCache
+{
+public:
+    struct Surface
+    {
+        IRenderableObject* object;
+        Shader* shader;
+
+        // The world bounds of the object
+        AABB bounds;
+    };
+
+    struct EntitySurfaces
+    {
+        IRenderEntity* entity;
+        std::vector<Surface> surfaces;
+    };
+
+private:
+    AABB _lightBounds;
+
+    // The render pass this cache has been updated in, 0 if never
+    std::size_t _lastUpdate = 0;
+
+    // The render pass the surfaces have last been changing in
+    std::size_t _lastChange = 0;
+
+    // The surfaces touching the light, keyed by entity index
+    std::map<std::size_t, EntitySurfaces> _surfacesByEntity;
+
+public:
+    /**
+     * Brings the cached surfaces up to date. The entity list must be the same
+     * (in the same order) as in every previous update. For each entity the
+     * change vector holds the number of the render pass that entity has
+     * last been seen changing its renderables.
+     */
+    void update(const AABB& lightBounds, const std::vector<IRenderEntity*>& entities,
+        const std::vector<std::size_t>& entityChangePasses, std::size_t renderPass)
+    {
+        auto fullUpdate = _lastUpdate == 0 || lightBounds != _lightBounds;
+
+        if (fullUpdate)
+        {
+            _surfacesByEntity.clear();
+            _lastChange = renderPass;
+        }
+
+        for (std::size_t i = 0; i < entities.size(); ++i)
+        {
+            if (!fullUpdate && entityChangePasses[i] <= _lastUpdate) continue;
+
+            EntitySurfaces entitySurfaces{ entities[i] };
+
+            entities[i]->foreachPreparedRenderableTouchingBounds(lightBounds,
+                [&](const IRenderableObject::Ptr& object, Shader* shader, const AABB& bounds)
+            {
+                entitySurfaces.surfaces.push_back(Surface{ object.get(), shader, bounds });
+            });
+
+            if (entitySurfaces.surfaces.empty())
+            {
+                if (_surfacesByEntity.erase(i) > 0)
+                {
+                    _lastChange = renderPass;
+                }
+            }
+            else
+            {
+                _surfacesByEntity[i] = std::move(entitySurfaces);
+                _lastChange = renderPass;
+            }
+        }
+
+        _lightBounds = lightBounds;
+        _lastUpdate = renderPass;
+    }
+
+    // Returns the render pass in which the light bounds or any of the surfaces
+    // touching the light have last been changing (including geometry updates)
+    std::size_t getLastChange() const
+    {
+        return _lastChange;
+    }
+
+    // Visits the cached surfaces, grouped by entity
+    template<typename Functor>
+    void foreachSurface(const Functor& functor) const
+    {
+        for (const auto& [_, entitySurfaces] : _surfacesByEntity)
+        {
+            for (const auto& surface : entitySurfaces.surfaces)
+            {
+                functor(*entitySurfaces.entity, *surface.object, surface.shader, surface.bounds);
+            }
+        }
+    }
+};
+
+}
@@ -21,11 +21,14 @@ public:
     std::size_t nonInteractionDrawCalls = 0;
     std::size_t shadowDrawCalls = 0;
 
+    std::size_t shadowMaps = 0;
+    std::size_t cachedShadowMaps = 0;
+
     std::string toString() override
     {
-        return fmt::format("Lights: {0}/{1} | Ents: {2} | Objs: {3} | Draws: D={4}|Int={5}|Bl={6}|Shdw={7}", 
+        return fmt::format("Lights: {0}/{1} | Ents: {2} | Objs: {3} | Draws: D={4}|Int={5}|Bl={6}|Shdw={7} | Shadow Maps: {8} ({9} cached)", 
             visibleLights, visibleLights + skippedLights, entities, objects, depthDrawCalls, 
-            interactionDrawCalls, nonInteractionDrawCalls, shadowDrawCalls);
+            interactionDrawCalls, nonInteractionDrawCalls, shadowDrawCalls, shadowMaps, cachedShadowMaps);
     }
 };
 
@@ -10,6 +10,9 @@
 #include "glprogram/DepthFillAlphaProgram.h"
 #include "glprogram/InteractionProgram.h"
 #include "glprogram/RegularStageProgram.h"
+#include "ParallelForEach.h"
+
+#include <algorithm>
 
 namespace render
 {
@@ -26,30 +29,32 @@ LightingModeRenderer::LightingModeRenderer(GLProgramFactory& programFactory,
     _entities(entities),
     _shadowMapProgram(nullptr),
     _blendLightProgram(nullptr),
-    _shadowMappingEnabled(RKEY_ENABLE_SHADOW_MAPPING)
+    _shadowMappingEnabled(RKEY_ENABLE_SHADOW_MAPPING),
+    _renderPass(0)
 {
     _untransformedObjectsWithoutAlphaTest.reserve(10000);
-    _nearestShadowLights.reserve(MaxShadowCastingLights + 1);
+    _shadowLights.reserve(MaxShadowCastingLights);
+    _shadowLightTiles.reserve(MaxShadowCastingLights);
 }
 
 void LightingModeRenderer::ensureShadowMapSetup()
 {
-    if (!_shadowMappingEnabled.get()) return;
+    if (!_shadowMappingEnabled.get())
+    {
+        // The shadow maps are not kept up to date while disabled
+        if (!_shadowMapTiles.empty())
+        {
+            clearShadowMapTiles();
+        }
+
+        return;
+    }
 
     if (!_shadowMapFbo)
     {
         _shadowMapFbo = FrameBuffer::CreateShadowMapBuffer();
-
-        // Define the shadow atlas regions (supporting 6 lights)
-        _shadowMapAtlas.resize(6);
-
-        for (int i = 0; i < 6; ++i)
-        {
-            _shadowMapAtlas[i].x = 0;
-            _shadowMapAtlas[i].y = static_cast<int>((_shadowMapFbo->getHeight() / 6) * i);
-            _shadowMapAtlas[i].width = static_cast<int>(_shadowMapFbo->getWidth() / 6);
-            _shadowMapAtlas[i].height = static_cast<int>(_shadowMapFbo->getHeight() / 6);
-        }
+        _shadowMapAtlas = std::make_unique<ShadowMapAtlas>(_shadowMapFbo->getWidth());
+        _shadowMapTiles.clear();
     }
 
     if (!_shadowMapProgram)
@@ -109,8 +114,11 @@ IRenderResult::Ptr LightingModeRenderer::render(RenderStateFlags globalFlagsMask
 
     // Cleanup the data accumulated in this render pass
     _regularLights.clear();
-    _nearestShadowLights.clear();
+    _regularLightSurfaces.clear();
+    _shadowLights.clear();
+    _shadowLightTiles.clear();
     _blendLights.clear();
+    _blendLightSurfaces.clear();
 
     return std::move(_result); // move-return our result reference
 }
@@ -119,6 +127,9 @@ void LightingModeRenderer::collectLights(const IRenderView& view)
 {
     _regularLights.reserve(_lights.size());
 
+    // Find out which entities have been changing their renderables
+    updateEntityChanges();
+
     // Categorise all visible lights
     for (const auto& light : _lights)
     {
@@ -133,97 +144,321 @@ void LightingModeRenderer::collectLights(const IRenderView& view)
         collectRegularLight(*light, view);
     }
 
-    // Assign shadow light indices
-    for (auto index = 0; index < _nearestShadowLights.size(); ++index)
+    // Check all the surfaces that are touching the lights
+    collectSurfaces(view);
+
+    for (auto& light : _regularLights)
+    {
+        _result->visibleLights++;
+        _result->objects += light.getObjectCount();
+        _result->entities += light.getEntityCount();
+    }
+
+    for (auto& light : _blendLights)
+    {
+        _result->visibleLights++;
+        _result->objects += light.getObjectCount();
+    }
+
+    if (_shadowMappingEnabled.get())
     {
-        _nearestShadowLights[index]->setShadowLightIndex(index);
+        assignShadowMapTiles(view);
     }
 }
 
-void LightingModeRenderer::collectRegularLight(RendererLight& light, const IRenderView& view)
+namespace
 {
-    RegularLight interaction(light, _geometryStore, _objectRenderer);
 
-    if (!interaction.isInView(view))
+// Rough estimate of the screen space covered by the light volume
+double getScreenCoverage(const RegularLight& light, const Vector3& viewer)
+{
+    const auto& bounds = light.getLightBounds();
+
+    auto radius = bounds.getExtents().getLength();
+    auto distance = (bounds.getOrigin() - viewer).getLength();
+
+    // Viewers within the light volume get the full coverage
+    return distance > radius ? radius / distance : 1.0;
+}
+
+}
+
+void LightingModeRenderer::assignShadowMapTiles(const IRenderView& view)
+{
+    struct ShadowLight
     {
-        _result->skippedLights++;
-        return;
+        std::size_t index;
+        double coverage;
+        std::size_t tileSize;
+    };
+
+    std::vector<ShadowLight> shadowLights;
+
+    for (std::size_t i = 0; i < _regularLights.size(); ++i)
+    {
+        if (_regularLights[i].isShadowCasting())
+        {
+            shadowLights.push_back(ShadowLight{ i, getScreenCoverage(_regularLights[i], view.getViewer()) });
+        }
     }
 
-    // Check all the surfaces that are touching this light
-    interaction.collectSurfaces(view, _entities);
+    // The lights covering most of the screen are served first
+    std::sort(shadowLights.begin(), shadowLights.end(), [](const ShadowLight& a, const ShadowLight& b)
+    {
+        return a.coverage > b.coverage;
+    });
 
-    _result->visibleLights++;
-    _result->objects += interaction.getObjectCount();
-    _result->entities += interaction.getEntityCount();
+    if (shadowLights.size() > MaxShadowCastingLights)
+    {
+        shadowLights.resize(MaxShadowCastingLights);
+    }
+
+    std::vector<ShadowLight*> lightsWithoutTile;
+
+    for (auto& shadowLight : shadowLights)
+    {
+        // Halve the tile size for every halving of the coverage
+        shadowLight.tileSize = _shadowMapAtlas->getMaxTileSize();
+
+        for (auto coverage = shadowLight.coverage; coverage < MinCoverageForMaxShadowMapSize &&
+            shadowLight.tileSize > _shadowMapAtlas->getMinTileSize(); coverage *= 2)
+        {
+            shadowLight.tileSize /= 2;
+        }
+
+        auto existing = _shadowMapTiles.find(&_regularLights[shadowLight.index].getLight());
+
+        if (existing == _shadowMapTiles.end())
+        {
+            lightsWithoutTile.push_back(&shadowLight);
+        }
+        else if (static_cast<std::size_t>(existing->second.rectangle.width) > shadowLight.tileSize)
+        {
+            // Release the tile, it's re-allocated below
+            _shadowMapAtlas->free(existing->second.rectangle);
+            _shadowMapTiles.erase(existing);
+            lightsWithoutTile.push_back(&shadowLight);
+        }
+        else
+        {
+            auto& tile = existing->second;
+            tile.lastUsedPass = _renderPass;
+
+            // Upgrade to a larger tile if there's free space, otherwise keep
+            // the current tile to not lose its contents
+            Rectangle rectangle;
+
+            if (static_cast<std::size_t>(tile.rectangle.width) < shadowLight.tileSize &&
+                _shadowMapAtlas->allocate(shadowLight.tileSize, rectangle))
+            {
+                _shadowMapAtlas->free(tile.rectangle);
+                tile.rectangle = rectangle;
+                tile.hasContents = false;
+            }
+        }
+    }
+
+    for (auto shadowLight : lightsWithoutTile)
+    {
+        Rectangle rectangle;
 
-    // Move the interaction list into its place
-    auto& moved = _regularLights.emplace_back(std::move(interaction));
+        // Try the smaller sizes if there's not enough room for the requested one
+        if (_shadowMapAtlas->allocateUpTo(shadowLight->tileSize, rectangle,
+            [this] { return evictUnusedShadowMapTile(); }))
+        {
+            auto& tile = _shadowMapTiles[&_regularLights[shadowLight->index].getLight()];
+            tile.rectangle = rectangle;
+            tile.lastUsedPass = _renderPass;
+        }
+    }
 
-    // Check the distance of shadow casting lights to the viewer
-    if (_shadowMappingEnabled.get() && moved.isShadowCasting())
+    // Check which of the tiles need to be rendered
+    for (const auto& shadowLight : shadowLights)
     {
-        addToShadowLights(moved, view.getViewer());
+        auto& light = _regularLights[shadowLight.index];
+        auto tile = _shadowMapTiles.find(&light.getLight());
+
+        if (tile == _shadowMapTiles.end()) continue; // no space left in the atlas
+
+        auto lightOrigin = light.getLight().getLightOrigin();
+        auto surfaceChange = _regularLightSurfaces[shadowLight.index]->getLastChange();
+        auto casterSignature = light.getShadowCasterSignature();
+
+        tile->second.needsRedraw = !tile->second.hasContents || lightOrigin != tile->second.lightOrigin ||
+            surfaceChange != tile->second.surfaceChange || casterSignature != tile->second.casterSignature ||
+            casterSignature == RegularLight::NoShadowCasterSignature;
+
+        tile->second.hasContents = true;
+        tile->second.lightOrigin = lightOrigin;
+        tile->second.surfaceChange = surfaceChange;
+        tile->second.casterSignature = casterSignature;
+
+        light.setShadowLightIndex(static_cast<int>(_shadowLights.size()));
+        _shadowLights.push_back(&light);
+        _shadowLightTiles.push_back(&tile->second);
     }
 }
 
-void LightingModeRenderer::collectBlendLight(RendererLight& light, const IRenderView& view)
+bool LightingModeRenderer::evictUnusedShadowMapTile()
 {
-    BlendLight blendLight(light, _geometryStore, _objectRenderer);
+    auto oldest = _shadowMapTiles.end();
 
-    if (!blendLight.isInView(view))
+    for (auto tile = _shadowMapTiles.begin(); tile != _shadowMapTiles.end(); ++tile)
     {
-        _result->skippedLights++;
-        return;
+        if (tile->second.lastUsedPass < _renderPass &&
+            (oldest == _shadowMapTiles.end() || tile->second.lastUsedPass < oldest->second.lastUsedPass))
+        {
+            oldest = tile;
+        }
+    }
+
+    if (oldest == _shadowMapTiles.end())
+    {
+        return false; // all tiles are in use
     }
 
-    // Check all the surfaces that are touching this light
-    blendLight.collectSurfaces(view, _entities);
+    _shadowMapAtlas->free(oldest->second.rectangle);
+    _shadowMapTiles.erase(oldest);
 
-    _result->visibleLights++;
-    _result->objects += blendLight.getObjectCount();
+    return true;
+}
 
-    // Move the light into its place
-    _blendLights.emplace_back(std::move(blendLight));
+void LightingModeRenderer::clearShadowMapTiles()
+{
+    _shadowMapTiles.clear();
 
-    // Make sure we have the blend light program around
-    if (!_blendLightProgram)
+    if (_shadowMapAtlas)
     {
-        _blendLightProgram = dynamic_cast<BlendLightProgram*>(
-            _programFactory.getBuiltInProgram(ShaderProgram::BlendLight));
-        assert(_blendLightProgram != nullptr);
+        _shadowMapAtlas->clear();
     }
 }
 
-void LightingModeRenderer::addToShadowLights(RegularLight& light, const Vector3& viewer)
+void LightingModeRenderer::collectSurfaces(const IRenderView& view)
 {
-    if (_nearestShadowLights.empty())
+    // Entities are building their pending geometry (which is touching the
+    // shared geometry store) and caching the bounds of their objects here,
+    // the collection below is only reading them
+    for (auto entity : _cachedEntityPointers)
     {
-        _nearestShadowLights.push_back(&light);
+        entity->prepareRenderableBounds();
+    }
+
+    auto numLights = _regularLights.size() + _blendLights.size();
+
+    auto collectSurfacesOfLight = [&](std::size_t index)
+    {
+        if (index < _regularLights.size())
+        {
+            auto& light = _regularLights[index];
+            auto& surfaces = *_regularLightSurfaces[index];
+
+            surfaces.update(light.getLightBounds(), _cachedEntityPointers, _entityChangePasses, _renderPass);
+            light.collectSurfaces(view, surfaces);
+        }
+        else
+        {
+            auto& light = _blendLights[index - _regularLights.size()];
+            auto& surfaces = *_blendLightSurfaces[index - _regularLights.size()];
+
+            surfaces.update(light.getLightBounds(), _cachedEntityPointers, _entityChangePasses, _renderPass);
+            light.collectSurfaces(view, surfaces);
+        }
+    };
+
+    if (numLights < MinLightsForParallelCollection)
+    {
+        for (std::size_t i = 0; i < numLights; ++i)
+        {
+            collectSurfacesOfLight(i);
+        }
+
         return;
     }
 
-    auto distance = (light.getBoundsCenter() - viewer).getLengthSquared();
+    // The prepared entities are only read during collection,
+    // every light is filling its own surface lists
+    parallel::forEachIndex(numLights, collectSurfacesOfLight);
+}
+
+void LightingModeRenderer::updateEntityChanges()
+{
+    ++_renderPass;
 
-    for (auto other = _nearestShadowLights.begin(); other != _nearestShadowLights.end(); ++other)
+    auto isSameEntity = [](const IRenderEntityPtr& entity, const IRenderEntityWeakPtr& cached)
     {
-        if (((*other)->getBoundsCenter() - viewer).getLengthSquared() > distance)
+        return !entity.owner_before(cached) && !cached.owner_before(entity);
+    };
+
+    if (_cachedEntities.size() != _entities.size() ||
+        !std::equal(_entities.begin(), _entities.end(), _cachedEntities.begin(), isSameEntity))
+    {
+        // The cached entity indices are invalid, start over. Lights are entities
+        // too, so the light pointers used as keys might be invalid as well.
+        _lightSurfaceCaches.clear();
+        clearShadowMapTiles();
+        _cachedEntities.clear();
+        _cachedEntityPointers.clear();
+        _entityChangeCounts.clear();
+        _entityChangePasses.clear();
+
+        for (const auto& entity : _entities)
         {
-            // Insert here
-            _nearestShadowLights.insert(other, &light);
+            _cachedEntities.push_back(entity);
+            _cachedEntityPointers.push_back(entity.get());
+            _entityChangeCounts.push_back(entity->getRenderableChangeCount());
+            _entityChangePasses.push_back(_renderPass);
+        }
 
-            if (_nearestShadowLights.size() > MaxShadowCastingLights)
-            {
-                _nearestShadowLights.pop_back();
-            }
-            return;
+        return;
+    }
+
+    for (std::size_t i = 0; i < _cachedEntityPointers.size(); ++i)
+    {
+        auto changeCount = _cachedEntityPointers[i]->getRenderableChangeCount();
+
+        if (changeCount != _entityChangeCounts[i])
+        {
+            _entityChangeCounts[i] = changeCount;
+            _entityChangePasses[i] = _renderPass;
         }
     }
+}
 
-    // All existing lights are nearer, is there room at the end?
-    if (_nearestShadowLights.size() < MaxShadowCastingLights)
+void LightingModeRenderer::collectRegularLight(RendererLight& light, const IRenderView& view)
+{
+    RegularLight interaction(light, _geometryStore, _objectRenderer);
+
+    if (!interaction.isInView(view))
+    {
+        _result->skippedLights++;
+        return;
+    }
+
+    // Move the interaction list into its place, surfaces are collected later
+    _regularLights.emplace_back(std::move(interaction));
+    _regularLightSurfaces.push_back(&_lightSurfaceCaches[&light]);
+}
+
+void LightingModeRenderer::collectBlendLight(RendererLight& light, const IRenderView& view)
+{
+    BlendLight blendLight(light, _geometryStore, _objectRenderer);
+
+    if (!blendLight.isInView(view))
+    {
+        _result->skippedLights++;
+        return;
+    }
+
+    // Move the light into its place, surfaces are collected later
+    _blendLights.emplace_back(std::move(blendLight));
+    _blendLightSurfaces.push_back(&_lightSurfaceCaches[&light]);
+
+    // Make sure we have the blend light program around
+    if (!_blendLightProgram)
     {
-        _nearestShadowLights.push_back(&light);
+        _blendLightProgram = dynamic_cast<BlendLightProgram*>(
+            _programFactory.getBuiltInProgram(ShaderProgram::BlendLight));
+        assert(_blendLightProgram != nullptr);
     }
 }
 
@@ -255,7 +490,7 @@ void LightingModeRenderer::drawInteractingLights(OpenGLState& current, RenderSta
         {
             // Define which part of the shadow map atlas should be sampled
             interactionProgram->enableShadowMapping(true);
-            interactionProgram->setShadowMapRectangle(_shadowMapAtlas[shadowLightIndex]);
+            interactionProgram->setShadowMapRectangle(_shadowLightTiles[shadowLightIndex]->rectangle);
         }
         else
         {
@@ -296,6 +531,19 @@ void LightingModeRenderer::drawShadowMaps(OpenGLState& current,std::size_t rende
 {
     if (!_shadowMappingEnabled.get()) return;
 
+    _result->shadowMaps = _shadowLights.size();
+
+    // Tiles of lights that didn't change since the last pass are kept as they are
+    for (auto tile : _shadowLightTiles)
+    {
+        if (!tile->needsRedraw)
+        {
+            _result->cachedShadowMaps++;
+        }
+    }
+
+    if (_result->cachedShadowMaps == _result->shadowMaps) return;
+
     // Draw the shadow maps of each light
     // Save the viewport set up in the camera code
     GLint previousViewport[4];
@@ -326,16 +574,25 @@ void LightingModeRenderer::drawShadowMaps(OpenGLState& current,std::size_t rende
     glEnable(GL_CLIP_DISTANCE2);
     glEnable(GL_CLIP_DISTANCE3);
 
-    glViewport(0, 0, static_cast<GLsizei>(_shadowMapFbo->getWidth()), static_cast<GLsizei>(_shadowMapFbo->getHeight()));
-    glClear(GL_DEPTH_BUFFER_BIT);
+    // Only the tiles being re-drawn are cleared, using the scissor box
+    glEnable(GL_SCISSOR_TEST);
 
-    // Render shadow casting lights to the shadow map buffer, up to MaxShadowLightCount
-    for (auto light : _nearestShadowLights)
+    // Render shadow casting lights to their tiles of the shadow map buffer
+    for (std::size_t i = 0; i < _shadowLights.size(); ++i)
     {
-        light->drawShadowMap(current, _shadowMapAtlas[light->getShadowLightIndex()], *_shadowMapProgram, renderTime);
-        _result->shadowDrawCalls += light->getShadowMapDrawCalls();
+        const auto& tile = *_shadowLightTiles[i];
+
+        if (!tile.needsRedraw) continue;
+
+        glScissor(tile.rectangle.x, tile.rectangle.y, 6 * tile.rectangle.width, tile.rectangle.width);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        _shadowLights[i]->drawShadowMap(current, tile.rectangle, *_shadowMapProgram, renderTime);
+        _result->shadowDrawCalls += _shadowLights[i]->getShadowMapDrawCalls();
     }
 
+    glDisable(GL_SCISSOR_TEST);
+
     _shadowMapFbo->unbind();
     _shadowMapProgram->disable();
 
@@ -383,6 +640,12 @@ void LightingModeRenderer::drawDepthFillPass(OpenGLState& current, RenderStateFl
         depthFillProgram->setObjectTransform(Matrix4::getIdentity());
         depthFillProgram->setAlphaTest(-1);
 
+        // Objects touching more than one light have been collected multiple times,
+        // sorting the slots is grouping the geometry by its location in the buffers
+        std::sort(_untransformedObjectsWithoutAlphaTest.begin(), _untransformedObjectsWithoutAlphaTest.end());
+        _untransformedObjectsWithoutAlphaTest.erase(std::unique(_untransformedObjectsWithoutAlphaTest.begin(),
+            _untransformedObjectsWithoutAlphaTest.end()), _untransformedObjectsWithoutAlphaTest.end());
+
         _objectRenderer.submitGeometry(_untransformedObjectsWithoutAlphaTest, GL_TRIANGLES);
         _result->depthDrawCalls++;
 
@@ -7,10 +7,12 @@
 #include "iobjectrenderer.h"
 #include "FrameBuffer.h"
 #include "render/Rectangle.h"
+#include "render/ShadowMapAtlas.h"
 #include "glprogram/ShadowMapProgram.h"
 #include "glprogram/BlendLightProgram.h"
 #include "RegularLight.h"
 #include "BlendLight.h"
+#include "LightSurfaceCache.h"
 #include "registry/CachedKey.h"
 
 namespace render
@@ -37,19 +39,63 @@ private:
     std::vector<IGeometryStore::Slot> _untransformedObjectsWithoutAlphaTest;
 
     FrameBuffer::Ptr _shadowMapFbo;
-    std::vector<Rectangle> _shadowMapAtlas;
+    std::unique_ptr<ShadowMapAtlas> _shadowMapAtlas;
     ShadowMapProgram* _shadowMapProgram;
     BlendLightProgram* _blendLightProgram;
 
-    constexpr static std::size_t MaxShadowCastingLights = 6;
+    // Upper limit of lights getting a shadow map in a single pass, the
+    // actual number depends on the space left in the shadow map atlas
+    constexpr static std::size_t MaxShadowCastingLights = 64;
+
+    // Lights covering less than this (radius/distance) get smaller shadow map tiles
+    constexpr static double MinCoverageForMaxShadowMapSize = 0.5;
+
+    // Below this number of visible lights the surfaces are collected in the render thread
+    constexpr static std::size_t MinLightsForParallelCollection = 4;
 
     registry::CachedKey<bool> _shadowMappingEnabled;
 
+    // Data kept across render passes, to avoid re-collecting the surfaces
+    // of lights whose surroundings haven't changed
+
+    std::size_t _renderPass;
+
+    // The entities the surface caches are referring to (by index). For each entity
+    // the last seen change count and the render pass it changed in is recorded.
+    std::vector<IRenderEntityWeakPtr> _cachedEntities;
+    std::vector<IRenderEntity*> _cachedEntityPointers;
+    std::vector<std::size_t> _entityChangeCounts;
+    std::vector<std::size_t> _entityChangePasses;
+
+    std::map<RendererLight*, LightSurfaceCache> _lightSurfaceCaches;
+
+    // The region of the shadow map atlas assigned to a light. Tiles of lights
+    // which are out of view are kept until the space is needed elsewhere.
+    struct ShadowMapTile
+    {
+        Rectangle rectangle;
+        std::size_t lastUsedPass = 0;
+
+        // The state the depth contents of this tile have been rendered with
+        bool hasContents = false;
+        Vector3 lightOrigin;
+        std::size_t surfaceChange = 0;
+        std::size_t casterSignature = RegularLight::NoShadowCasterSignature;
+
+        // Whether the contents need to be rendered in the current pass
+        bool needsRedraw = true;
+    };
+
+    std::map<const RendererLight*, ShadowMapTile> _shadowMapTiles;
+
     // Data that is valid during a single render pass only
 
     std::vector<RegularLight> _regularLights;
-    std::vector<RegularLight*> _nearestShadowLights;
+    std::vector<LightSurfaceCache*> _regularLightSurfaces;
+    std::vector<RegularLight*> _shadowLights;
+    std::vector<ShadowMapTile*> _shadowLightTiles;
     std::vector<BlendLight> _blendLights;
+    std::vector<LightSurfaceCache*> _blendLightSurfaces;
 
     std::shared_ptr<LightingModeRenderResult> _result;
 
@@ -66,6 +112,8 @@ private:
     void collectLights(const IRenderView& view);
     void collectBlendLight(RendererLight& light, const IRenderView& view);
     void collectRegularLight(RendererLight& light, const IRenderView& view);
+    void collectSurfaces(const IRenderView& view);
+    void updateEntityChanges();
 
     void drawInteractingLights(OpenGLState& current, RenderStateFlags globalFlagsMask,
         const IRenderView& view, std::size_t renderTime);
@@ -83,7 +131,9 @@ private:
 
     void ensureShadowMapSetup();
 
-    void addToShadowLights(RegularLight& light, const Vector3& viewer);
+    void assignShadowMapTiles(const IRenderView& view);
+    bool evictUnusedShadowMapTile();
+    void clearShadowMapTiles();
 };
 
 }
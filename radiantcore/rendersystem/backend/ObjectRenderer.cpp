@@ -4,14 +4,27 @@
 #include "irenderableobject.h"
 #include "math/Matrix4.h"
 #include "render/RenderVertex.h"
+#include "debugging/gl.h"
+
+#include <cstdint>
 
 namespace render
 {
 
 ObjectRenderer::ObjectRenderer(IGeometryStore& store) :
-    _store(store)
+    _store(store),
+    _drawCommandBuffer(0)
 {}
 
+void ObjectRenderer::releaseBuffers()
+{
+    if (_drawCommandBuffer != 0)
+    {
+        glDeleteBuffers(1, &_drawCommandBuffer);
+        _drawCommandBuffer = 0;
+    }
+}
+
 void ObjectRenderer::submitObject(IRenderableObject& object)
 {
     // Orient the object
@@ -114,10 +127,59 @@ void ObjectRenderer::submitGeometry(const std::vector<IGeometryStore::Slot>& slo
 
 void ObjectRenderer::submitInstancedGeometry(const std::vector<IGeometryStore::Slot>& slots, int numInstances, GLenum primitiveMode)
 {
+    if (slots.empty()) return;
+
+    // There's no instanced variant of glMultiDrawElementsBaseVertex,
+    // fall back to one draw call per slot if indirect drawing is not available
+    if (slots.size() > 1 && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect))
+    {
+        submitInstancedGeometryIndirect(slots, numInstances, primitiveMode);
+        return;
+    }
+
     for (const auto slot : slots)
     {
         submitInstancedGeometry(slot, numInstances, primitiveMode);
     }
 }
 
+void ObjectRenderer::submitInstancedGeometryIndirect(const std::vector<IGeometryStore::Slot>& slots, int numInstances, GLenum primitiveMode)
+{
+    _drawCommands.clear();
+    _drawCommands.reserve(slots.size());
+
+    for (const auto slot : slots)
+    {
+        auto renderParams = _store.getBufferAddresses(slot);
+
+        // The first index is passed as byte offset into the bound index buffer
+        auto firstIndex = reinterpret_cast<std::uintptr_t>(renderParams.firstIndex) / sizeof(unsigned int);
+
+        _drawCommands.push_back(DrawElementsIndirectCommand
+        {
+            static_cast<GLuint>(renderParams.indexCount),
+            static_cast<GLuint>(numInstances),
+            static_cast<GLuint>(firstIndex),
+            static_cast<GLint>(renderParams.firstVertex),
+            0
+        });
+    }
+
+    if (_drawCommandBuffer == 0)
+    {
+        glGenBuffers(1, &_drawCommandBuffer);
+    }
+
+    // Re-specify the whole buffer every time, the driver can hand out a fresh
+    // storage without waiting for the previous draw calls to finish
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _drawCommandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(_drawCommands.size() * sizeof(DrawElementsIndirectCommand)),
+        _drawCommands.data(), GL_STREAM_DRAW);
+
+    glMultiDrawElementsIndirect(primitiveMode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(_drawCommands.size()), 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    debug::assertNoGlErrors();
+}
+
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <set>
+#include <vector>
 #include "iobjectrenderer.h"
 
 namespace render
@@ -17,9 +18,28 @@ class ObjectRenderer :
 private:
     IGeometryStore& _store;
 
+    // Layout of a single command in the GL_DRAW_INDIRECT_BUFFER
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Command list used for batched instanced draws, built on the CPU
+    // and uploaded to the buffer object for every submission
+    std::vector<DrawElementsIndirectCommand> _drawCommands;
+    GLuint _drawCommandBuffer;
+
 public:
     ObjectRenderer(IGeometryStore& store);
 
+    // Deletes the GL buffer objects, the shared GL context needs to be current.
+    // They are created again on demand.
+    void releaseBuffers();
+
     // Initialise the vertex attribute pointers using the given start address (can be nullptr)
     void initAttributePointers() override;
 
@@ -42,7 +62,11 @@ public:
     void submitGeometry(const std::vector<IGeometryStore::Slot>& slots, GLenum primitiveMode) override;
 
     // Draws all geometry as defined by their store IDs in the given mode, no transforms (std::vector variant)
+    // Uses a single glMultiDrawElementsIndirect call if supported by the driver.
     void submitInstancedGeometry(const std::vector<IGeometryStore::Slot>& slots, int numInstances, GLenum primitiveMode) override;
+
+private:
+    void submitInstancedGeometryIndirect(const std::vector<IGeometryStore::Slot>& slots, int numInstances, GLenum primitiveMode);
 };
 
 }
@@ -1,11 +1,14 @@
 #include "RegularLight.h"
 
 #include "ishaders.h"
+#include "math/Hash.h"
 #include "OpenGLShader.h"
 #include "ObjectRenderer.h"
 #include "glprogram/DepthFillAlphaProgram.h"
 #include "glprogram/ShadowMapProgram.h"
 
+#include <algorithm>
+
 namespace render
 {
 
@@ -48,55 +51,77 @@ bool RegularLight::isShadowCasting() const
     return _isShadowCasting;
 }
 
-void RegularLight::collectSurfaces(const IRenderView& view, const std::set<IRenderEntityPtr>& entities)
+std::size_t RegularLight::getShadowCasterSignature() const
 {
-    bool shadowCasting = isShadowCasting();
+    std::size_t signature = 1;
 
-    // Now check all the entities intersecting with this light
-    for (const auto& entity : entities)
+    // Visit the objects in the same way drawShadowMap() does
+    for (const auto& [entity, objectsByShader] : _objectsByEntity)
     {
-        entity->foreachRenderableTouchingBounds(_lightBounds,
-            [&](const IRenderableObject::Ptr& object, Shader* shader)
+        if (!entity->isShadowCasting()) continue;
+
+        for (const auto& [shader, objects] : objectsByShader)
         {
-            // Skip empty objects
-            if (!object->isVisible()) return;
+            const auto& material = shader->getMaterial();
 
-            // Don't collect invisible shaders
-            if (!shader->isVisible()) return;
+            if (!material->surfaceCastsShadow()) continue;
 
-            // For non-shadow lights we can cull surfaces that are not in view
-            if (!shadowCasting)
+            // The alpha test might be affected by time and entity parms
+            if (material->getCoverage() == Material::MC_PERFORATED)
             {
-                if (object->isOriented())
-                {
-                    if (view.TestAABB(object->getObjectBounds(), object->getObjectTransform()) == VOLUME_OUTSIDE)
-                    {
-                        return;
-                    }
-                }
-                else if (view.TestAABB(object->getObjectBounds()) == VOLUME_OUTSIDE) // non-oriented AABB test
-                {
-                    return;
-                }
+                return NoShadowCasterSignature;
             }
 
-            auto glShader = static_cast<OpenGLShader*>(shader);
+            math::combineHash(signature, std::hash<OpenGLShader*>()(shader));
 
-            // We only consider materials designated for camera rendering
-            if (!glShader->isApplicableTo(RenderViewType::Camera))
+            for (const auto& object : objects)
             {
-                return;
-            }
+                if (!object.get().isShadowCasting()) continue;
 
-            // Collect all interaction surfaces and the ones with forceShadows materials
-            if (!glShader->getInteractionPass() && (!shader->getMaterial() || !shader->getMaterial()->surfaceCastsShadow()))
-            {
-                return; // This material doesn't interact with this light
+                math::combineHash(signature, std::hash<IRenderableObject*>()(&object.get()));
+                math::combineHash(signature, std::hash<IGeometryStore::Slot>()(object.get().getStorageLocation()));
             }
-
-            addObject(*object, *entity, glShader);
-        });
+        }
     }
+
+    return signature != NoShadowCasterSignature ? signature : signature + 1;
+}
+
+void RegularLight::collectSurfaces(const IRenderView& view, const LightSurfaceCache& surfaces)
+{
+    bool shadowCasting = isShadowCasting();
+
+    // Check all the objects intersecting with this light
+    surfaces.foreachSurface([&](IRenderEntity& entity, IRenderableObject& object, Shader* shader, const AABB& bounds)
+    {
+        // Skip empty objects
+        if (!object.isVisible()) return;
+
+        // Don't collect invisible shaders
+        if (!shader->isVisible()) return;
+
+        // For non-shadow lights we can cull surfaces that are not in view
+        if (!shadowCasting && view.TestAABB(bounds) == VOLUME_OUTSIDE)
+        {
+            return;
+        }
+
+        auto glShader = static_cast<OpenGLShader*>(shader);
+
+        // We only consider materials designated for camera rendering
+        if (!glShader->isApplicableTo(RenderViewType::Camera))
+        {
+            return;
+        }
+
+        // Collect all interaction surfaces and the ones with forceShadows materials
+        if (!glShader->getInteractionPass() && (!shader->getMaterial() || !shader->getMaterial()->surfaceCastsShadow()))
+        {
+            return; // This material doesn't interact with this light
+        }
+
+        addObject(object, entity, glShader);
+    });
 }
 
 void RegularLight::fillDepthBuffer(OpenGLState& state, DepthFillAlphaProgram& program, 
@@ -162,6 +187,11 @@ void RegularLight::drawShadowMap(OpenGLState& state, const Rectangle& rectangle,
     std::vector<IGeometryStore::Slot> untransformedObjects;
     untransformedObjects.reserve(1000);
 
+    // Objects without transform and alpha test share the same state,
+    // they are submitted all at once after everything else is done
+    std::vector<IGeometryStore::Slot> untransformedObjectsWithoutAlphaTest;
+    untransformedObjectsWithoutAlphaTest.reserve(10000);
+
     program.setLightOrigin(_light.getLightOrigin());
 
     // Set evaluated stage texture transformation matrix to the GLSL uniform
@@ -183,6 +213,8 @@ void RegularLight::drawShadowMap(OpenGLState& state, const Rectangle& rectangle,
             // Set up alphatest (it's ok to pass a nullptr as depth fill pass)
             setupAlphaTest(state, shader, shader->getDepthFillPass(), program, renderTime, entity);
 
+            auto hasAlphaTest = material->getCoverage() == Material::MC_PERFORATED;
+
             for (const auto& object : objects)
             {
                 // Skip models with "noshadows" set (this might be redundant to the entity check above)
@@ -191,7 +223,15 @@ void RegularLight::drawShadowMap(OpenGLState& state, const Rectangle& rectangle,
                 // We submit all objects with an identity matrix in a single multi draw call
                 if (!object.get().isOriented())
                 {
-                    untransformedObjects.push_back(object.get().getStorageLocation());
+                    if (hasAlphaTest)
+                    {
+                        untransformedObjects.push_back(object.get().getStorageLocation());
+                    }
+                    else
+                    {
+                        untransformedObjectsWithoutAlphaTest.push_back(object.get().getStorageLocation());
+                    }
+
                     continue;
                 }
 
@@ -213,6 +253,18 @@ void RegularLight::drawShadowMap(OpenGLState& state, const Rectangle& rectangle,
         }
     }
 
+    if (!untransformedObjectsWithoutAlphaTest.empty())
+    {
+        program.setAlphaTest(-1);
+        program.setObjectTransform(Matrix4::getIdentity());
+
+        // Sorting by slot is grouping the geometry by its location in the buffers
+        std::sort(untransformedObjectsWithoutAlphaTest.begin(), untransformedObjectsWithoutAlphaTest.end());
+
+        _objectRenderer.submitInstancedGeometry(untransformedObjectsWithoutAlphaTest, 6, GL_TRIANGLES);
+        ++_shadowMapDrawCalls;
+    }
+
     debug::assertNoGlErrors();
 }
 
@@ -9,6 +9,7 @@
 #include "irenderview.h"
 #include "render/Rectangle.h"
 #include "InteractionPass.h"
+#include "LightSurfaceCache.h"
 
 namespace render
 {
@@ -170,11 +171,26 @@ public:
 
     void addObject(IRenderableObject& object, IRenderEntity& entity, OpenGLShader* shader);
 
+    const AABB& getLightBounds() const
+    {
+        return _lightBounds;
+    }
+
     bool isInView(const IRenderView& view);
 
     bool isShadowCasting() const;
 
-    void collectSurfaces(const IRenderView& view, const std::set<IRenderEntityPtr>& entities);
+    // Value returned by getShadowCasterSignature() if the shadow map
+    // needs to be rendered in every pass
+    constexpr static std::size_t NoShadowCasterSignature = 0;
+
+    // Calculates a hash over the objects and materials drawn into this light's
+    // shadow map. Together with the surface change tracking of the light this
+    // is telling whether the shadow map of a previous pass can be re-used.
+    std::size_t getShadowCasterSignature() const;
+
+    // Collects the cached surfaces that are interacting with this light in the given view
+    void collectSurfaces(const IRenderView& view, const LightSurfaceCache& surfaces);
 
     void fillDepthBuffer(OpenGLState& state, DepthFillAlphaProgram& program, 
         std::size_t renderTime, std::vector<IGeometryStore::Slot>& untransformedObjectsWithoutAlphaTest);
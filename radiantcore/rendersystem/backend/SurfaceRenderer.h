@@ -17,15 +17,28 @@ private:
     IGeometryStore& _store;
     IObjectRenderer& _renderer;
 
+    // Surfaces returning the very same vertex and index arrays (like the
+    // instances of a static model) are sharing their storage
+    using StorageKey = std::pair<const std::vector<MeshVertex>*, const std::vector<unsigned int>*>;
+
+    struct SharedStorage
+    {
+        IGeometryStore::Slot storageHandle;
+        std::size_t numSurfaces;
+    };
+    std::map<StorageKey, SharedStorage> _storage;
+
     struct SurfaceInfo
     {
         std::reference_wrapper<IRenderableSurface> surface;
         bool surfaceDataChanged;
+        StorageKey storageKey;
         IGeometryStore::Slot storageHandle;
 
-        SurfaceInfo(IRenderableSurface& surface_, IGeometryStore::Slot slot) :
+        SurfaceInfo(IRenderableSurface& surface_, const StorageKey& key, IGeometryStore::Slot slot) :
             surface(surface_),
             surfaceDataChanged(false),
+            storageKey(key),
             storageHandle(slot)
         {}
     };
@@ -54,15 +67,10 @@ public:
         // Find a free slot
         auto newSlotIndex = getNextFreeSlotIndex();
 
-        const auto& vertices = surface.getVertices();
-        const auto& indices = surface.getIndices();
-
-        auto slot = _store.allocateSlot(vertices.size(), indices.size());
-
-        // Transform the vertices to single precision
-        _store.updateData(slot, ConvertToRenderVertices(vertices), indices);
+        auto key = getStorageKey(surface);
+        auto storageHandle = acquireStorage(key, surface);
 
-        _surfaces.emplace(newSlotIndex, SurfaceInfo(surface, slot));
+        _surfaces.emplace(newSlotIndex, SurfaceInfo(surface, key, storageHandle));
 
         return newSlotIndex;
     }
@@ -72,8 +80,8 @@ public:
         auto surface = _surfaces.find(slot);
         assert(surface != _surfaces.end());
 
-        // Deallocate the storage
-        _store.deallocateSlot(surface->second.storageHandle);
+        // Deallocate the storage if no other surface is using it
+        releaseStorage(surface->second.storageKey);
         _surfaces.erase(surface);
 
         if (slot < _freeSlotMappingHint)
@@ -127,7 +135,20 @@ public:
                 surfaceInfo.surfaceDataChanged = false;
 
                 auto& surface = surfaceInfo.surface.get();
-                _store.updateData(surfaceInfo.storageHandle, ConvertToRenderVertices(surface.getVertices()), surface.getIndices());
+                auto key = getStorageKey(surface);
+
+                if (key == surfaceInfo.storageKey)
+                {
+                    // Still the same arrays, any other surface sharing them sees the change too
+                    _store.updateData(surfaceInfo.storageHandle, ConvertToRenderVertices(surface.getVertices()), surface.getIndices());
+                    continue;
+                }
+
+                // The surface switched to different arrays (e.g. a model got its own scaled copy)
+                releaseStorage(surfaceInfo.storageKey);
+
+                surfaceInfo.storageKey = key;
+                surfaceInfo.storageHandle = acquireStorage(key, surface);
             }
         }
 
@@ -135,6 +156,47 @@ public:
     }
 
 private:
+    static StorageKey getStorageKey(IRenderableSurface& surface)
+    {
+        return StorageKey(&surface.getVertices(), &surface.getIndices());
+    }
+
+    // Returns the storage holding the given arrays, allocates and fills it on first use
+    IGeometryStore::Slot acquireStorage(const StorageKey& key, IRenderableSurface& surface)
+    {
+        auto existing = _storage.find(key);
+
+        if (existing != _storage.end())
+        {
+            existing->second.numSurfaces++;
+            return existing->second.storageHandle;
+        }
+
+        const auto& vertices = surface.getVertices();
+        const auto& indices = surface.getIndices();
+
+        auto slot = _store.allocateSlot(vertices.size(), indices.size());
+
+        // Transform the vertices to single precision
+        _store.updateData(slot, ConvertToRenderVertices(vertices), indices);
+
+        _storage.emplace(key, SharedStorage{ slot, 1 });
+
+        return slot;
+    }
+
+    void releaseStorage(const StorageKey& key)
+    {
+        auto existing = _storage.find(key);
+        assert(existing != _storage.end());
+
+        if (--existing->second.numSurfaces == 0)
+        {
+            _store.deallocateSlot(existing->second.storageHandle);
+            _storage.erase(existing);
+        }
+    }
+
     static std::vector<RenderVertex> ConvertToRenderVertices(const std::vector<MeshVertex>& vertices)
     {
         std::vector<RenderVertex> transformedVertices;
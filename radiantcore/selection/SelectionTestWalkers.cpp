@@ -6,6 +6,7 @@
 #include "igroupnode.h"
 #include "iselectiontest.h"
 #include "entitylib.h"
+#include "scenelib.h"
 #include "debugging/ScenegraphUtils.h"
 
 namespace selection
@@ -40,10 +41,17 @@ bool SelectionTestWalker::entityIsWorldspawn(const scene::INodePtr& node)
 	return Node_isWorldspawn(node);
 }
 
+bool SelectionTestWalker::primitiveIsOutsideTestVolume(const scene::INodePtr& node) const
+{
+    // Only brushes and patches are guaranteed to contain all their selectable
+    // geometry within their bounds, leave all other node types alone
+    return Node_isPrimitive(node) && _test.getVolume().TestAABB(node->worldAABB()) == VOLUME_OUTSIDE;
+}
+
 void SelectionTestWalker::performSelectionTest(const scene::INodePtr& selectableNode,
 	const scene::INodePtr& nodeToBeTested)
 {
-    if (!nodeIsEligibleForTesting(nodeToBeTested))
+    if (!nodeIsEligibleForTesting(nodeToBeTested) || primitiveIsOutsideTestVolume(nodeToBeTested))
     {
         return;
     }
@@ -172,6 +180,11 @@ void ComponentSelector::visit(const scene::INodePtr& node) const
 
 void ComponentSelector::performComponentselectionTest(const scene::INodePtr& node) const
 {
+	if (primitiveIsOutsideTestVolume(node))
+	{
+		return;
+	}
+
 	ComponentSelectionTestablePtr testable = Node_getComponentSelectionTestable(node);
 
 	if (testable)
@@ -40,6 +40,11 @@ protected:
         return node->getNodeType() != scene::INode::Type::MergeAction;
     }
 
+    // Returns true if the given node is a brush or patch whose bounds are
+    // entirely outside the test volume. Such primitives cannot produce any
+    // intersection, so we can skip the per-face or per-triangle tests.
+    bool primitiveIsOutsideTestVolume(const scene::INodePtr& node) const;
+
 	// Performs the actual selection test on the given node
 	// The nodeToBeTested is the node that is tested against, whereas 
 	// the selectableNode is the one that gets pushed to the Selector
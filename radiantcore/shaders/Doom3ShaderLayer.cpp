@@ -422,40 +422,26 @@ void Doom3ShaderLayer::setCondition(const IShaderExpression::Ptr& conditionExpr)
 
 void Doom3ShaderLayer::evaluateExpressions(std::size_t time)
 {
-    for (const auto& slot : _expressionSlots)
-    {
-        if (slot.expression)
-        {
-            slot.expression->evaluate(time);
-        }
-    }
-
-    for (const auto& parm : _vertexParms)
-    {
-        if (parm.expression)
-        {
-            parm.expression->evaluate(time);
-        }
-    }
+    _expressionSlots.evaluateExpressions(time, nullptr);
+    evaluateVertexParms(time, nullptr);
 }
 
 void Doom3ShaderLayer::evaluateExpressions(std::size_t time, const IRenderEntity& entity)
 {
-    for (const auto& slot : _expressionSlots)
-    {
-        if (slot.expression)
-        {
-            slot.expression->evaluate(time, entity);
-        }
-    }
+    _expressionSlots.evaluateExpressions(time, &entity);
+    evaluateVertexParms(time, &entity);
+}
 
-    for (const auto& parm : _vertexParms)
+void Doom3ShaderLayer::evaluateVertexParms(std::size_t time, const IRenderEntity* entity)
+{
+    if (_vertexParms.empty()) return;
+
+    if (!_vertexParmProgram.isCompiledFrom(_vertexParms))
     {
-        if (parm.expression)
-        {
-            parm.expression->evaluate(time, entity);
-        }
+        _vertexParmProgram.compile(_vertexParms);
     }
+
+    _vertexParmProgram.evaluate(time, entity, _registers);
 }
 
 IShaderExpression::Ptr Doom3ShaderLayer::getExpression(Expression::Slot slot)
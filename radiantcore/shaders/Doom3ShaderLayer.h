@@ -82,6 +82,9 @@ private:
     std::vector<ExpressionSlot> _vertexParms;
     std::vector<VertexParm> _vertexParmDefinitions;
 
+    // The compiled vertex parm expressions, rebuilt when the parms change
+    ExpressionProgram _vertexParmProgram;
+
     // The array of fragment maps
     std::vector<FragmentMap> _fragmentMaps;
 
@@ -287,6 +290,7 @@ public:
 
 private:
     void recalculateTransformationMatrix();
+    void evaluateVertexParms(std::size_t time, const IRenderEntity* entity);
 };
 
 }
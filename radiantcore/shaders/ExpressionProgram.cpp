@@ -0,0 +1,226 @@
+#include "ExpressionProgram.h"
+
+#include <cmath>
+#include "irender.h"
+#include "ExpressionSlots.h"
+#include "ShaderExpression.h"
+
+namespace shaders
+{
+
+ExpressionProgram::Compiler::Compiler(ExpressionProgram& program) :
+    _program(program)
+{}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::compile(const IShaderExpression::Ptr& expression)
+{
+    auto existing = _compiledExpressions.find(expression.get());
+
+    if (existing != _compiledExpressions.end())
+    {
+        return existing->second;
+    }
+
+    Operand result;
+
+    if (auto shaderExpression = dynamic_cast<ShaderExpression*>(expression.get()); shaderExpression)
+    {
+        result = shaderExpression->compile(*this);
+    }
+    else
+    {
+        // Unknown implementation, call it through its interface
+        _program._expressions.push_back(expression);
+        result = emit(OpCode::Expression, DependsOnTime | DependsOnEntity,
+            static_cast<std::uint32_t>(_program._expressions.size() - 1));
+    }
+
+    _compiledExpressions.emplace(expression.get(), result);
+
+    return result;
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::constant(float value)
+{
+    _program._values.push_back(value);
+    return Operand{ static_cast<std::uint32_t>(_program._values.size() - 1), 0 };
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::time()
+{
+    return emit(OpCode::Time, DependsOnTime);
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::shaderParm(int parmNum)
+{
+    return emit(OpCode::ShaderParm, DependsOnEntity, static_cast<std::uint32_t>(parmNum));
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::tableLookup(const ITableDefinition::Ptr& table, const IShaderExpression::Ptr& lookup)
+{
+    auto lookupValue = compile(lookup);
+
+    _program._tables.push_back(table);
+
+    return emit(OpCode::TableLookup, lookupValue.dependencies | DependsOnTable,
+        lookupValue.index, static_cast<std::uint32_t>(_program._tables.size() - 1));
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::binary(OpCode op, const IShaderExpression::Ptr& a, const IShaderExpression::Ptr& b)
+{
+    auto valueA = compile(a);
+    auto valueB = compile(b);
+
+    // Fold the operation if both operands are known in advance
+    if (valueA.dependencies == 0 && valueB.dependencies == 0)
+    {
+        return constant(applyOperation(op, _program._values[valueA.index], _program._values[valueB.index]));
+    }
+
+    return emit(op, valueA.dependencies | valueB.dependencies, valueA.index, valueB.index);
+}
+
+ExpressionProgram::Operand ExpressionProgram::Compiler::emit(OpCode op, int dependencies, std::uint32_t a, std::uint32_t b)
+{
+    _program._values.push_back(0);
+
+    auto target = static_cast<std::uint32_t>(_program._values.size() - 1);
+    auto& instructions = (dependencies & (DependsOnEntity | DependsOnTable)) != 0 ?
+        _program._instructions : _program._timeInstructions;
+
+    instructions.push_back(Instruction{ op, target, a, b });
+
+    return Operand{ target, dependencies };
+}
+
+ExpressionProgram::ExpressionProgram() :
+    _evaluatedTime(0),
+    _timeValuesValid(false)
+{}
+
+bool ExpressionProgram::isCompiledFrom(const std::vector<ExpressionSlot>& slots) const
+{
+    if (slots.size() != _sourceSlots.size())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].expression != _sourceSlots[i].first ||
+            (slots[i].expression && slots[i].registerIndex != _sourceSlots[i].second))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ExpressionProgram::compile(const std::vector<ExpressionSlot>& slots)
+{
+    _values.clear();
+    _timeInstructions.clear();
+    _instructions.clear();
+    _tables.clear();
+    _expressions.clear();
+    _registerStores.clear();
+    _sourceSlots.clear();
+    _timeValuesValid = false;
+
+    Compiler compiler(*this);
+
+    for (const auto& slot : slots)
+    {
+        _sourceSlots.emplace_back(slot.expression, slot.registerIndex);
+
+        if (!slot.expression) continue;
+
+        auto result = compiler.compile(slot.expression);
+        _registerStores.emplace_back(result.index, slot.registerIndex);
+    }
+}
+
+void ExpressionProgram::evaluate(std::size_t time, const IRenderEntity* entity, Registers& registers)
+{
+    if (!_timeValuesValid || time != _evaluatedTime)
+    {
+        execute(_timeInstructions, time, entity);
+
+        _evaluatedTime = time;
+        _timeValuesValid = true;
+    }
+
+    execute(_instructions, time, entity);
+
+    for (const auto& [valueIndex, registerIndex] : _registerStores)
+    {
+        registers[registerIndex] = _values[valueIndex];
+    }
+}
+
+float ExpressionProgram::applyOperation(OpCode op, float a, float b)
+{
+    switch (op)
+    {
+    case OpCode::Add: return a + b;
+    case OpCode::Subtract: return a - b;
+    case OpCode::Multiply: return a * b;
+    case OpCode::Divide: return a / b;
+    case OpCode::Modulo: return fmod(a, b);
+    case OpCode::LessThan: return a < b ? 1.0f : 0;
+    case OpCode::LessThanOrEqual: return a <= b ? 1.0f : 0;
+    case OpCode::GreaterThan: return a > b ? 1.0f : 0;
+    case OpCode::GreaterThanOrEqual: return a >= b ? 1.0f : 0;
+    case OpCode::Equal: return a == b ? 1.0f : 0;
+    case OpCode::NotEqual: return a != b ? 1.0f : 0;
+    case OpCode::LogicalAnd: return (a != 0 && b != 0) ? 1.0f : 0;
+    case OpCode::LogicalOr: return (a != 0 || b != 0) ? 1.0f : 0;
+    default:
+        return 0;
+    }
+}
+
+void ExpressionProgram::execute(const std::vector<Instruction>& instructions, std::size_t time, const IRenderEntity* entity)
+{
+    for (const auto& instruction : instructions)
+    {
+        float value;
+
+        switch (instruction.op)
+        {
+        case OpCode::Time:
+            value = time / 1000.0f; // convert msecs to secs
+            break;
+
+        case OpCode::ShaderParm:
+            if (entity)
+            {
+                value = entity->getShaderParm(static_cast<int>(instruction.a));
+            }
+            else
+            {
+                // RGBA _color parms [0-3] have default value 1.0, the rest is 0
+                value = instruction.a < 4 ? 1.0f : 0.0f;
+            }
+            break;
+
+        case OpCode::TableLookup:
+            value = _tables[instruction.b]->getValue(_values[instruction.a]);
+            break;
+
+        case OpCode::Expression:
+            value = entity ? _expressions[instruction.a]->getValue(time, *entity) :
+                _expressions[instruction.a]->getValue(time);
+            break;
+
+        default:
+            value = applyOperation(instruction.op, _values[instruction.a], _values[instruction.b]);
+            break;
+        }
+
+        _values[instruction.target] = value;
+    }
+}
+
+}
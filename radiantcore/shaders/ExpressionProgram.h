@@ -0,0 +1,143 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "ishaderexpression.h"
+#include "ishaders.h"
+
+class IRenderEntity;
+
+namespace shaders
+{
+
+struct ExpressionSlot;
+
+/**
+ * Flat representation of a set of shader expressions, which is evaluated
+ * without walking the expression trees.
+ *
+ * Every sub-expression is compiled into a single instruction writing its result
+ * to a value array. Sub-expressions only depending on constants are folded at
+ * compile time. Instructions depending on nothing but the time are skipped if
+ * the program is evaluated again with the same time, like it happens for the
+ * many entities using a material in a single frame. Everything depending on
+ * entity shader parms or tables (which might be re-parsed in the meantime)
+ * is calculated in every evaluation.
+ */
+class ExpressionProgram
+{
+public:
+    enum class OpCode : std::uint8_t
+    {
+        Time,           // time in seconds
+        ShaderParm,     // entity shader parm (a: parm number)
+        TableLookup,    // table lookup (a: lookup value, b: table index)
+        Expression,     // not compilable expression (a: expression index)
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo,
+        LessThan,
+        LessThanOrEqual,
+        GreaterThan,
+        GreaterThanOrEqual,
+        Equal,
+        NotEqual,
+        LogicalAnd,
+        LogicalOr,
+    };
+
+    // The things an expression value is depending on
+    enum Dependency
+    {
+        DependsOnTime = 1 << 0,
+        DependsOnEntity = 1 << 1,
+        DependsOnTable = 1 << 2, // tables can be re-parsed, don't fold lookups
+    };
+
+    // Reference to the result of a compiled (sub-)expression
+    struct Operand
+    {
+        std::uint32_t index;
+        int dependencies;
+    };
+
+    // Interface used by the ShaderExpression implementations to emit their instructions
+    class Compiler
+    {
+    private:
+        ExpressionProgram& _program;
+
+        // Sub-expressions shared by multiple slots are only compiled once
+        std::map<const IShaderExpression*, Operand> _compiledExpressions;
+
+    public:
+        Compiler(ExpressionProgram& program);
+
+        // Compiles the given (sub-)expression, returning the location of its result
+        Operand compile(const IShaderExpression::Ptr& expression);
+
+        Operand constant(float value);
+        Operand time();
+        Operand shaderParm(int parmNum);
+        Operand tableLookup(const ITableDefinition::Ptr& table, const IShaderExpression::Ptr& lookup);
+        Operand binary(OpCode op, const IShaderExpression::Ptr& a, const IShaderExpression::Ptr& b);
+
+    private:
+        Operand emit(OpCode op, int dependencies, std::uint32_t a = 0, std::uint32_t b = 0);
+    };
+
+private:
+    struct Instruction
+    {
+        OpCode op;
+        std::uint32_t target;
+        std::uint32_t a;
+        std::uint32_t b;
+    };
+
+    // Constants, followed by the results of all instructions
+    std::vector<float> _values;
+
+    // Instructions only depending on the time, and all the others
+    std::vector<Instruction> _timeInstructions;
+    std::vector<Instruction> _instructions;
+
+    std::vector<ITableDefinition::Ptr> _tables;
+    std::vector<IShaderExpression::Ptr> _expressions;
+
+    // The results to copy to the registers (value index => register index)
+    std::vector<std::pair<std::uint32_t, std::size_t>> _registerStores;
+
+    // The configuration of the slots this program has been compiled from. The
+    // references are keeping the addresses from being re-used by new expressions.
+    std::vector<std::pair<IShaderExpression::Ptr, std::size_t>> _sourceSlots;
+
+    // The time the time-dependent values have last been evaluated for
+    std::size_t _evaluatedTime;
+    bool _timeValuesValid;
+
+public:
+    ExpressionProgram();
+
+    // Returns true if this program has been compiled from the given slots,
+    // i.e. the same expressions linked to the same registers
+    bool isCompiledFrom(const std::vector<ExpressionSlot>& slots) const;
+
+    // Replaces the program with the compiled expressions of the given slots
+    void compile(const std::vector<ExpressionSlot>& slots);
+
+    // Evaluates all expressions, writing the results to the given registers.
+    // Without entity the default shader parm values are used.
+    void evaluate(std::size_t time, const IRenderEntity* entity, Registers& registers);
+
+    // Applies the given binary operation, used for evaluation and constant folding
+    static float applyOperation(OpCode op, float a, float b);
+
+private:
+    void execute(const std::vector<Instruction>& instructions, std::size_t time, const IRenderEntity* entity);
+};
+
+}
@@ -97,6 +97,17 @@ bool ExpressionSlots::expressionsAreEquivalent(IShaderLayer::Expression::Slot sl
     return false;
 }
 
+void ExpressionSlots::evaluateExpressions(std::size_t time, const IRenderEntity* entity)
+{
+    // Slots can be changed through the vector interface, check for changes
+    if (!_program.isCompiledFrom(*this))
+    {
+        _program.compile(*this);
+    }
+
+    _program.evaluate(time, entity, _registers);
+}
+
 bool ExpressionSlots::registerIsShared(std::size_t index) const
 {
     std::size_t useCount = 0;
@@ -2,6 +2,7 @@
 
 #include "ishaderlayer.h"
 #include "ishaderexpression.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -25,6 +26,9 @@ class ExpressionSlots :
 private:
     Registers& _registers;
 
+    // The compiled form of the expressions, rebuilt when the slots change
+    ExpressionProgram _program;
+
     static const IShaderExpression::Ptr NullExpression;
 
 public:
@@ -46,6 +50,10 @@ public:
     // This also returns true if both slots are empty
     bool expressionsAreEquivalent(IShaderLayer::Expression::Slot slotA, IShaderLayer::Expression::Slot slotB) const;
 
+    // Evaluates the expressions of all slots, writing the results to the registers.
+    // Without entity the default shader parm values are used.
+    void evaluateExpressions(std::size_t time, const IRenderEntity* entity);
+
 private:
     // Returns true if the given register index is in use by more than one expression
     bool registerIsShared(std::size_t index) const;
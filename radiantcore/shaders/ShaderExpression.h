@@ -6,6 +6,7 @@
 #include "fmt/format.h"
 #include "string/convert.h"
 #include "TableDefinition.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -119,6 +120,9 @@ public:
 
     // To be implemented by the subclasses
     virtual std::string convertToString() = 0;
+
+    // Emits the instructions calculating the value of this expression
+    virtual ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) = 0;
 };
 
 // Detail namespace
@@ -168,6 +172,11 @@ public:
     {
         return std::make_shared<ShaderParmExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.shaderParm(_parmNum);
+    }
 };
 
 class GlobalShaderParmExpression :
@@ -208,6 +217,11 @@ public:
     {
         return std::make_shared<GlobalShaderParmExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.constant(0.0f); // globalNN is always 0
+    }
 };
 
 // An expression returning the current (game) time as result
@@ -242,6 +256,11 @@ public:
     {
         return std::make_shared<TimeExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.time();
+    }
 };
 
 // An expression representing a constant floating point number
@@ -281,6 +300,11 @@ public:
     {
         return std::make_shared<ConstantExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.constant(_value);
+    }
 };
 
 // An expression looking up a value in a table def
@@ -330,6 +354,11 @@ public:
     {
         return std::make_shared<TableLookupExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.tableLookup(_tableDef, _lookupExpr);
+    }
 };
 
 // Abstract base class for an expression taking two sub-expression as arguments
@@ -426,6 +455,11 @@ public:
     {
         return std::make_shared<AddExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Add, _a, _b);
+    }
 };
 
 // An expression subtracting the value of two expressions
@@ -461,6 +495,11 @@ public:
     {
         return std::make_shared<SubtractExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Subtract, _a, _b);
+    }
 };
 
 // An expression multiplying the value of two expressions
@@ -496,6 +535,11 @@ public:
     {
         return std::make_shared<MultiplyExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Multiply, _a, _b);
+    }
 };
 
 // An expression dividing the value of two expressions
@@ -531,6 +575,11 @@ public:
     {
         return std::make_shared<DivideExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Divide, _a, _b);
+    }
 };
 
 // An expression returning modulo of A % B
@@ -566,6 +615,11 @@ public:
     {
         return std::make_shared<ModuloExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Modulo, _a, _b);
+    }
 };
 
 // An expression returning 1 if A < B, otherwise 0
@@ -601,6 +655,11 @@ public:
     {
         return std::make_shared<LessThanExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::LessThan, _a, _b);
+    }
 };
 
 // An expression returning 1 if A <= B, otherwise 0
@@ -636,6 +695,11 @@ public:
     {
         return std::make_shared<LessThanOrEqualExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::LessThanOrEqual, _a, _b);
+    }
 };
 
 // An expression returning 1 if A > B, otherwise 0
@@ -671,6 +735,11 @@ public:
     {
         return std::make_shared<GreaterThanExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::GreaterThan, _a, _b);
+    }
 };
 
 // An expression returning 1 if A >= B, otherwise 0
@@ -706,6 +775,11 @@ public:
     {
         return std::make_shared<GreaterThanOrEqualExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::GreaterThanOrEqual, _a, _b);
+    }
 };
 
 // An expression returning 1 if A == B, otherwise 0
@@ -741,6 +815,11 @@ public:
     {
         return std::make_shared<EqualityExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::Equal, _a, _b);
+    }
 };
 
 // An expression returning 1 if A != B, otherwise 0
@@ -776,6 +855,11 @@ public:
     {
         return std::make_shared<InequalityExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::NotEqual, _a, _b);
+    }
 };
 
 // An expression returning 1 if both A and B are true (non-zero), otherwise 0
@@ -811,6 +895,11 @@ public:
     {
         return std::make_shared<LogicalAndExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::LogicalAnd, _a, _b);
+    }
 };
 
 // An expression returning 1 if either A or B are true (non-zero), otherwise 0
@@ -846,6 +935,11 @@ public:
     {
         return std::make_shared<LogicalOrExpression>(*this);
     }
+
+    ExpressionProgram::Operand compile(ExpressionProgram::Compiler& compiler) override
+    {
+        return compiler.binary(ExpressionProgram::OpCode::LogicalOr, _a, _b);
+    }
 };
 
 } // namespace
@@ -7,6 +7,7 @@
 #include "iselection.h"
 #include "ifilesystem.h"
 #include "isound.h"
+#include "inamespace.h"
 #include "iundo.h"
 #include "ishaders.h"
 #include "render/RenderableCollectionWalker.h"
@@ -842,6 +843,114 @@ TEST_F(EntityTest, RenderFuncStaticWithMultiSurfaceModel)
     EXPECT_EQ(objects.size(), 3) << "Expected one renderable object attached to the func_static";
 }
 
+TEST_F(EntityTest, RenderableObjectsTouchingBounds)
+{
+    // Worldspawn holds lots of surfaces in this map, enough to be spatially indexed
+    loadMap("altar.map");
+
+    RenderFixture fixture;
+    render::RenderableCollectionWalker::CollectRenderablesInScene(fixture.collector, fixture.volumeTest);
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto entity = detail::getFirstRenderEntity([&](IRenderEntityPtr candidate)
+    {
+        return candidate == std::dynamic_pointer_cast<IEntityNode>(worldspawn);
+    });
+    ASSERT_TRUE(entity);
+
+    std::vector<std::pair<render::IRenderableObject::Ptr, AABB>> allObjects;
+
+    entity->foreachRenderable([&](const render::IRenderableObject::Ptr& object, Shader*)
+    {
+        allObjects.emplace_back(object, object->isOriented() ?
+            AABB::createFromOrientedAABBSafe(object->getObjectBounds(), object->getObjectTransform()) :
+            object->getObjectBounds());
+    });
+
+    EXPECT_GT(allObjects.size(), 100) << "Expected lots of worldspawn surfaces";
+
+    auto mapBounds = worldspawn->worldAABB();
+
+    // Run queries of various sizes, comparing the results to a brute-force check
+    for (auto extents : { 16.0, 128.0, 600.0, 2048.0 })
+    {
+        for (auto fraction : { 0.0, 0.3, 0.5, 0.85 })
+        {
+            auto origin = mapBounds.origin - mapBounds.extents + mapBounds.extents * 2 * fraction;
+            AABB queryBounds(origin, { extents, extents, extents });
+
+            std::set<render::IRenderableObject::Ptr> expected;
+
+            for (const auto& [object, bounds] : allObjects)
+            {
+                if (queryBounds.intersects(bounds))
+                {
+                    expected.insert(object);
+                }
+            }
+
+            std::vector<render::IRenderableObject::Ptr> found;
+
+            entity->foreachRenderableTouchingBounds(queryBounds,
+                [&](const render::IRenderableObject::Ptr& object, Shader*)
+            {
+                found.push_back(object);
+            });
+
+            EXPECT_EQ(found.size(), expected.size()) << "Query at " << origin << " reported the wrong number of objects";
+            EXPECT_EQ(std::set<render::IRenderableObject::Ptr>(found.begin(), found.end()), expected);
+
+            // The prepared query used by the renderer must find the same objects
+            // and report the bounds the objects have been sorted in with
+            std::set<render::IRenderableObject::Ptr> foundPrepared;
+
+            entity->prepareRenderableBounds();
+            entity->foreachPreparedRenderableTouchingBounds(queryBounds,
+                [&](const render::IRenderableObject::Ptr& object, Shader*, const AABB& objectBounds)
+            {
+                foundPrepared.insert(object);
+
+                auto existing = std::find_if(allObjects.begin(), allObjects.end(),
+                    [&](const auto& pair) { return pair.first == object; });
+
+                ASSERT_NE(existing, allObjects.end());
+                EXPECT_EQ(objectBounds.origin, existing->second.origin);
+                EXPECT_EQ(objectBounds.extents, existing->second.extents);
+            });
+
+            EXPECT_EQ(foundPrepared, expected) << "Prepared query at " << origin << " reported the wrong objects";
+        }
+    }
+}
+
+TEST_F(EntityTest, RenderableChangeCount)
+{
+    auto funcStatic = algorithm::createEntityByClassName("func_static");
+    funcStatic->getEntity().setKeyValue("model", "models/torch.lwo");
+    scene::addNodeToContainer(funcStatic, GlobalMapModule().getRoot());
+
+    RenderFixture fixture;
+    render::RenderableCollectionWalker::CollectRenderablesInScene(fixture.collector, fixture.volumeTest);
+
+    auto entity = detail::getFirstRenderEntity([&](IRenderEntityPtr candidate)
+    {
+        return candidate == funcStatic;
+    });
+    ASSERT_TRUE(entity);
+
+    auto changeCount = entity->getRenderableChangeCount();
+    EXPECT_GT(changeCount, 0) << "Attaching the model surfaces should have been counted";
+
+    // Rendering the unchanged scene again must not report any changes
+    render::RenderableCollectionWalker::CollectRenderablesInScene(fixture.collector, fixture.volumeTest);
+    EXPECT_EQ(entity->getRenderableChangeCount(), changeCount);
+
+    // Exchanging the model replaces the attached surfaces
+    funcStatic->getEntity().setKeyValue("model", "models/moss_patch.ase");
+    render::RenderableCollectionWalker::CollectRenderablesInScene(fixture.collector, fixture.volumeTest);
+    EXPECT_NE(entity->getRenderableChangeCount(), changeCount);
+}
+
 TEST_F(EntityTest, EntityNodeRGBShaderParms)
 {
     auto funcStatic = TestEntity::create("func_static");
@@ -1872,4 +1981,31 @@ TEST_F(EntityTest, CloneGenericEntityRotatableRotation)
     Matrix4 mat = Matrix4::getRotationAboutZ(math::Degrees(180.0));
 }
 
-}
\ No newline at end of file
+TEST_F(EntityTest, NamespaceAddUniqueName)
+{
+    auto nspace = GlobalNamespaceFactory().createNamespace();
+
+    EXPECT_EQ(nspace->addUniqueName("func_static_1"), "func_static_1");
+    EXPECT_EQ(nspace->addUniqueName("func_static_1"), "func_static_2");
+    EXPECT_EQ(nspace->addUniqueName("func_static_1"), "func_static_3");
+    EXPECT_EQ(nspace->addUniqueName("func_static_5"), "func_static_5");
+
+    // The lowest free postfix should be picked
+    EXPECT_EQ(nspace->addUniqueName("func_static_1"), "func_static_4");
+    EXPECT_EQ(nspace->addUniqueName("func_static_1"), "func_static_6");
+
+    // Erased names become available again
+    EXPECT_TRUE(nspace->erase("func_static_2"));
+    EXPECT_EQ(nspace->addUniqueName("func_static_3"), "func_static_2");
+
+    // Non-canonical postfixes don't block their numeric value
+    EXPECT_EQ(nspace->addUniqueName("light_07"), "light_07");
+    EXPECT_EQ(nspace->addUniqueName("light_07"), "light_1");
+    EXPECT_EQ(nspace->addUniqueName("light_7"), "light_7");
+
+    // No postfix
+    EXPECT_EQ(nspace->addUniqueName("speaker"), "speaker");
+    EXPECT_EQ(nspace->addUniqueName("speaker"), "speaker1");
+}
+
+}
@@ -6,6 +6,7 @@
 
 #include "eclass.h"
 #include "string/join.h"
+#include <algorithm>
 
 #include "algorithm/Entity.h"
 #include "algorithm/FileUtils.h"
@@ -220,6 +221,45 @@ TEST_F(EntityClassTest, VisitInheritedClassAttributes)
     EXPECT_EQ(attributes.at("editor_displayFolder"), false);
 }
 
+TEST_F(EntityClassTest, InheritedAttributeLookupIgnoresCase)
+{
+    auto cls = GlobalEntityClassManager().findClass("light_extinguishable");
+    ASSERT_TRUE(cls);
+
+    // Inherited from 'atdm:light_base', looked up using a different case
+    EXPECT_EQ(cls->getAttributeValue("aiuse"), "AIUSE_LIGHTSOURCE");
+    EXPECT_EQ(cls->getAttributeValue("SPAWNCLASS"), "idLight");
+
+    // Overridden on 'light_extinguishable' itself
+    EXPECT_EQ(cls->getAttributeValue("EDITOR_DISPLAYFOLDER"), "Lights/Base Entities, DoNotUse");
+}
+
+TEST_F(EntityClassTest, VisitOverriddenAttributeOnlyOnce)
+{
+    auto cls = GlobalEntityClassManager().findClass("light_extinguishable");
+    ASSERT_TRUE(cls);
+
+    std::vector<std::string> visitedNames;
+    std::string displayFolder;
+
+    cls->forEachAttribute([&](const EntityClassAttribute& a, bool inherited)
+    {
+        visitedNames.push_back(a.getName());
+
+        if (a.getName() == "editor_displayFolder")
+        {
+            displayFolder = a.getValue();
+        }
+    }, true);
+
+    // The visited names should be unique and come in sorted order
+    EXPECT_TRUE(std::is_sorted(visitedNames.begin(), visitedNames.end()));
+    EXPECT_EQ(std::adjacent_find(visitedNames.begin(), visitedNames.end()), visitedNames.end());
+
+    // The visitor should have received the most derived value
+    EXPECT_EQ(displayFolder, "Lights/Base Entities, DoNotUse");
+}
+
 // #5621: When the classname key is selected in the entity inspector, the description of that
 // attribute should deliver the text that is stored in the editor_usage attributes
 TEST_F(EntityClassTest, MultiLineEditorUsage)
@@ -390,6 +430,51 @@ TEST_F(EntityClassTest, OverrideEClassColourRemoval)
     EXPECT_EQ(torchCls->getColour(), GREEN); // inherited
 }
 
+// A subclass with its own colour keeps it when the parent's colour changes,
+// the change is still propagated since the parent's attributes might be gone
+TEST_F(EntityClassTest, ParentColourChangeNotAffectingSubclass)
+{
+    auto baseCls = GlobalEntityClassManager().findClass("atdm:entity_base");
+    auto staticCls = GlobalEntityClassManager().findClass("func_static");
+    ASSERT_TRUE(baseCls && staticCls);
+    ASSERT_EQ(staticCls->getParent(), baseCls.get());
+
+    // Build the attribute table of the subclass
+    EXPECT_EQ(staticCls->getAttributeValue("editor_color"), "0 .5 .8");
+    auto staticColour = staticCls->getColour();
+
+    std::size_t baseChangedCount = 0;
+    std::size_t staticChangedCount = 0;
+    baseCls->changedSignal().connect([&] { ++baseChangedCount; });
+    staticCls->changedSignal().connect([&] { ++staticChangedCount; });
+
+    // func_static has its own editor_color, the override of the parent is not visible
+    GlobalEclassColourManager().addOverrideColour("atdm:entity_base", YELLOW);
+
+    EXPECT_EQ(baseChangedCount, 1);
+    EXPECT_EQ(staticChangedCount, 1);
+    EXPECT_EQ(staticCls->getColour(), staticColour);
+    EXPECT_EQ(staticCls->getAttributeValue("editor_color"), "0 .5 .8");
+}
+
+// Subclasses inheriting the colour of a parent are notified when it changes
+TEST_F(EntityClassTest, ParentColourChangeAffectingSubclass)
+{
+    auto lightCls = GlobalEntityClassManager().findClass("light");
+    auto torchCls = GlobalEntityClassManager().findClass("light_torchflame_small");
+    ASSERT_TRUE(lightCls && torchCls);
+
+    expectEntityClassColour(torchCls, GREEN);
+
+    std::size_t torchChangedCount = 0;
+    torchCls->changedSignal().connect([&] { ++torchChangedCount; });
+
+    GlobalEclassColourManager().addOverrideColour("light", YELLOW);
+
+    EXPECT_EQ(torchCls->getColour(), YELLOW);
+    EXPECT_GE(torchChangedCount, 1) << "Subclass should signal its colour change";
+}
+
 TEST_F(EntityClassTest, DefaultEclassColourIsValid)
 {
     auto eclass = GlobalEntityClassManager().findClass("dr:entity_using_modeldef");
@@ -1,9 +1,12 @@
 #include "RadiantTest.h"
 
 #include "ifilter.h"
+#include "ientity.h"
+#include "ieclass.h"
 #include "scene/Node.h"
 #include "imap.h"
 #include "scenelib.h"
+#include "algorithm/Primitives.h"
 
 namespace test
 {
@@ -50,4 +53,97 @@ TEST_F(FilterTest, OnFiltersChangedInvoked)
     EXPECT_EQ(testNode->onFiltersChangedInvocationCount, 1) << "Node should have been notified";
 }
 
+TEST_F(FilterTest, SetStateOfUnknownFilter)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto testNode = std::make_shared<DummyNode>();
+    scene::addNodeToContainer(testNode, worldspawn);
+
+    GlobalFilterSystem().setFilterState("NonExistentFilter", true);
+
+    EXPECT_FALSE(GlobalFilterSystem().getFilterState("NonExistentFilter")) << "Unknown filter must not be activated";
+    EXPECT_EQ(testNode->onFiltersChangedInvocationCount, 0) << "Nodes should not have been notified";
+}
+
+TEST_F(FilterTest, EntityFilterHidesChildren)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0), "textures/common/caulk");
+
+    GlobalFilterSystem().setFilterState("World geometry", true);
+
+    EXPECT_TRUE(worldspawn->isFiltered()) << "Worldspawn should be hidden";
+    EXPECT_TRUE(brush->isFiltered()) << "Child brush should be hidden";
+
+    GlobalFilterSystem().setFilterState("World geometry", false);
+
+    EXPECT_FALSE(worldspawn->isFiltered()) << "Worldspawn should be visible again";
+    EXPECT_FALSE(brush->isFiltered()) << "Child brush should be visible again";
+}
+
+TEST_F(FilterTest, TextureFilterKeepsHiddenEntities)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto caulkBrush = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0), "textures/common/caulk");
+    auto otherBrush = algorithm::createCubicBrush(worldspawn, Vector3(128, 0, 0), "textures/numbers/1");
+
+    GlobalFilterSystem().setFilterState("World geometry", true);
+    GlobalFilterSystem().setFilterState("Caulk", true);
+
+    EXPECT_TRUE(worldspawn->isFiltered()) << "Worldspawn should still be hidden";
+    EXPECT_TRUE(caulkBrush->isFiltered());
+    EXPECT_TRUE(otherBrush->isFiltered()) << "Brushes of a hidden entity should stay hidden";
+
+    // Showing the entity again needs to re-evaluate its children
+    GlobalFilterSystem().setFilterState("World geometry", false);
+
+    EXPECT_FALSE(worldspawn->isFiltered());
+    EXPECT_TRUE(caulkBrush->isFiltered()) << "Caulk brush should be hidden by the texture filter";
+    EXPECT_FALSE(otherBrush->isFiltered());
+}
+
+TEST_F(FilterTest, EntityFilterKeepsFilteredPrimitives)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto caulkBrush = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0), "textures/common/caulk");
+    auto otherBrush = algorithm::createCubicBrush(worldspawn, Vector3(128, 0, 0), "textures/numbers/1");
+
+    auto light = GlobalEntityModule().createEntity(GlobalEntityClassManager().findClass("light"));
+    scene::addNodeToContainer(light, GlobalMapModule().getRoot());
+
+    GlobalFilterSystem().setFilterState("Caulk", true);
+
+    EXPECT_TRUE(caulkBrush->isFiltered());
+    EXPECT_FALSE(otherBrush->isFiltered());
+    EXPECT_FALSE(light->isFiltered());
+
+    GlobalFilterSystem().setFilterState("Lights", true);
+
+    EXPECT_TRUE(light->isFiltered()) << "Light should be hidden";
+    EXPECT_FALSE(worldspawn->isFiltered());
+    EXPECT_TRUE(caulkBrush->isFiltered()) << "Caulk brush should still be hidden";
+    EXPECT_FALSE(otherBrush->isFiltered());
+
+    GlobalFilterSystem().setAllFilterStates(false);
+
+    EXPECT_FALSE(light->isFiltered());
+    EXPECT_FALSE(caulkBrush->isFiltered());
+    EXPECT_FALSE(otherBrush->isFiltered());
+}
+
+TEST_F(FilterTest, InvalidRuleExpressionIsIgnored)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0), "textures/common/caulk");
+
+    EXPECT_TRUE(GlobalFilterSystem().addFilter("Invalid", {
+        FilterRule::Create(FilterRule::TYPE_TEXTURE, "textures/common/(", false),
+        FilterRule::Create(FilterRule::TYPE_TEXTURE, "textures/common/caulk", false)
+    }));
+
+    GlobalFilterSystem().setFilterState("Invalid", true);
+
+    EXPECT_TRUE(brush->isFiltered()) << "The valid rule should still be applied";
+}
+
 }
@@ -0,0 +1,253 @@
+#include "RadiantTest.h"
+
+#include <chrono>
+#include "imap.h"
+#include "ientity.h"
+#include "scenelib.h"
+#include "algorithm/Entity.h"
+#include "testutil/LoopbackGameServer.h"
+
+#include "dm.gameconnection/AutomationEngine.h"
+#include "dm.gameconnection/DiffBinaryMapWriter.h"
+#include "dm.gameconnection/DiffDoom3MapWriter.h"
+#include "dm.gameconnection/MapDiffExport.h"
+#include "dm.gameconnection/MapObserver.h"
+
+namespace test
+{
+
+using GameConnectionTest = RadiantTest;
+
+namespace
+{
+
+IEntityNodePtr createEntityWithSpawnargs(const std::string& className, const std::string& origin)
+{
+    auto entity = algorithm::createEntityByClassName(className);
+    scene::addNodeToContainer(entity, GlobalMapModule().getRoot());
+
+    entity->getEntity().setKeyValue("origin", origin);
+    entity->getEntity().setKeyValue("_color", "0.5 0.5 0.5");
+
+    return entity;
+}
+
+// Returns the text diff without the leading "// diff N" line
+std::string getEntityBlocks(const std::string& textDiff)
+{
+    return textDiff.substr(textDiff.find('\n') + 1);
+}
+
+std::size_t countOccurrences(const std::string& haystack, const std::string& needle)
+{
+    std::size_t count = 0;
+
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+}
+
+TEST_F(GameConnectionTest, BinaryDiffMatchesTextDiff)
+{
+    auto added = createEntityWithSpawnargs("light", "16 32 48");
+    auto modified = createEntityWithSpawnargs("func_static", "-128 0 64.5");
+    auto respawned = createEntityWithSpawnargs("info_player_start", "0 0 0");
+
+    gameconn::DiffEntityStatuses statuses;
+    statuses[added->name()] = gameconn::DiffStatus::added();
+    statuses[modified->name()] = gameconn::DiffStatus::modified();
+    statuses[respawned->name()] = gameconn::DiffStatus::forceRespawn();
+    statuses["removed_entity"] = gameconn::DiffStatus::removed();
+
+    auto textDiff = gameconn::saveMapDiff<gameconn::DiffDoom3MapWriter>(statuses);
+    auto binaryDiff = gameconn::saveMapDiff<gameconn::DiffBinaryMapWriter>(statuses);
+
+    EXPECT_EQ(textDiff.substr(0, textDiff.find('\n')), "// diff 4");
+    EXPECT_NE(textDiff.find("remove entity\n{\n\"name\" \"removed_entity\"\n}\n"), std::string::npos);
+    EXPECT_NE(textDiff.find("modify_respawn entity\n"), std::string::npos);
+
+    // Decoding the binary diff results in the same entity blocks
+    EXPECT_EQ(gameconn::DiffBinaryMapWriter::ConvertToText(binaryDiff), getEntityBlocks(textDiff));
+    EXPECT_LT(binaryDiff.size(), textDiff.size()) << "Binary diff is not smaller than the text diff";
+}
+
+TEST_F(GameConnectionTest, BinaryDiffWritesEachKeyOnce)
+{
+    gameconn::DiffEntityStatuses statuses;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        auto entity = createEntityWithSpawnargs("light", std::to_string(i * 64) + " 0 0");
+        statuses[entity->name()] = gameconn::DiffStatus::modified();
+    }
+
+    auto textDiff = gameconn::saveMapDiff<gameconn::DiffDoom3MapWriter>(statuses);
+    auto binaryDiff = gameconn::saveMapDiff<gameconn::DiffBinaryMapWriter>(statuses);
+
+    EXPECT_EQ(countOccurrences(textDiff, "origin"), 20);
+    EXPECT_EQ(countOccurrences(binaryDiff, "origin"), 1) << "Keys should be referenced by index after their first use";
+    EXPECT_EQ(countOccurrences(binaryDiff, "classname"), 1);
+
+    EXPECT_EQ(gameconn::DiffBinaryMapWriter::ConvertToText(binaryDiff), getEntityBlocks(textDiff));
+}
+
+TEST_F(GameConnectionTest, MalformedBinaryDiffIsRejected)
+{
+    auto entity = createEntityWithSpawnargs("light", "16 32 48");
+
+    gameconn::DiffEntityStatuses statuses;
+    statuses[entity->name()] = gameconn::DiffStatus::added();
+
+    auto binaryDiff = gameconn::saveMapDiff<gameconn::DiffBinaryMapWriter>(statuses);
+    EXPECT_NO_THROW(gameconn::DiffBinaryMapWriter::ConvertToText(binaryDiff));
+
+    using gameconn::DiffBinaryMapWriter;
+
+    // Empty data, text diff, wrong version
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(""), std::runtime_error);
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText("// diff 0\n"), std::runtime_error);
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(std::string("TDMD\x7f\0", 6)), std::runtime_error);
+
+    // Missing end marker, data after the end marker
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(binaryDiff.substr(0, binaryDiff.size() - 1)), std::runtime_error);
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(binaryDiff + "x"), std::runtime_error);
+
+    // Unknown record kind, key index beyond the key table
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(std::string("TDMD\x01\x09\0", 7)), std::runtime_error);
+    EXPECT_THROW(DiffBinaryMapWriter::ConvertToText(std::string("TDMD\x01\x01\x01\x05\x00\0", 10)), std::runtime_error);
+}
+
+TEST_F(GameConnectionTest, MapObserverSettlesAfterQuietPeriod)
+{
+    using namespace std::chrono_literals;
+
+    auto settleTime = 200ms;
+    auto maxDelay = 1h;
+
+    gameconn::MapObserver observer;
+    observer.setEnabled(true);
+
+    auto entity = createEntityWithSpawnargs("light", "0 0 0");
+    observer.clear();
+
+    EXPECT_FALSE(observer.hasSettledChanges(settleTime, maxDelay, std::chrono::steady_clock::now() + 2h))
+        << "No changes pending, nothing should be reported";
+
+    auto beforeChange = std::chrono::steady_clock::now();
+    entity->getEntity().setKeyValue("origin", "64 0 0");
+    auto afterChange = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(observer.getChanges().count(entity->name()), 1);
+
+    // Not settled right after the change, settled once the settle time has passed
+    EXPECT_FALSE(observer.hasSettledChanges(settleTime, maxDelay, beforeChange + settleTime - 1ms));
+    EXPECT_TRUE(observer.hasSettledChanges(settleTime, maxDelay, afterChange + settleTime));
+
+    // Another change is restarting the settle time
+    auto beforeSecondChange = std::chrono::steady_clock::now();
+    entity->getEntity().setKeyValue("origin", "128 0 0");
+    auto afterSecondChange = std::chrono::steady_clock::now();
+
+    EXPECT_FALSE(observer.hasSettledChanges(settleTime, maxDelay, beforeSecondChange + settleTime - 1ms));
+    EXPECT_TRUE(observer.hasSettledChanges(settleTime, maxDelay, afterSecondChange + settleTime));
+
+    observer.clear();
+    EXPECT_FALSE(observer.hasSettledChanges(settleTime, maxDelay, afterSecondChange + 2h));
+}
+
+TEST_F(GameConnectionTest, MapObserverReportsContinuousChangesAfterMaxDelay)
+{
+    using namespace std::chrono_literals;
+
+    auto settleTime = 1h;
+    auto maxDelay = 500ms;
+
+    gameconn::MapObserver observer;
+    observer.setEnabled(true);
+
+    auto entity = createEntityWithSpawnargs("light", "0 0 0");
+    observer.clear();
+
+    auto beforeFirstChange = std::chrono::steady_clock::now();
+    entity->getEntity().setKeyValue("origin", "64 0 0");
+    auto afterFirstChange = std::chrono::steady_clock::now();
+
+    // Keep on changing, the changes never settle
+    for (int i = 0; i < 10; ++i)
+    {
+        entity->getEntity().setKeyValue("origin", std::to_string(i) + " 0 0");
+    }
+
+    EXPECT_FALSE(observer.hasSettledChanges(settleTime, maxDelay, beforeFirstChange + maxDelay - 1ms));
+    EXPECT_TRUE(observer.hasSettledChanges(settleTime, maxDelay, afterFirstChange + maxDelay))
+        << "Pending changes should be reported after the max delay, even if they don't settle";
+}
+
+TEST_F(GameConnectionTest, HotReloadRoundTripOverLoopback)
+{
+    using namespace std::chrono_literals;
+
+    auto entity = createEntityWithSpawnargs("light", "16 32 48");
+
+    gameconn::DiffEntityStatuses statuses;
+    statuses[entity->name()] = gameconn::DiffStatus::added();
+    statuses["removed_entity"] = gameconn::DiffStatus::removed();
+
+    auto binaryDiff = gameconn::saveMapDiff<gameconn::DiffBinaryMapWriter>(statuses);
+    auto textDiff = gameconn::saveMapDiff<gameconn::DiffDoom3MapWriter>(statuses);
+
+    // The stand-in server is decoding the binary diff like the game would
+    const std::string preamble = "message \"action\"\naction \"reloadmap-diff-binary\"\ncontent:\n";
+
+    LoopbackGameServer server([&](const std::string& request)
+    {
+        if (request.compare(0, preamble.size(), preamble) != 0)
+        {
+            return std::string("HotReload: FAILURE: unknown action\n");
+        }
+
+        try
+        {
+            gameconn::DiffBinaryMapWriter::ConvertToText(request.substr(preamble.size()));
+        }
+        catch (const std::runtime_error& ex)
+        {
+            return std::string("HotReload: FAILURE: ") + ex.what() + "\n";
+        }
+
+        return std::string("HotReload: SUCCESS\n");
+    });
+    ASSERT_TRUE(server.isListening()) << "Could not listen on the loopback interface";
+    EXPECT_NE(server.getPort(), 0);
+
+    gameconn::AutomationEngine engine;
+    ASSERT_TRUE(engine.connect("127.0.0.1", server.getPort()));
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto response = engine.executeRequestBlocking(0, preamble + binaryDiff);
+    auto roundTrip = std::chrono::steady_clock::now() - startTime;
+
+    EXPECT_EQ(response, "HotReload: SUCCESS\n");
+    EXPECT_LT(roundTrip, 5s) << "Round trip over the loopback connection took too long";
+
+    // The binary diff (containing null bytes) arrived unchanged
+    auto requests = server.getRequests();
+    ASSERT_EQ(requests.size(), 1);
+    EXPECT_EQ(requests.front(), preamble + binaryDiff);
+    EXPECT_EQ(gameconn::DiffBinaryMapWriter::ConvertToText(requests.front().substr(preamble.size())),
+        getEntityBlocks(textDiff));
+
+    // Actions the server doesn't know are answered with a failure
+    response = engine.executeRequestBlocking(0, "message \"action\"\naction \"reloadmap-diff\"\ncontent:\n" + textDiff);
+    EXPECT_EQ(response.find("HotReload: SUCCESS"), std::string::npos);
+    EXPECT_NE(response.find("unknown action"), std::string::npos);
+
+    engine.disconnect(true);
+}
+
+}
@@ -1,5 +1,7 @@
 #include "RadiantTest.h"
 
+#include <sstream>
+#include <iomanip>
 #include "imap.h"
 #include "imapformat.h"
 #include "ibrush.h"
@@ -7,12 +9,15 @@
 #include "math/Matrix3.h"
 #include "iselection.h"
 #include "scenelib.h"
+#include "scene/Traverse.h"
 #include "os/path.h"
 #include "string/predicate.h"
+#include "stream/DoubleFormat.h"
 #include "xmlutil/Document.h"
 #include "messages/MapFileOperation.h"
 #include "algorithm/XmlUtils.h"
 #include "algorithm/Primitives.h"
+#include "algorithm/Entity.h"
 #include "testutil/FileSelectionHelper.h"
 
 namespace test
@@ -333,4 +338,128 @@ TEST_F(MapExportTest, ExportPrefabWithEmptyFileExtension)
     runExportWithEmptyFileExtension(_context.getTemporaryDataPath(), "SaveSelectedAsPrefab");
 }
 
+namespace
+{
+
+// Passes all calls to the wrapped writer, which is then only seeing the nodes in sequence
+class SequentialMapWriter :
+    public map::IMapWriter
+{
+private:
+    map::IMapWriter& _writer;
+
+public:
+    SequentialMapWriter(map::IMapWriter& writer) :
+        _writer(writer)
+    {}
+
+    void beginWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override { _writer.beginWriteMap(root, stream); }
+    void endWriteMap(const scene::IMapRootNodePtr& root, std::ostream& stream) override { _writer.endWriteMap(root, stream); }
+    void beginWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override { _writer.beginWriteEntity(entity, stream); }
+    void endWriteEntity(const IEntityNodePtr& entity, std::ostream& stream) override { _writer.endWriteEntity(entity, stream); }
+    void beginWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override { _writer.beginWriteBrush(brush, stream); }
+    void endWriteBrush(const IBrushNodePtr& brush, std::ostream& stream) override { _writer.endWriteBrush(brush, stream); }
+    void beginWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override { _writer.beginWritePatch(patch, stream); }
+    void endWritePatch(const IPatchNodePtr& patch, std::ostream& stream) override { _writer.endWritePatch(patch, stream); }
+};
+
+std::string exportSceneUsingWriter(map::IMapWriter& writer)
+{
+    std::ostringstream output;
+
+    auto root = GlobalMapModule().getRoot();
+    auto exporter = GlobalMapModule().createMapExporter(writer, root, output);
+    exporter->exportMap(root, scene::traverse);
+    exporter.reset();
+
+    return output.str();
+}
+
+}
+
+// Large maps are written by several threads, the result must be the same as writing them in sequence
+TEST_F(MapExportTest, ConcurrentExportMatchesSequentialExport)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    // Use fractional coordinates to cover the number formatting
+    for (auto i = 0; i < 1000; ++i)
+    {
+        auto origin = Vector3(i * 17.3125, (i % 37) * -9.7, (i % 11) * 3.03);
+        algorithm::createCuboidBrush(worldspawn, AABB(origin, Vector3(8.5, 4.25, 16.1)), "textures/numbers/1");
+    }
+
+    for (auto e = 0; e < 5; ++e)
+    {
+        auto entity = algorithm::createEntityByClassName("func_static");
+        scene::addNodeToContainer(entity, GlobalMapModule().getRoot());
+
+        for (auto i = 0; i < 300; ++i)
+        {
+            algorithm::createCubicBrush(entity, Vector3(e * 512.7, i * 33.1, 0), "textures/numbers/2");
+        }
+
+        algorithm::createPatchFromBounds(entity, AABB(Vector3(e * 100.1, 0, 0), Vector3(16.3, 64, 32)));
+    }
+
+    auto format = GlobalMapFormatManager().getMapFormatForGameType("doom3", "map");
+    auto writer = format->getMapWriter();
+
+    auto concurrentOutput = exportSceneUsingWriter(*writer);
+
+    SequentialMapWriter sequentialWriter(*format->getMapWriter());
+    auto sequentialOutput = exportSceneUsingWriter(sequentialWriter);
+
+    EXPECT_NE(concurrentOutput.find("// entity 5"), std::string::npos) << "Missing the last entity";
+    EXPECT_NE(concurrentOutput.find("// primitive 999"), std::string::npos) << "Missing the last worldspawn brush";
+    EXPECT_EQ(concurrentOutput, sequentialOutput) << "Concurrent export differs from the sequential one";
+}
+
+// The map writers format doubles with fmt, the result must be the same as the iostream formatting
+TEST(DoubleFormatTest, WriteDoubleMatchesStreamFormatting)
+{
+    const std::vector<double> values =
+    {
+        // Integers
+        0.0, 1.0, -1.0, 42.0, -512.0, 65536.0, 999999.0, 1000000.0, 1234567.0, 123456789012.0,
+        // Small and large exponents
+        1e-4, 1e-5, -2.5e-5, 1.5e-7, 3.0e-300, 4.9e-324, 1e15, 1e16, -3.2e100, 1.7976931348623157e308,
+        // Negative zero
+        -0.0,
+        // Long fractions
+        0.1, 0.5, 1.0 / 3, -2.0 / 3, 3.14159265358979323846, 0.123456789012345678,
+        -1234.5678901234, 99999.95, 0.00012345678901234, 17.3125, -9.7, 3.03,
+    };
+
+    for (auto precision : { 0, 1, 3, 6, 9, 12, 16, 17 })
+    {
+        for (auto value : values)
+        {
+            std::ostringstream expected;
+            expected.precision(precision);
+            expected << value;
+
+            std::ostringstream actual;
+            actual.precision(precision);
+            stream::writeDouble(value, actual);
+
+            EXPECT_EQ(actual.str(), expected.str()) << "Value " << value << " with precision " << precision;
+        }
+    }
+
+    // Non-default notations are passed to the stream
+    std::ostringstream expected;
+    expected << std::fixed << std::setprecision(4) << -0.0 << ' ' << 1e-5 << ' ' << 12.34567;
+
+    std::ostringstream actual;
+    actual << std::fixed << std::setprecision(4);
+    stream::writeDouble(-0.0, actual);
+    actual << ' ';
+    stream::writeDouble(1e-5, actual);
+    actual << ' ';
+    stream::writeDouble(12.34567, actual);
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
 }
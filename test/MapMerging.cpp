@@ -1,7 +1,13 @@
 #include "RadiantTest.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include "icommandsystem.h"
+#include "ieclass.h"
+#include "ientity.h"
 #include "itransformable.h"
+#include "iundo.h"
 #include "ibrush.h"
 #include "imapresource.h"
 #include "ipatch.h"
@@ -9,6 +15,7 @@
 #include "algorithm/Scene.h"
 #include "registry/registry.h"
 #include "scenelib.h"
+#include "string/convert.h"
 #include "scene/merge/GraphComparer.h"
 #include "scene/merge/MergeOperation.h"
 #include "scene/merge/ThreeWayMergeOperation.h"
@@ -236,6 +243,56 @@ TEST_F(MapMergeTest, EntityFingerprintInsensitiveToChildOrder)
     EXPECT_EQ(comparable->getFingerprint(), originalFingerprint);
 }
 
+// Fingerprints are cached by the nodes, check that undo/redo is refreshing them
+TEST_F(MapMergeTest, FingerprintIsUpdatedAfterUndo)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    auto entityNode = algorithm::getEntityByName(GlobalMapModule().getRoot(), "func_static_1");
+    auto entity = std::dynamic_pointer_cast<IEntityNode>(entityNode);
+
+    // Pick the first brush of the func_static
+    scene::INodePtr brushNode;
+    entity->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isBrush(node))
+        {
+            brushNode = node;
+        }
+
+        return !brushNode;
+    });
+    EXPECT_TRUE(brushNode) << "func_static doesn't have any child brushes";
+
+    auto comparableEntity = std::dynamic_pointer_cast<scene::IComparableNode>(entityNode);
+    auto comparableBrush = std::dynamic_pointer_cast<scene::IComparableNode>(brushNode);
+
+    auto originalEntityFingerprint = comparableEntity->getFingerprint();
+    auto originalBrushFingerprint = comparableBrush->getFingerprint();
+
+    {
+        UndoableCommand cmd("changeFingerprints");
+        Node_getIBrush(brushNode)->setShader("textures/somethingelse");
+        entity->getEntity().setKeyValue("dummyspawnarg", "changed");
+    }
+
+    auto changedEntityFingerprint = comparableEntity->getFingerprint();
+    auto changedBrushFingerprint = comparableBrush->getFingerprint();
+
+    EXPECT_NE(changedBrushFingerprint, originalBrushFingerprint);
+    EXPECT_NE(changedEntityFingerprint, originalEntityFingerprint);
+
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(comparableBrush->getFingerprint(), originalBrushFingerprint);
+    EXPECT_EQ(comparableEntity->getFingerprint(), originalEntityFingerprint);
+
+    GlobalUndoSystem().redo();
+
+    EXPECT_EQ(comparableBrush->getFingerprint(), changedBrushFingerprint);
+    EXPECT_EQ(comparableEntity->getFingerprint(), changedEntityFingerprint);
+}
+
 using namespace scene::merge;
 
 inline ComparisonResult::Ptr performComparison(const std::string& targetMap, const std::string& sourceMapPath)
@@ -291,6 +348,176 @@ inline ComparisonResult::EntityDifference getEntityDifference(const ComparisonRe
     return ComparisonResult::EntityDifference();
 }
 
+// Larger maps are compared using several threads, the result must be the same as before
+TEST_F(MapMergeTest, ComparisonOfManyEntitiesIsDeterministic)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    auto resource = GlobalMapResourceManager().createFromPath(_context.getTestProjectPath() + "maps/fingerprinting_2.mapx");
+    EXPECT_TRUE(resource->load()) << "Test map not found";
+
+    auto sourceRoot = resource->getRootNode();
+    auto baseRoot = GlobalMapModule().getRoot();
+
+    // Add the same set of entities to both maps, with a different origin in the source map
+    constexpr std::size_t NumEntities = 100;
+    auto eclass = GlobalEntityClassManager().findOrInsert("func_static", true);
+
+    for (std::size_t i = 0; i < NumEntities; ++i)
+    {
+        auto name = "parallel_comparison_" + string::to_string(i);
+
+        for (const auto& root : { sourceRoot, baseRoot })
+        {
+            auto entity = GlobalEntityModule().createEntity(eclass);
+            entity->getEntity().setKeyValue("name", name);
+            entity->getEntity().setKeyValue("origin", root == sourceRoot ? "16 0 0" : "0 0 0");
+            root->addChildNode(entity);
+        }
+    }
+
+    std::vector<float> progress;
+    auto result = GraphComparer::Compare(sourceRoot, baseRoot, [&](float fraction) { progress.push_back(fraction); });
+
+    std::size_t numChangedEntities = 0;
+
+    for (const auto& difference : result->differingEntities)
+    {
+        if (!string::starts_with(difference.entityName, "parallel_comparison_")) continue;
+
+        EXPECT_EQ(difference.type, ComparisonResult::EntityDifference::Type::EntityPresentButDifferent);
+        EXPECT_EQ(difference.differingKeyValues.size(), 1) << "Only the origin should be different";
+        EXPECT_TRUE(difference.differingChildren.empty());
+        ++numChangedEntities;
+    }
+
+    EXPECT_EQ(numChangedEntities, NumEntities);
+
+    // A second comparison must report the differences in the same order
+    auto secondResult = GraphComparer::Compare(sourceRoot, baseRoot);
+    ASSERT_EQ(secondResult->differingEntities.size(), result->differingEntities.size());
+
+    auto secondDifference = secondResult->differingEntities.begin();
+
+    for (const auto& difference : result->differingEntities)
+    {
+        EXPECT_EQ(secondDifference->entityName, difference.entityName);
+        EXPECT_EQ(secondDifference->type, difference.type);
+        EXPECT_EQ(secondDifference->differingKeyValues.size(), difference.differingKeyValues.size());
+        EXPECT_EQ(secondDifference->differingChildren.size(), difference.differingChildren.size());
+        ++secondDifference;
+    }
+
+    // The progress is reported in ascending order, up to completion
+    EXPECT_FALSE(progress.empty());
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    EXPECT_FLOAT_EQ(progress.back(), 1.0f);
+}
+
+// Adds a 16x16x16 brush at the given origin, bypassing the undo system to keep the setup fast
+inline void addBenchmarkBrush(const scene::INodePtr& parent, const Vector3& origin, const std::string& material)
+{
+    auto brushNode = GlobalBrushCreator().createBrush();
+    parent->addChildNode(brushNode);
+
+    auto& brush = *Node_getIBrush(brushNode);
+    auto translation = Matrix4::getTranslation(origin);
+
+    brush.addFace(Plane3(+1, 0, 0, 8).transform(translation));
+    brush.addFace(Plane3(-1, 0, 0, 8).transform(translation));
+    brush.addFace(Plane3(0, +1, 0, 8).transform(translation));
+    brush.addFace(Plane3(0, -1, 0, 8).transform(translation));
+    brush.addFace(Plane3(0, 0, +1, 8).transform(translation));
+    brush.addFace(Plane3(0, 0, -1, 8).transform(translation));
+
+    brush.setShader(material);
+    brush.evaluateBRep();
+}
+
+// Fills the given root with func_statics holding 50k brushes in total.
+// Every changeInterval-th entity gets a modified spawnarg and one moved brush,
+// starting at changeOffset. Pass 0 as changeInterval to generate the unchanged base.
+inline void generateBenchmarkMap(const scene::INodePtr& root, std::size_t changeInterval, std::size_t changeOffset)
+{
+    constexpr std::size_t NumEntities = 1000;
+    constexpr std::size_t BrushesPerEntity = 50;
+
+    auto eclass = GlobalEntityClassManager().findOrInsert("func_static", true);
+
+    for (std::size_t i = 0; i < NumEntities; ++i)
+    {
+        auto isChanged = changeInterval > 0 && i % changeInterval == changeOffset;
+
+        auto entity = GlobalEntityModule().createEntity(eclass);
+        entity->getEntity().setKeyValue("name", "benchmark_" + string::to_string(i));
+        entity->getEntity().setKeyValue("origin", "0 0 0");
+        entity->getEntity().setKeyValue("benchmark_value", isChanged ? "changed" : "original");
+        root->addChildNode(entity);
+
+        for (std::size_t b = 0; b < BrushesPerEntity; ++b)
+        {
+            Vector3 origin(static_cast<double>(i % 32) * 1024 + static_cast<double>(b) * 20,
+                static_cast<double>(i / 32) * 1024, isChanged && b == 0 ? 32 : 0);
+
+            addBenchmarkBrush(entity, origin, b % 2 == 0 ? "textures/numbers/1" : "textures/numbers/2");
+        }
+    }
+}
+
+// Times the two-way comparison and the three-way merge setup on generated maps with 50k primitives.
+// Disabled by default, run it using --gtest_also_run_disabled_tests --gtest_filter=*MergeBenchmark*
+TEST_F(MapMergeTest, DISABLED_MergeBenchmark)
+{
+    using std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    auto mapPath = _context.getTestProjectPath() + "maps/fingerprinting.mapx";
+
+    auto baseResource = GlobalMapResourceManager().createFromPath(mapPath);
+    auto sourceResource = GlobalMapResourceManager().createFromPath(mapPath);
+    auto targetResource = GlobalMapResourceManager().createFromPath(mapPath);
+
+    ASSERT_TRUE(baseResource->load()) << "Test map not found";
+    ASSERT_TRUE(sourceResource->load()) << "Test map not found";
+    ASSERT_TRUE(targetResource->load()) << "Test map not found";
+
+    auto generationStart = steady_clock::now();
+
+    // Source and target are changing different entities, there are no conflicts
+    generateBenchmarkMap(baseResource->getRootNode(), 0, 0);
+    generateBenchmarkMap(sourceResource->getRootNode(), 50, 0);
+    generateBenchmarkMap(targetResource->getRootNode(), 50, 25);
+
+    auto comparisonStart = steady_clock::now();
+
+    auto result = GraphComparer::Compare(sourceResource->getRootNode(), baseResource->getRootNode());
+
+    auto threeWayStart = steady_clock::now();
+
+    auto operation = ThreeWayMergeOperation::Create(baseResource->getRootNode(),
+        sourceResource->getRootNode(), targetResource->getRootNode());
+
+    auto end = steady_clock::now();
+
+    EXPECT_EQ(result->differingEntities.size(), 20);
+
+    std::size_t numConflicts = 0;
+    operation->foreachAction([&](const IMergeAction::Ptr& action)
+    {
+        if (std::dynamic_pointer_cast<IConflictResolutionAction>(action))
+        {
+            ++numConflicts;
+        }
+    });
+    EXPECT_EQ(numConflicts, 0);
+
+    std::cout << "Merging maps with 50000 brushes each" << std::endl
+        << "  generation:      " << duration_cast<milliseconds>(comparisonStart - generationStart).count() << " ms" << std::endl
+        << "  two-way compare: " << duration_cast<milliseconds>(threeWayStart - comparisonStart).count() << " ms" << std::endl
+        << "  three-way merge: " << duration_cast<milliseconds>(end - threeWayStart).count() << " ms" << std::endl;
+}
+
 TEST_F(MapMergeTest, DetectMissingEntities)
 {
     auto result = performComparison("maps/fingerprinting.mapx", _context.getTestProjectPath() + "maps/fingerprinting_2.mapx");
@@ -20,6 +20,7 @@
 #include "algorithm/Scene.h"
 #include "algorithm/XmlUtils.h"
 #include "algorithm/Primitives.h"
+#include "algorithm/FileUtils.h"
 #include "os/file.h"
 #include <sigc++/connection.h>
 #include "testutil/FileSelectionHelper.h"
@@ -1259,8 +1260,9 @@ TEST_F(MapSavingTest, AutoSaveSnapshotsSupportRelativePaths)
 
     EXPECT_FALSE(GlobalFileSystem().openTextFile(expectedSnapshotPath)) << "Snapshot already exists in " << expectedSnapshotPath;
 
-    // Trigger an auto save now
+    // Trigger an auto save now and wait for the files to be written
     GlobalAutoSaver().performAutosave();
+    GlobalAutoSaver().finishPendingSave();
 
     EXPECT_TRUE(GlobalFileSystem().openTextFile(expectedSnapshotPath)) << "Snapshot should now exist in " << expectedSnapshotPath;
     
@@ -1294,8 +1296,9 @@ TEST_F(MapSavingTest, AutoSaveSnapshotsSupportAbsolutePaths)
 
     EXPECT_FALSE(GlobalFileSystem().openTextFileInAbsolutePath(expectedSnapshotPath)) << "Snapshot already exists in " << expectedSnapshotPath;
 
-    // Trigger an auto save now
+    // Trigger an auto save now and wait for the files to be written
     GlobalAutoSaver().performAutosave();
+    GlobalAutoSaver().finishPendingSave();
 
     EXPECT_TRUE(GlobalFileSystem().openTextFileInAbsolutePath(expectedSnapshotPath)) << "Snapshot should now exist in " << expectedSnapshotPath;
 
@@ -1307,6 +1310,75 @@ TEST_F(MapSavingTest, AutoSaveSnapshotsSupportAbsolutePaths)
     fs::remove(expectedSnapshotPath);
 }
 
+// The autosaver captures the scene immediately, changes made while the files are written are not included
+TEST_F(MapSavingTest, AutoSaveSnapshotIsNotAffectedBySubsequentChanges)
+{
+    std::string modRelativePath = "maps/altar.map";
+    GlobalCommandSystem().executeCommand("OpenMap", modRelativePath);
+    checkAltarScene();
+
+    auto snapshotFolder = _context.getTemporaryDataPath() + "snapshots/";
+    registry::setValue(map::RKEY_AUTOSAVE_SNAPSHOTS_ENABLED, true);
+    registry::setValue(map::RKEY_AUTOSAVE_SNAPSHOTS_FOLDER, snapshotFolder);
+
+    std::string expectedSnapshotPath = snapshotFolder + "altar.0.map";
+
+    GlobalAutoSaver().performAutosave();
+
+    // Remove the worldspawn before the snapshot is confirmed to be on disk
+    scene::removeNodeFromParent(GlobalMapModule().findOrInsertWorldspawn());
+
+    GlobalAutoSaver().finishPendingSave();
+
+    EXPECT_TRUE(os::fileOrDirExists(expectedSnapshotPath)) << "Snapshot should now exist in " << expectedSnapshotPath;
+
+    // The snapshot still contains the unmodified scene
+    FileSaveConfirmationHelper helper(radiant::FileSaveConfirmation::Action::DiscardChanges);
+    GlobalCommandSystem().executeCommand("OpenMap", expectedSnapshotPath);
+    checkAltarScene();
+
+    fs::remove(os::replaceExtension(expectedSnapshotPath, "darkradiant"));
+    fs::remove(expectedSnapshotPath);
+}
+
+// The autosaver serialises a copy of the scene, the files are the same as the ones of a regular save
+TEST_F(MapSavingTest, AutoSaveSnapshotMatchesSavedCopy)
+{
+    std::string modRelativePath = "maps/altar.map";
+    GlobalCommandSystem().executeCommand("OpenMap", modRelativePath);
+    checkAltarScene();
+
+    fs::path copyPath = _context.getTemporaryDataPath();
+    copyPath /= "altar_copy.map";
+
+    FileSelectionHelper responder(copyPath.string(), GlobalMapFormatManager().getMapFormatForFilename(modRelativePath));
+    GlobalCommandSystem().executeCommand("SaveMapCopyAs");
+
+    auto snapshotFolder = _context.getTemporaryDataPath() + "copiedsnapshots/";
+    registry::setValue(map::RKEY_AUTOSAVE_SNAPSHOTS_ENABLED, true);
+    registry::setValue(map::RKEY_AUTOSAVE_SNAPSHOTS_FOLDER, snapshotFolder);
+
+    std::string snapshotPath = snapshotFolder + "altar.0.map";
+
+    GlobalAutoSaver().performAutosave();
+    GlobalAutoSaver().finishPendingSave();
+
+    EXPECT_TRUE(os::fileOrDirExists(snapshotPath)) << "Snapshot should now exist in " << snapshotPath;
+
+    // Entities with child primitives, layers and selection sets are written the same way
+    EXPECT_EQ(algorithm::loadFileToString(snapshotPath), algorithm::loadFileToString(copyPath));
+    EXPECT_EQ(algorithm::loadFileToString(os::replaceExtension(snapshotPath, "darkradiant")),
+        algorithm::loadFileToString(os::replaceExtension(copyPath.string(), "darkradiant")));
+
+    // The scene itself is unchanged
+    checkAltarScene();
+
+    fs::remove(os::replaceExtension(snapshotPath, "darkradiant"));
+    fs::remove(snapshotPath);
+    fs::remove(os::replaceExtension(copyPath.string(), "darkradiant"));
+    fs::remove(copyPath);
+}
+
 namespace
 {
 
@@ -1136,6 +1136,42 @@ TEST_F(MaterialsTest, MaterialParserRgbaExpressions)
     EXPECT_EQ(diffuse->getColourExpression(IShaderLayer::COMP_ALPHA)->getExpressionString(), "time * 7");
 }
 
+// The compiled stage expressions need to produce the same values as the expression trees
+TEST_F(MaterialsTest, MaterialStageExpressionEvaluation)
+{
+    GlobalMaterialManager().foreachShaderName([&](const std::string& name)
+    {
+        auto material = GlobalMaterialManager().getMaterial(name);
+
+        for (const auto& layer : getAllLayers(material))
+        {
+            // Evaluate the same time twice, the cached values need to stay valid
+            for (std::size_t time : { 0, 10, 10, 1500, 27000 })
+            {
+                layer->evaluateExpressions(time);
+
+                auto colour = layer->getColour();
+
+                for (auto component : { IShaderLayer::COMP_RED, IShaderLayer::COMP_GREEN,
+                                        IShaderLayer::COMP_BLUE, IShaderLayer::COMP_ALPHA })
+                {
+                    auto expression = layer->getColourExpression(component);
+
+                    // Colours out of range are replaced by white, skip these
+                    if (!expression || colour == Colour4::WHITE()) continue;
+
+                    EXPECT_EQ(colour[component], expression->getValue(time)) << name << " at time " << time;
+                }
+
+                if (auto alphaTest = layer->getAlphaTestExpression(); alphaTest)
+                {
+                    EXPECT_EQ(layer->getAlphaTest(), alphaTest->getValue(time)) << name << " at time " << time;
+                }
+            }
+        }
+    });
+}
+
 TEST_F(MaterialsTest, MaterialParserLightfallOff)
 {
     auto material = GlobalMaterialManager().getMaterial("textures/parsertest/lights/lightfalloff1");
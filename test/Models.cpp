@@ -1,15 +1,27 @@
 #include "RadiantTest.h"
 
 #include <unordered_set>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <set>
 #include "imodelsurface.h"
 #include "imodelcache.h"
+#include "imd5model.h"
+#include "itransformable.h"
 #include "scenelib.h"
 #include "algorithm/Entity.h"
 #include "algorithm/FileUtils.h"
 #include "algorithm/Scene.h"
 #include "os/file.h"
+#include "os/dir.h"
 
+#include "render/MeshOptimiser.h"
 #include "render/VertexHashing.h"
+#include "string/convert.h"
 #include "string/replace.h"
 
 namespace test
@@ -515,6 +527,318 @@ TEST_F(ModelTest, ModelKeyReferencesMd5Model)
     performModelNodeTest(_context.getTestProjectPath(), "models/md5/flag01.md5mesh", 96);
 }
 
+inline const model::IIndexedModelSurface& getIndexedSurface(const model::ModelNodePtr& model, int surfaceNum)
+{
+    return static_cast<const model::IIndexedModelSurface&>(model->getIModel().getSurface(surfaceNum));
+}
+
+// Instances of the same static model are sharing their vertex data, until one of them gets scaled
+TEST_F(ModelTest, StaticModelInstancesShareSurfaceData)
+{
+    auto modelPath = "models/torch.lwo";
+
+    auto funcStatic1 = algorithm::createEntityByClassName("func_static");
+    auto funcStatic2 = algorithm::createEntityByClassName("func_static");
+    scene::addNodeToContainer(funcStatic1, GlobalMapModule().getRoot());
+    scene::addNodeToContainer(funcStatic2, GlobalMapModule().getRoot());
+
+    funcStatic1->getEntity().setKeyValue("model", modelPath);
+    funcStatic2->getEntity().setKeyValue("model", modelPath);
+
+    auto model1 = algorithm::findChildModel(funcStatic1);
+    auto model2 = algorithm::findChildModel(funcStatic2);
+    ASSERT_TRUE(model1);
+    ASSERT_TRUE(model2);
+    ASSERT_EQ(model1->getIModel().getSurfaceCount(), model2->getIModel().getSurfaceCount());
+
+    for (int i = 0; i < model1->getIModel().getSurfaceCount(); ++i)
+    {
+        EXPECT_EQ(&getIndexedSurface(model1, i).getVertexArray(), &getIndexedSurface(model2, i).getVertexArray());
+        EXPECT_EQ(&getIndexedSurface(model1, i).getIndexArray(), &getIndexedSurface(model2, i).getIndexArray());
+    }
+
+    // Scale the first model, this must not affect the second one
+    auto transformable = scene::node_cast<ITransformable>(algorithm::findChildModelNode(funcStatic1));
+    ASSERT_TRUE(transformable);
+
+    transformable->setType(TRANSFORM_PRIMITIVE);
+    transformable->setScale(Vector3(2, 2, 2));
+    transformable->freezeTransform();
+
+    for (int i = 0; i < model1->getIModel().getSurfaceCount(); ++i)
+    {
+        const auto& scaledSurface = getIndexedSurface(model1, i);
+        const auto& unscaledSurface = getIndexedSurface(model2, i);
+
+        EXPECT_NE(&scaledSurface.getVertexArray(), &unscaledSurface.getVertexArray());
+        ASSERT_EQ(scaledSurface.getNumVertices(), unscaledSurface.getNumVertices());
+
+        for (int v = 0; v < scaledSurface.getNumVertices(); ++v)
+        {
+            EXPECT_TRUE(math::isNear(scaledSurface.getVertex(v).vertex, unscaledSurface.getVertex(v).vertex * 2, 1e-5));
+        }
+    }
+}
+
+TEST_F(ModelTest, PreloadedModelsAreCached)
+{
+    GlobalModelCache().preloadModels({ "models/torch.lwo", "models/ase/testcube.ase", "models/nonexisting.lwo" });
+
+    // Requesting a model which is possibly still being loaded should wait for it
+    auto torch = GlobalModelCache().getModel("models/torch.lwo");
+    ASSERT_TRUE(torch) << "Preloaded model should be available";
+    EXPECT_EQ(torch->getPolyCount(), 258);
+    EXPECT_EQ(GlobalModelCache().getModel("models/torch.lwo"), torch) << "Preloaded model should be in the cache";
+
+    auto cube = GlobalModelCache().getModel("models/ase/testcube.ase");
+    ASSERT_TRUE(cube);
+    EXPECT_EQ(cube->getPolyCount(), 12);
+
+    EXPECT_FALSE(GlobalModelCache().getModel("models/nonexisting.lwo"));
+
+    // Preloading cached models again is not changing anything
+    GlobalModelCache().preloadModels({ "models/torch.lwo" });
+    EXPECT_EQ(GlobalModelCache().getModel("models/torch.lwo"), torch);
+}
+
+// The models of a map are loaded after its entities have been parsed
+TEST_F(ModelTest, ModelsAreAttachedAfterMapLoad)
+{
+    loadMap("selection_test2.map");
+
+    for (const auto& name : { "torch1", "torch2" })
+    {
+        auto entity = algorithm::getEntityByName(GlobalMapModule().getRoot(), name);
+        ASSERT_TRUE(entity);
+
+        auto modelNode = algorithm::findChildModelNode(entity);
+        ASSERT_TRUE(modelNode) << name << " should have a model node after map load";
+
+        auto model = Node_getModel(modelNode);
+        EXPECT_EQ(model->getIModel().getModelPath(), "models/torch.lwo");
+        EXPECT_EQ(model->getIModel().getPolyCount(), 258);
+
+        // The model should follow the entity's origin
+        auto origin = string::convert<Vector3>(Node_getEntity(entity)->getKeyValue("origin"));
+        EXPECT_TRUE(math::isNear(modelNode->localToWorld().tCol().getVector3(), origin, 0.01));
+    }
+}
+
+TEST_F(ModelTest, Md5AnimationPose)
+{
+    auto model = GlobalModelCache().getModel("models/md5/testflag.md5mesh");
+    EXPECT_TRUE(model);
+
+    auto anim = GlobalAnimationCache().getAnim("models/md5/testflag_move.md5anim");
+    EXPECT_TRUE(anim);
+
+    // Frame poses are calculated once and shared
+    EXPECT_EQ(GlobalAnimationCache().getFramePose(anim, 1), GlobalAnimationCache().getFramePose(anim, 1));
+
+    auto& md5Model = dynamic_cast<md5::IMD5Model&>(*model);
+    md5Model.setAnim(anim);
+
+    auto getVertices = [&]()
+    {
+        std::vector<Vector3> vertices;
+
+        for (int s = 0; s < model->getSurfaceCount(); ++s)
+        {
+            const auto& surface = model->getSurface(s);
+
+            for (int v = 0; v < surface.getNumVertices(); ++v)
+            {
+                vertices.push_back(surface.getVertex(v).vertex);
+            }
+        }
+
+        return vertices;
+    };
+
+    // The anim is moving the origin joint 10 units along X from frame 0 to frame 1 (at 25 fps)
+    md5Model.updateAnim(0);
+    auto firstFrame = getVertices();
+
+    for (auto [time, offset] : std::vector<std::pair<std::size_t, double>>{ { 40, 10 }, { 20, 5 }, { 80, 0 } })
+    {
+        md5Model.updateAnim(time);
+        auto vertices = getVertices();
+
+        ASSERT_EQ(vertices.size(), firstFrame.size());
+
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            EXPECT_TRUE(math::isNear(vertices[i], firstFrame[i] + Vector3(offset, 0, 0), 0.01))
+                << "Vertex " << i << " at time " << time << " is " << vertices[i];
+        }
+    }
+
+    md5Model.setAnim(md5::IMD5AnimPtr());
+}
+
+namespace
+{
+
+// Returns the single compiled md5 file in the given folder, or an empty path
+fs::path findCompiledMd5File(const std::string& compiledFilePath)
+{
+    std::vector<fs::path> files;
+    os::forEachItemInDirectory(compiledFilePath, [&](const fs::path& file) { files.push_back(file); }, std::nothrow);
+
+    return files.size() == 1 ? files.front() : fs::path();
+}
+
+std::string loadBinaryFile(const fs::path& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+void saveBinaryFile(const fs::path& path, const std::string& contents)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(contents.data(), contents.size());
+}
+
+std::uint32_t readUInt32(const std::string& data, std::size_t offset)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+// Returns a copy of the data with the value at the given offset replaced
+std::string writeUInt32(std::string data, std::size_t offset, std::uint32_t value)
+{
+    std::memcpy(&data[offset], &value, sizeof(value));
+    return data;
+}
+
+}
+
+TEST_F(ModelTest, Md5MeshLoadedFromCompiledFile)
+{
+    auto compiledFilePath = _context.getCacheDataPath() + "md5/";
+    os::removeDirectory(compiledFilePath);
+
+    std::string modelPath = "models/md5/testflag.md5mesh";
+    GlobalModelCache().removeModel(modelPath);
+
+    // The first load is parsing the text file and is storing the compiled version
+    auto parsedModel = GlobalModelCache().getModel(modelPath);
+    EXPECT_TRUE(parsedModel);
+
+    auto compiledFile = findCompiledMd5File(compiledFilePath);
+    ASSERT_FALSE(compiledFile.empty()) << "Compiled file has not been written";
+
+    // Falling back to the text parser would write the compiled file again,
+    // backdate it to be able to tell whether it has been touched
+    auto backdatedTime = fs::last_write_time(compiledFile) - std::chrono::hours(1);
+    fs::last_write_time(compiledFile, backdatedTime);
+
+    GlobalModelCache().removeModel(modelPath);
+
+    auto compiledModel = GlobalModelCache().getModel(modelPath);
+    EXPECT_TRUE(compiledModel);
+    EXPECT_NE(compiledModel, parsedModel);
+    EXPECT_EQ(fs::last_write_time(compiledFile), backdatedTime) << "Model has not been loaded from the compiled file";
+
+    ASSERT_EQ(compiledModel->getSurfaceCount(), parsedModel->getSurfaceCount());
+    EXPECT_EQ(compiledModel->getVertexCount(), parsedModel->getVertexCount());
+    EXPECT_EQ(compiledModel->getPolyCount(), parsedModel->getPolyCount());
+
+    for (int s = 0; s < parsedModel->getSurfaceCount(); ++s)
+    {
+        const auto& parsedSurface = parsedModel->getSurface(s);
+        const auto& compiledSurface = compiledModel->getSurface(s);
+
+        EXPECT_EQ(compiledSurface.getDefaultMaterial(), parsedSurface.getDefaultMaterial());
+        ASSERT_EQ(compiledSurface.getNumTriangles(), parsedSurface.getNumTriangles());
+        ASSERT_EQ(compiledSurface.getNumVertices(), parsedSurface.getNumVertices());
+
+        for (int p = 0; p < parsedSurface.getNumTriangles(); ++p)
+        {
+            EXPECT_EQ(compiledSurface.getPolygon(p).a.vertex, parsedSurface.getPolygon(p).a.vertex);
+            EXPECT_EQ(compiledSurface.getPolygon(p).b.vertex, parsedSurface.getPolygon(p).b.vertex);
+            EXPECT_EQ(compiledSurface.getPolygon(p).c.vertex, parsedSurface.getPolygon(p).c.vertex);
+        }
+
+        for (int v = 0; v < parsedSurface.getNumVertices(); ++v)
+        {
+            EXPECT_EQ(compiledSurface.getVertex(v).vertex, parsedSurface.getVertex(v).vertex);
+            EXPECT_EQ(compiledSurface.getVertex(v).texcoord, parsedSurface.getVertex(v).texcoord);
+        }
+    }
+}
+
+// Damaged compiled files must be ignored, the model is parsed from the text file instead
+TEST_F(ModelTest, Md5MeshLoadedFromDamagedCompiledFile)
+{
+    auto compiledFilePath = _context.getCacheDataPath() + "md5/";
+    os::removeDirectory(compiledFilePath);
+
+    std::string modelPath = "models/md5/testflag.md5mesh";
+    GlobalModelCache().removeModel(modelPath);
+
+    auto parsedModel = GlobalModelCache().getModel(modelPath);
+    ASSERT_TRUE(parsedModel);
+
+    auto compiledFile = findCompiledMd5File(compiledFilePath);
+    ASSERT_FALSE(compiledFile.empty()) << "Compiled file has not been written";
+
+    auto validContents = loadBinaryFile(compiledFile);
+
+    // The joint count follows the header: magic, version, size_t width and source hash
+    auto hashLength = readUInt32(validContents, 13);
+    auto jointCountOffset = 17 + hashLength;
+    ASSERT_LT(jointCountOffset + 4, validContents.size());
+
+    std::vector<std::string> damagedContents =
+    {
+        validContents.substr(0, validContents.size() / 2), // truncated
+        writeUInt32(validContents, jointCountOffset, 0xFFFFFFFF), // huge joint count
+        writeUInt32(validContents, jointCountOffset, readUInt32(validContents, jointCountOffset) + 1), // one joint too many
+    };
+
+    for (const auto& contents : damagedContents)
+    {
+        saveBinaryFile(compiledFile, contents);
+        GlobalModelCache().removeModel(modelPath);
+
+        auto model = GlobalModelCache().getModel(modelPath);
+        ASSERT_TRUE(model) << "Damaged compiled file prevented the model from loading";
+        EXPECT_NE(model, parsedModel);
+        EXPECT_EQ(model->getSurfaceCount(), parsedModel->getSurfaceCount());
+        EXPECT_EQ(model->getVertexCount(), parsedModel->getVertexCount());
+        EXPECT_EQ(model->getPolyCount(), parsedModel->getPolyCount());
+
+        // The text parser replaced the damaged file
+        EXPECT_EQ(loadBinaryFile(compiledFile), validContents) << "Damaged compiled file has not been replaced";
+    }
+}
+
+TEST_F(ModelTest, Md5AnimCompiledOnlyAfterSuccessfulParse)
+{
+    auto compiledFilePath = _context.getCacheDataPath() + "md5/";
+    os::removeDirectory(compiledFilePath);
+
+    auto countCompiledFiles = [&]()
+    {
+        std::size_t numCompiledFiles = 0;
+        os::forEachItemInDirectory(compiledFilePath, [&](const fs::path&) { ++numCompiledFiles; }, std::nothrow);
+        return numCompiledFiles;
+    };
+
+    // The second frame block is missing in this file
+    GlobalAnimationCache().getAnim("models/md5/testflag_truncated.md5anim");
+    EXPECT_EQ(countCompiledFiles(), 0) << "Incompletely parsed anim should not be compiled";
+
+    auto anim = GlobalAnimationCache().getAnim("models/md5/testflag_move.md5anim");
+    ASSERT_TRUE(anim);
+    EXPECT_EQ(anim->getNumFrames(), 2);
+    EXPECT_EQ(countCompiledFiles(), 1) << "Compiled file has not been written";
+}
+
 TEST_F(ModelTest, ModelKeyReferencesModelDef)
 {
     auto funcStatic = algorithm::createEntityByClassName("func_static");
@@ -710,4 +1034,195 @@ TEST_F(ObjImportTest, UseMtlReferencingMaterial)
         << "OBJ Model loader should have taken the material from the usemtl keyword";
 }
 
+namespace
+{
+
+// A triangle with its first index rotated to the front, keeping the winding
+std::array<unsigned int, 3> getCanonicalTriangle(unsigned int a, unsigned int b, unsigned int c)
+{
+    if (b < a && b < c) return { b, c, a };
+    if (c < a && c < b) return { c, a, b };
+    return { a, b, c };
+}
+
+std::multiset<std::array<unsigned int, 3>> getCanonicalTriangles(const std::vector<unsigned int>& indices)
+{
+    std::multiset<std::array<unsigned int, 3>> triangles;
+
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        triangles.insert(getCanonicalTriangle(indices[i], indices[i + 1], indices[i + 2]));
+    }
+
+    return triangles;
+}
+
+// Counts the vertex cache misses when rendering the triangles with a FIFO cache
+std::size_t countCacheMisses(const std::vector<unsigned int>& indices, std::size_t cacheSize)
+{
+    std::deque<unsigned int> cache;
+    std::size_t misses = 0;
+
+    for (auto index : indices)
+    {
+        if (std::find(cache.begin(), cache.end(), index) != cache.end()) continue;
+
+        ++misses;
+        cache.push_front(index);
+
+        if (cache.size() > cacheSize)
+        {
+            cache.pop_back();
+        }
+    }
+
+    return misses;
+}
+
+}
+
+TEST(MeshOptimiserTest, WeldVerticesMergesOnlyIdenticalVertices)
+{
+    MeshVertex base({ 1, 2, 3 }, { 0, 0, 1 }, { 0.5, 0.25 }, { 1, 1, 1, 1 }, { 1, 0, 0 }, { 0, 1, 0 });
+
+    auto differentNormal = base;
+    differentNormal.normal = { 0, 1, 0 };
+
+    auto differentTexcoord = base;
+    differentTexcoord.texcoord = { 0.5, 0.75 };
+
+    auto differentColour = base;
+    differentColour.colour = { 1, 0, 0, 1 };
+
+    auto differentTangent = base;
+    differentTangent.tangent = { 0, 0, 1 };
+
+    auto differentBitangent = base;
+    differentBitangent.bitangent = { 0, 0, -1 };
+
+    auto slightlyMoved = base;
+    slightlyMoved.vertex.x() += 1e-9;
+
+    auto negativeZero = base;
+    negativeZero.vertex = { 0, 2, 3 };
+    auto positiveZero = negativeZero;
+    negativeZero.vertex.x() = -0.0;
+
+    std::vector<MeshVertex> vertices
+    {
+        base,               // 0
+        differentNormal,    // 1
+        base,               // 2 => 0
+        differentTexcoord,  // 3
+        differentColour,    // 4
+        differentTangent,   // 5
+        differentBitangent, // 6
+        slightlyMoved,      // 7
+        positiveZero,       // 8
+        negativeZero,       // 9 => 8
+        differentNormal,    // 10 => 1
+    };
+    auto originalVertices = vertices;
+
+    std::vector<unsigned int> indices { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 2, 10, 9 };
+    auto originalIndices = indices;
+
+    render::MeshOptimiser::weldVertices(vertices, indices);
+
+    EXPECT_EQ(vertices.size(), 8) << "Only the exact duplicates should have been merged";
+    ASSERT_EQ(indices.size(), originalIndices.size());
+
+    // The unique vertices keep their order
+    EXPECT_EQ(indices, std::vector<unsigned int>({ 0, 1, 0, 2, 3, 4, 5, 6, 7, 7, 1, 0, 1, 7 }));
+
+    // Every index is still referring to a vertex with the same attributes
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        const auto& original = originalVertices[originalIndices[i]];
+        const auto& welded = vertices[indices[i]];
+
+        EXPECT_EQ(welded.vertex, original.vertex) << "Position mismatch at index " << i;
+        EXPECT_EQ(welded.normal, original.normal) << "Normal mismatch at index " << i;
+        EXPECT_EQ(welded.texcoord, original.texcoord) << "Texcoord mismatch at index " << i;
+        EXPECT_EQ(welded.colour, original.colour) << "Colour mismatch at index " << i;
+        EXPECT_EQ(welded.tangent, original.tangent) << "Tangent mismatch at index " << i;
+        EXPECT_EQ(welded.bitangent, original.bitangent) << "Bitangent mismatch at index " << i;
+    }
+}
+
+TEST(MeshOptimiserTest, WeldVerticesWithoutDuplicates)
+{
+    std::vector<MeshVertex> vertices
+    {
+        MeshVertex({ 0, 0, 0 }, { 0, 0, 1 }, { 0, 0 }),
+        MeshVertex({ 1, 0, 0 }, { 0, 0, 1 }, { 1, 0 }),
+        MeshVertex({ 0, 1, 0 }, { 0, 0, 1 }, { 0, 1 }),
+    };
+    std::vector<unsigned int> indices { 0, 1, 2 };
+
+    render::MeshOptimiser::weldVertices(vertices, indices);
+
+    EXPECT_EQ(vertices.size(), 3);
+    EXPECT_EQ(indices, std::vector<unsigned int>({ 0, 1, 2 }));
+}
+
+TEST(MeshOptimiserTest, OptimiseTriangleOrderKeepsTriangles)
+{
+    // A grid of 32x32 quads, with the triangles in random order
+    constexpr unsigned int GridSize = 32;
+    constexpr unsigned int RowLength = GridSize + 1;
+
+    std::vector<std::array<unsigned int, 3>> triangles;
+
+    for (unsigned int y = 0; y < GridSize; ++y)
+    {
+        for (unsigned int x = 0; x < GridSize; ++x)
+        {
+            auto corner = y * RowLength + x;
+
+            triangles.push_back({ corner, corner + 1, corner + RowLength });
+            triangles.push_back({ corner + 1, corner + RowLength + 1, corner + RowLength });
+        }
+    }
+
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(17));
+
+    std::vector<unsigned int> indices;
+
+    for (const auto& triangle : triangles)
+    {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    auto numVertices = RowLength * RowLength;
+    auto originalIndices = indices;
+
+    render::MeshOptimiser::optimiseTriangleOrder(indices, numVertices);
+
+    // Same triangles, each with the same winding
+    ASSERT_EQ(indices.size(), originalIndices.size());
+    EXPECT_EQ(getCanonicalTriangles(indices), getCanonicalTriangles(originalIndices));
+    EXPECT_NE(indices, originalIndices) << "Triangle order should have been changed";
+
+    EXPECT_LT(countCacheMisses(indices, 32), countCacheMisses(originalIndices, 32))
+        << "Optimised order should have fewer vertex cache misses";
+}
+
+TEST(MeshOptimiserTest, OptimiseTriangleOrderIgnoresInvalidMeshes)
+{
+    // Index 3 is out of range
+    std::vector<unsigned int> indices { 0, 1, 2, 2, 1, 3 };
+    auto originalIndices = indices;
+
+    render::MeshOptimiser::optimiseTriangleOrder(indices, 3);
+    EXPECT_EQ(indices, originalIndices);
+
+    // Not a multiple of three
+    indices = { 0, 1, 2, 2, 1 };
+    originalIndices = indices;
+
+    render::MeshOptimiser::optimiseTriangleOrder(indices, 3);
+    EXPECT_EQ(indices, originalIndices);
+}
+
 }
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include "ParallelForEach.h"
+
+namespace test
+{
+
+TEST(ParallelForEachTest, EveryIndexIsProcessedOnce)
+{
+    std::vector<std::atomic<int>> counts(1000);
+
+    parallel::forEachIndex(counts.size(), [&](std::size_t i)
+    {
+        counts[i]++;
+    });
+
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        EXPECT_EQ(counts[i], 1) << "Index " << i << " processed the wrong number of times";
+    }
+}
+
+TEST(ParallelForEachTest, EmptyRange)
+{
+    bool called = false;
+
+    parallel::forEachIndex(0, [&](std::size_t) { called = true; });
+
+    EXPECT_FALSE(called);
+}
+
+TEST(ParallelForEachTest, ExceptionIsPropagated)
+{
+    std::atomic<std::size_t> numProcessed(0);
+
+    EXPECT_THROW(parallel::forEachIndex(10000, [&](std::size_t i)
+    {
+        if (i == 10) throw std::runtime_error("Failure");
+
+        ++numProcessed;
+    }), std::runtime_error);
+
+    EXPECT_LT(numProcessed, 9999) << "Workers should stop after an exception";
+}
+
+TEST(ParallelForEachTest, ProgressIsReported)
+{
+    std::size_t lastProgress = 0;
+    std::size_t numProgressCalls = 0;
+
+    parallel::forEachIndex(100, [&](std::size_t)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    },
+    [&](std::size_t numProcessed)
+    {
+        EXPECT_GE(numProcessed, lastProgress) << "Progress should never go backwards";
+        lastProgress = numProcessed;
+        ++numProgressCalls;
+    }, std::chrono::milliseconds(5));
+
+    EXPECT_GT(numProgressCalls, 0);
+}
+
+TEST(ParallelForEachTest, ProgressCallbackCancels)
+{
+    std::atomic<std::size_t> numProcessed(0);
+
+    EXPECT_THROW(parallel::forEachIndex(100000, [&](std::size_t)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++numProcessed;
+    },
+    [&](std::size_t)
+    {
+        throw std::runtime_error("Cancelled");
+    }, std::chrono::milliseconds(5)), std::runtime_error);
+
+    // All workers must have stopped when the exception arrives
+    auto processedAfterCancel = numProcessed.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(numProcessed, processedAfterCancel) << "Workers still running after cancellation";
+    EXPECT_LT(processedAfterCancel, 100000);
+}
+
+TEST(ParallelForEachTest, WorkersOutliveCreatingScope)
+{
+    auto results = std::make_shared<std::vector<int>>(500, 0);
+
+    std::vector<parallel::IndexWorkers> allWorkers;
+
+    {
+        allWorkers.emplace_back(results->size(), [results](std::size_t i)
+        {
+            (*results)[i] = static_cast<int>(i) * 2;
+        });
+    }
+
+    allWorkers.front().get();
+    EXPECT_TRUE(allWorkers.front().isFinished());
+    EXPECT_EQ(allWorkers.front().getNumProcessed(), results->size());
+
+    for (std::size_t i = 0; i < results->size(); ++i)
+    {
+        EXPECT_EQ((*results)[i], static_cast<int>(i) * 2);
+    }
+}
+
+}
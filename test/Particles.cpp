@@ -2,11 +2,15 @@
 
 #include "iparticles.h"
 #include "iparticlestage.h"
+#include "imap.h"
+#include "irender.h"
+#include <cstdlib>
 #include "os/path.h"
 #include "string/replace.h"
 #include "algorithm/FileUtils.h"
 #include "parser/DefBlockSyntaxParser.h"
 #include "string/case_conv.h"
+#include "math/Matrix4.h"
 #include "testutil/TemporaryFile.h"
 
 namespace test
@@ -539,4 +543,60 @@ TEST_F(ParticlesTest, AcquireParticleNode)
     EXPECT_TRUE(GlobalParticlesManager().createParticleNode("firefly_blue_in_pk4"));
 }
 
+namespace
+{
+
+// Creates a renderable particle with a fixed random seed, so that
+// two instances are generating the same particles
+particles::IRenderableParticlePtr createSeededRenderableParticle(const std::string& name, unsigned int seed)
+{
+    srand(seed);
+
+    auto particle = GlobalParticlesManager().getRenderableParticle(name);
+    particle->setRenderSystem(GlobalMapModule().getRoot()->getRenderSystem());
+
+    return particle;
+}
+
+AABB getParticleBoundsAtTime(const particles::IRenderableParticlePtr& particle, std::size_t time, const Matrix4& viewRotation)
+{
+    GlobalMapModule().getRoot()->getRenderSystem()->setTime(time);
+    particle->update(viewRotation, Matrix4::getIdentity(), nullptr);
+
+    return particle->getBounds();
+}
+
+}
+
+// Bunches are re-used when their cycle rolls over, the geometry must be the
+// same as the one generated by a freshly constructed particle
+TEST_F(ParticlesTest, ReusedBunchesMatchFreshBunches)
+{
+    // The stages of this particle have cycles of 1000 ms, 30 ms and 2700 ms, with bunching < 1
+    const std::string particleName = "tdm_fire_torch";
+    constexpr unsigned int seed = 42;
+
+    auto viewRotation = Matrix4::getRotationAboutZ(math::Degrees(30));
+
+    // This particle is stepped through time, it's keeping its bunches
+    auto steppedParticle = createSeededRenderableParticle(particleName, seed);
+    ASSERT_TRUE(steppedParticle);
+
+    for (std::size_t time = 85; time <= 6000; time += 85)
+    {
+        auto steppedBounds = getParticleBoundsAtTime(steppedParticle, time, viewRotation);
+
+        // Same time twice, nothing is regenerated, the result is the same
+        EXPECT_EQ(getParticleBoundsAtTime(steppedParticle, time, viewRotation), steppedBounds);
+
+        // A new particle has to build all its bunches from scratch
+        auto freshParticle = createSeededRenderableParticle(particleName, seed);
+        auto freshBounds = getParticleBoundsAtTime(freshParticle, time, viewRotation);
+
+        EXPECT_TRUE(steppedBounds.isValid()) << "No particles at time " << time;
+        EXPECT_EQ(steppedBounds.getOrigin(), freshBounds.getOrigin()) << "Bounds mismatch at time " << time;
+        EXPECT_EQ(steppedBounds.getExtents(), freshBounds.getExtents()) << "Bounds mismatch at time " << time;
+    }
+}
+
 }
@@ -4,11 +4,20 @@
 #include "ipatch.h"
 #include "igrid.h"
 #include "iselection.h"
+#include "itraceable.h"
+#include "itransformable.h"
 #include "scenelib.h"
 #include "algorithm/Primitives.h"
 #include "algorithm/Scene.h"
 #include "algorithm/View.h"
 #include "render/View.h"
+#include "render/MeshVertex.h"
+#include "render/NopVolumeTest.h"
+#include "math/Ray.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
 
 namespace test
 {
@@ -34,6 +43,126 @@ void selectSinglePatchVertexAt(const Vector3& position)
         << "1 additional vertex component should be selected now";
 }
 
+// Copy of the bezier sampling the patch tesselation was using before it has been
+// optimised, used as reference for the generated vertices
+void sampleReferencePatchPoint(const MeshVertex ctrl[3][3], float u, float v, MeshVertex& out)
+{
+    double vCtrl[3][8];
+
+    for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+    {
+        for (std::size_t axis = 0; axis < 8; axis++)
+        {
+            double a, b, c;
+
+            if (axis < 3)
+            {
+                a = ctrl[0][vPoint].vertex[axis];
+                b = ctrl[1][vPoint].vertex[axis];
+                c = ctrl[2][vPoint].vertex[axis];
+            }
+            else if (axis < 6)
+            {
+                a = ctrl[0][vPoint].normal[axis - 3];
+                b = ctrl[1][vPoint].normal[axis - 3];
+                c = ctrl[2][vPoint].normal[axis - 3];
+            }
+            else
+            {
+                a = ctrl[0][vPoint].texcoord[axis - 6];
+                b = ctrl[1][vPoint].texcoord[axis - 6];
+                c = ctrl[2][vPoint].texcoord[axis - 6];
+            }
+
+            double qA = a - 2.0 * b + c;
+            double qB = 2.0 * b - 2.0 * a;
+            double qC = a;
+
+            vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
+        }
+    }
+
+    for (std::size_t axis = 0; axis < 8; axis++)
+    {
+        double a = vCtrl[0][axis];
+        double b = vCtrl[1][axis];
+        double c = vCtrl[2][axis];
+        double qA = a - 2.0 * b + c;
+        double qB = 2.0 * b - 2.0 * a;
+        double qC = a;
+
+        if (axis < 3)
+        {
+            out.vertex[axis] = qA * v * v + qB * v + qC;
+        }
+        else if (axis < 6)
+        {
+            out.normal[axis - 3] = qA * v * v + qB * v + qC;
+        }
+        else
+        {
+            out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+        }
+    }
+}
+
+// Generates the reference mesh of a patch using fixed subdivisions
+std::vector<MeshVertex> generateReferenceMesh(const IPatch& patch, std::size_t subdivX, std::size_t subdivY)
+{
+    auto width = patch.getWidth();
+    auto height = patch.getHeight();
+    auto outWidth = ((width - 1) / 2 * subdivX) + 1;
+    auto outHeight = ((height - 1) / 2 * subdivY) + 1;
+
+    std::vector<MeshVertex> controlVertices(width * height);
+
+    for (std::size_t row = 0; row < height; ++row)
+    {
+        for (std::size_t col = 0; col < width; ++col)
+        {
+            controlVertices[row * width + col].vertex = patch.ctrlAt(row, col).vertex;
+            controlVertices[row * width + col].texcoord = patch.ctrlAt(row, col).texcoord;
+        }
+    }
+
+    std::vector<MeshVertex> result(outWidth * outHeight);
+    MeshVertex sample[3][3];
+    std::size_t baseCol = 0;
+
+    for (std::size_t i = 0; i + 2 < width; i += 2)
+    {
+        std::size_t baseRow = 0;
+
+        for (std::size_t j = 0; j + 2 < height; j += 2)
+        {
+            for (std::size_t k = 0; k < 3; k++)
+            {
+                for (std::size_t l = 0; l < 3; l++)
+                {
+                    sample[k][l] = controlVertices[((j + l) * width) + i + k];
+                }
+            }
+
+            for (std::size_t x = 0; x <= subdivX; x++)
+            {
+                for (std::size_t y = 0; y <= subdivY; y++)
+                {
+                    float u = static_cast<float>(x) / subdivX;
+                    float v = static_cast<float>(y) / subdivY;
+
+                    sampleReferencePatchPoint(sample, u, v, result[((baseRow + y) * outWidth) + x + baseCol]);
+                }
+            }
+
+            baseRow += subdivY;
+        }
+
+        baseCol += subdivX;
+    }
+
+    return result;
+}
+
 }
 
 // Checks that snapping a single selected patch vertex is working
@@ -247,4 +376,334 @@ TEST_F(PatchTest, CapPatch)
     }
 }
 
+namespace
+{
+
+// Reference implementation testing the ray against every triangle of the quad strips
+bool intersectPatchMeshBruteForce(const PatchMesh& mesh, const PatchRenderIndices& renderIndices,
+    const Ray& ray, Vector3& intersection)
+{
+    bool found = false;
+    auto bestDistanceSquared = std::numeric_limits<double>::max();
+
+    auto testTriangle = [&](std::size_t i1, std::size_t i2, std::size_t i3)
+    {
+        Vector3 triangleIntersection;
+
+        if (ray.intersectTriangle(mesh.vertices[i1].vertex, mesh.vertices[i2].vertex,
+            mesh.vertices[i3].vertex, triangleIntersection) == Ray::POINT)
+        {
+            auto distanceSquared = (triangleIntersection - ray.origin).getLengthSquared();
+
+            if (distanceSquared < bestDistanceSquared)
+            {
+                bestDistanceSquared = distanceSquared;
+                intersection = triangleIntersection;
+                found = true;
+            }
+        }
+    };
+
+    for (std::size_t strip = 0; strip < renderIndices.numStrips; ++strip)
+    {
+        const auto* indices = &renderIndices.indices[strip * renderIndices.lenStrips];
+
+        for (std::size_t i = 0; i + 2 < renderIndices.lenStrips; i += 2)
+        {
+            testTriangle(indices[i], indices[i + 1], indices[i + 2]);
+            testTriangle(indices[i + 2], indices[i + 1], indices[i + 3]);
+        }
+    }
+
+    return found;
+}
+
+// Creates a hilly 512x512 terrain patch with a high fixed tesselation
+scene::INodePtr createHighResolutionTerrainPatch()
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto patchNode = GlobalPatchModule().createPatch(patch::PatchDefType::Def3);
+    worldspawn->addChildNode(patchNode);
+
+    auto patch = Node_getIPatch(patchNode);
+    patch->setDims(9, 9);
+
+    for (std::size_t row = 0; row < patch->getHeight(); ++row)
+    {
+        for (std::size_t col = 0; col < patch->getWidth(); ++col)
+        {
+            patch->ctrlAt(row, col).vertex = Vector3(col * 64.0, row * 64.0, 48 * sin(col * 0.8) * cos(row * 0.6));
+        }
+    }
+
+    patch->setFixedSubdivisions(true, Subdivisions(32, 32));
+    patch->controlPointsChanged();
+
+    return patchNode;
+}
+
+// Slightly tilted rays pointing down on the terrain patch, in a grid with the given spacing
+std::vector<Ray> createRayGrid(double spacing)
+{
+    std::vector<Ray> rays;
+
+    for (double x = 4; x < 512; x += spacing)
+    {
+        for (double y = 4; y < 512; y += spacing)
+        {
+            rays.emplace_back(Ray::createForPoints(Vector3(x, y, 1000), Vector3(x + 3, y - 5, -1000)));
+        }
+    }
+
+    return rays;
+}
+
+}
+
+// Traces a grid of rays against a high-resolution terrain patch, comparing the
+// results of the patch's triangle tree to the brute-force approach
+TEST_F(PatchTest, RayIntersectionWithHighResolutionPatch)
+{
+    auto patchNode = createHighResolutionTerrainPatch();
+    auto patch = Node_getIPatch(patchNode);
+
+    auto mesh = patch->getTesselatedPatchMesh();
+    auto renderIndices = patch->getRenderIndices();
+    EXPECT_GT(mesh.vertices.size(), 10000) << "Test patch should be high-res";
+
+    auto traceable = std::dynamic_pointer_cast<ITraceable>(patchNode);
+    ASSERT_TRUE(traceable);
+
+    auto rays = createRayGrid(16);
+
+    // Rays missing the patch entirely
+    rays.emplace_back(Ray::createForPoints(Vector3(-100, -100, 1000), Vector3(-100, -100, -1000)));
+    rays.emplace_back(Ray::createForPoints(Vector3(256, 256, 1000), Vector3(256, 256, 2000)));
+
+    std::vector<std::pair<bool, Vector3>> expectedResults;
+    expectedResults.reserve(rays.size());
+
+    for (const auto& ray : rays)
+    {
+        Vector3 intersection;
+        auto hit = intersectPatchMeshBruteForce(mesh, renderIndices, ray, intersection);
+        expectedResults.emplace_back(hit, intersection);
+    }
+
+    std::vector<std::pair<bool, Vector3>> results;
+    results.reserve(rays.size());
+
+    for (const auto& ray : rays)
+    {
+        Vector3 intersection;
+        auto hit = traceable->getIntersection(ray, intersection);
+        results.emplace_back(hit, intersection);
+    }
+
+    for (std::size_t i = 0; i < rays.size(); ++i)
+    {
+        EXPECT_EQ(results[i].first, expectedResults[i].first) << "Hit mismatch for ray " << i;
+
+        if (results[i].first && expectedResults[i].first)
+        {
+            EXPECT_TRUE(math::isNear(results[i].second, expectedResults[i].second, 0.001)) << "Intersection mismatch for ray " << i;
+        }
+    }
+
+    EXPECT_FALSE(results[rays.size() - 2].first) << "Ray outside the patch bounds should miss";
+    EXPECT_FALSE(results[rays.size() - 1].first) << "Ray pointing away from the patch should miss";
+}
+
+// Benchmark comparing the triangle tree to the brute-force ray test, not run by default.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*PatchRayIntersectionBenchmark
+TEST_F(PatchTest, DISABLED_PatchRayIntersectionBenchmark)
+{
+    using std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    constexpr int NumPasses = 5;
+
+    auto patchNode = createHighResolutionTerrainPatch();
+    auto patch = Node_getIPatch(patchNode);
+
+    auto mesh = patch->getTesselatedPatchMesh();
+    auto renderIndices = patch->getRenderIndices();
+    auto traceable = std::dynamic_pointer_cast<ITraceable>(patchNode);
+    ASSERT_TRUE(traceable);
+
+    auto rays = createRayGrid(4);
+    std::size_t bruteForceHits = 0;
+    std::size_t treeHits = 0;
+
+    auto bruteForceStart = steady_clock::now();
+
+    for (int pass = 0; pass < NumPasses; ++pass)
+    {
+        for (const auto& ray : rays)
+        {
+            Vector3 intersection;
+            bruteForceHits += intersectPatchMeshBruteForce(mesh, renderIndices, ray, intersection) ? 1 : 0;
+        }
+    }
+
+    // The first tree query is building the tree, time it separately
+    auto treeBuildStart = steady_clock::now();
+
+    Vector3 intersection;
+    traceable->getIntersection(rays.front(), intersection);
+
+    auto treeStart = steady_clock::now();
+
+    for (int pass = 0; pass < NumPasses; ++pass)
+    {
+        for (const auto& ray : rays)
+        {
+            treeHits += traceable->getIntersection(ray, intersection) ? 1 : 0;
+        }
+    }
+
+    auto end = steady_clock::now();
+
+    EXPECT_EQ(treeHits, bruteForceHits);
+
+    std::cout << "Traced " << rays.size() << " rays " << NumPasses << " times against "
+        << renderIndices.indices.size() << " patch indices" << std::endl
+        << "  brute force:   " << duration_cast<microseconds>(treeBuildStart - bruteForceStart).count() << " us" << std::endl
+        << "  tree build:    " << duration_cast<microseconds>(treeStart - treeBuildStart).count() << " us" << std::endl
+        << "  triangle tree: " << duration_cast<microseconds>(end - treeStart).count() << " us" << std::endl;
+}
+
+// The patches of a loaded map are tesselated in one batch (possibly in parallel),
+// the resulting meshes must be the same as the ones generated one by one
+TEST_F(PatchTest, BatchTesselationOnMapLoad)
+{
+    loadMap("altar.map");
+
+    std::vector<scene::INodePtr> patchNodes;
+
+    GlobalMapModule().getRoot()->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isPatch(node))
+        {
+            patchNodes.push_back(node);
+        }
+
+        return true;
+    });
+
+    EXPECT_GT(patchNodes.size(), 100) << "Expected lots of patches in this map";
+
+    for (const auto& node : patchNodes)
+    {
+        auto patch = Node_getIPatch(node);
+        auto batchMesh = patch->getTesselatedPatchMesh();
+
+        EXPECT_FALSE(batchMesh.vertices.empty()) << "Patch has not been tesselated";
+
+        // Regenerate this single patch and compare the results
+        patch->updateTesselation(true);
+        auto singleMesh = patch->getTesselatedPatchMesh();
+
+        EXPECT_EQ(batchMesh.width, singleMesh.width);
+        EXPECT_EQ(batchMesh.height, singleMesh.height);
+        EXPECT_TRUE(batchMesh.vertices == singleMesh.vertices) << "Tesselation mismatch";
+    }
+
+    // Rendering any patch is running the queued updates, e.g. of the patches moved on load
+    render::NopVolumeTest volumeTest;
+    patchNodes.front()->onPreRender(volumeTest);
+    EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), 0) << "Queue has not been processed";
+
+    // Transformed patches are queued, each of them once
+    for (const auto& node : patchNodes)
+    {
+        auto transformable = scene::node_cast<ITransformable>(node);
+        transformable->setTranslation(Vector3(16, 0, 0));
+        transformable->setTranslation(Vector3(32, 8, 0));
+    }
+
+    EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), patchNodes.size());
+
+    // Patches removed from the scene are leaving the queue
+    auto removedNode = patchNodes.back();
+    patchNodes.pop_back();
+    scene::removeNodeFromParent(removedNode);
+
+    EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), patchNodes.size()) << "Removed patch is still queued";
+
+    // Destroyed patches as well, the same address might be used by the next node
+    {
+        auto patchNode = GlobalPatchModule().createPatch(patch::PatchDefType::Def2);
+        scene::node_cast<ITransformable>(patchNode)->setTranslation(Vector3(0, 0, 8));
+
+        EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), patchNodes.size() + 1);
+    }
+
+    EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), patchNodes.size()) << "Destroyed patch is still queued";
+
+    // The first rendered patch is updating all of them in one batch
+    patchNodes.front()->onPreRender(volumeTest);
+    EXPECT_EQ(GlobalPatchModule().getNumQueuedTesselations(), 0) << "Queue has not been processed";
+
+    for (const auto& node : patchNodes)
+    {
+        auto patch = Node_getIPatch(node);
+        auto batchMesh = patch->getTesselatedPatchMesh();
+
+        patch->updateTesselation(true);
+
+        EXPECT_TRUE(batchMesh.vertices == patch->getTesselatedPatchMesh().vertices) << "Tesselation mismatch after transform";
+    }
+}
+
+// The optimised bezier evaluation must produce exactly the same vertices as before
+TEST_F(PatchTest, TesselationMatchesReferenceSampling)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    struct TestCase
+    {
+        std::size_t width;
+        std::size_t height;
+        Subdivisions subdivisions;
+    };
+
+    for (const auto& testCase : { TestCase{ 3, 3, Subdivisions(4, 4) },
+                                  TestCase{ 5, 3, Subdivisions(7, 3) },
+                                  TestCase{ 7, 5, Subdivisions(5, 9) } })
+    {
+        auto patchNode = GlobalPatchModule().createPatch(patch::PatchDefType::Def3);
+        worldspawn->addChildNode(patchNode);
+
+        auto patch = Node_getIPatch(patchNode);
+        patch->setDims(testCase.width, testCase.height);
+
+        // Curved in all directions, with uneven texture coordinates
+        for (std::size_t row = 0; row < patch->getHeight(); ++row)
+        {
+            for (std::size_t col = 0; col < patch->getWidth(); ++col)
+            {
+                patch->ctrlAt(row, col).vertex = Vector3(col * 37.3 + row * 3.1,
+                    row * 41.7 - col * col * 1.9, 29 * sin(col * 1.3 + 0.2) * cos(row * 0.7));
+                patch->ctrlAt(row, col).texcoord = Vector2(col * 0.37 + row * row * 0.013, row * 0.29 - col * 0.071);
+            }
+        }
+
+        patch->setFixedSubdivisions(true, testCase.subdivisions);
+        patch->controlPointsChanged();
+
+        auto expected = generateReferenceMesh(*patch, testCase.subdivisions.x(), testCase.subdivisions.y());
+        auto mesh = patch->getTesselatedPatchMesh();
+
+        ASSERT_EQ(mesh.vertices.size(), expected.size());
+
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(mesh.vertices[i].vertex, expected[i].vertex) << "Vertex mismatch at index " << i;
+            EXPECT_EQ(mesh.vertices[i].texcoord, expected[i].texcoord) << "Texcoord mismatch at index " << i;
+        }
+    }
+}
+
 }
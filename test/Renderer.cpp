@@ -5,7 +5,10 @@
 #include "irender.h"
 #include "ilightnode.h"
 #include "math/Matrix4.h"
+#include "render/ShadowMapAtlas.h"
 #include "scenelib.h"
+#include <algorithm>
+#include <iterator>
 
 namespace test
 {
@@ -490,4 +493,237 @@ TEST_F(RenderSystemTest, AttachmentIsRegisteredAsLight)
     EXPECT_EQ(getLightCount(renderSystem), 1) << "Rendersystem should know of 1 light after removing the torch";
 }
 
+
+namespace
+{
+
+// Shadow map texture holding six tiles of 1024 pixels in a row (and six rows)
+constexpr std::size_t ShadowMapSize = 6 * 1024;
+
+bool rectanglesOverlap(const render::Rectangle& a, const render::Rectangle& b)
+{
+    // The six tiles of each light are placed next to each other
+    return a.x < b.x + 6 * b.width && b.x < a.x + 6 * a.width &&
+        a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void expectValidAllocations(const std::vector<render::Rectangle>& rectangles)
+{
+    for (std::size_t i = 0; i < rectangles.size(); ++i)
+    {
+        const auto& rect = rectangles[i];
+
+        EXPECT_GE(rect.x, 0);
+        EXPECT_GE(rect.y, 0);
+        EXPECT_LE(rect.x + 6 * rect.width, static_cast<int>(ShadowMapSize)) << "Tile strip " << i << " exceeds the texture";
+        EXPECT_LE(rect.y + rect.height, static_cast<int>(ShadowMapSize)) << "Tile strip " << i << " exceeds the texture";
+
+        for (std::size_t j = i + 1; j < rectangles.size(); ++j)
+        {
+            EXPECT_FALSE(rectanglesOverlap(rect, rectangles[j])) << "Tile strips " << i << " and " << j << " overlap";
+        }
+    }
+}
+
+std::vector<render::Rectangle> allocateAll(render::ShadowMapAtlas& atlas, std::size_t tileSize)
+{
+    std::vector<render::Rectangle> rectangles;
+    render::Rectangle rectangle;
+
+    while (atlas.allocate(tileSize, rectangle))
+    {
+        rectangles.push_back(rectangle);
+    }
+
+    return rectangles;
+}
+
+}
+
+TEST(ShadowMapAtlasTest, TileSizes)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    EXPECT_EQ(atlas.getMaxTileSize(), 1024);
+    EXPECT_EQ(atlas.getMinTileSize(), 1024 >> (render::ShadowMapAtlas::NumTileSizes - 1));
+}
+
+TEST(ShadowMapAtlasTest, ExhaustAtlasWithLargestTiles)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    auto rectangles = allocateAll(atlas, atlas.getMaxTileSize());
+
+    // Six strips of the maximum size fit into the texture
+    EXPECT_EQ(rectangles.size(), 6);
+    expectValidAllocations(rectangles);
+
+    for (const auto& rect : rectangles)
+    {
+        EXPECT_EQ(rect.width, 1024);
+        EXPECT_EQ(rect.height, 1024);
+    }
+
+    // No space left for any size
+    render::Rectangle rectangle;
+    EXPECT_FALSE(atlas.allocate(atlas.getMinTileSize(), rectangle));
+
+    // Clearing the atlas makes all space available again
+    atlas.clear();
+    EXPECT_EQ(allocateAll(atlas, atlas.getMaxTileSize()).size(), 6);
+}
+
+TEST(ShadowMapAtlasTest, ExhaustAtlasWithSmallestTiles)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    auto rectangles = allocateAll(atlas, atlas.getMinTileSize());
+
+    // Every root block is split into 4^4 blocks of the smallest size
+    EXPECT_EQ(rectangles.size(), 6 * 256);
+    expectValidAllocations(rectangles);
+
+    render::Rectangle rectangle;
+    EXPECT_FALSE(atlas.allocate(atlas.getMaxTileSize(), rectangle));
+}
+
+TEST(ShadowMapAtlasTest, MixedTileSizesDontOverlap)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    std::vector<render::Rectangle> rectangles;
+    render::Rectangle rectangle;
+
+    // Allocate all sizes in turns until the atlas is full
+    for (bool allocated = true; allocated;)
+    {
+        allocated = false;
+
+        for (auto size = atlas.getMaxTileSize(); size >= atlas.getMinTileSize(); size /= 2)
+        {
+            if (atlas.allocate(size, rectangle))
+            {
+                rectangles.push_back(rectangle);
+                allocated = true;
+            }
+        }
+    }
+
+    EXPECT_GT(rectangles.size(), 6);
+    expectValidAllocations(rectangles);
+}
+
+TEST(ShadowMapAtlasTest, FreedSiblingsAreMerged)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    // Fill the atlas with tiles of half the maximum size, four of them in each root block
+    auto halfSize = atlas.getMaxTileSize() / 2;
+    auto rectangles = allocateAll(atlas, halfSize);
+    EXPECT_EQ(rectangles.size(), 6 * 4);
+
+    render::Rectangle rectangle;
+    EXPECT_FALSE(atlas.allocate(atlas.getMaxTileSize(), rectangle));
+
+    // Pick the four siblings of the root block at the top of the texture
+    std::vector<render::Rectangle> siblings;
+    std::copy_if(rectangles.begin(), rectangles.end(), std::back_inserter(siblings),
+        [](const render::Rectangle& rect) { return rect.y < 1024; });
+    ASSERT_EQ(siblings.size(), 4);
+
+    // Freeing three of them is not enough for a large tile, but the space can be reused
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        atlas.free(siblings[i]);
+    }
+
+    EXPECT_FALSE(atlas.allocate(atlas.getMaxTileSize(), rectangle)) << "Siblings should not be merged before all are free";
+
+    EXPECT_TRUE(atlas.allocate(halfSize, rectangle));
+    atlas.free(rectangle);
+
+    // Once the last sibling is free, they are merged into a root block again
+    atlas.free(siblings[3]);
+
+    EXPECT_TRUE(atlas.allocate(atlas.getMaxTileSize(), rectangle)) << "Freed siblings should have been merged";
+    EXPECT_EQ(rectangle.x, 0);
+    EXPECT_EQ(rectangle.y, 0);
+    EXPECT_EQ(rectangle.width, 1024);
+
+    EXPECT_FALSE(atlas.allocate(atlas.getMaxTileSize(), rectangle));
+}
+
+TEST(ShadowMapAtlasTest, FreeingEverythingRestoresRootBlocks)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    auto rectangles = allocateAll(atlas, atlas.getMinTileSize());
+
+    // Release the small tiles in a different order than they've been allocated
+    for (std::size_t i = 0; i < rectangles.size(); i += 2)
+    {
+        atlas.free(rectangles[i]);
+    }
+
+    for (std::size_t i = 1; i < rectangles.size(); i += 2)
+    {
+        atlas.free(rectangles[i]);
+    }
+
+    EXPECT_EQ(allocateAll(atlas, atlas.getMaxTileSize()).size(), 6);
+}
+
+TEST(ShadowMapAtlasTest, FallbackToSmallerTileSize)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+    render::Rectangle rectangle;
+
+    // Leave room for three half size tiles only
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_TRUE(atlas.allocate(atlas.getMaxTileSize(), rectangle));
+    }
+
+    EXPECT_TRUE(atlas.allocate(atlas.getMaxTileSize() / 2, rectangle));
+
+    std::size_t evictCalls = 0;
+    auto noEviction = [&] { ++evictCalls; return false; };
+
+    EXPECT_TRUE(atlas.allocateUpTo(atlas.getMaxTileSize(), rectangle, noEviction));
+    EXPECT_EQ(rectangle.width, atlas.getMaxTileSize() / 2) << "Should have fallen back to the next smaller size";
+    EXPECT_EQ(evictCalls, 1);
+
+    // Exhaust the remaining space
+    EXPECT_TRUE(atlas.allocate(atlas.getMaxTileSize() / 2, rectangle));
+    EXPECT_TRUE(atlas.allocate(atlas.getMaxTileSize() / 2, rectangle));
+
+    // All sizes are tried before giving up
+    evictCalls = 0;
+    EXPECT_FALSE(atlas.allocateUpTo(atlas.getMaxTileSize(), rectangle, noEviction));
+    EXPECT_EQ(evictCalls, render::ShadowMapAtlas::NumTileSizes);
+}
+
+TEST(ShadowMapAtlasTest, EvictionBeforeFallback)
+{
+    render::ShadowMapAtlas atlas(ShadowMapSize);
+
+    auto rectangles = allocateAll(atlas, atlas.getMaxTileSize());
+    ASSERT_EQ(rectangles.size(), 6);
+
+    // Evicting a tile is making room for the requested size, no fallback needed
+    auto evictOne = [&]
+    {
+        if (rectangles.empty()) return false;
+
+        atlas.free(rectangles.back());
+        rectangles.pop_back();
+        return true;
+    };
+
+    render::Rectangle rectangle;
+    EXPECT_TRUE(atlas.allocateUpTo(atlas.getMaxTileSize(), rectangle, evictOne));
+    EXPECT_EQ(rectangle.width, 1024);
+    EXPECT_EQ(rectangles.size(), 5) << "Exactly one tile should have been evicted";
+}
+
 }
@@ -0,0 +1,216 @@
+#include "RadiantTest.h"
+
+#include "iscript.h"
+#include "imap.h"
+#include "ibrush.h"
+#include "ipatch.h"
+#include "iselection.h"
+#include "scenelib.h"
+#include "algorithm/Primitives.h"
+
+namespace test
+{
+
+using ScriptingSystemTest = RadiantTest;
+
+namespace
+{
+
+// Runs the given script, failing the test if the script reported an error
+void executeScript(const std::string& script)
+{
+    auto result = GlobalScriptingSystem().executeString(script);
+
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result->errorOccurred) << "Script failed:\n" << result->output;
+}
+
+// Runs the given script, expecting it to raise a ValueError
+void expectValueError(const std::string& script)
+{
+    auto result = GlobalScriptingSystem().executeString(script);
+
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result->errorOccurred) << "Script should have failed:\n" << script;
+    EXPECT_NE(result->output.find("ValueError"), std::string::npos) << "Unexpected error:\n" << result->output;
+}
+
+std::vector<PatchControl> getControlPoints(const IPatch& patch)
+{
+    std::vector<PatchControl> controls;
+
+    for (std::size_t row = 0; row < patch.getHeight(); ++row)
+    {
+        for (std::size_t col = 0; col < patch.getWidth(); ++col)
+        {
+            controls.push_back(patch.ctrlAt(row, col));
+        }
+    }
+
+    return controls;
+}
+
+void expectControlPointsUnchanged(const IPatch& patch, const std::vector<PatchControl>& controls)
+{
+    auto current = getControlPoints(patch);
+    ASSERT_EQ(current.size(), controls.size());
+
+    for (std::size_t i = 0; i < controls.size(); ++i)
+    {
+        EXPECT_TRUE(math::isNear(current[i].vertex, controls[i].vertex, 1e-6)) << "Vertex " << i << " changed";
+        EXPECT_TRUE(math::isNear(current[i].texcoord, controls[i].texcoord, 1e-6)) << "Texcoord " << i << " changed";
+    }
+}
+
+std::vector<Matrix3> getFaceTextureMatrices(IBrush& brush)
+{
+    std::vector<Matrix3> matrices;
+
+    for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+    {
+        matrices.push_back(brush.getFace(i).getProjectionMatrix());
+    }
+
+    return matrices;
+}
+
+}
+
+// The numpy module can only be loaded once per process, but the interpreter is
+// restarted along with the modules for every test. All array accessors are
+// therefore exercised by this single test case.
+TEST_F(ScriptingSystemTest, NumPyAccessorsRoundTrip)
+{
+    // numpy is an optional dependency, only needed by scripts using these accessors
+    auto numpyCheck = GlobalScriptingSystem().executeString("import numpy");
+
+    if (!numpyCheck || numpyCheck->errorOccurred)
+    {
+        GTEST_SKIP() << "numpy is not available to the script module";
+    }
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    // Patch control points
+    auto patchNode = algorithm::createPatchFromBounds(worldspawn, AABB({ 0, 0, 0 }, { 64, 128, 32 }));
+    auto& patch = *Node_getIPatch(patchNode);
+
+    auto originalControls = getControlPoints(patch);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+    Node_setSelected(patchNode, true);
+
+    executeScript(R"(
+patch = GlobalSelectionSystem.ultimateSelected().getPatch()
+points = patch.getControlPoints()
+if points.shape != (3, 3, 5):
+    raise RuntimeError('Unexpected shape ' + str(points.shape))
+points[:, :, 2] += 16
+points[:, :, 3] = 0.25
+points[:, :, 4] = points[:, :, 0] / 64
+patch.setControlPoints(points)
+)");
+
+    auto controls = getControlPoints(patch);
+    ASSERT_EQ(controls.size(), originalControls.size());
+
+    for (std::size_t i = 0; i < controls.size(); ++i)
+    {
+        const auto& original = originalControls[i].vertex;
+        EXPECT_TRUE(math::isNear(controls[i].vertex, original + Vector3(0, 0, 16), 1e-6)) << "Vertex " << i << " not moved";
+        EXPECT_TRUE(math::isNear(controls[i].texcoord, Vector2(0.25, original.x() / 64), 1e-6)) << "Texcoord " << i << " not assigned";
+    }
+
+    // The array dimensions must match the patch dimensions
+    originalControls = getControlPoints(patch);
+
+    expectValueError(R"(
+patch = GlobalSelectionSystem.ultimateSelected().getPatch()
+patch.setControlPoints(patch.getControlPoints()[:2])
+)");
+    expectValueError(R"(
+patch = GlobalSelectionSystem.ultimateSelected().getPatch()
+patch.setControlPoints(patch.getControlPoints()[:, :, :3])
+)");
+
+    expectControlPointsUnchanged(patch, originalControls);
+
+    // Brush face shaders, assigned by the face planes
+    auto brushNode = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0), "textures/numpy/side");
+    auto& brush = *Node_getIBrush(brushNode);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+    Node_setSelected(brushNode, true);
+
+    executeScript(R"(
+brush = GlobalSelectionSystem.ultimateSelected().getBrush()
+planes = brush.getFacePlanes()
+if planes.shape != (6, 4):
+    raise RuntimeError('Unexpected shape ' + str(planes.shape))
+brush.setFaceShaders(['textures/numpy/top' if plane[2] > 0.5 else 'textures/numpy/side' for plane in planes])
+)");
+
+    for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+    {
+        const auto& face = brush.getFace(i);
+        auto expectedShader = face.getPlane3().normal().z() > 0.5 ? "textures/numpy/top" : "textures/numpy/side";
+
+        EXPECT_EQ(face.getShader(), expectedShader) << "Wrong shader on face " << i;
+    }
+
+    // Brush face texture matrices
+    auto originalMatrices = getFaceTextureMatrices(brush);
+
+    executeScript(R"(
+brush = GlobalSelectionSystem.ultimateSelected().getBrush()
+matrices = brush.getFaceTextureMatrices()
+if matrices.shape != (6, 2, 3):
+    raise RuntimeError('Unexpected shape ' + str(matrices.shape))
+matrices[:, 0, 2] += 0.5
+brush.setFaceTextureMatrices(matrices)
+)");
+
+    auto matrices = getFaceTextureMatrices(brush);
+    ASSERT_EQ(matrices.size(), originalMatrices.size());
+
+    for (std::size_t i = 0; i < matrices.size(); ++i)
+    {
+        const auto& original = originalMatrices[i].eigen().matrix();
+        const auto& changed = matrices[i].eigen().matrix();
+
+        EXPECT_NEAR(changed(0, 2), original(0, 2) + 0.5, 1e-6) << "Shift not applied to face " << i;
+        EXPECT_NEAR(changed(1, 2), original(1, 2), 1e-6) << "Vertical shift changed on face " << i;
+        EXPECT_NEAR(changed(0, 0), original(0, 0), 1e-6) << "Scale changed on face " << i;
+        EXPECT_NEAR(changed(1, 1), original(1, 1), 1e-6) << "Scale changed on face " << i;
+    }
+
+    // Mismatching face counts and array shapes are rejected, leaving the brush alone
+    std::vector<std::string> shaders;
+
+    for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+    {
+        shaders.push_back(brush.getFace(i).getShader());
+    }
+
+    originalMatrices = getFaceTextureMatrices(brush);
+
+    expectValueError(R"(
+brush = GlobalSelectionSystem.ultimateSelected().getBrush()
+brush.setFaceShaders(['textures/numpy/top'])
+)");
+    expectValueError(R"(
+brush = GlobalSelectionSystem.ultimateSelected().getBrush()
+brush.setFaceTextureMatrices(brush.getFaceTextureMatrices()[:, :, :2])
+)");
+
+    matrices = getFaceTextureMatrices(brush);
+
+    for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+    {
+        EXPECT_EQ(brush.getFace(i).getShader(), shaders[i]) << "Shader changed on face " << i;
+        EXPECT_TRUE(matrices[i].eigen().matrix().isApprox(originalMatrices[i].eigen().matrix()))
+            << "Texture matrix changed on face " << i;
+    }
+}
+
+}
@@ -10,6 +10,7 @@
 #include "ipatch.h"
 #include "ientity.h"
 #include "ieclass.h"
+#include "icommandsystem.h"
 #include "algorithm/Scene.h"
 #include "algorithm/Primitives.h"
 #include "scenelib.h"
@@ -550,6 +551,108 @@ TEST_F(CameraViewSelectionTest, TwosidedBrushFacingAwayFromViewIsNotSelectable)
     performBrushSelectionTest("textures/darkmod/decals/vegetation/ivy_mixed_pieces2", false); // not selectable in camera, face is not visible
 }
 
+// --------- Brush with many faces (faces are culled by their bounds) -----
+
+namespace
+{
+
+scene::INodePtr createPrismBrush(std::size_t numSides)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = algorithm::createCuboidBrush(worldspawn, AABB({ 0, 0, 0 }, { 64, 64, 64 }), "textures/numbers/1");
+
+    Node_setSelected(brush, true);
+    GlobalCommandSystem().executeCommand("BrushMakePrefab",
+        { cmd::Argument(static_cast<int>(brush::PrefabType::Prism)), cmd::Argument(static_cast<int>(numSides)) });
+    Node_setSelected(brush, false);
+
+    EXPECT_EQ(Node_getIBrush(brush)->getNumFaces(), numSides + 2);
+
+    return brush;
+}
+
+// Runs a face selection test at the center of the given view
+void selectFaceAtViewCenter(render::View& view)
+{
+    auto rectangle = selection::Rectangle::ConstructFromPoint(Vector2(0, 0), Vector2(8.0 / algorithm::DeviceWidth, 8.0 / algorithm::DeviceHeight));
+    ConstructSelectionTest(view, rectangle);
+
+    SelectionVolume test(view);
+    GlobalSelectionSystem().selectPoint(test, selection::SelectionSystem::eToggle, true);
+}
+
+// Returns bounds of the same size as the node's, located right next to it
+AABB getBoundsNextTo(const scene::INodePtr& node)
+{
+    const auto& bounds = node->worldAABB();
+    return AABB(bounds.getOrigin() + Vector3(bounds.getExtents().x() * 4, 0, 0), bounds.getExtents());
+}
+
+}
+
+TEST_F(OrthoViewSelectionTest, ManySidedBrushIsSelectable)
+{
+    auto brush = createPrismBrush(16);
+
+    performSelectionTest(brush, true);
+}
+
+TEST_F(CameraViewSelectionTest, ManySidedBrushIsSelectable)
+{
+    auto brush = createPrismBrush(16);
+
+    performSelectionTest(brush, true);
+}
+
+TEST_F(OrthoViewSelectionTest, ManySidedBrushOutsideVolumeIsNotSelectable)
+{
+    auto brush = createPrismBrush(16);
+
+    // Center the view next to the brush, the selection volume doesn't touch its bounds
+    render::View view = createView();
+    constructView(view, getBoundsNextTo(brush));
+
+    performViewSelectionTest(view, brush, false);
+}
+
+TEST_F(CameraViewSelectionTest, ManySidedBrushOutsideVolumeIsNotSelectable)
+{
+    auto brush = createPrismBrush(16);
+
+    render::View view = createView();
+    constructView(view, getBoundsNextTo(brush));
+
+    performViewSelectionTest(view, brush, false);
+}
+
+TEST_F(CameraViewSelectionTest, ManySidedBrushFaceSelection)
+{
+    auto brush = createPrismBrush(16);
+
+    render::View view = createView();
+    constructView(view, brush->worldAABB());
+
+    selectFaceAtViewCenter(view);
+
+    // The side faces are outside the selection volume, the bottom face is
+    // facing away from the camera, leaving the top face as the only candidate
+    ASSERT_EQ(GlobalSelectionSystem().getSelectedFaceCount(), 1);
+    EXPECT_TRUE(math::isNear(GlobalSelectionSystem().getSingleSelectedFace().getPlane3().normal(), Vector3(0, 0, 1), 0.001))
+        << "The top face should have been selected";
+}
+
+TEST_F(CameraViewSelectionTest, ManySidedBrushFacesOutsideVolumeAreNotSelectable)
+{
+    auto brush = createPrismBrush(16);
+
+    render::View view = createView();
+    constructView(view, getBoundsNextTo(brush));
+
+    selectFaceAtViewCenter(view);
+
+    EXPECT_EQ(GlobalSelectionSystem().getSelectedFaceCount(), 0) << "No face should have been selected";
+}
+
 // --------- Patch with one-sided material -----
 
 TEST_F(OrthoViewSelectionTest, OnesidedPatchFacingTowardsViewIsSelectable)
@@ -2,6 +2,8 @@
 
 #include "isound.h"
 
+#include <vector>
+
 namespace test
 {
 
@@ -92,4 +94,135 @@ TEST_F(SoundManagerTest, GetSoundFileDurationWithoutExtension)
     EXPECT_NEAR(duration, oggDuration, 0.001) << "The OGG file should have been found, not the wav file";
 }
 
+namespace
+{
+
+// Reads the whole stream in chunks of the given size, the size of every chunk is recorded
+std::vector<char> readStream(ISoundStream& stream, std::size_t chunkSize, std::vector<std::size_t>* chunkSizes = nullptr)
+{
+    std::vector<char> result;
+    std::vector<char> chunk(chunkSize);
+
+    while (auto bytesRead = stream.read(chunk.data(), chunk.size()))
+    {
+        result.insert(result.end(), chunk.begin(), chunk.begin() + bytesRead);
+
+        if (chunkSizes)
+        {
+            chunkSizes->push_back(bytesRead);
+        }
+    }
+
+    return result;
+}
+
+std::size_t getFrameSize(const ISoundStream& stream)
+{
+    return stream.getNumChannels() * (stream.getBitsPerSample() / 8);
+}
+
+}
+
+TEST_F(SoundManagerTest, OggDurationMatchesDecodedSamples)
+{
+    auto stream = GlobalSoundManager().openSoundStream("sound/test/jorge.ogg", false);
+
+    EXPECT_EQ(stream->getNumChannels(), 1);
+    EXPECT_EQ(stream->getBitsPerSample(), 16);
+    EXPECT_EQ(stream->getSampleRate(), 44100);
+
+    // The duration is read from the page headers, it should match the number of decoded samples
+    auto numFrames = readStream(*stream, 4096).size() / getFrameSize(*stream);
+    auto duration = GlobalSoundManager().getSoundFileDuration("sound/test/jorge.ogg");
+
+    EXPECT_NEAR(duration, static_cast<float>(numFrames) / stream->getSampleRate(), 1.0 / stream->getSampleRate());
+}
+
+TEST_F(SoundManagerTest, InvalidOggFileHasNoDuration)
+{
+    EXPECT_EQ(GlobalSoundManager().getSoundFileDuration("sound/test/invalid.ogg"), 0.0f)
+        << "The duration of a file without OGG pages should be reported as 0";
+
+    EXPECT_THROW(GlobalSoundManager().openSoundStream("sound/test/invalid.ogg", false), std::runtime_error);
+}
+
+TEST_F(SoundManagerTest, OpenNonExistingSoundStream)
+{
+    EXPECT_THROW(GlobalSoundManager().openSoundStream("sound/test/nonexisting.ogg", false), std::out_of_range);
+}
+
+TEST_F(SoundManagerTest, WaveStreamReadInChunks)
+{
+    auto stream = GlobalSoundManager().openSoundStream("sound/test/jorge.wav", false);
+
+    EXPECT_EQ(stream->getNumChannels(), 1);
+    EXPECT_EQ(stream->getBitsPerSample(), 16);
+    EXPECT_EQ(stream->getSampleRate(), 44100);
+
+    std::vector<std::size_t> chunkSizes;
+    auto samples = readStream(*stream, 1000, &chunkSizes);
+
+    // The payload of the data chunk, without any header bytes
+    EXPECT_EQ(samples.size(), 8456);
+    EXPECT_NEAR(static_cast<float>(samples.size() / getFrameSize(*stream)) / stream->getSampleRate(),
+        GlobalSoundManager().getSoundFileDuration("sound/test/jorge.wav"), 0.001);
+
+    // Every chunk is filled up, except the last one
+    for (std::size_t i = 0; i + 1 < chunkSizes.size(); ++i)
+    {
+        EXPECT_EQ(chunkSizes[i], 1000) << "Chunk " << i << " is not filled up";
+    }
+
+    // Reading the stream in one piece yields the same samples
+    auto otherStream = GlobalSoundManager().openSoundStream("sound/test/jorge.wav", false);
+    EXPECT_EQ(readStream(*otherStream, 65536), samples);
+
+    // The stream is not rewindable, it stays at its end
+    EXPECT_FALSE(stream->rewind());
+    EXPECT_EQ(readStream(*stream, 1000).size(), 0);
+}
+
+TEST_F(SoundManagerTest, OggStreamReturnsCompleteFrames)
+{
+    auto stream = GlobalSoundManager().openSoundStream("sound/test/jorge.ogg", false);
+    auto frameSize = getFrameSize(*stream);
+
+    // Request chunks of whole frames, the decoder must not split a frame between two reads
+    std::vector<std::size_t> chunkSizes;
+    auto samples = readStream(*stream, frameSize * 333, &chunkSizes);
+
+    EXPECT_GT(chunkSizes.size(), 1) << "The stream should have been read in several chunks";
+    EXPECT_EQ(samples.size() % frameSize, 0);
+
+    for (auto chunkSize : chunkSizes)
+    {
+        EXPECT_EQ(chunkSize % frameSize, 0) << "Chunk size " << chunkSize << " is not aligned to the frame size";
+    }
+
+    // Reading the stream in one piece yields the same samples
+    auto otherStream = GlobalSoundManager().openSoundStream("sound/test/jorge.ogg", false);
+    EXPECT_EQ(readStream(*otherStream, 1 << 20), samples);
+}
+
+TEST_F(SoundManagerTest, RewindSoundStreams)
+{
+    for (auto path : { "sound/test/jorge.ogg", "sound/test/jorge.wav" })
+    {
+        auto stream = GlobalSoundManager().openSoundStream(path, true);
+        auto samples = readStream(*stream, 2048);
+        ASSERT_FALSE(samples.empty()) << path;
+
+        // Rewinding at the end of the stream replays all the samples
+        EXPECT_TRUE(stream->rewind()) << path;
+        EXPECT_EQ(readStream(*stream, 2048), samples) << path << " differs after rewinding at the end";
+
+        // Rewinding in the middle of the stream, the data read afterwards starts at the first sample
+        EXPECT_TRUE(stream->rewind()) << path;
+        std::vector<char> firstChunk(1024);
+        EXPECT_EQ(stream->read(firstChunk.data(), firstChunk.size()), firstChunk.size());
+        EXPECT_TRUE(stream->rewind()) << path;
+        EXPECT_EQ(readStream(*stream, 2048), samples) << path << " differs after rewinding in the middle";
+    }
+}
+
 }
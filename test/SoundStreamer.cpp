@@ -0,0 +1,347 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include "sound/SoundStreamer.h"
+
+namespace test
+{
+
+namespace
+{
+
+// 8 bit mono stream, each byte holds its position in the stream (modulo 256)
+class CountingSoundStream :
+    public ISoundStream
+{
+private:
+    std::size_t _size;
+    std::size_t _position;
+
+public:
+    std::size_t numRewinds = 0;
+
+    CountingSoundStream(std::size_t size) :
+        _size(size),
+        _position(0)
+    {}
+
+    unsigned int getNumChannels() const override { return 1; }
+    unsigned int getBitsPerSample() const override { return 8; }
+    unsigned int getSampleRate() const override { return 22050; }
+
+    std::size_t read(char* buffer, std::size_t size) override
+    {
+        auto bytes = std::min(size, _size - _position);
+
+        for (std::size_t i = 0; i < bytes; ++i)
+        {
+            buffer[i] = static_cast<char>((_position + i) % 256);
+        }
+
+        _position += bytes;
+        return bytes;
+    }
+
+    bool rewind() override
+    {
+        ++numRewinds;
+        _position = 0;
+        return true;
+    }
+};
+
+// Records the buffer operations, the test decides which buffers have been processed
+class FakeStreamingSource :
+    public sound::IStreamingSource
+{
+private:
+    std::mutex _lock;
+    std::deque<unsigned int> _queue;
+    std::size_t _numProcessed = 0;
+    bool _playing = false;
+
+public:
+    // Processes all queued buffers immediately, as if playing at infinite speed
+    bool processEverything = false;
+
+    std::map<unsigned int, std::vector<char>> bufferData;
+    std::size_t numQueueCalls = 0;
+    std::size_t numPlayCalls = 0;
+
+    void setBufferData(unsigned int buffer, int format, const char* data,
+        std::size_t size, unsigned int sampleRate) override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        EXPECT_EQ(std::count(_queue.begin(), _queue.end(), buffer), 0) << "Queued buffer must not be overwritten";
+        bufferData[buffer].assign(data, data + size);
+    }
+
+    void queueBuffer(unsigned int buffer) override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _queue.push_back(buffer);
+        ++numQueueCalls;
+    }
+
+    unsigned int unqueueProcessedBuffer() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        updateProcessed();
+
+        EXPECT_GT(_numProcessed, 0) << "Unqueued a buffer that has not been processed";
+        --_numProcessed;
+
+        auto buffer = _queue.front();
+        _queue.pop_front();
+        return buffer;
+    }
+
+    std::size_t getNumProcessedBuffers() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        updateProcessed();
+        return _numProcessed;
+    }
+
+    std::size_t getNumQueuedBuffers() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _queue.size();
+    }
+
+    bool isPlaying() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _playing;
+    }
+
+    void play() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _playing = true;
+        ++numPlayCalls;
+    }
+
+    // Marks the given number of buffers at the front of the queue as played.
+    // The source stops once all of its buffers have been played.
+    void process(std::size_t numBuffers)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _numProcessed = std::min(_numProcessed + numBuffers, _queue.size());
+        _playing = _numProcessed < _queue.size();
+    }
+
+    std::vector<unsigned int> getQueue()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return std::vector<unsigned int>(_queue.begin(), _queue.end());
+    }
+
+    std::size_t getNumQueueCalls()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return numQueueCalls;
+    }
+
+private:
+    void updateProcessed()
+    {
+        if (processEverything)
+        {
+            _numProcessed = _queue.size();
+            _playing = false;
+        }
+    }
+};
+
+constexpr std::size_t TestBufferSize = 100;
+const sound::SoundStreamer::Buffers TestBuffers = { 11, 12, 13, 14 };
+
+// Checks that the buffer holds the bytes following the given stream position
+void expectStreamData(const std::vector<char>& data, std::size_t startPosition, std::size_t size)
+{
+    ASSERT_EQ(data.size(), size);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        ASSERT_EQ(data[i], static_cast<char>((startPosition + i) % 256)) << "Wrong sample at index " << i;
+    }
+}
+
+}
+
+TEST(SoundStreamerTest, InitialBuffersAreQueued)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(1000), 0, false, TestBuffers, TestBufferSize);
+
+    EXPECT_TRUE(streamer.queueInitialBuffers());
+    EXPECT_EQ(source.getQueue(), std::vector<unsigned int>(TestBuffers.begin(), TestBuffers.end()));
+
+    for (std::size_t i = 0; i < TestBuffers.size(); ++i)
+    {
+        expectStreamData(source.bufferData[TestBuffers[i]], i * TestBufferSize, TestBufferSize);
+    }
+}
+
+TEST(SoundStreamerTest, ShortStreamQueuesFewerBuffers)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(150), 0, false, TestBuffers, TestBufferSize);
+
+    EXPECT_TRUE(streamer.queueInitialBuffers());
+    EXPECT_EQ(source.getQueue(), (std::vector<unsigned int>{ 11, 12 }));
+    expectStreamData(source.bufferData[12], 100, 50);
+}
+
+TEST(SoundStreamerTest, EmptyStreamQueuesNothing)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(0), 0, true, TestBuffers, TestBufferSize);
+
+    EXPECT_FALSE(streamer.queueInitialBuffers()) << "Looping an empty stream must not spin";
+    EXPECT_TRUE(source.getQueue().empty());
+}
+
+TEST(SoundStreamerTest, ProcessedBuffersAreRefilled)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(10000), 0, false, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+    source.play();
+
+    // Nothing processed yet, nothing to do
+    EXPECT_TRUE(streamer.update());
+    EXPECT_EQ(source.getNumQueueCalls(), 4);
+
+    source.process(2);
+    EXPECT_TRUE(streamer.update());
+
+    // The two played buffers went to the back of the queue, holding the next chunks
+    EXPECT_EQ(source.getQueue(), (std::vector<unsigned int>{ 13, 14, 11, 12 }));
+    expectStreamData(source.bufferData[11], 400, TestBufferSize);
+    expectStreamData(source.bufferData[12], 500, TestBufferSize);
+    EXPECT_EQ(source.numPlayCalls, 1) << "Source is still playing, should not be restarted";
+}
+
+TEST(SoundStreamerTest, StoppedSourceIsResumed)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(10000), 0, false, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+    source.play();
+
+    // The source ran out of data before the buffers could be refilled
+    source.process(4);
+    EXPECT_TRUE(streamer.update());
+
+    EXPECT_EQ(source.getQueue().size(), 4);
+    EXPECT_EQ(source.numPlayCalls, 2) << "Source should have been restarted after refilling";
+}
+
+TEST(SoundStreamerTest, LoopingStreamIsRewound)
+{
+    auto stream = std::make_unique<CountingSoundStream>(150);
+    auto& streamRef = *stream;
+
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::move(stream), 0, true, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+
+    // All buffers are filled completely, the data continues at the start of the stream
+    EXPECT_EQ(source.getQueue().size(), 4);
+    expectStreamData(source.bufferData[11], 0, TestBufferSize);
+
+    std::vector<char> secondBuffer = source.bufferData[12];
+    ASSERT_EQ(secondBuffer.size(), TestBufferSize);
+    expectStreamData(std::vector<char>(secondBuffer.begin(), secondBuffer.begin() + 50), 100, 50);
+    expectStreamData(std::vector<char>(secondBuffer.begin() + 50, secondBuffer.end()), 0, 50);
+
+    EXPECT_EQ(streamRef.numRewinds, 2);
+
+    // Looping streams never run dry
+    for (int i = 0; i < 10; ++i)
+    {
+        source.process(4);
+        EXPECT_TRUE(streamer.update());
+        EXPECT_EQ(source.getQueue().size(), 4);
+    }
+}
+
+TEST(SoundStreamerTest, NonLoopingStreamFinishes)
+{
+    FakeStreamingSource source;
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(550), 0, false, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+
+    source.process(4);
+    EXPECT_TRUE(streamer.update());
+
+    // 400 bytes played, the remaining 150 are in two buffers
+    EXPECT_EQ(source.getQueue(), (std::vector<unsigned int>{ 11, 12 }));
+    expectStreamData(source.bufferData[12], 500, 50);
+
+    source.process(2);
+    EXPECT_FALSE(streamer.update()) << "No buffers left, the stream should be done";
+    EXPECT_TRUE(source.getQueue().empty());
+}
+
+TEST(SoundStreamerTest, WorkerFinishesStream)
+{
+    FakeStreamingSource source;
+    source.processEverything = true;
+
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(2000), 0, false, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+    streamer.start(std::chrono::milliseconds(1));
+
+    for (int i = 0; i < 1000 && !streamer.isFinished(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    EXPECT_TRUE(streamer.isFinished());
+    EXPECT_EQ(source.getNumQueueCalls(), 20) << "Every chunk should have been queued once";
+
+    streamer.stop();
+}
+
+TEST(SoundStreamerTest, StopEndsWorker)
+{
+    FakeStreamingSource source;
+    source.processEverything = true;
+
+    // Looping, this is never going to finish by itself
+    sound::SoundStreamer streamer(source, std::make_unique<CountingSoundStream>(1000), 0, true, TestBuffers, TestBufferSize);
+
+    streamer.queueInitialBuffers();
+    streamer.start(std::chrono::milliseconds(1));
+
+    for (int i = 0; i < 1000 && source.getNumQueueCalls() < 20; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    EXPECT_GE(source.getNumQueueCalls(), 20) << "Worker doesn't refill the buffers";
+
+    streamer.stop();
+
+    auto numQueueCalls = source.getNumQueueCalls();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(source.getNumQueueCalls(), numQueueCalls) << "Worker still running after stop()";
+    EXPECT_FALSE(streamer.isFinished());
+
+    // Stopping twice is fine
+    streamer.stop();
+}
+
+}
@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include "math/Hash.h"
+#include "render/ThumbnailFilename.h"
+
+namespace test
+{
+
+TEST(ThumbnailFilenameTest, ParseValidFilename)
+{
+    std::string key;
+    Vector2i sourceSize;
+
+    EXPECT_TRUE(render::parseThumbnailFilename("0123456789abcdef-fedcba9876543210_512x256", key, sourceSize));
+    EXPECT_EQ(key, "0123456789abcdef-fedcba9876543210");
+    EXPECT_EQ(sourceSize, Vector2i(512, 256));
+
+    // The file name is generated in the same format
+    EXPECT_EQ(render::getThumbnailFilename(key, sourceSize), "0123456789abcdef-fedcba9876543210_512x256.png");
+
+    // Underscores in the key are allowed, the last one separates the size
+    EXPECT_TRUE(render::parseThumbnailFilename("some_key_1x2048", key, sourceSize));
+    EXPECT_EQ(key, "some_key");
+    EXPECT_EQ(sourceSize, Vector2i(1, 2048));
+}
+
+TEST(ThumbnailFilenameTest, ParseInvalidFilename)
+{
+    std::string key = "unchanged";
+    Vector2i sourceSize(3, 4);
+
+    for (const auto& stem : {
+        "", "key", "key_", "key_512", "key_512x", "key_x256", "_512x256", "key_0x256", "key_512x0",
+        "key_-512x256", "key_512x-256", "key_512x256junk", "key_ 512x256", "key_512y256", "key_512x256_",
+        "key_512xx256", "keyx_512" })
+    {
+        EXPECT_FALSE(render::parseThumbnailFilename(stem, key, sourceSize)) << "Accepted " << stem;
+    }
+
+    EXPECT_EQ(key, "unchanged") << "Key should not be touched on failure";
+    EXPECT_EQ(sourceSize, Vector2i(3, 4)) << "Size should not be touched on failure";
+}
+
+TEST(ThumbnailFilenameTest, RemoveOutdatedThumbnails)
+{
+    std::map<std::string, std::string> thumbnails
+    {
+        { "aaaa-0001", "aaaa-0001.png" },
+        { "aaaa-0002", "aaaa-0002.png" },
+        { "aaaa-0003", "aaaa-0003.png" },
+        { "aaaab-0001", "aaaab-0001.png" }, // material hash starting with the same characters
+        { "aaa-0001", "aaa-0001.png" },     // material hash being a prefix of the other one
+        { "bbbb-0001", "bbbb-0001.png" },
+    };
+
+    auto removed = render::removeOutdatedThumbnails(thumbnails, "aaaa-0002");
+
+    std::sort(removed.begin(), removed.end());
+    EXPECT_EQ(removed, std::vector<std::string>({ "aaaa-0001.png", "aaaa-0003.png" }));
+
+    std::vector<std::string> remainingKeys;
+
+    for (const auto& [key, _] : thumbnails)
+    {
+        remainingKeys.push_back(key);
+    }
+
+    EXPECT_EQ(remainingKeys, std::vector<std::string>({ "aaa-0001", "aaaa-0002", "aaaab-0001", "bbbb-0001" }));
+
+    // The only thumbnail of a material is kept
+    EXPECT_TRUE(render::removeOutdatedThumbnails(thumbnails, "bbbb-0001").empty());
+    EXPECT_EQ(thumbnails.size(), 4);
+
+    // The new key doesn't need to be in the map yet
+    removed = render::removeOutdatedThumbnails(thumbnails, "aaab-0001");
+    EXPECT_TRUE(removed.empty());
+
+    removed = render::removeOutdatedThumbnails(thumbnails, "aaaab-0002");
+    EXPECT_EQ(removed, std::vector<std::string>({ "aaaab-0001.png" }));
+    EXPECT_EQ(thumbnails.size(), 3);
+}
+
+TEST(ThumbnailFilenameTest, RemoveOutdatedThumbnailsIgnoresMalformedKeys)
+{
+    std::map<std::string, std::string> thumbnails
+    {
+        { "aaaa-0001", "aaaa-0001.png" },
+        { "bbbb-0001", "bbbb-0001.png" },
+    };
+
+    // Without a material part, nothing must be considered outdated
+    EXPECT_TRUE(render::removeOutdatedThumbnails(thumbnails, "").empty());
+    EXPECT_TRUE(render::removeOutdatedThumbnails(thumbnails, "aaaa").empty());
+    EXPECT_TRUE(render::removeOutdatedThumbnails(thumbnails, "-0001").empty());
+    EXPECT_EQ(thumbnails.size(), 2);
+}
+
+TEST(ThumbnailFilenameTest, MakeThumbnailKey)
+{
+    auto makeKey = [](const std::string& asset, const std::string& source)
+    {
+        math::Hash assetHash;
+        assetHash.addString(asset);
+
+        math::Hash sourceHash;
+        sourceHash.addString(source);
+
+        return render::makeThumbnailKey(assetHash, sourceHash);
+    };
+
+    auto key = makeKey("models/md5/chars/guard.md5mesh", "source1");
+
+    EXPECT_EQ(key.length(), render::ThumbnailHashLength * 2 + 1);
+    EXPECT_EQ(key, makeKey("models/md5/chars/guard.md5mesh", "source1")) << "Key must be stable";
+
+    // A changed source is keeping the asset part, such that the old file is found as outdated
+    auto changedKey = makeKey("models/md5/chars/guard.md5mesh", "source2");
+    EXPECT_NE(key, changedKey);
+    EXPECT_EQ(render::getThumbnailAssetPrefix(key), render::getThumbnailAssetPrefix(changedKey));
+    EXPECT_NE(render::getThumbnailAssetPrefix(key),
+        render::getThumbnailAssetPrefix(makeKey("models/md5/chars/guard2.md5mesh", "source1")));
+
+    // Keys survive the round trip through the file name
+    std::string parsedKey;
+    Vector2i sourceSize;
+    auto filename = render::getThumbnailFilename(key, Vector2i(320, 240));
+    EXPECT_TRUE(render::parseThumbnailFilename(filename.substr(0, filename.length() - 4), parsedKey, sourceSize));
+    EXPECT_EQ(parsedKey, key);
+    EXPECT_EQ(sourceSize, Vector2i(320, 240));
+}
+
+}
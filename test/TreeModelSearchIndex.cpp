@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "wxutil/dataview/TreeModel.h"
+#include "wxutil/dataview/TreeModelSearchIndex.h"
+
+namespace test
+{
+
+namespace
+{
+
+struct SearchIndexColumns :
+    public wxutil::TreeModel::ColumnRecord
+{
+    wxutil::TreeModel::Column name;
+
+    SearchIndexColumns() :
+        name(add(wxutil::TreeModel::Column::String))
+    {}
+};
+
+class TreeModelSearchIndexTest :
+    public ::testing::Test
+{
+protected:
+    SearchIndexColumns _columns;
+    wxutil::TreeModel::Ptr _model;
+    wxutil::TreeModelSearchIndex _index;
+    wxString _filterText;
+
+    wxDataViewItem _folder;
+    wxDataViewItem _stone;
+    wxDataViewItem _wood;
+
+    void SetUp() override
+    {
+        _model = new wxutil::TreeModel(_columns);
+
+        _folder = addRow(wxDataViewItem(), "Textures");
+        _stone = addRow(_folder, "Stone");
+        _wood = addRow(_folder, "Wood");
+
+        _index.Reset(*_model, { _columns.name });
+    }
+
+    wxDataViewItem addRow(const wxDataViewItem& parent, const wxString& name)
+    {
+        auto row = parent.IsOk() ? _model->AddItemUnderParent(parent) : _model->AddItem();
+        row[_columns.name] = name;
+        row.SendItemAdded();
+
+        return row.getItem();
+    }
+
+    void renameRow(const wxDataViewItem& item, const wxString& name)
+    {
+        wxutil::TreeModel::Row row(item, *_model);
+        row[_columns.name] = name;
+    }
+
+    // Matches the rows against the cached search text, like the ResourceTreeView does
+    wxutil::TreeModelSearchIndex::MatchFunction getMatchFunction()
+    {
+        return [this](const wxDataViewItem& item)
+        {
+            return _index.GetSearchText(item)->Contains(_filterText);
+        };
+    }
+};
+
+}
+
+TEST_F(TreeModelSearchIndexTest, EvaluateVisibility)
+{
+    _filterText = "stone";
+    _index.Evaluate(getMatchFunction());
+
+    EXPECT_TRUE(_index.IsVisible(_stone));
+    EXPECT_FALSE(_index.IsVisible(_wood));
+    EXPECT_TRUE(_index.IsVisible(_folder)) << "Parent of a matching row should be visible";
+}
+
+TEST_F(TreeModelSearchIndexTest, UpdateRenamedRow)
+{
+    _filterText = "stone";
+    _index.Evaluate(getMatchFunction());
+
+    renameRow(_stone, "Brick");
+    _index.Update(_stone, getMatchFunction());
+
+    EXPECT_FALSE(_index.IsVisible(_stone));
+    EXPECT_FALSE(_index.IsVisible(_folder));
+
+    renameRow(_wood, "Stoneware");
+    _index.Update(_wood, getMatchFunction());
+
+    EXPECT_TRUE(_index.IsVisible(_wood));
+    EXPECT_TRUE(_index.IsVisible(_folder));
+}
+
+// A row changed while a full re-evaluation is pending doesn't get an Update() call,
+// the re-evaluation must not use the search text cached before the change
+TEST_F(TreeModelSearchIndexTest, RenameRowWhileEvaluationIsPending)
+{
+    _filterText = "stone";
+    _index.Evaluate(getMatchFunction());
+    EXPECT_TRUE(_index.IsVisible(_stone));
+
+    // A row has been added, the ResourceTreeView is going to re-evaluate the whole tree
+    auto brick = addRow(_folder, "Brick");
+
+    renameRow(_stone, "Marble");
+    _index.InvalidateSearchText(_stone);
+
+    _index.Evaluate(getMatchFunction());
+
+    EXPECT_FALSE(_index.IsVisible(_stone)) << "Renamed row still matches its old name";
+    EXPECT_FALSE(_index.IsVisible(brick));
+    EXPECT_FALSE(_index.IsVisible(_folder));
+
+    EXPECT_EQ(*_index.GetSearchText(_stone), "marble");
+}
+
+// Removing a folder drops the entries of its children too, the model
+// might hand out their IDs again for rows added later on
+TEST_F(TreeModelSearchIndexTest, RemoveFolderWithChildren)
+{
+    auto models = addRow(wxDataViewItem(), "Models");
+
+    _filterText = "stone";
+    _index.Evaluate(getMatchFunction());
+    EXPECT_TRUE(_index.IsVisible(_stone));
+
+    _index.Remove(_folder);
+    _model->RemoveItem(_folder);
+
+    EXPECT_FALSE(_index.IsEvaluated(_folder));
+    EXPECT_FALSE(_index.IsEvaluated(_stone)) << "Child of the removed folder is still indexed";
+    EXPECT_FALSE(_index.IsEvaluated(_wood)) << "Child of the removed folder is still indexed";
+    EXPECT_FALSE(_index.IsVisible(_stone));
+    EXPECT_TRUE(_index.IsEvaluated(models)) << "Sibling of the removed folder should be kept";
+
+    // Add the same number of rows again, some of them might get the IDs of the removed ones
+    auto materials = addRow(wxDataViewItem(), "Materials");
+    auto metal = addRow(materials, "Metal");
+    auto glass = addRow(materials, "Glass");
+
+    for (const auto& item : { materials, metal, glass })
+    {
+        EXPECT_FALSE(_index.IsEvaluated(item)) << "New row must not be evaluated yet";
+        EXPECT_FALSE(_index.IsVisible(item)) << "New row must not be visible before evaluation";
+    }
+
+    EXPECT_EQ(*_index.GetSearchText(materials), "materials");
+    EXPECT_EQ(*_index.GetSearchText(metal), "metal");
+    EXPECT_EQ(*_index.GetSearchText(glass), "glass");
+
+    _index.Evaluate(getMatchFunction());
+
+    EXPECT_FALSE(_index.IsVisible(metal));
+    EXPECT_FALSE(_index.IsVisible(materials));
+
+    _filterText = "metal";
+    _index.Evaluate(getMatchFunction());
+
+    EXPECT_TRUE(_index.IsVisible(metal));
+    EXPECT_TRUE(_index.IsVisible(materials));
+    EXPECT_FALSE(_index.IsVisible(glass));
+    EXPECT_FALSE(_index.IsVisible(models));
+}
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+#include "dm.gameconnection/MessageTcp.h"
+#include "dm.gameconnection/clsocket/ActiveSocket.h"
+#include "dm.gameconnection/clsocket/PassiveSocket.h"
+
+namespace test
+{
+
+// Stand-in for TheDarkMod's automation server, listening on the loopback interface
+// on a port assigned by the system, such that parallel test runs don't collide.
+// Accepts a single connection and answers every request using the given handler,
+// which is invoked on the server thread with the request content (without the seqno line).
+class LoopbackGameServer
+{
+public:
+    using RequestHandler = std::function<std::string(const std::string& request)>;
+
+private:
+    RequestHandler _handler;
+
+    CPassiveSocket _listener;
+    bool _listening;
+    int _port;
+
+    std::atomic<bool> _stopped;
+    std::thread _thread;
+
+    std::mutex _lock;
+    std::vector<std::string> _requests;
+
+public:
+    LoopbackGameServer(const RequestHandler& handler) :
+        _handler(handler),
+        _port(0),
+        _stopped(false)
+    {
+        // Port 0 lets the system pick a free port, look it up after binding
+        _listening = _listener.Initialize() && _listener.SetNonblocking() &&
+            _listener.Listen("127.0.0.1", 0);
+
+        if (_listening)
+        {
+            sockaddr_in address;
+            socklen_t addressLength = sizeof(address);
+
+            _listening = getsockname(_listener.GetSocketDescriptor(),
+                reinterpret_cast<sockaddr*>(&address), &addressLength) == 0;
+            _port = ntohs(address.sin_port);
+        }
+
+        if (_listening)
+        {
+            _thread = std::thread([this]() { run(); });
+        }
+    }
+
+    ~LoopbackGameServer()
+    {
+        _stopped = true;
+
+        if (_thread.joinable())
+        {
+            _thread.join();
+        }
+    }
+
+    bool isListening() const
+    {
+        return _listening;
+    }
+
+    // The port the server is listening on, only valid if isListening() is true
+    int getPort() const
+    {
+        return _port;
+    }
+
+    // Returns the contents of all requests received so far
+    std::vector<std::string> getRequests()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _requests;
+    }
+
+private:
+    void run()
+    {
+        std::unique_ptr<gameconn::MessageTcp> connection;
+        std::vector<char> message;
+
+        while (!_stopped)
+        {
+            if (!connection)
+            {
+                if (auto client = _listener.Accept())
+                {
+                    client->SetNonblocking();
+                    connection = std::make_unique<gameconn::MessageTcp>();
+                    connection->init(std::unique_ptr<CActiveSocket>(client));
+                }
+            }
+            else
+            {
+                while (connection->readMessage(message))
+                {
+                    std::string fullRequest(message.begin(), message.end());
+
+                    // Requests are prefixed with "seqno N\n", the response is using the same number
+                    int seqno = 0;
+                    auto lineEnd = fullRequest.find('\n');
+
+                    if (lineEnd == std::string::npos || sscanf(fullRequest.c_str(), "seqno %d", &seqno) != 1)
+                    {
+                        continue;
+                    }
+
+                    auto request = fullRequest.substr(lineEnd + 1);
+                    {
+                        std::lock_guard<std::mutex> lock(_lock);
+                        _requests.push_back(request);
+                    }
+
+                    auto response = "response " + std::to_string(seqno) + "\n" + _handler(request);
+                    connection->writeMessage(response.data(), static_cast<int>(response.size()));
+                }
+
+                connection->think();
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+}